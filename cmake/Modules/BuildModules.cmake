@@ -21,6 +21,13 @@ macro (BuildModules)
 	    cocos_find_package(FMOD FMOD REQUIRED)
 	    cocos_find_package(Fontconfig FONTCONFIG REQUIRED)
 	    cocos_find_package(GTK3 GTK3 REQUIRED)
+	    if(USE_AUDIO_MIXER)
+	      # optional, the mixer falls back to its null output without ALSA
+	      cocos_find_package(ALSA ALSA)
+	      if(ALSA_FOUND)
+	        add_definitions(-DCC_AUDIO_MIXER_USE_ALSA=1)
+	      endif()
+	    endif()
 	  endif()
 
 	  if(WINDOWS)
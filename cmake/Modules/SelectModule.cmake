@@ -30,6 +30,7 @@ macro (SelectModule)
   option(USE_BULLET "Use bullet for physics3d library" ON)
   option(USE_RECAST "Use Recast for navigation mesh" ON)
   option(USE_WEBP "Use WebP codec" ${USE_WEBP_DEFAULT})
+  option(USE_AUDIO_MIXER "Use the software mixer for AudioEngine on Linux" OFF)
   option(BUILD_SHARED_LIBS "Build shared libraries" OFF)
   option(DEBUG_MODE "Debug or release?" ON)
   option(BUILD_EXTENSIONS "Build extension library" ON)
@@ -36,6 +36,13 @@ macro (SetCompilerOptions)
 		add_definitions(-DCC_USE_NAVMESH=0)
 	endif()
 
+    # definitions for the software audio mixer
+	if (LINUX AND USE_AUDIO_MIXER)
+		add_definitions(-DCC_USE_AUDIO_MIXER=1)
+	else()
+		add_definitions(-DCC_USE_AUDIO_MIXER=0)
+	endif()
+
 	# Compiler options
 	if(MSVC)
 	  add_definitions(-D_CRT_SECURE_NO_WARNINGS -D_SCL_SECURE_NO_WARNINGS
@@ -382,6 +382,18 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, const s
     _loadedFileNames->insert(plist);
 }
 
+void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, ValueMap& dictionary, const std::string& textureFileName)
+{
+    CCASSERT(textureFileName.size()>0, "texture name should not be null");
+    if (_loadedFileNames->find(plist) != _loadedFileNames->end())
+    {
+        return; // We already added it
+    }
+
+    addSpriteFramesWithDictionary(dictionary, textureFileName);
+    _loadedFileNames->insert(plist);
+}
+
 void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist)
 {
     CCASSERT(plist.size()>0, "plist filename should not be nullptr");
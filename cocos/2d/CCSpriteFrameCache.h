@@ -159,6 +159,17 @@ public:
      */
     void addSpriteFramesWithFileContent(const std::string& plist_content, Texture2D *texture);
 
+    /** Adds multiple Sprite Frames from the dictionary of a plist file read beforehand, by a loading thread for instance.
+     * The file counts as loaded, as with addSpriteFramesWithFile.
+     * @js NA
+     * @lua NA
+     *
+     * @param plist Plist file name.
+     * @param dictionary The content of the plist file.
+     * @param textureFileName Texture file name.
+     */
+    void addSpriteFramesWithFile(const std::string& plist, ValueMap& dictionary, const std::string& textureFileName);
+
     /** Adds an sprite frame with a given name.
      If the name already exists, then the contents of the old name will be replaced with the new one.
      *
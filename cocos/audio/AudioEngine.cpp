@@ -29,6 +29,11 @@
 #include <queue>
 #include "platform/CCFileUtils.h"
 #include "base/ccUtils.h"
+#include "base/ccUTF8.h"
+#include "base/CCConsole.h"
+#include "base/CCDirector.h"
+#include "base/CCProfiling.h"
+#include "base/CCScheduler.h"
 
 #if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
 #include "audio/android/AudioEngine-inl.h"
@@ -46,6 +51,10 @@
 
 #define TIME_DELAY_PRECISION 0.0001
 
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX && CC_USE_AUDIO_MIXER
+#define AUDIO_ENGINE_SOFTWARE_MIXER 1
+#endif
+
 #ifdef ERROR
 #undef ERROR
 #endif // ERROR
@@ -188,6 +197,9 @@ int AudioEngine::play2d(const std::string& filePath, bool loop, float volume, co
 {
     int ret = AudioEngine::INVALID_AUDIO_ID;
 
+    // may decode the file synchronously
+    CC_PROFILER_START_CATEGORY(kProfilerCategoryAudio, "AudioEngine - play2d");
+
     do {
         if ( !lazyInit() ){
             break;
@@ -204,10 +216,6 @@ int AudioEngine::play2d(const std::string& filePath, bool loop, float volume, co
             profileHelper->profile = *profile;
         }
         
-        if (_audioIDInfoMap.size() >= _maxInstances) {
-            log("Fail to play %s cause by limited max instance of AudioEngine",filePath.c_str());
-            break;
-        }
         if (profileHelper)
         {
              if(profileHelper->profile.maxInstances != 0 && profileHelper->audioIDs.size() >= profileHelper->profile.maxInstances){
@@ -229,7 +237,23 @@ int AudioEngine::play2d(const std::string& filePath, bool loop, float volume, co
         else if (volume > 1.0f){
             volume = 1.0f;
         }
+
+        // replace a less important instance rather than failing
+        if (_audioIDInfoMap.size() >= _maxInstances) {
+            int stolenID = findStealableAudio(profileHelper ? profileHelper->profile.priority : 0);
+            if (stolenID == INVALID_AUDIO_ID) {
+                log("Fail to play %s cause by limited max instance of AudioEngine",filePath.c_str());
+                break;
+            }
+            stop(stolenID);
+        }
         
+#if AUDIO_ENGINE_SOFTWARE_MIXER
+        if (profileHelper && profileHelper->profile.stream) {
+            ret = _audioEngineImpl->playStream(filePath, loop, volume);
+        }
+        else
+#endif
         ret = _audioEngineImpl->play2d(filePath, loop, volume);
         if (ret != INVALID_AUDIO_ID)
         {
@@ -244,11 +268,18 @@ int AudioEngine::play2d(const std::string& filePath, bool loop, float volume, co
             if (profileHelper) {
                 profileHelper->lastPlayTime = utils::gettime();
                 profileHelper->audioIDs.push_back(ret);
+#if AUDIO_ENGINE_SOFTWARE_MIXER
+                if (profileHelper->profile.keepResident) {
+                    _audioEngineImpl->setKeepResident(filePath, true);
+                }
+                _audioEngineImpl->setPriority(ret, profileHelper->profile.priority);
+#endif
             }
             audioRef.profileHelper = profileHelper;
         }
     } while (0);
 
+    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryAudio, "AudioEngine - play2d");
     return ret;
 }
 
@@ -345,6 +376,28 @@ void AudioEngine::remove(int audioID)
     }
 }
 
+int AudioEngine::findStealableAudio(int priority)
+{
+    int stealableID = INVALID_AUDIO_ID;
+    int stealablePriority = priority;
+    float stealableVolume = 0.0f;
+    for (auto& it : _audioIDInfoMap) {
+        auto& info = it.second;
+        if (info.state == AudioState::PAUSED) {
+            continue;
+        }
+        int infoPriority = info.profileHelper ? info.profileHelper->profile.priority : 0;
+        // only a lower priority is replaced, the lowest first, then the quietest
+        if (infoPriority < stealablePriority
+            || (stealableID != INVALID_AUDIO_ID && infoPriority == stealablePriority && info.volume < stealableVolume)) {
+            stealableID = it.first;
+            stealablePriority = infoPriority;
+            stealableVolume = info.volume;
+        }
+    }
+    return stealableID;
+}
+
 void AudioEngine::stopAll()
 {
     if(!_audioEngineImpl){
@@ -437,6 +490,17 @@ void AudioEngine::setFinishCallback(int audioID, const std::function<void (int,
     }
 }
 
+bool AudioEngine::playNext(int audioID, const std::string& filePath)
+{
+#if AUDIO_ENGINE_SOFTWARE_MIXER
+    auto it = _audioIDInfoMap.find(audioID);
+    if (it != _audioIDInfoMap.end() && FileUtils::getInstance()->isFileExist(filePath)) {
+        return _audioEngineImpl->playNext(audioID, filePath);
+    }
+#endif
+    return false;
+}
+
 bool AudioEngine::setMaxAudioInstance(int maxInstances)
 {
     if (maxInstances > 0 && maxInstances <= MAX_AUDIOINSTANCES) {
@@ -531,6 +595,122 @@ void AudioEngine::preload(const std::string& filePath, std::function<void(bool i
     }
 }
 
+void AudioEngine::setCacheBudget(size_t bytes)
+{
+#if AUDIO_ENGINE_SOFTWARE_MIXER
+    if (lazyInit())
+    {
+        _audioEngineImpl->setPcmCacheBudget(bytes);
+    }
+#endif
+}
+
+size_t AudioEngine::getCacheBudget()
+{
+#if AUDIO_ENGINE_SOFTWARE_MIXER
+    if (lazyInit())
+    {
+        return _audioEngineImpl->getPcmCacheBudget();
+    }
+#endif
+    return 0;
+}
+
+AudioMetrics::AudioMetrics()
+: instances(0)
+, activeVoices(0)
+, virtualVoices(0)
+, streams(0)
+, lastMixTime(0)
+, maxMixTime(0)
+, averageMixTime(0.0f)
+, bufferDuration(0)
+, mixedBuffers(0)
+, outputUnderruns(0)
+, streamUnderruns(0)
+, cacheSize(0)
+, cacheBudget(0)
+, cachedFiles(0)
+, cacheHits(0)
+, cacheMisses(0)
+, cacheEvictions(0)
+, streamSize(0)
+{
+}
+
+AudioMetrics AudioEngine::getMetrics()
+{
+    AudioMetrics metrics;
+    metrics.instances = (int)_audioIDInfoMap.size();
+#if AUDIO_ENGINE_SOFTWARE_MIXER
+    if (_audioEngineImpl)
+    {
+        _audioEngineImpl->getMetrics(metrics);
+    }
+#endif
+    return metrics;
+}
+
+void AudioEngine::resetMetrics()
+{
+#if AUDIO_ENGINE_SOFTWARE_MIXER
+    if (_audioEngineImpl)
+    {
+        _audioEngineImpl->resetMetrics();
+    }
+#endif
+}
+
+std::string AudioEngine::getMetricsSummary()
+{
+    auto metrics = getMetrics();
+    std::string summary = StringUtils::format("instances: %d\n", metrics.instances);
+    if (metrics.bufferDuration == 0)
+    {
+        // the back end doesn't report more
+        return summary;
+    }
+
+    summary += StringUtils::format("voices: %d active, %d virtual, %d streams\n", metrics.activeVoices, metrics.virtualVoices, metrics.streams);
+    summary += StringUtils::format("mixer: last %u us, average %.1f us, max %u us per buffer of %u us, %llu buffers\n",
+                                   metrics.lastMixTime, metrics.averageMixTime, metrics.maxMixTime, metrics.bufferDuration, metrics.mixedBuffers);
+    summary += StringUtils::format("underruns: %u output, %u streams\n", metrics.outputUnderruns, metrics.streamUnderruns);
+    summary += StringUtils::format("cache: %d files, %.2f of %.2f MB, %u hits, %u misses, %u evictions\n",
+                                   metrics.cachedFiles, metrics.cacheSize / 1048576.0, metrics.cacheBudget / 1048576.0,
+                                   metrics.cacheHits, metrics.cacheMisses, metrics.cacheEvictions);
+    summary += StringUtils::format("streams: %.1f KB\n", metrics.streamSize / 1024.0);
+    for (const auto& decode : metrics.decodes)
+    {
+        const auto& stats = decode.second;
+        summary += StringUtils::format("decoded %s: %u times, average %.2f ms, max %.2f ms, %.1f KB\n", decode.first.c_str(),
+                                       stats.count, stats.count ? stats.totalTime / stats.count : 0.0, stats.maxTime, stats.size / 1024.0);
+    }
+    return summary;
+}
+
+void AudioEngine::addConsoleCommand(Console* console)
+{
+    if (console == nullptr)
+    {
+        console = Director::getInstance()->getConsole();
+    }
+
+    // the commands run in the console thread, the audio engine is used from the cocos thread
+    console->addCommand({"audio", "Print the audio engine metrics. Args: [-h | help | reset | ]",
+        [](int fd, const std::string& args) {
+            Director::getInstance()->getScheduler()->performFunctionInCocosThread([=](){
+                Console::Utility::mydprintf(fd, "%s", AudioEngine::getMetricsSummary().c_str());
+                Console::Utility::sendPrompt(fd);
+            });
+        }});
+    console->addSubCommand("audio", {"reset", "Clear the maximum times, underruns and decoding costs.",
+        [](int fd, const std::string& args) {
+            Director::getInstance()->getScheduler()->performFunctionInCocosThread([](){
+                AudioEngine::resetMetrics();
+            });
+        }});
+}
+
 void AudioEngine::addTask(const std::function<void()>& task)
 {
     lazyInit();
@@ -9,6 +9,10 @@ LOCAL_MODULE_FILENAME := libaudioengine
 
 LOCAL_SRC_FILES := AudioEngine-inl.cpp \
                    ../AudioEngine.cpp \
+                   ../mixer/MixerOutput.cpp \
+                   ../mixer/MixerStream.cpp \
+                   ../mixer/PcmCache.cpp \
+                   ../mixer/SoftwareMixer.cpp \
                    CCThreadPool.cpp \
                    AssetFd.cpp \
                    AudioDecoder.cpp \
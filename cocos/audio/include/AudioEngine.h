@@ -29,6 +29,7 @@
 
 #include <functional>
 #include <list>
+#include <map>
 #include <string>
 #include <unordered_map>
 
@@ -45,6 +46,9 @@
  */
 
 NS_CC_BEGIN
+
+class Console;
+
     namespace experimental{
 
 /**
@@ -63,6 +67,23 @@ public:
     
     /* Minimum delay in between sounds */
     double minDelay;
+
+    /* Whether the decoded audio played with this profile is kept in memory whatever the cache budget */
+    bool keepResident;
+
+    /*
+     * Whether the audio played with this profile is decoded while it plays, in a small buffer,
+     * instead of being decoded whole. Meant for the music, only the software mixer of Linux streams.
+     */
+    bool stream;
+
+    /*
+     * When the maximum number of audio instances is reached, a new instance stops a playing instance
+     * with a lower priority, the lowest and then the quietest one. Without such an instance the new one fails to play,
+     * so with the default priority 0 of every profile nothing is ever stopped.
+     * The software mixer of Linux also mixes the highest priorities first.
+     */
+    int priority;
     
     /**
      * Default constructor
@@ -72,11 +93,71 @@ public:
     AudioProfile()
     : maxInstances(0)
     , minDelay(0.0)
+    , keepResident(false)
+    , stream(false)
+    , priority(0)
     {
         
     }
 };
 
+/**
+ * @class AudioMetrics
+ *
+ * @brief Performance counters of the audio engine, see AudioEngine::getMetrics.
+ * Only the software mixer of Linux reports the voices, mixing, decoding and cache counters,
+ * the other back ends report the audio instances.
+ * @js NA
+ * @lua NA
+ */
+class EXPORT_DLL AudioMetrics
+{
+public:
+    struct DecodeStats
+    {
+        unsigned int count;
+        /* Milliseconds spent decoding the file */
+        double totalTime;
+        double maxTime;
+        /* Bytes of the decoded audio, for a streamed file the bytes held by its stream */
+        size_t size;
+
+        DecodeStats() : count(0), totalTime(0), maxTime(0), size(0) {}
+    };
+
+    /* Audio instances playing or paused */
+    int instances;
+    /* Voices of the mixer playing or paused, and the playing ones which weren't mixed in the last buffer */
+    int activeVoices;
+    int virtualVoices;
+    int streams;
+
+    /* Microseconds spent by the mixer thread per buffer, they must stay well below bufferDuration */
+    unsigned int lastMixTime;
+    unsigned int maxMixTime;
+    float averageMixTime;
+    unsigned int bufferDuration;
+    unsigned long long mixedBuffers;
+
+    /* Times the output ran out of mixed audio, and buffers the streams didn't decode in time */
+    unsigned int outputUnderruns;
+    unsigned int streamUnderruns;
+
+    /* Decoded audio kept in memory */
+    size_t cacheSize;
+    size_t cacheBudget;
+    int cachedFiles;
+    unsigned int cacheHits;
+    unsigned int cacheMisses;
+    unsigned int cacheEvictions;
+    size_t streamSize;
+
+    /* Decoding cost by file path */
+    std::map<std::string, DecodeStats> decodes;
+
+    AudioMetrics();
+};
+
 class AudioEngineImpl;
 
 /**
@@ -236,6 +317,18 @@ public:
      * @param callback
      */
     static void setFinishCallback(int audioID, const std::function<void(int,const std::string&)>& callback);
+
+    /**
+     * Queue an audio file to be played right after an audio instance, without a gap.
+     * The instance must be played with a `AudioProfile::stream` profile, it keeps its audioID
+     * and its finish callback is invoked once the last queued file ends.
+     * If the instance loops, the last queued file is looped.
+     *
+     * @param audioID An audioID returned by the play2d function.
+     * @param filePath The path of the audio file played next.
+     * @return False if the instance isn't streamed or the file can't be opened.
+     */
+    static bool playNext(int audioID, const std::string& filePath);
     
     /**
      * Gets the maximum number of simultaneous audio instance of AudioEngine.
@@ -294,9 +387,44 @@ public:
      */
     static void preload(const std::string& filePath, std::function<void(bool isSuccess)> callback);
 
+    /**
+     * Sets the maximum bytes of decoded audio kept in memory.
+     * The least recently used audio is evicted first, audio being played or played with a
+     * `AudioProfile::keepResident` profile is never evicted.
+     * Only the software mixer back end of Linux shares a decoded audio cache, other back ends ignore it.
+     *
+     * @param bytes The budget in bytes, 32 MB by default.
+     */
+    static void setCacheBudget(size_t bytes);
+
+    /**
+     * Gets the maximum bytes of decoded audio kept in memory, 0 if the back end doesn't support it.
+     */
+    static size_t getCacheBudget();
+
+    /**
+     * Gets the performance counters of the audio engine.
+     * The maximum times, underruns and decoding costs are accumulated since the last resetMetrics.
+     */
+    static AudioMetrics getMetrics();
+
+    static void resetMetrics();
+
+    /** Gets the metrics as readable text. */
+    static std::string getMetricsSummary();
+
+    /**
+     * Add the "audio" command to a console, Director's console is used if console is nullptr.
+     * Usage: audio [reset]
+     * The calls of the cocos thread are profiled by enabling kProfilerCategoryAudio.
+     */
+    static void addConsoleCommand(Console* console = nullptr);
+
 protected:
     static void addTask(const std::function<void()>& task);
     static void remove(int audioID);
+    /** Find the playing instance with a priority lower than this one that a new instance can replace. */
+    static int findStealableAudio(int priority);
     
     struct ProfileHelper
     {
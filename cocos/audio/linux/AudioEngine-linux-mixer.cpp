@@ -0,0 +1,575 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+/**
+ * AudioEngineImpl built on SoftwareMixer, used when cocos is configured with USE_AUDIO_MIXER.
+ * FMOD only decodes the files, the output is selected by the COCOS_AUDIO_OUTPUT environment
+ * variable, see MixerOutput::create. It defaults to ALSA when available, to the null output otherwise.
+ */
+#include <cstdlib>
+#include "audio/linux/AudioEngine-linux.h"
+#include "audio/mixer/MixerOps.h"
+#include "audio/mixer/MixerOutput.h"
+
+#include "base/CCDirector.h"
+#include "base/CCProfiling.h"
+#include "base/CCScheduler.h"
+#include "platform/CCFileUtils.h"
+
+using namespace cocos2d;
+using namespace cocos2d::experimental;
+
+static bool ERRCHECK(FMOD_RESULT result)
+{
+    if (result != FMOD_OK) {
+        printf("FMOD error! (%d) %s\n", result, FMOD_ErrorString(result));
+        return true;
+    }
+    return false;
+}
+
+/**
+ * decodes the whole file, called from the AudioEngine workers
+ */
+static std::shared_ptr<MixerPcm> decodePcm(FMOD::System *system, const std::string &fullPath)
+{
+    FMOD::Sound *sound = nullptr;
+    FMOD_RESULT result = system->createSound(fullPath.c_str(), FMOD_OPENONLY | FMOD_ACCURATETIME, 0, &sound);
+    if (ERRCHECK(result)) {
+        return nullptr;
+    }
+
+    FMOD_SOUND_FORMAT format;
+    int channels = 0;
+    int bits = 0;
+    float frequency = 0;
+    unsigned int length = 0;
+    sound->getFormat(nullptr, &format, &channels, &bits);
+    sound->getDefaults(&frequency, nullptr);
+    sound->getLength(&length, FMOD_TIMEUNIT_PCM);
+
+    std::shared_ptr<MixerPcm> pcm;
+    if ((format == FMOD_SOUND_FORMAT_PCM16 || format == FMOD_SOUND_FORMAT_PCMFLOAT) && (channels == 1 || channels == 2)) {
+        pcm = std::make_shared<MixerPcm>();
+        pcm->channelCount = channels;
+        pcm->sampleRate = (int)frequency;
+        pcm->samples.resize((size_t)length * channels);
+
+        unsigned int read = 0;
+        if (format == FMOD_SOUND_FORMAT_PCM16) {
+            result = sound->readData(pcm->samples.data(), (unsigned int)(pcm->samples.size() * sizeof(int16_t)), &read);
+            read /= sizeof(int16_t);
+        }
+        else {
+            std::vector<float> samples(pcm->samples.size());
+            result = sound->readData(samples.data(), (unsigned int)(samples.size() * sizeof(float)), &read);
+            read /= sizeof(float);
+            mixer::floatToInt16(samples.data(), pcm->samples.data(), read);
+        }
+        if (result != FMOD_OK && result != FMOD_ERR_FILE_EOF) {
+            ERRCHECK(result);
+            pcm = nullptr;
+        }
+        else {
+            pcm->samples.resize(read);
+            pcm->frameCount = (int)(read / channels);
+        }
+    }
+    else {
+        printf("AudioEngineImpl: unsupported format %d with %d channels in %s\n", format, channels, fullPath.c_str());
+    }
+    sound->release();
+
+    return pcm;
+}
+
+/**
+ * decodes a file while it plays, called from the worker of a MixerStream
+ */
+class FmodStreamDecoder : public StreamDecoder
+{
+public:
+    static FmodStreamDecoder* create(FMOD::System *system, const std::string &fullPath)
+    {
+        FMOD::Sound *sound = nullptr;
+        FMOD_RESULT result = system->createSound(fullPath.c_str(), FMOD_OPENONLY | FMOD_CREATESTREAM | FMOD_ACCURATETIME, 0, &sound);
+        if (ERRCHECK(result)) {
+            return nullptr;
+        }
+
+        FMOD_SOUND_FORMAT format;
+        int channels = 0;
+        int bits = 0;
+        float frequency = 0;
+        unsigned int length = 0;
+        sound->getFormat(nullptr, &format, &channels, &bits);
+        sound->getDefaults(&frequency, nullptr);
+        sound->getLength(&length, FMOD_TIMEUNIT_PCM);
+        if ((format != FMOD_SOUND_FORMAT_PCM16 && format != FMOD_SOUND_FORMAT_PCMFLOAT) || channels < 1 || channels > 2) {
+            printf("AudioEngineImpl: unsupported format %d with %d channels in %s\n", format, channels, fullPath.c_str());
+            sound->release();
+            return nullptr;
+        }
+        return new (std::nothrow) FmodStreamDecoder(sound, format, channels, (int)frequency, length);
+    }
+
+    ~FmodStreamDecoder()
+    {
+        _sound->release();
+    }
+
+    virtual int getChannelCount() const override { return _channelCount; }
+
+    virtual int getSampleRate() const override { return _sampleRate; }
+
+    virtual int64_t getFrameCount() const override { return _frameCount; }
+
+    virtual int read(int16_t *samples, int frameCount) override
+    {
+        unsigned int read = 0;
+        FMOD_RESULT result;
+        if (_format == FMOD_SOUND_FORMAT_PCM16) {
+            result = _sound->readData(samples, frameCount * _channelCount * sizeof(int16_t), &read);
+            read /= sizeof(int16_t);
+        }
+        else {
+            // reused, the size of the reads of the stream doesn't change
+            _floatSamples.resize(frameCount * _channelCount);
+            result = _sound->readData(_floatSamples.data(), frameCount * _channelCount * sizeof(float), &read);
+            read /= sizeof(float);
+            mixer::floatToInt16(_floatSamples.data(), samples, read);
+        }
+        if (result != FMOD_OK && result != FMOD_ERR_FILE_EOF) {
+            ERRCHECK(result);
+            return 0;
+        }
+        return (int)(read / _channelCount);
+    }
+
+    virtual bool seek(int64_t frame) override
+    {
+        return !ERRCHECK(_sound->seekData((unsigned int)frame));
+    }
+
+private:
+    FmodStreamDecoder(FMOD::Sound *sound, FMOD_SOUND_FORMAT format, int channelCount, int sampleRate, unsigned int frameCount)
+    : _sound(sound)
+    , _format(format)
+    , _channelCount(channelCount)
+    , _sampleRate(sampleRate)
+    , _frameCount(frameCount)
+    {
+    }
+
+    FMOD::Sound *_sound;
+    FMOD_SOUND_FORMAT _format;
+    int _channelCount;
+    int _sampleRate;
+    int64_t _frameCount;
+    std::vector<float> _floatSamples;
+};
+
+AudioEngineImpl::AudioEngineImpl()
+: _mixer(nullptr)
+, _pcmCache(nullptr)
+, _currentAudioID(0)
+, _streamUnderruns(0)
+, pSystem(nullptr)
+{
+}
+
+AudioEngineImpl::~AudioEngineImpl()
+{
+    cocos2d::Director::getInstance()->getScheduler()->unschedule(schedule_selector(AudioEngineImpl::update), this);
+
+    // stop the mixer thread before releasing the pcm it reads
+    delete _mixer;
+    _audioInfos.clear();
+    delete _pcmCache;
+
+    if (pSystem) {
+        pSystem->close();
+        pSystem->release();
+    }
+}
+
+bool AudioEngineImpl::init()
+{
+    FMOD_RESULT result = FMOD::System_Create(&pSystem);
+    if (ERRCHECK(result)) {
+        return false;
+    }
+    // nothing is played by FMOD
+    pSystem->setOutput(FMOD_OUTPUTTYPE_NOSOUND);
+    result = pSystem->init(1, FMOD_INIT_NORMAL, 0);
+    if (ERRCHECK(result)) {
+        return false;
+    }
+
+    const char *description = getenv("COCOS_AUDIO_OUTPUT");
+    if (!description) {
+#if CC_AUDIO_MIXER_USE_ALSA
+        description = "alsa";
+#else
+        description = "null";
+#endif
+    }
+    MixerOutput *output = MixerOutput::create(description);
+    if (!output) {
+        output = new (std::nothrow) NullMixerOutput();
+    }
+
+    SoftwareMixer::Config config;
+    // stopped voices keep their slot while fading out, an instance replacing them needs another one
+    config.maxVoices = MAX_AUDIOINSTANCES * 2;
+    config.maxAudibleVoices = MAX_AUDIBLE_VOICES;
+    _mixer = new (std::nothrow) SoftwareMixer();
+    if (!_mixer || !_mixer->init(config, output)) {
+        printf("AudioEngineImpl::init: can't start the mixer with the %s output\n", description);
+        delete _mixer;
+        _mixer = nullptr;
+        return false;
+    }
+    _voiceAudioIDs.assign(config.maxVoices, -1);
+
+    // FMOD is thread safe, the files are decoded in parallel by the AudioEngine workers
+    auto system = pSystem;
+    _pcmCache = new (std::nothrow) PcmCache([system](const std::string &fullPath){
+        return decodePcm(system, fullPath);
+    }, [](const std::function<void()> &task){
+        AudioEngine::addTask(task);
+    });
+
+    auto scheduler = cocos2d::Director::getInstance()->getScheduler();
+    scheduler->schedule(schedule_selector(AudioEngineImpl::update), this, 0.05f, false);
+
+    return true;
+}
+
+int AudioEngineImpl::play2d(const std::string &fileFullPath, bool loop, float volume)
+{
+    auto pcm = _pcmCache->get(FileUtils::getInstance()->fullPathForFilename(fileFullPath));
+    if (!pcm) {
+        return AudioEngine::INVALID_AUDIO_ID;
+    }
+
+    int voice = _mixer->play(pcm.get(), volume, loop);
+    if (voice < 0) {
+        printf("AudioEngineImpl::play2d: no voice available for %s\n", fileFullPath.c_str());
+        return AudioEngine::INVALID_AUDIO_ID;
+    }
+
+    int id = _currentAudioID++;
+    auto& info = _audioInfos[id];
+    info.voice = voice;
+    info.path = fileFullPath;
+    info.pcm = pcm;
+    info.stopped = false;
+    _voiceAudioIDs[voice] = id;
+
+    AudioEngine::_audioIDInfoMap[id].state = AudioEngine::AudioState::PLAYING;
+    return id;
+}
+
+int AudioEngineImpl::playStream(const std::string &fileFullPath, bool loop, float volume)
+{
+    auto decoder = FmodStreamDecoder::create(pSystem, FileUtils::getInstance()->fullPathForFilename(fileFullPath));
+    if (!decoder) {
+        return AudioEngine::INVALID_AUDIO_ID;
+    }
+
+    // decoded ahead by the worker of the stream, converted to the format of the mixer
+    const auto& config = _mixer->getConfig();
+    auto stream = std::make_shared<MixerStream>(config.sampleRate, config.channelCount);
+    stream->setLoop(loop);
+    if (!stream->open(decoder)) {
+        return AudioEngine::INVALID_AUDIO_ID;
+    }
+
+    int voice = _mixer->play(stream.get(), volume);
+    if (voice < 0) {
+        printf("AudioEngineImpl::playStream: no voice available for %s\n", fileFullPath.c_str());
+        return AudioEngine::INVALID_AUDIO_ID;
+    }
+
+    int id = _currentAudioID++;
+    auto& info = _audioInfos[id];
+    info.voice = voice;
+    info.path = fileFullPath;
+    info.stream = stream;
+    info.stopped = false;
+    _voiceAudioIDs[voice] = id;
+
+    AudioEngine::_audioIDInfoMap[id].state = AudioEngine::AudioState::PLAYING;
+    return id;
+}
+
+bool AudioEngineImpl::playNext(int audioID, const std::string &fileFullPath)
+{
+    auto it = _audioInfos.find(audioID);
+    if (it == _audioInfos.end() || !it->second.stream) {
+        return false;
+    }
+
+    auto decoder = FmodStreamDecoder::create(pSystem, FileUtils::getInstance()->fullPathForFilename(fileFullPath));
+    if (!decoder) {
+        return false;
+    }
+    it->second.stream->queue(decoder);
+    return true;
+}
+
+void AudioEngineImpl::setVolume(int audioID, float volume)
+{
+    auto it = _audioInfos.find(audioID);
+    if (it != _audioInfos.end()) {
+        _mixer->setVolume(it->second.voice, volume);
+    }
+}
+
+void AudioEngineImpl::setLoop(int audioID, bool loop)
+{
+    auto it = _audioInfos.find(audioID);
+    if (it != _audioInfos.end()) {
+        _mixer->setLoop(it->second.voice, loop);
+    }
+}
+
+bool AudioEngineImpl::pause(int audioID)
+{
+    auto it = _audioInfos.find(audioID);
+    if (it == _audioInfos.end() || !_mixer->pause(it->second.voice)) {
+        return false;
+    }
+    AudioEngine::_audioIDInfoMap[audioID].state = AudioEngine::AudioState::PAUSED;
+    return true;
+}
+
+bool AudioEngineImpl::resume(int audioID)
+{
+    auto it = _audioInfos.find(audioID);
+    if (it == _audioInfos.end() || !_mixer->resume(it->second.voice)) {
+        return false;
+    }
+    AudioEngine::_audioIDInfoMap[audioID].state = AudioEngine::AudioState::PLAYING;
+    return true;
+}
+
+bool AudioEngineImpl::stop(int audioID)
+{
+    auto it = _audioInfos.find(audioID);
+    if (it == _audioInfos.end()) {
+        return false;
+    }
+    // AudioEngine forgets the id now, the pcm is kept until the mixer releases the voice
+    it->second.stopped = true;
+    _mixer->stop(it->second.voice);
+    return true;
+}
+
+void AudioEngineImpl::stopAll()
+{
+    for (auto& info : _audioInfos) {
+        info.second.stopped = true;
+        _mixer->stop(info.second.voice);
+    }
+}
+
+float AudioEngineImpl::getDuration(int audioID)
+{
+    auto it = _audioInfos.find(audioID);
+    if (it == _audioInfos.end()) {
+        return AudioEngine::TIME_UNKNOWN;
+    }
+    if (it->second.stream) {
+        float duration = it->second.stream->getDuration();
+        return duration > 0.0f ? duration : AudioEngine::TIME_UNKNOWN;
+    }
+    return it->second.pcm->getDuration();
+}
+
+float AudioEngineImpl::getCurrentTime(int audioID)
+{
+    auto it = _audioInfos.find(audioID);
+    if (it == _audioInfos.end()) {
+        return AudioEngine::TIME_UNKNOWN;
+    }
+    return _mixer->getPosition(it->second.voice);
+}
+
+bool AudioEngineImpl::setCurrentTime(int audioID, float time)
+{
+    auto it = _audioInfos.find(audioID);
+    if (it == _audioInfos.end()) {
+        return false;
+    }
+    _mixer->setPosition(it->second.voice, time);
+    return true;
+}
+
+void AudioEngineImpl::setPriority(int audioID, int priority)
+{
+    auto it = _audioInfos.find(audioID);
+    if (it != _audioInfos.end()) {
+        _mixer->setPriority(it->second.voice, priority);
+    }
+}
+
+void AudioEngineImpl::setFinishCallback(int audioID, const std::function<void (int, const std::string &)> &callback)
+{
+    auto it = _audioInfos.find(audioID);
+    if (it != _audioInfos.end()) {
+        it->second.callback = callback;
+    }
+}
+
+void AudioEngineImpl::uncache(const std::string& path)
+{
+    // the voices playing the file keep their own reference to the pcm
+    _pcmCache->remove(FileUtils::getInstance()->fullPathForFilename(path));
+}
+
+void AudioEngineImpl::uncacheAll()
+{
+    _pcmCache->clear();
+}
+
+int AudioEngineImpl::preload(const std::string& filePath, std::function<void(bool isSuccess)> callback)
+{
+    _pcmCache->load(FileUtils::getInstance()->fullPathForFilename(filePath), [filePath, callback](const std::shared_ptr<MixerPcm> &pcm){
+        if (!pcm) {
+            printf("sound effect in %s could not be preload\n", filePath.c_str());
+        }
+        if (callback) {
+            callback(pcm != nullptr);
+        }
+    });
+    return 0;
+}
+
+void AudioEngineImpl::setPcmCacheBudget(size_t bytes)
+{
+    _pcmCache->setBudget(bytes);
+}
+
+size_t AudioEngineImpl::getPcmCacheBudget() const
+{
+    return _pcmCache->getBudget();
+}
+
+void AudioEngineImpl::setKeepResident(const std::string& filePath, bool keepResident)
+{
+    _pcmCache->setKeepResident(FileUtils::getInstance()->fullPathForFilename(filePath), keepResident);
+}
+
+void AudioEngineImpl::getMetrics(AudioMetrics &metrics) const
+{
+    const auto& config = _mixer->getConfig();
+    metrics.activeVoices = _mixer->getActiveVoiceCount();
+    metrics.virtualVoices = _mixer->getVirtualVoiceCount();
+    metrics.lastMixTime = _mixer->getLastMixTime();
+    metrics.maxMixTime = _mixer->getMaxMixTime();
+    metrics.averageMixTime = _mixer->getAverageMixTime();
+    metrics.bufferDuration = (unsigned int)(1000000LL * config.framesPerBuffer / config.sampleRate);
+    metrics.mixedBuffers = _mixer->getMixedBufferCount();
+    metrics.outputUnderruns = _mixer->getUnderrunCount();
+
+    metrics.cacheSize = _pcmCache->getResidentSize();
+    metrics.cacheBudget = _pcmCache->getBudget();
+    metrics.cachedFiles = (int)_pcmCache->getCount();
+    metrics.cacheHits = _pcmCache->getHitCount();
+    metrics.cacheMisses = _pcmCache->getMissCount();
+    metrics.cacheEvictions = _pcmCache->getEvictionCount();
+    for (const auto& stats : _pcmCache->getDecodeStats()) {
+        auto& decode = metrics.decodes[stats.first];
+        decode.count = stats.second.count;
+        decode.totalTime = stats.second.totalTime;
+        decode.maxTime = stats.second.maxTime;
+        decode.size = stats.second.size;
+    }
+
+    metrics.streamUnderruns = _streamUnderruns;
+    for (const auto& stats : _streamDecodeStats) {
+        metrics.decodes[stats.first] = stats.second;
+    }
+    for (const auto& info : _audioInfos) {
+        auto& stream = info.second.stream;
+        if (stream) {
+            ++metrics.streams;
+            metrics.streamSize += stream->getMemorySize();
+            metrics.streamUnderruns += stream->getUnderrunCount();
+        }
+    }
+}
+
+void AudioEngineImpl::resetMetrics()
+{
+    _mixer->resetMixStats();
+    _pcmCache->resetStats();
+    _streamDecodeStats.clear();
+    _streamUnderruns = 0;
+}
+
+void AudioEngineImpl::update(float dt)
+{
+    CC_PROFILER_START_CATEGORY(kProfilerCategoryAudio, "AudioEngine - update");
+
+    bool released = false;
+    _mixer->releaseVoices([this, &released](int voice, bool reachedEnd){
+        released = true;
+        int id = _voiceAudioIDs[voice];
+        _voiceAudioIDs[voice] = -1;
+
+        auto it = _audioInfos.find(id);
+        if (it == _audioInfos.end()) {
+            return;
+        }
+        // the callback may play another sound, don't keep a reference in the map
+        AudioInfo info = std::move(it->second);
+        _audioInfos.erase(it);
+
+        if (info.stream) {
+            double decodeTime = info.stream->getDecodeTime() / 1000.0;
+            auto& stats = _streamDecodeStats[FileUtils::getInstance()->fullPathForFilename(info.path)];
+            ++stats.count;
+            stats.totalTime += decodeTime;
+            stats.maxTime = std::max(stats.maxTime, decodeTime);
+            stats.size = info.stream->getMemorySize();
+            _streamUnderruns += info.stream->getUnderrunCount();
+        }
+
+        if (!info.stopped) {
+            if (info.callback) {
+                info.callback(id, info.path);
+            }
+            AudioEngine::remove(id);
+        }
+    });
+    // the sounds which stopped playing may be evicted now
+    if (released) {
+        _pcmCache->trim();
+    }
+
+    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryAudio, "AudioEngine - update");
+}
@@ -37,9 +37,24 @@
 
 #include "base/CCRef.h"
 
+#if CC_USE_AUDIO_MIXER
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "audio/mixer/MixerStream.h"
+#include "audio/mixer/PcmCache.h"
+#include "audio/mixer/SoftwareMixer.h"
+#endif
+
 NS_CC_BEGIN
     namespace experimental{
+#if CC_USE_AUDIO_MIXER
+// only MAX_AUDIBLE_VOICES instances are mixed, the others are virtual
+#define MAX_AUDIOINSTANCES 128
+#define MAX_AUDIBLE_VOICES 32
+#else
 #define MAX_AUDIOINSTANCES 32
+#endif
 
 class CC_DLL AudioEngineImpl : public cocos2d::Ref
 {
@@ -68,6 +83,52 @@ public:
     
     void update(float dt);
     
+#if CC_USE_AUDIO_MIXER
+    void setPcmCacheBudget(size_t bytes);
+    size_t getPcmCacheBudget() const;
+    void setKeepResident(const std::string& filePath, bool keepResident);
+    void setPriority(int audioID, int priority);
+    int playStream(const std::string &fileFullPath, bool loop, float volume);
+    bool playNext(int audioID, const std::string &fileFullPath);
+    void getMetrics(AudioMetrics &metrics) const;
+    void resetMetrics();
+
+private:
+
+    struct AudioInfo{
+        int voice;
+        std::string path;
+        std::shared_ptr<MixerPcm> pcm;
+        /**
+         * set instead of pcm for the streamed sounds
+         */
+        std::shared_ptr<MixerStream> stream;
+        bool stopped;
+        std::function<void (int, const std::string &)> callback;
+    };
+
+    /**
+     * the sounds are mixed by the software mixer, FMOD is only used to decode them
+     */
+    SoftwareMixer * _mixer;
+
+    std::unordered_map<int, AudioInfo> _audioInfos;
+
+    /**
+     * audio id playing on each voice of the mixer, -1 if none
+     */
+    std::vector<int> _voiceAudioIDs;
+
+    PcmCache * _pcmCache;
+
+    int _currentAudioID;
+
+    /**
+     * decoding cost and underruns of the streams which ended
+     */
+    std::unordered_map<std::string, AudioMetrics::DecodeStats> _streamDecodeStats;
+    unsigned int _streamUnderruns;
+#else
     /**
      * used internally by ffmod callback 
      */ 
@@ -97,6 +158,7 @@ private:
     std::map<std::string, int> mapId;
     
     std::map<std::string, FMOD::Sound *> mapSound;  
+#endif
     
     FMOD::System* pSystem;
     
@@ -0,0 +1,124 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __MIXER_OPS_H__
+#define __MIXER_OPS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CC_MIXER_USE_SSE2 1
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CC_MIXER_USE_NEON 1
+#endif
+
+namespace cocos2d { namespace experimental { namespace mixer {
+
+/** Convert float samples in [-1, 1] to signed 16 bits samples, out of range samples are clamped. */
+inline void floatToInt16(const float* in, int16_t* out, size_t count)
+{
+    size_t i = 0;
+#if CC_MIXER_USE_SSE2
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const __m128 minValue = _mm_set1_ps(-1.0f);
+    const __m128 maxValue = _mm_set1_ps(1.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128 a = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(in + i), maxValue), minValue);
+        __m128 b = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(in + i + 4), maxValue), minValue);
+        __m128i ia = _mm_cvtps_epi32(_mm_mul_ps(a, scale));
+        __m128i ib = _mm_cvtps_epi32(_mm_mul_ps(b, scale));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(ia, ib));
+    }
+#elif CC_MIXER_USE_NEON
+    const float32x4_t scale = vdupq_n_f32(32767.0f);
+    const float32x4_t minValue = vdupq_n_f32(-1.0f);
+    const float32x4_t maxValue = vdupq_n_f32(1.0f);
+    const uint32x4_t half = vreinterpretq_u32_f32(vdupq_n_f32(0.5f));
+    const uint32x4_t signMask = vdupq_n_u32(0x80000000);
+    for (; i + 8 <= count; i += 8)
+    {
+        float32x4_t a = vmulq_f32(vmaxq_f32(vminq_f32(vld1q_f32(in + i), maxValue), minValue), scale);
+        float32x4_t b = vmulq_f32(vmaxq_f32(vminq_f32(vld1q_f32(in + i + 4), maxValue), minValue), scale);
+        // vcvtq_s32_f32 truncates toward zero, add 0.5 with the sign of the sample to round as the scalar code does
+        // (vcvtnq_s32_f32 would round directly but is ARMv8 only)
+        a = vaddq_f32(a, vreinterpretq_f32_u32(vorrq_u32(vandq_u32(vreinterpretq_u32_f32(a), signMask), half)));
+        b = vaddq_f32(b, vreinterpretq_f32_u32(vorrq_u32(vandq_u32(vreinterpretq_u32_f32(b), signMask), half)));
+        int32x4_t ia = vcvtq_s32_f32(a);
+        int32x4_t ib = vcvtq_s32_f32(b);
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(ia), vqmovn_s32(ib)));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        float sample = in[i];
+        if (sample > 1.0f)
+            sample = 1.0f;
+        else if (sample < -1.0f)
+            sample = -1.0f;
+        out[i] = (int16_t)(sample * 32767.0f + (sample >= 0 ? 0.5f : -0.5f));
+    }
+}
+
+/** Add signed 16 bits samples multiplied by gain to float samples, the result is in [-1, 1] for gain 1. */
+inline void accumulateInt16(const int16_t* in, float* out, size_t count, float gain)
+{
+    const float scale = gain / 32768.0f;
+    size_t i = 0;
+#if CC_MIXER_USE_SSE2
+    const __m128 vscale = _mm_set1_ps(scale);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        // sign extend to 32 bits by shifting the samples into the high half
+        __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        __m128 a = _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_cvtepi32_ps(low), vscale));
+        __m128 b = _mm_add_ps(_mm_loadu_ps(out + i + 4), _mm_mul_ps(_mm_cvtepi32_ps(high), vscale));
+        _mm_storeu_ps(out + i, a);
+        _mm_storeu_ps(out + i + 4, b);
+    }
+#elif CC_MIXER_USE_NEON
+    const float32x4_t vscale = vdupq_n_f32(scale);
+    for (; i + 8 <= count; i += 8)
+    {
+        int16x8_t samples = vld1q_s16(in + i);
+        float32x4_t low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples)));
+        float32x4_t high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples)));
+        vst1q_f32(out + i, vmlaq_f32(vld1q_f32(out + i), low, vscale));
+        vst1q_f32(out + i + 4, vmlaq_f32(vld1q_f32(out + i + 4), high, vscale));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        out[i] += in[i] * scale;
+    }
+}
+
+}}} // namespace cocos2d { namespace experimental { namespace mixer {
+
+#endif // __MIXER_OPS_H__
@@ -0,0 +1,288 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "audio/mixer/MixerOutput.h"
+
+#include <thread>
+
+#include "base/ccMacros.h"
+
+#if CC_AUDIO_MIXER_USE_ALSA
+#include <errno.h>
+#include <alsa/asoundlib.h>
+#endif
+
+NS_CC_BEGIN
+namespace experimental {
+
+namespace {
+
+#if CC_AUDIO_MIXER_USE_ALSA
+class AlsaMixerOutput : public MixerOutput
+{
+public:
+    explicit AlsaMixerOutput(const std::string& device)
+    : _device(device.empty() ? "default" : device)
+    , _pcm(nullptr)
+    , _channelCount(0)
+    , _underrunCount(0)
+    {
+    }
+
+    virtual ~AlsaMixerOutput()
+    {
+        close();
+    }
+
+    virtual bool open(int sampleRate, int channelCount, int framesPerBuffer) override
+    {
+        int err = snd_pcm_open(&_pcm, _device.c_str(), SND_PCM_STREAM_PLAYBACK, 0);
+        if (err < 0)
+        {
+            CCLOG("AlsaMixerOutput: can't open %s, %s", _device.c_str(), snd_strerror(err));
+            _pcm = nullptr;
+            return false;
+        }
+
+        // keep two buffers queued in the device
+        unsigned int latency = (unsigned int)(2000000LL * framesPerBuffer / sampleRate);
+        err = snd_pcm_set_params(_pcm, SND_PCM_FORMAT_S16, SND_PCM_ACCESS_RW_INTERLEAVED,
+                                 channelCount, sampleRate, 1, latency);
+        if (err < 0)
+        {
+            CCLOG("AlsaMixerOutput: can't configure %s, %s", _device.c_str(), snd_strerror(err));
+            close();
+            return false;
+        }
+        _channelCount = channelCount;
+        return true;
+    }
+
+    virtual bool write(const int16_t* samples, int frameCount) override
+    {
+        while (frameCount > 0)
+        {
+            snd_pcm_sframes_t written = snd_pcm_writei(_pcm, samples, frameCount);
+            if (written < 0)
+            {
+                if (written == -EPIPE)
+                {
+                    ++_underrunCount;
+                }
+                // recover from underruns and suspends, give up on other errors
+                if (snd_pcm_recover(_pcm, (int)written, 1) < 0)
+                {
+                    CCLOG("AlsaMixerOutput: write failed, %s", snd_strerror((int)written));
+                    return false;
+                }
+                continue;
+            }
+            samples += written * _channelCount;
+            frameCount -= (int)written;
+        }
+        return true;
+    }
+
+    virtual void close() override
+    {
+        if (_pcm)
+        {
+            snd_pcm_drain(_pcm);
+            snd_pcm_close(_pcm);
+            _pcm = nullptr;
+        }
+    }
+
+    virtual const char* getName() const override { return "alsa"; }
+
+    virtual uint32_t getUnderrunCount() const override { return _underrunCount; }
+
+private:
+    std::string _device;
+    snd_pcm_t* _pcm;
+    int _channelCount;
+    uint32_t _underrunCount;
+};
+#endif // CC_AUDIO_MIXER_USE_ALSA
+
+void writeLittleEndian(FILE* file, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+    {
+        fputc((value >> (i * 8)) & 0xff, file);
+    }
+}
+
+} // namespace {
+
+MixerOutput* MixerOutput::create(const std::string& description)
+{
+    std::string type = description;
+    std::string argument;
+    auto colon = description.find(':');
+    if (colon != std::string::npos)
+    {
+        type = description.substr(0, colon);
+        argument = description.substr(colon + 1);
+    }
+
+    if (type == "null")
+    {
+        return new (std::nothrow) NullMixerOutput(argument != "fast");
+    }
+    if (type == "wav" && !argument.empty())
+    {
+        return new (std::nothrow) WavMixerOutput(argument);
+    }
+#if CC_AUDIO_MIXER_USE_ALSA
+    if (type == "alsa")
+    {
+        return new (std::nothrow) AlsaMixerOutput(argument);
+    }
+#endif
+
+    CCLOG("MixerOutput: unsupported output \"%s\"", description.c_str());
+    return nullptr;
+}
+
+// NullMixerOutput
+
+NullMixerOutput::NullMixerOutput(bool realtime)
+: _realtime(realtime)
+, _sampleRate(0)
+{
+}
+
+bool NullMixerOutput::open(int sampleRate, int channelCount, int framesPerBuffer)
+{
+    CC_UNUSED_PARAM(channelCount);
+    CC_UNUSED_PARAM(framesPerBuffer);
+    _sampleRate = sampleRate;
+    _nextWriteTime = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool NullMixerOutput::write(const int16_t* samples, int frameCount)
+{
+    CC_UNUSED_PARAM(samples);
+    waitBufferDuration(frameCount);
+    return true;
+}
+
+void NullMixerOutput::close()
+{
+}
+
+void NullMixerOutput::waitBufferDuration(int frameCount)
+{
+    if (!_realtime)
+        return;
+
+    // sleep until the buffer would have been played by a device
+    _nextWriteTime += std::chrono::microseconds(1000000LL * frameCount / _sampleRate);
+    auto now = std::chrono::steady_clock::now();
+    if (_nextWriteTime > now)
+    {
+        std::this_thread::sleep_until(_nextWriteTime);
+    }
+    else
+    {
+        // the mixer is late, don't try to catch up
+        _nextWriteTime = now;
+    }
+}
+
+// WavMixerOutput
+
+WavMixerOutput::WavMixerOutput(const std::string& filename, bool realtime)
+: NullMixerOutput(realtime)
+, _filename(filename)
+, _file(nullptr)
+, _channelCount(0)
+, _dataSize(0)
+{
+}
+
+WavMixerOutput::~WavMixerOutput()
+{
+    close();
+}
+
+bool WavMixerOutput::open(int sampleRate, int channelCount, int framesPerBuffer)
+{
+    _file = fopen(_filename.c_str(), "wb");
+    if (!_file)
+    {
+        CCLOG("WavMixerOutput: can't create %s", _filename.c_str());
+        return false;
+    }
+    _sampleRate = sampleRate;
+    _channelCount = channelCount;
+    _dataSize = 0;
+    // the sizes of the header are patched by close
+    writeHeader();
+    return NullMixerOutput::open(sampleRate, channelCount, framesPerBuffer);
+}
+
+bool WavMixerOutput::write(const int16_t* samples, int frameCount)
+{
+    size_t count = (size_t)frameCount * _channelCount;
+    // all the supported platforms are little endian, like WAV files
+    fwrite(samples, sizeof(int16_t), count, _file);
+    _dataSize += (uint32_t)(count * sizeof(int16_t));
+
+    waitBufferDuration(frameCount);
+    return !ferror(_file);
+}
+
+void WavMixerOutput::close()
+{
+    if (_file)
+    {
+        fseek(_file, 0, SEEK_SET);
+        writeHeader();
+        fclose(_file);
+        _file = nullptr;
+    }
+}
+
+void WavMixerOutput::writeHeader()
+{
+    fwrite("RIFF", 1, 4, _file);
+    writeLittleEndian(_file, 36 + _dataSize, 4);
+    fwrite("WAVEfmt ", 1, 8, _file);
+    writeLittleEndian(_file, 16, 4);
+    // PCM format
+    writeLittleEndian(_file, 1, 2);
+    writeLittleEndian(_file, _channelCount, 2);
+    writeLittleEndian(_file, _sampleRate, 4);
+    writeLittleEndian(_file, _sampleRate * _channelCount * 2, 4);
+    writeLittleEndian(_file, _channelCount * 2, 2);
+    writeLittleEndian(_file, 16, 2);
+    fwrite("data", 1, 4, _file);
+    writeLittleEndian(_file, _dataSize, 4);
+}
+
+} // namespace experimental
+NS_CC_END
@@ -0,0 +1,117 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __MIXER_OUTPUT_H__
+#define __MIXER_OUTPUT_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+#include <string>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+namespace experimental {
+
+/**
+ * Destination of the buffers mixed by SoftwareMixer.
+ *
+ * The samples are interleaved signed 16 bits. write is called from the mixer thread only
+ * and blocks until the destination can accept more samples, this is what paces the mixer.
+ */
+class CC_DLL MixerOutput
+{
+public:
+    virtual ~MixerOutput() {}
+
+    virtual bool open(int sampleRate, int channelCount, int framesPerBuffer) = 0;
+
+    /** Write one mixed buffer, return false if the output is broken and the mixer should stop. */
+    virtual bool write(const int16_t* samples, int frameCount) = 0;
+
+    virtual void close() = 0;
+
+    virtual const char* getName() const = 0;
+
+    /** Number of times the destination ran out of samples, called from the mixer thread. */
+    virtual uint32_t getUnderrunCount() const { return 0; }
+
+    /**
+     * Create an output from its description:
+     * - "alsa" or "alsa:device", the default ALSA device goes through PulseAudio when its plugin is installed.
+     * - "null", discards the samples at the real-time rate.
+     * - "null:fast", discards the samples as fast as they are mixed.
+     * - "wav:filename", writes the samples to a WAV file at the real-time rate.
+     *
+     * @return nullptr if the description is invalid or the output isn't supported on this platform.
+     */
+    static MixerOutput* create(const std::string& description);
+};
+
+/** Output discarding the samples, useful without sound hardware. */
+class CC_DLL NullMixerOutput : public MixerOutput
+{
+public:
+    /** @param realtime if true write sleeps for the duration of the buffer. */
+    explicit NullMixerOutput(bool realtime = true);
+
+    virtual bool open(int sampleRate, int channelCount, int framesPerBuffer) override;
+    virtual bool write(const int16_t* samples, int frameCount) override;
+    virtual void close() override;
+    virtual const char* getName() const override { return "null"; }
+
+protected:
+    void waitBufferDuration(int frameCount);
+
+    bool _realtime;
+    int _sampleRate;
+    std::chrono::steady_clock::time_point _nextWriteTime;
+};
+
+/** Output writing the samples to a WAV file, to check the mixing without sound hardware. */
+class CC_DLL WavMixerOutput : public NullMixerOutput
+{
+public:
+    WavMixerOutput(const std::string& filename, bool realtime = true);
+    virtual ~WavMixerOutput();
+
+    virtual bool open(int sampleRate, int channelCount, int framesPerBuffer) override;
+    virtual bool write(const int16_t* samples, int frameCount) override;
+    virtual void close() override;
+    virtual const char* getName() const override { return "wav"; }
+
+private:
+    void writeHeader();
+
+    std::string _filename;
+    FILE* _file;
+    int _channelCount;
+    uint32_t _dataSize;
+};
+
+} // namespace experimental
+NS_CC_END
+
+#endif // __MIXER_OUTPUT_H__
@@ -0,0 +1,412 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "audio/mixer/MixerStream.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "audio/mixer/MixerOps.h"
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+namespace experimental {
+
+namespace {
+    // frames decoded at once by the worker
+    const int DECODE_FRAMES = 2048;
+    // the worker waits until it can write at least this many frames
+    const int MIN_WRITE_FRAMES = 1024;
+    // the mixer thread doesn't wake the worker up, it polls the free space
+    const int POLL_INTERVAL = 10;
+
+    inline int16_t toInt16(float sample)
+    {
+        // interpolated samples stay in the range of their sources
+        return (int16_t)(sample + (sample >= 0.0f ? 0.5f : -0.5f));
+    }
+}
+
+MixerStream::MixerStream(int sampleRate, int channelCount, int capacityFrames)
+: _sampleRate(sampleRate)
+, _channelCount(channelCount)
+, _writeFrame(0)
+, _readFrame(0)
+, _discardFrame(0)
+, _finished(false)
+, _markerWrite(0)
+, _markerRead(0)
+, _position(0)
+, _duration(0)
+, _trackIndex(0)
+, _underrunCount(0)
+, _trackStart(0)
+, _started(false)
+, _loop(false)
+, _seekRequest(-1.0f)
+, _decodeTime(0)
+, _decodedTrack(0)
+, _decodedFrames(0)
+, _decoderEnded(false)
+, _trackDecoded(false)
+, _phase(0)
+, _step(0)
+, _running(false)
+{
+    CCASSERT(channelCount == 1 || channelCount == 2, "MixerStream supports mono and stereo only");
+
+    // a power of two capacity turns the wrapping into a mask
+    uint64_t capacity = 1;
+    while (capacity < (uint64_t)std::max(capacityFrames, MIN_WRITE_FRAMES * 2))
+    {
+        capacity <<= 1;
+    }
+    _ringMask = capacity - 1;
+    _ring.resize(capacity * channelCount);
+    _decodeBuffer.resize(DECODE_FRAMES * 2);
+}
+
+MixerStream::~MixerStream()
+{
+    if (_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running = false;
+        }
+        _condition.notify_one();
+        _thread.join();
+    }
+}
+
+bool MixerStream::open(StreamDecoder* decoder)
+{
+    CCASSERT(!_decoder, "MixerStream is already open");
+    if (!decoder || decoder->getSampleRate() <= 0 || decoder->getChannelCount() < 1 || decoder->getChannelCount() > 2)
+    {
+        delete decoder;
+        return false;
+    }
+
+    _decoder.reset(decoder);
+    startTrack(0, 0);
+    _running = true;
+    _thread = std::thread(&MixerStream::threadLoop, this);
+    return true;
+}
+
+void MixerStream::queue(StreamDecoder* decoder)
+{
+    if (!decoder || decoder->getSampleRate() <= 0 || decoder->getChannelCount() < 1 || decoder->getChannelCount() > 2)
+    {
+        delete decoder;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.push_back(std::unique_ptr<StreamDecoder>(decoder));
+    }
+    _condition.notify_one();
+}
+
+void MixerStream::setLoop(bool loop)
+{
+    _loop = loop;
+    _condition.notify_one();
+}
+
+void MixerStream::seek(float seconds)
+{
+    _seekRequest = std::max(seconds, 0.0f);
+    _condition.notify_one();
+}
+
+float MixerStream::getPosition() const
+{
+    return (float)_position.load(std::memory_order_relaxed) / _sampleRate;
+}
+
+float MixerStream::getDuration() const
+{
+    return (float)_duration.load(std::memory_order_relaxed) / _sampleRate;
+}
+
+size_t MixerStream::getMemorySize() const
+{
+    return (_ring.size() + _decodeBuffer.size()) * sizeof(int16_t);
+}
+
+bool MixerStream::mix(float* buffer, int frameCount, float gain, float targetGain)
+{
+    // the discarded frame is published after the frames it refers to, load it first
+    uint64_t discardFrame = _discardFrame.load(std::memory_order_acquire);
+    bool finished = _finished.load(std::memory_order_acquire);
+    uint64_t writeFrame = _writeFrame.load(std::memory_order_acquire);
+    uint64_t readFrame = std::max(_readFrame.load(std::memory_order_relaxed), discardFrame);
+
+    const int available = (int)std::min(writeFrame - readFrame, (uint64_t)frameCount);
+    if (buffer)
+    {
+        const uint64_t capacity = _ringMask + 1;
+        const float gainStep = (targetGain - gain) / frameCount;
+        int done = 0;
+        while (done < available)
+        {
+            uint64_t index = (readFrame + done) & _ringMask;
+            int count = (int)std::min((uint64_t)(available - done), capacity - index);
+            const int16_t* in = _ring.data() + index * _channelCount;
+            float* out = buffer + done * _channelCount;
+            if (gainStep == 0.0f)
+            {
+                mixer::accumulateInt16(in, out, count * _channelCount, gain);
+            }
+            else
+            {
+                for (int i = 0; i < count * _channelCount; i += _channelCount)
+                {
+                    const float scale = gain / 32768.0f;
+                    for (int c = 0; c < _channelCount; ++c)
+                    {
+                        out[i + c] += in[i + c] * scale;
+                    }
+                    gain += gainStep;
+                }
+            }
+            done += count;
+        }
+    }
+
+    readFrame += available;
+    _readFrame.store(readFrame, std::memory_order_release);
+    readMarkers(readFrame);
+    _position.store((int64_t)readFrame - _trackStart, std::memory_order_relaxed);
+
+    if (available > 0)
+    {
+        _started = true;
+    }
+    if (available < frameCount && !finished && _started)
+    {
+        _underrunCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    return !finished || readFrame < writeFrame;
+}
+
+void MixerStream::readMarkers(uint64_t readFrame)
+{
+    uint32_t read = _markerRead.load(std::memory_order_relaxed);
+    const uint32_t write = _markerWrite.load(std::memory_order_acquire);
+    while (read != write && _markers[read % MAX_MARKERS].frame <= readFrame)
+    {
+        const Marker& marker = _markers[read % MAX_MARKERS];
+        _trackStart = marker.trackStart;
+        _duration.store(marker.duration, std::memory_order_relaxed);
+        _trackIndex.store(marker.track, std::memory_order_relaxed);
+        ++read;
+    }
+    _markerRead.store(read, std::memory_order_release);
+}
+
+void MixerStream::pushMarker(const Marker& marker)
+{
+    uint32_t write = _markerWrite.load(std::memory_order_relaxed);
+    while (write - _markerRead.load(std::memory_order_acquire) >= MAX_MARKERS)
+    {
+        // only with many very short looping tracks, wait for the mixer thread to play them
+        if (!_running)
+            return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    _markers[write % MAX_MARKERS] = marker;
+    _markerWrite.store(write + 1, std::memory_order_release);
+}
+
+void MixerStream::startTrack(uint64_t frame, int64_t trackStart)
+{
+    _decodedFrames = 0;
+    _decoderEnded = false;
+    _trackDecoded = false;
+    _phase = 0;
+    _step = ((uint64_t)_decoder->getSampleRate() << 32) / _sampleRate;
+
+    Marker marker;
+    marker.frame = frame;
+    marker.trackStart = trackStart;
+    marker.duration = _decoder->getFrameCount() * _sampleRate / _decoder->getSampleRate();
+    marker.track = _decodedTrack;
+    pushMarker(marker);
+    _finished.store(false, std::memory_order_relaxed);
+}
+
+bool MixerStream::nextTrack(uint64_t frame)
+{
+    std::unique_ptr<StreamDecoder> next;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_queue.empty())
+        {
+            next = std::move(_queue.front());
+            _queue.pop_front();
+        }
+    }
+
+    if (next)
+    {
+        _decoder = std::move(next);
+        ++_decodedTrack;
+        startTrack(frame, frame);
+        return true;
+    }
+    if (_loop && _trackDecoded && _decoder->seek(0))
+    {
+        startTrack(frame, frame);
+        return true;
+    }
+    return false;
+}
+
+void MixerStream::threadLoop()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_running)
+    {
+        lock.unlock();
+        bool decoded = decode();
+        lock.lock();
+        if (!decoded && _running)
+        {
+            _condition.wait_for(lock, std::chrono::milliseconds(POLL_INTERVAL));
+        }
+    }
+}
+
+bool MixerStream::decode()
+{
+    float seconds = _seekRequest.exchange(-1.0f);
+    if (seconds >= 0.0f)
+    {
+        uint64_t frame = _writeFrame.load(std::memory_order_relaxed);
+        if (_decoder->seek((int64_t)(seconds * _decoder->getSampleRate())))
+        {
+            // the frames decoded before the seek are skipped by the mixer thread
+            _discardFrame.store(frame, std::memory_order_release);
+            startTrack(frame, (int64_t)frame - (int64_t)(seconds * _sampleRate));
+        }
+    }
+
+    if (_finished.load(std::memory_order_relaxed))
+    {
+        // a track queued or a loop set after the end restarts the stream
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_queue.empty() && !_loop)
+            return false;
+    }
+
+    const uint64_t writeFrame = _writeFrame.load(std::memory_order_relaxed);
+    const uint64_t space = _ringMask + 1 - (writeFrame - _readFrame.load(std::memory_order_acquire));
+    if (space < MIN_WRITE_FRAMES)
+        return false;
+
+    auto start = std::chrono::steady_clock::now();
+    bool ended = false;
+    int written = convert(writeFrame, (int)std::min(space, (uint64_t)DECODE_FRAMES), ended);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    _decodeTime.fetch_add((uint64_t)elapsed.count(), std::memory_order_relaxed);
+    _writeFrame.store(writeFrame + written, std::memory_order_release);
+    if (ended)
+    {
+        _finished.store(true, std::memory_order_release);
+    }
+    return written > 0 && !ended;
+}
+
+int MixerStream::convert(uint64_t writeFrame, int maxFrames, bool& ended)
+{
+    const float fractionScale = 1.0f / 4294967296.0f;
+    int16_t* source = _decodeBuffer.data();
+    int written = 0;
+    while (written < maxFrames)
+    {
+        const int sourceChannels = _decoder->getChannelCount();
+        uint64_t index = _phase >> 32;
+        if (index + 1 >= (uint64_t)_decodedFrames && !_decoderEnded)
+        {
+            // keep the last frame to interpolate it with the next ones
+            int drop = (int)std::min(index, (uint64_t)_decodedFrames);
+            if (drop > 0)
+            {
+                std::copy(source + drop * sourceChannels, source + _decodedFrames * sourceChannels, source);
+                _decodedFrames -= drop;
+                _phase -= (uint64_t)drop << 32;
+            }
+            int count = _decoder->read(source + _decodedFrames * sourceChannels, DECODE_FRAMES - _decodedFrames);
+            if (count > 0)
+            {
+                _decodedFrames += count;
+                _trackDecoded = true;
+            }
+            else
+            {
+                _decoderEnded = true;
+            }
+            continue;
+        }
+
+        if (index >= (uint64_t)_decodedFrames)
+        {
+            if (!nextTrack(writeFrame + written))
+            {
+                ended = true;
+                break;
+            }
+            continue;
+        }
+
+        // linear interpolation to the rate of the mixer, the channels are remapped too
+        uint64_t next = index + 1 < (uint64_t)_decodedFrames ? index + 1 : index;
+        const float fraction = (uint32_t)_phase * fractionScale;
+        const int16_t* a = source + index * sourceChannels;
+        const int16_t* b = source + next * sourceChannels;
+        float left = a[0] + (b[0] - a[0]) * fraction;
+        float right = sourceChannels == 2 ? a[1] + (b[1] - a[1]) * fraction : left;
+
+        int16_t* out = _ring.data() + ((writeFrame + written) & _ringMask) * _channelCount;
+        if (_channelCount == 2)
+        {
+            out[0] = toInt16(left);
+            out[1] = toInt16(right);
+        }
+        else
+        {
+            out[0] = toInt16((left + right) * 0.5f);
+        }
+        _phase += _step;
+        ++written;
+    }
+    return written;
+}
+
+} // namespace experimental
+NS_CC_END
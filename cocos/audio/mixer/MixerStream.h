@@ -0,0 +1,204 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __MIXER_STREAM_H__
+#define __MIXER_STREAM_H__
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+namespace experimental {
+
+/** Incremental decoder of a sound file, only called from the worker of a MixerStream. */
+class CC_DLL StreamDecoder
+{
+public:
+    virtual ~StreamDecoder() {}
+
+    /** 1 or 2. */
+    virtual int getChannelCount() const = 0;
+
+    virtual int getSampleRate() const = 0;
+
+    /** Length in frames, 0 if unknown. */
+    virtual int64_t getFrameCount() const = 0;
+
+    /** Decode up to frameCount frames of interleaved signed 16 bits samples, return the decoded frame count, 0 at the end. */
+    virtual int read(int16_t* samples, int frameCount) = 0;
+
+    virtual bool seek(int64_t frame) = 0;
+};
+
+/**
+ * Sound decoded while it is played, for the music too long to be decoded whole.
+ *
+ * A worker thread decodes ahead into a ring buffer, converted to the rate and channels of the mixer,
+ * and the mixer thread consumes it without locking. The memory used doesn't depend on the length of
+ * the tracks: the ring buffer holds capacityFrames frames, 128 KB in stereo by default.
+ *
+ * The queued tracks are decoded right after the current one so that there is no gap between them.
+ * When loop is set the last track is restarted by the worker the same way.
+ *
+ * The stream is controlled from a single thread, usually the cocos thread, mix and skip are called
+ * by the mixer thread.
+ */
+class CC_DLL MixerStream
+{
+public:
+    MixerStream(int sampleRate, int channelCount, int capacityFrames = 32768);
+    ~MixerStream();
+
+    /** Start decoding the first track, the stream takes the ownership of decoder. */
+    bool open(StreamDecoder* decoder);
+
+    /** Play decoder after the queued tracks without a gap, the stream takes the ownership of decoder. */
+    void queue(StreamDecoder* decoder);
+
+    void setLoop(bool loop);
+
+    bool isLoop() const { return _loop; }
+
+    /**
+     * Seek the track being decoded, it is the one played unless the next track
+     * is closer than the duration of the ring buffer.
+     */
+    void seek(float seconds);
+
+    /** Position in the track played, in seconds. */
+    float getPosition() const;
+
+    /** Duration of the track played in seconds, 0 if unknown. */
+    float getDuration() const;
+
+    /** Index of the track played, 0 for the track given to open. */
+    int getTrackIndex() const { return _trackIndex; }
+
+    /** Number of buffers the worker didn't fill in time. */
+    uint32_t getUnderrunCount() const { return _underrunCount; }
+
+    /** Microseconds spent by the worker decoding and converting. */
+    uint64_t getDecodeTime() const { return _decodeTime; }
+
+    int getSampleRate() const { return _sampleRate; }
+
+    int getChannelCount() const { return _channelCount; }
+
+    /** Bytes of samples held by the stream. */
+    size_t getMemorySize() const;
+
+    /**
+     * Add frameCount frames to buffer, the gain goes from gain to targetGain.
+     * Called by the mixer thread, return false once the stream ended.
+     */
+    bool mix(float* buffer, int frameCount, float gain, float targetGain);
+
+    /** Consume frameCount frames without mixing them, return false once the stream ended. */
+    bool skip(int frameCount) { return mix(nullptr, frameCount, 0.0f, 0.0f); }
+
+private:
+    /** Start of a track in the ring buffer, published by the worker before the frames. */
+    struct Marker
+    {
+        uint64_t frame;
+        /** Frame where the position in the track is 0, before frame after a seek. */
+        int64_t trackStart;
+        int64_t duration;
+        int track;
+    };
+
+    void threadLoop();
+    // decode into the ring buffer, return false when it is full or the stream ended
+    bool decode();
+    // convert the decoded frames into the ring buffer, return the number of frames written
+    int convert(uint64_t writeFrame, int maxFrames, bool& ended);
+    // switch to the queued track or loop, return false at the end of the stream
+    bool nextTrack(uint64_t frame);
+    void startTrack(uint64_t frame, int64_t trackStart);
+    void pushMarker(const Marker& marker);
+    // apply the markers reached by the read position, mixer thread only
+    void readMarkers(uint64_t readFrame);
+
+    const int _sampleRate;
+    const int _channelCount;
+    std::vector<int16_t> _ring;
+    uint64_t _ringMask;
+
+    /** Frames written and read since the stream was opened. */
+    std::atomic<uint64_t> _writeFrame;
+    std::atomic<uint64_t> _readFrame;
+    /** The frames before this one were decoded before a seek and aren't played. */
+    std::atomic<uint64_t> _discardFrame;
+    std::atomic<bool> _finished;
+
+    static const int MAX_MARKERS = 16;
+    Marker _markers[MAX_MARKERS];
+    std::atomic<uint32_t> _markerWrite;
+    std::atomic<uint32_t> _markerRead;
+
+    // published by the mixer thread
+    std::atomic<int64_t> _position;
+    std::atomic<int64_t> _duration;
+    std::atomic<int> _trackIndex;
+    std::atomic<uint32_t> _underrunCount;
+    // owned by the mixer thread
+    int64_t _trackStart;
+    bool _started;
+
+    // requests from the controlling thread
+    std::atomic<bool> _loop;
+    std::atomic<float> _seekRequest;
+
+    std::atomic<uint64_t> _decodeTime;
+
+    // owned by the worker
+    std::unique_ptr<StreamDecoder> _decoder;
+    int _decodedTrack;
+    std::vector<int16_t> _decodeBuffer;
+    int _decodedFrames;
+    bool _decoderEnded;
+    /** Whether the track being decoded produced any frame, an empty track isn't looped. */
+    bool _trackDecoded;
+    uint64_t _phase;
+    uint64_t _step;
+
+    std::deque<std::unique_ptr<StreamDecoder>> _queue;
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::atomic<bool> _running;
+};
+
+} // namespace experimental
+NS_CC_END
+
+#endif // __MIXER_STREAM_H__
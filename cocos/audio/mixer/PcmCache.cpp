@@ -0,0 +1,244 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "audio/mixer/PcmCache.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+
+NS_CC_BEGIN
+namespace experimental {
+
+namespace {
+    std::shared_ptr<MixerPcm> timedDecode(const PcmCache::Decoder& decoder, const std::string& fullPath, double& milliseconds)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto pcm = decoder(fullPath);
+        milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return pcm;
+    }
+}
+
+PcmCache::PcmCache(const Decoder& decoder, const TaskRunner& taskRunner)
+: _decoder(decoder)
+, _taskRunner(taskRunner)
+, _budget(32 * 1024 * 1024)
+, _residentSize(0)
+, _hitCount(0)
+, _missCount(0)
+, _evictionCount(0)
+, _isAlive(std::make_shared<bool>(true))
+{
+}
+
+PcmCache::~PcmCache()
+{
+    *_isAlive = false;
+}
+
+void PcmCache::setBudget(size_t bytes)
+{
+    _budget = bytes;
+    trim();
+}
+
+std::shared_ptr<MixerPcm> PcmCache::find(const std::string& fullPath)
+{
+    auto it = _entries.find(fullPath);
+    if (it == _entries.end())
+        return nullptr;
+
+    _lru.splice(_lru.begin(), _lru, it->second.lru);
+    return it->second.pcm;
+}
+
+std::shared_ptr<MixerPcm> PcmCache::get(const std::string& fullPath)
+{
+    auto pcm = find(fullPath);
+    if (pcm)
+    {
+        ++_hitCount;
+        return pcm;
+    }
+
+    ++_missCount;
+    double decodeTime = 0;
+    pcm = timedDecode(_decoder, fullPath, decodeTime);
+    addDecodeStats(fullPath, pcm, decodeTime);
+    if (pcm)
+    {
+        pcm = insert(fullPath, pcm);
+    }
+    return pcm;
+}
+
+void PcmCache::load(const std::string& fullPath, const LoadCallback& callback)
+{
+    auto pcm = find(fullPath);
+    if (pcm)
+    {
+        ++_hitCount;
+        if (callback)
+        {
+            callback(pcm);
+        }
+        return;
+    }
+
+    auto& callbacks = _loading[fullPath];
+    callbacks.push_back(callback);
+    if (callbacks.size() > 1)
+    {
+        // already being decoded
+        return;
+    }
+    ++_missCount;
+
+    std::weak_ptr<bool> isAlive = _isAlive;
+    auto decoder = _decoder;
+    _taskRunner([this, isAlive, decoder, fullPath](){
+        double decodeTime = 0;
+        auto pcm = timedDecode(decoder, fullPath, decodeTime);
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([this, isAlive, fullPath, pcm, decodeTime](){
+            auto alive = isAlive.lock();
+            if (alive && *alive)
+            {
+                onLoaded(fullPath, pcm, decodeTime);
+            }
+        });
+    });
+}
+
+void PcmCache::onLoaded(const std::string& fullPath, const std::shared_ptr<MixerPcm>& decoded, double decodeTime)
+{
+    addDecodeStats(fullPath, decoded, decodeTime);
+
+    auto it = _loading.find(fullPath);
+    if (it == _loading.end())
+        return;
+    auto callbacks = std::move(it->second);
+    _loading.erase(it);
+
+    // get may have decoded the file meanwhile
+    std::shared_ptr<MixerPcm> pcm = find(fullPath);
+    if (!pcm && decoded)
+    {
+        pcm = insert(fullPath, decoded);
+    }
+
+    for (auto& callback : callbacks)
+    {
+        if (callback)
+        {
+            callback(pcm);
+        }
+    }
+}
+
+void PcmCache::setKeepResident(const std::string& fullPath, bool keepResident)
+{
+    if (keepResident)
+    {
+        _keepResident.insert(fullPath);
+    }
+    else if (_keepResident.erase(fullPath) > 0)
+    {
+        trim();
+    }
+}
+
+void PcmCache::remove(const std::string& fullPath)
+{
+    auto it = _entries.find(fullPath);
+    if (it != _entries.end())
+    {
+        _residentSize -= it->second.size;
+        _lru.erase(it->second.lru);
+        _entries.erase(it);
+    }
+    _keepResident.erase(fullPath);
+}
+
+void PcmCache::clear()
+{
+    _entries.clear();
+    _lru.clear();
+    _keepResident.clear();
+    _residentSize = 0;
+}
+
+void PcmCache::trim()
+{
+    auto it = _lru.end();
+    while (_residentSize > _budget && it != _lru.begin())
+    {
+        --it;
+        auto entry = _entries.find(*it);
+        // the voices playing the sound share it, evicting it would not free memory
+        if (entry->second.pcm.use_count() > 1 || _keepResident.count(*it) > 0)
+            continue;
+
+        _residentSize -= entry->second.size;
+        _entries.erase(entry);
+        it = _lru.erase(it);
+        ++_evictionCount;
+    }
+}
+
+void PcmCache::addDecodeStats(const std::string& fullPath, const std::shared_ptr<MixerPcm>& pcm, double decodeTime)
+{
+    auto& stats = _decodeStats[fullPath];
+    ++stats.count;
+    stats.totalTime += decodeTime;
+    stats.maxTime = std::max(stats.maxTime, decodeTime);
+    stats.size = pcm ? pcm->samples.size() * sizeof(int16_t) : 0;
+}
+
+void PcmCache::resetStats()
+{
+    _decodeStats.clear();
+    _hitCount = 0;
+    _missCount = 0;
+    _evictionCount = 0;
+}
+
+std::shared_ptr<MixerPcm> PcmCache::insert(const std::string& fullPath, const std::shared_ptr<MixerPcm>& pcm)
+{
+    _lru.push_front(fullPath);
+
+    auto& entry = _entries[fullPath];
+    entry.pcm = pcm;
+    entry.size = pcm->samples.size() * sizeof(int16_t);
+    entry.lru = _lru.begin();
+    _residentSize += entry.size;
+
+    trim();
+    return pcm;
+}
+
+} // namespace experimental
+NS_CC_END
@@ -0,0 +1,153 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __PCM_CACHE_H__
+#define __PCM_CACHE_H__
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "audio/mixer/SoftwareMixer.h"
+
+NS_CC_BEGIN
+namespace experimental {
+
+/**
+ * Decoded sounds shared by the voices playing them, bounded by a memory budget.
+ *
+ * When the budget is exceeded the least recently used sounds are evicted, unless
+ * they are still referenced by a voice or marked as resident.
+ * load decodes on worker threads, concurrent loads of a file are merged.
+ *
+ * Must be used from the cocos thread, only the decoder is called from the workers.
+ */
+class CC_DLL PcmCache
+{
+public:
+    /** Decode a file, return nullptr on failure. Called from any thread. */
+    typedef std::function<std::shared_ptr<MixerPcm>(const std::string& fullPath)> Decoder;
+
+    /** Run a task on a worker thread, usually AudioEngine::addTask. */
+    typedef std::function<void(const std::function<void()>& task)> TaskRunner;
+
+    typedef std::function<void(const std::shared_ptr<MixerPcm>& pcm)> LoadCallback;
+
+    /** Cost of the decoding of a file. */
+    struct DecodeStats
+    {
+        uint32_t count;
+        /** Milliseconds spent decoding the file. */
+        double totalTime;
+        double maxTime;
+        /** Bytes of the last decoded pcm. */
+        size_t size;
+
+        DecodeStats() : count(0), totalTime(0), maxTime(0), size(0) {}
+    };
+
+    PcmCache(const Decoder& decoder, const TaskRunner& taskRunner);
+    ~PcmCache();
+
+    /** Set the maximum bytes of decoded samples. Default is 32 MB. */
+    void setBudget(size_t bytes);
+
+    size_t getBudget() const { return _budget; }
+
+    /** Bytes of decoded samples in the cache. */
+    size_t getResidentSize() const { return _residentSize; }
+
+    size_t getCount() const { return _entries.size(); }
+
+    /** @return the cached sound, nullptr if it isn't decoded yet. */
+    std::shared_ptr<MixerPcm> find(const std::string& fullPath);
+
+    /** @return the cached sound, decoded in the calling thread if needed. */
+    std::shared_ptr<MixerPcm> get(const std::string& fullPath);
+
+    /** Decode the file on a worker if it isn't cached, callback is invoked in the cocos thread. */
+    void load(const std::string& fullPath, const LoadCallback& callback);
+
+    /** A resident sound is never evicted, the flag may be set before the sound is loaded. */
+    void setKeepResident(const std::string& fullPath, bool keepResident);
+
+    void remove(const std::string& fullPath);
+
+    void clear();
+
+    /** Evict sounds until the budget is respected, if possible. */
+    void trim();
+
+    /** Decoding cost of the files decoded since the last resetStats, by full path. */
+    const std::unordered_map<std::string, DecodeStats>& getDecodeStats() const { return _decodeStats; }
+
+    /** Number of get and load calls which found the sound in the cache. */
+    uint32_t getHitCount() const { return _hitCount; }
+
+    uint32_t getMissCount() const { return _missCount; }
+
+    uint32_t getEvictionCount() const { return _evictionCount; }
+
+    void resetStats();
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<MixerPcm> pcm;
+        size_t size;
+        std::list<std::string>::iterator lru;
+    };
+
+    std::shared_ptr<MixerPcm> insert(const std::string& fullPath, const std::shared_ptr<MixerPcm>& pcm);
+    void onLoaded(const std::string& fullPath, const std::shared_ptr<MixerPcm>& pcm, double decodeTime);
+    void addDecodeStats(const std::string& fullPath, const std::shared_ptr<MixerPcm>& pcm, double decodeTime);
+
+    Decoder _decoder;
+    TaskRunner _taskRunner;
+    size_t _budget;
+    size_t _residentSize;
+
+    std::unordered_map<std::string, Entry> _entries;
+    /** Most recently used first. */
+    std::list<std::string> _lru;
+    std::unordered_set<std::string> _keepResident;
+    std::unordered_map<std::string, std::vector<LoadCallback>> _loading;
+
+    std::unordered_map<std::string, DecodeStats> _decodeStats;
+    uint32_t _hitCount;
+    uint32_t _missCount;
+    uint32_t _evictionCount;
+
+    /** Expires with the cache, the pending loads check it before reporting. */
+    std::shared_ptr<bool> _isAlive;
+};
+
+} // namespace experimental
+NS_CC_END
+
+#endif // __PCM_CACHE_H__
@@ -0,0 +1,633 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "audio/mixer/SoftwareMixer.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "audio/mixer/MixerOps.h"
+#include "audio/mixer/MixerOutput.h"
+#include "audio/mixer/MixerStream.h"
+#include "base/ccMacros.h"
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+#include <windows.h>
+#elif CC_TARGET_PLATFORM != CC_PLATFORM_WINRT
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+NS_CC_BEGIN
+namespace experimental {
+
+namespace {
+    // phases and steps are fixed point numbers with 32 bits of fraction
+    const uint64_t PHASE_ONE = (uint64_t)1 << 32;
+
+    bool raiseThreadPriority()
+    {
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+        return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#elif CC_TARGET_PLATFORM != CC_PLATFORM_WINRT
+        sched_param param;
+        param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+        return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#else
+        return true;
+#endif
+    }
+}
+
+SoftwareMixer::SoftwareMixer()
+: _output(nullptr)
+, _fallbackOutput(nullptr)
+, _failedOutput(nullptr)
+, _realtimePriorityDenied(false)
+, _running(false)
+, _lastMixTime(0)
+, _maxMixTime(0)
+, _totalMixTime(0)
+, _statsBufferCount(0)
+, _mixedBufferCount(0)
+, _underrunCount(0)
+, _previousUnderrunCount(0)
+, _virtualVoiceCount(0)
+{
+}
+
+SoftwareMixer::~SoftwareMixer()
+{
+    destroy();
+}
+
+bool SoftwareMixer::init(const Config& config, MixerOutput* output)
+{
+    CCASSERT(!_voices, "SoftwareMixer is already initialized");
+    CCASSERT(config.channelCount == 1 || config.channelCount == 2, "SoftwareMixer supports mono and stereo only");
+
+    _config = config;
+    _voices.reset(new (std::nothrow) Voice[config.maxVoices]);
+    if (!_voices)
+    {
+        delete output;
+        return false;
+    }
+    for (int i = 0; i < config.maxVoices; ++i)
+    {
+        _voices[i].state = VOICE_FREE;
+        _voices[i].pcm = nullptr;
+        _voices[i].stream = nullptr;
+    }
+    _config.maxAudibleVoices = std::min(config.maxAudibleVoices, config.maxVoices);
+    _playingVoices.resize(config.maxVoices);
+    _voiceKeys.resize(config.maxVoices);
+    _mixBuffer.resize(config.framesPerBuffer * config.channelCount);
+    _outputBuffer.resize(config.framesPerBuffer * config.channelCount);
+
+    if (output)
+    {
+        // allocated here since the mixer thread doesn't allocate when the output fails
+        _fallbackOutput = new (std::nothrow) NullMixerOutput();
+        if (!_fallbackOutput || !output->open(config.sampleRate, config.channelCount, config.framesPerBuffer))
+        {
+            delete output;
+            delete _fallbackOutput;
+            _fallbackOutput = nullptr;
+            _voices.reset();
+            return false;
+        }
+        _fallbackOutput->open(config.sampleRate, config.channelCount, config.framesPerBuffer);
+        _output = output;
+        _running = true;
+        _thread = std::thread(&SoftwareMixer::threadLoop, this);
+    }
+    return true;
+}
+
+void SoftwareMixer::destroy()
+{
+    if (_running)
+    {
+        _running = false;
+        _thread.join();
+    }
+    closeFailedOutput();
+    if (_output)
+    {
+        _output->close();
+        delete _output;
+        if (_output != _fallbackOutput)
+        {
+            _fallbackOutput->close();
+            delete _fallbackOutput;
+        }
+        _output = nullptr;
+        _fallbackOutput = nullptr;
+    }
+    _voices.reset();
+}
+
+int SoftwareMixer::play(const MixerPcm* pcm, float volume, bool loop, int priority)
+{
+    if (!pcm || pcm->frameCount <= 0 || pcm->channelCount < 1 || pcm->channelCount > 2)
+        return -1;
+
+    return startVoice(pcm, nullptr, volume, loop, priority);
+}
+
+int SoftwareMixer::play(MixerStream* stream, float volume, int priority)
+{
+    if (!stream || stream->getSampleRate() != _config.sampleRate || stream->getChannelCount() != _config.channelCount)
+        return -1;
+
+    return startVoice(nullptr, stream, volume, stream->isLoop(), priority);
+}
+
+int SoftwareMixer::startVoice(const MixerPcm* pcm, MixerStream* stream, float volume, bool loop, int priority)
+{
+    for (int i = 0; i < _config.maxVoices; ++i)
+    {
+        Voice& voice = _voices[i];
+        if (voice.state.load(std::memory_order_acquire) != VOICE_FREE)
+            continue;
+
+        // the mixer thread ignores free voices, it sees these values once the state is published
+        voice.pcm = pcm;
+        voice.stream = stream;
+        // a stream is already at the rate of the mixer
+        voice.step = pcm ? ((uint64_t)pcm->sampleRate << 32) / _config.sampleRate : PHASE_ONE;
+        voice.phase = 0;
+        voice.gain = volume;
+        voice.volume.store(volume, std::memory_order_relaxed);
+        voice.loop.store(loop, std::memory_order_relaxed);
+        voice.priority.store(priority, std::memory_order_relaxed);
+        voice.seekFrame.store(-1, std::memory_order_relaxed);
+        voice.position.store(0, std::memory_order_relaxed);
+        voice.state.store(VOICE_PLAYING, std::memory_order_release);
+        return i;
+    }
+    return -1;
+}
+
+bool SoftwareMixer::pause(int voice)
+{
+    if (!isValidVoice(voice))
+        return false;
+    int expected = VOICE_PLAYING;
+    return _voices[voice].state.compare_exchange_strong(expected, VOICE_PAUSED);
+}
+
+bool SoftwareMixer::resume(int voice)
+{
+    if (!isValidVoice(voice))
+        return false;
+    int expected = VOICE_PAUSED;
+    return _voices[voice].state.compare_exchange_strong(expected, VOICE_PLAYING);
+}
+
+void SoftwareMixer::stop(int voice)
+{
+    if (!isValidVoice(voice))
+        return;
+
+    // a voice which just ended is released as is
+    auto& state = _voices[voice].state;
+    int expected = VOICE_PLAYING;
+    if (!state.compare_exchange_strong(expected, VOICE_STOPPING))
+    {
+        expected = VOICE_PAUSED;
+        state.compare_exchange_strong(expected, VOICE_STOPPING);
+    }
+
+    if (!_running)
+    {
+        // no mixer thread to acknowledge the stop
+        expected = VOICE_STOPPING;
+        state.compare_exchange_strong(expected, VOICE_STOPPED);
+    }
+}
+
+void SoftwareMixer::setVolume(int voice, float volume)
+{
+    if (isValidVoice(voice))
+    {
+        _voices[voice].volume.store(volume, std::memory_order_relaxed);
+    }
+}
+
+void SoftwareMixer::setLoop(int voice, bool loop)
+{
+    if (isValidVoice(voice))
+    {
+        _voices[voice].loop.store(loop, std::memory_order_relaxed);
+        if (_voices[voice].stream)
+        {
+            _voices[voice].stream->setLoop(loop);
+        }
+    }
+}
+
+void SoftwareMixer::setPriority(int voice, int priority)
+{
+    if (isValidVoice(voice))
+    {
+        _voices[voice].priority.store(priority, std::memory_order_relaxed);
+    }
+}
+
+void SoftwareMixer::setPosition(int voice, float seconds)
+{
+    if (isValidVoice(voice) && _voices[voice].state.load() != VOICE_FREE)
+    {
+        auto& v = _voices[voice];
+        if (v.stream)
+        {
+            v.stream->seek(seconds);
+            return;
+        }
+        int64_t frame = (int64_t)(seconds * v.pcm->sampleRate);
+        frame = std::max((int64_t)0, std::min(frame, (int64_t)v.pcm->frameCount));
+        v.seekFrame.store(frame, std::memory_order_relaxed);
+        v.position.store(frame, std::memory_order_relaxed);
+    }
+}
+
+float SoftwareMixer::getPosition(int voice) const
+{
+    if (!isValidVoice(voice) || _voices[voice].state.load() == VOICE_FREE)
+        return 0.0f;
+    auto& v = _voices[voice];
+    if (v.stream)
+        return v.stream->getPosition();
+    return (float)v.position.load(std::memory_order_relaxed) / v.pcm->sampleRate;
+}
+
+void SoftwareMixer::releaseVoices(const ReleaseCallback& callback)
+{
+    closeFailedOutput();
+    if (_realtimePriorityDenied.exchange(false, std::memory_order_relaxed))
+    {
+        // usually the process isn't allowed to, the mixer still works with a normal priority
+        CCLOG("SoftwareMixer: real-time priority is not available");
+    }
+
+    for (int i = 0; i < _config.maxVoices; ++i)
+    {
+        auto& state = _voices[i].state;
+        int current = state.load(std::memory_order_acquire);
+        if (current == VOICE_STOPPED || current == VOICE_ENDED)
+        {
+            _voices[i].pcm = nullptr;
+            _voices[i].stream = nullptr;
+            state.store(VOICE_FREE, std::memory_order_release);
+            if (callback)
+            {
+                callback(i, current == VOICE_ENDED);
+            }
+        }
+    }
+}
+
+int SoftwareMixer::getActiveVoiceCount() const
+{
+    int count = 0;
+    for (int i = 0; i < _config.maxVoices; ++i)
+    {
+        int state = _voices[i].state.load(std::memory_order_relaxed);
+        if (state == VOICE_PLAYING || state == VOICE_PAUSED || state == VOICE_STOPPING)
+            ++count;
+    }
+    return count;
+}
+
+void SoftwareMixer::mix(int16_t* output, int frameCount)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    const int channelCount = _config.channelCount;
+    while (frameCount > 0)
+    {
+        int count = std::min(frameCount, _config.framesPerBuffer);
+        mixBuffer(_mixBuffer.data(), count);
+        mixer::floatToInt16(_mixBuffer.data(), output, count * channelCount);
+        output += count * channelCount;
+        frameCount -= count;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    uint32_t mixTime = (uint32_t)elapsed.count();
+    _lastMixTime.store(mixTime, std::memory_order_relaxed);
+    if (mixTime > _maxMixTime.load(std::memory_order_relaxed))
+    {
+        // only the mixer thread raises it, a concurrent reset may be lost, it doesn't matter
+        _maxMixTime.store(mixTime, std::memory_order_relaxed);
+    }
+    _totalMixTime.fetch_add(mixTime, std::memory_order_relaxed);
+    _statsBufferCount.fetch_add(1, std::memory_order_relaxed);
+    _mixedBufferCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+float SoftwareMixer::getAverageMixTime() const
+{
+    uint64_t count = _statsBufferCount.load(std::memory_order_relaxed);
+    return count > 0 ? (float)_totalMixTime.load(std::memory_order_relaxed) / count : 0.0f;
+}
+
+void SoftwareMixer::resetMixStats()
+{
+    _maxMixTime.store(0, std::memory_order_relaxed);
+    _totalMixTime.store(0, std::memory_order_relaxed);
+    _statsBufferCount.store(0, std::memory_order_relaxed);
+}
+
+void SoftwareMixer::mixBuffer(float* buffer, int frameCount)
+{
+    std::fill(buffer, buffer + frameCount * _config.channelCount, 0.0f);
+
+    int playingCount = 0;
+    for (int i = 0; i < _config.maxVoices; ++i)
+    {
+        Voice& voice = _voices[i];
+        int state = voice.state.load(std::memory_order_acquire);
+        if (state == VOICE_PLAYING)
+        {
+            _playingVoices[playingCount++] = i;
+        }
+        else if (state == VOICE_PAUSED)
+        {
+            // resume fades in
+            voice.gain = 0.0f;
+        }
+        else if (state == VOICE_STOPPING)
+        {
+            // fade out over one buffer to avoid a click
+            mixVoice(voice, buffer, frameCount, 0.0f);
+            voice.state.store(VOICE_STOPPED, std::memory_order_release);
+        }
+    }
+
+    int audibleCount = selectAudibleVoices(playingCount);
+    for (int i = 0; i < playingCount; ++i)
+    {
+        Voice& voice = _voices[_playingVoices[i]];
+        bool playing;
+        if (i < audibleCount)
+        {
+            playing = mixVoice(voice, buffer, frameCount, voice.volume.load(std::memory_order_relaxed));
+        }
+        else if (voice.gain > 0.0f)
+        {
+            // just became virtual, fade out
+            playing = mixVoice(voice, buffer, frameCount, 0.0f);
+        }
+        else
+        {
+            playing = skipVoice(voice, frameCount);
+        }
+
+        if (!playing)
+        {
+            // the voice may have been paused or stopped meanwhile, it has ended anyway
+            voice.state.store(VOICE_ENDED, std::memory_order_release);
+        }
+    }
+    _virtualVoiceCount.store(playingCount - audibleCount, std::memory_order_relaxed);
+}
+
+int SoftwareMixer::selectAudibleVoices(int playingCount)
+{
+    const int audibleCount = _config.maxAudibleVoices;
+    if (playingCount <= audibleCount)
+        return playingCount;
+
+    for (int i = 0; i < playingCount; ++i)
+    {
+        const Voice& voice = _voices[_playingVoices[i]];
+        _voiceKeys[i].priority = voice.priority.load(std::memory_order_relaxed);
+        _voiceKeys[i].volume = voice.volume.load(std::memory_order_relaxed);
+        _voiceKeys[i].voice = _playingVoices[i];
+    }
+
+    std::nth_element(_voiceKeys.begin(), _voiceKeys.begin() + audibleCount, _voiceKeys.begin() + playingCount,
+                     [](const VoiceKey& a, const VoiceKey& b){
+        if (a.priority != b.priority)
+            return a.priority > b.priority;
+        return a.volume > b.volume;
+    });
+
+    for (int i = 0; i < playingCount; ++i)
+    {
+        _playingVoices[i] = _voiceKeys[i].voice;
+    }
+    return audibleCount;
+}
+
+bool SoftwareMixer::skipVoice(Voice& voice, int frameCount)
+{
+    if (voice.stream)
+    {
+        // keep consuming so that the stream stays in time with the other voices
+        return voice.stream->skip(frameCount);
+    }
+
+    const uint64_t sourceFrames = (uint64_t)voice.pcm->frameCount;
+
+    int64_t seekFrame = voice.seekFrame.exchange(-1, std::memory_order_relaxed);
+    if (seekFrame >= 0)
+    {
+        voice.phase = (uint64_t)seekFrame << 32;
+    }
+
+    uint64_t phase = voice.phase + voice.step * frameCount;
+    bool playing = true;
+    if ((phase >> 32) >= sourceFrames)
+    {
+        if (voice.loop.load(std::memory_order_relaxed))
+        {
+            phase %= sourceFrames << 32;
+        }
+        else
+        {
+            phase = sourceFrames << 32;
+            playing = false;
+        }
+    }
+
+    voice.phase = phase;
+    voice.position.store((int64_t)(phase >> 32), std::memory_order_relaxed);
+    return playing;
+}
+
+bool SoftwareMixer::mixVoice(Voice& voice, float* buffer, int frameCount, float targetGain)
+{
+    if (voice.stream)
+    {
+        bool playing = voice.stream->mix(buffer, frameCount, voice.gain, targetGain);
+        voice.gain = targetGain;
+        return playing;
+    }
+
+    const MixerPcm* pcm = voice.pcm;
+    const int16_t* samples = pcm->samples.data();
+    const int sourceChannels = pcm->channelCount;
+    const uint64_t sourceFrames = (uint64_t)pcm->frameCount;
+    const int channelCount = _config.channelCount;
+    const bool loop = voice.loop.load(std::memory_order_relaxed);
+
+    int64_t seekFrame = voice.seekFrame.exchange(-1, std::memory_order_relaxed);
+    if (seekFrame >= 0)
+    {
+        voice.phase = (uint64_t)seekFrame << 32;
+    }
+
+    uint64_t phase = voice.phase;
+    float gain = voice.gain;
+    const float gainStep = (targetGain - gain) / frameCount;
+    int frame = 0;
+
+    if (voice.step == PHASE_ONE && sourceChannels == channelCount)
+    {
+        // same rate and layout, copy whole runs of samples
+        while (frame < frameCount)
+        {
+            uint64_t index = phase >> 32;
+            if (index >= sourceFrames)
+            {
+                if (!loop)
+                    break;
+                index = 0;
+                phase = 0;
+            }
+
+            int count = (int)std::min((uint64_t)(frameCount - frame), sourceFrames - index);
+            const int16_t* in = samples + index * channelCount;
+            float* out = buffer + frame * channelCount;
+            if (gainStep == 0.0f)
+            {
+                mixer::accumulateInt16(in, out, count * channelCount, gain);
+            }
+            else
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    const float scale = gain / 32768.0f;
+                    for (int c = 0; c < channelCount; ++c)
+                    {
+                        out[i * channelCount + c] += in[i * channelCount + c] * scale;
+                    }
+                    gain += gainStep;
+                }
+            }
+            frame += count;
+            phase += (uint64_t)count << 32;
+        }
+    }
+    else
+    {
+        // resample with a linear interpolation, remap the channels
+        const uint64_t step = voice.step;
+        const float fractionScale = 1.0f / 4294967296.0f;
+        while (frame < frameCount)
+        {
+            uint64_t index = phase >> 32;
+            if (index >= sourceFrames)
+            {
+                if (!loop)
+                    break;
+                phase -= sourceFrames << 32;
+                continue;
+            }
+
+            uint64_t next = index + 1;
+            if (next >= sourceFrames)
+            {
+                next = loop ? 0 : index;
+            }
+            const float fraction = (uint32_t)phase * fractionScale;
+            const int16_t* a = samples + index * sourceChannels;
+            const int16_t* b = samples + next * sourceChannels;
+            float left = a[0] + (b[0] - a[0]) * fraction;
+            float right = sourceChannels == 2 ? a[1] + (b[1] - a[1]) * fraction : left;
+
+            const float scale = gain / 32768.0f;
+            float* out = buffer + frame * channelCount;
+            if (channelCount == 2)
+            {
+                out[0] += left * scale;
+                out[1] += right * scale;
+            }
+            else
+            {
+                out[0] += (left + right) * 0.5f * scale;
+            }
+
+            gain += gainStep;
+            phase += step;
+            ++frame;
+        }
+    }
+
+    voice.phase = phase;
+    voice.gain = targetGain;
+    voice.position.store((int64_t)std::min(phase >> 32, sourceFrames), std::memory_order_relaxed);
+    return frame == frameCount;
+}
+
+void SoftwareMixer::closeFailedOutput()
+{
+    MixerOutput* failedOutput = _failedOutput.exchange(nullptr, std::memory_order_acquire);
+    if (failedOutput)
+    {
+        CCLOG("SoftwareMixer: %s output failed, switched to the null output", failedOutput->getName());
+        failedOutput->close();
+        delete failedOutput;
+    }
+}
+
+void SoftwareMixer::threadLoop()
+{
+    if (_config.realtimePriority && !raiseThreadPriority())
+    {
+        _realtimePriorityDenied.store(true, std::memory_order_relaxed);
+    }
+
+    while (_running.load(std::memory_order_acquire))
+    {
+        mix(_outputBuffer.data(), _config.framesPerBuffer);
+        bool written = _output->write(_outputBuffer.data(), _config.framesPerBuffer);
+        _underrunCount.store(_previousUnderrunCount + _output->getUnderrunCount(), std::memory_order_relaxed);
+        if (!written && _output != _fallbackOutput)
+        {
+            // keep the voices progressing so that they end and get released,
+            // the controlling thread closes the failed output in releaseVoices
+            _previousUnderrunCount += _output->getUnderrunCount();
+            _failedOutput.store(_output, std::memory_order_release);
+            _output = _fallbackOutput;
+        }
+    }
+}
+
+} // namespace experimental
+NS_CC_END
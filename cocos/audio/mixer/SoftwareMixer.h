@@ -0,0 +1,249 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __SOFTWARE_MIXER_H__
+#define __SOFTWARE_MIXER_H__
+
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+namespace experimental {
+
+class MixerOutput;
+class MixerStream;
+
+/** Decoded sound, interleaved signed 16 bits samples, mono or stereo. */
+struct CC_DLL MixerPcm
+{
+    std::vector<int16_t> samples;
+    int channelCount;
+    int sampleRate;
+    int frameCount;
+
+    MixerPcm() : channelCount(0), sampleRate(0), frameCount(0) {}
+
+    float getDuration() const { return sampleRate > 0 ? (float)frameCount / sampleRate : 0.0f; }
+};
+
+/**
+ * Platform independent mixer of decoded sounds.
+ *
+ * The voices are mixed in a dedicated thread and written to a MixerOutput.
+ * The mixer thread never allocates memory nor takes a lock: the voices are preallocated slots
+ * controlled through atomics, the samples are resampled to the output rate with a linear
+ * interpolation, accumulated in float and converted with SIMD instructions when available.
+ *
+ * When more voices play than maxAudibleVoices, only the ones with the highest priority, then the
+ * highest volume, are mixed. The others are virtual: their position keeps advancing without being
+ * mixed and they fade in when they become audible again, so the mixing cost stays bounded.
+ *
+ * A voice plays either a decoded pcm or a MixerStream decoded while it plays.
+ *
+ * The voices must be controlled from a single thread, usually the cocos thread.
+ * The pcm or stream of a voice must stay alive until the voice is released by releaseVoices.
+ */
+class CC_DLL SoftwareMixer
+{
+public:
+    struct Config
+    {
+        int sampleRate;
+        /** 1 or 2. */
+        int channelCount;
+        int framesPerBuffer;
+        /** Voices which can be played, audible or virtual. */
+        int maxVoices;
+        /** Voices mixed at the same time. */
+        int maxAudibleVoices;
+        /** Try to run the mixer thread with a real-time scheduling policy. */
+        bool realtimePriority;
+
+        Config() : sampleRate(44100), channelCount(2), framesPerBuffer(512), maxVoices(64), maxAudibleVoices(32), realtimePriority(true) {}
+    };
+
+    /** Called for each released voice, reachedEnd is false if the voice was stopped. */
+    typedef std::function<void(int voice, bool reachedEnd)> ReleaseCallback;
+
+    SoftwareMixer();
+    ~SoftwareMixer();
+
+    /**
+     * Start the mixer thread writing to output, the mixer takes the ownership of output.
+     * If output is nullptr no thread is started and the buffers are produced by calling mix.
+     */
+    bool init(const Config& config, MixerOutput* output);
+
+    /** Stop the mixer thread and close the output, all the voices are stopped. */
+    void destroy();
+
+    /** @return the voice playing pcm, -1 if all the voices are used. */
+    int play(const MixerPcm* pcm, float volume, bool loop, int priority = 0);
+
+    /**
+     * @return the voice playing stream, -1 if all the voices are used or if the stream
+     * doesn't have the rate and channels of the mixer. The stream handles the looping.
+     */
+    int play(MixerStream* stream, float volume, int priority = 0);
+
+    bool pause(int voice);
+
+    bool resume(int voice);
+
+    /** Fade out and stop the voice, it is released by the next releaseVoices after the fade. */
+    void stop(int voice);
+
+    void setVolume(int voice, float volume);
+
+    void setLoop(int voice, bool loop);
+
+    /** Voices with a higher priority are mixed first when there are too many voices. */
+    void setPriority(int voice, int priority);
+
+    void setPosition(int voice, float seconds);
+
+    float getPosition(int voice) const;
+
+    /**
+     * Free the voices which ended or were stopped.
+     * Also closes the output which failed in the mixer thread and logs the problems of the mixer thread.
+     */
+    void releaseVoices(const ReleaseCallback& callback);
+
+    /** Number of voices playing or paused. */
+    int getActiveVoiceCount() const;
+
+    /** Number of playing voices which weren't mixed in the last buffer. */
+    int getVirtualVoiceCount() const { return _virtualVoiceCount; }
+
+    /** Mix the voices into interleaved samples, called by the mixer thread. */
+    void mix(int16_t* output, int frameCount);
+
+    const Config& getConfig() const { return _config; }
+
+    /** Duration of the last mix in microseconds. */
+    uint32_t getLastMixTime() const { return _lastMixTime; }
+
+    /** Longest mix in microseconds since the last resetMixStats. */
+    uint32_t getMaxMixTime() const { return _maxMixTime; }
+
+    /** Average mix duration in microseconds since the last resetMixStats. */
+    float getAverageMixTime() const;
+
+    void resetMixStats();
+
+    uint64_t getMixedBufferCount() const { return _mixedBufferCount; }
+
+    /** Number of times the output ran out of mixed buffers. */
+    uint32_t getUnderrunCount() const { return _underrunCount; }
+
+private:
+    enum VoiceState
+    {
+        VOICE_FREE,
+        VOICE_PLAYING,
+        VOICE_PAUSED,
+        VOICE_STOPPING,
+        VOICE_STOPPED,
+        VOICE_ENDED
+    };
+
+    struct Voice
+    {
+        std::atomic<int> state;
+        std::atomic<float> volume;
+        std::atomic<bool> loop;
+        std::atomic<int> priority;
+        /** Requested position in frames of the pcm, -1 if none. */
+        std::atomic<int64_t> seekFrame;
+        /** Position in frames of the pcm, updated by the mixer thread. */
+        std::atomic<int64_t> position;
+
+        // written by the controlling thread before the voice is playing
+        const MixerPcm* pcm;
+        MixerStream* stream;
+        uint64_t step;
+
+        // owned by the mixer thread
+        uint64_t phase;
+        float gain;
+    };
+
+    int startVoice(const MixerPcm* pcm, MixerStream* stream, float volume, bool loop, int priority);
+    void mixBuffer(float* buffer, int frameCount);
+    // return false when the end of a non looping pcm is reached
+    bool mixVoice(Voice& voice, float* buffer, int frameCount, float targetGain);
+    // advance a virtual voice without mixing it, return false when the end is reached
+    bool skipVoice(Voice& voice, int frameCount);
+    // keep the audible voices at the beginning of _playingVoices, return their count
+    int selectAudibleVoices(int playingCount);
+    void closeFailedOutput();
+    void threadLoop();
+    bool isValidVoice(int voice) const { return voice >= 0 && voice < _config.maxVoices; }
+
+    Config _config;
+    std::unique_ptr<Voice[]> _voices;
+    std::vector<float> _mixBuffer;
+    /** Indices of the playing voices, reused by each buffer. */
+    std::vector<int> _playingVoices;
+    /** Priority and volume of the playing voices read once per buffer, the controlling thread may change them while they are sorted. */
+    struct VoiceKey
+    {
+        int priority;
+        float volume;
+        int voice;
+    };
+    std::vector<VoiceKey> _voiceKeys;
+    std::vector<int16_t> _outputBuffer;
+
+    MixerOutput* _output;
+    /** Null output opened by init, the mixer thread switches to it when _output fails. */
+    MixerOutput* _fallbackOutput;
+    /** Output which failed in the mixer thread, closed and deleted by the controlling thread. */
+    std::atomic<MixerOutput*> _failedOutput;
+    std::atomic<bool> _realtimePriorityDenied;
+    std::thread _thread;
+    std::atomic<bool> _running;
+
+    std::atomic<uint32_t> _lastMixTime;
+    std::atomic<uint32_t> _maxMixTime;
+    std::atomic<uint64_t> _totalMixTime;
+    std::atomic<uint64_t> _statsBufferCount;
+    std::atomic<uint64_t> _mixedBufferCount;
+    std::atomic<uint32_t> _underrunCount;
+    /** Underruns of the outputs replaced after a failure. */
+    uint32_t _previousUnderrunCount;
+    std::atomic<int> _virtualVoiceCount;
+};
+
+} // namespace experimental
+NS_CC_END
+
+#endif // __SOFTWARE_MIXER_H__
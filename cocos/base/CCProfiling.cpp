@@ -34,6 +34,7 @@ NS_CC_BEGIN
 bool kProfilerCategorySprite = false;
 bool kProfilerCategoryBatchSprite = false;
 bool kProfilerCategoryParticles = false;
+bool kProfilerCategoryAudio = false;
 
 
 static Profiler* g_sSharedProfiler = nullptr;
@@ -157,6 +157,7 @@ extern void CC_DLL ProfilingResetTimingBlock(const char *timerName);
 extern bool kProfilerCategorySprite;
 extern bool kProfilerCategoryBatchSprite;
 extern bool kProfilerCategoryParticles;
+extern bool kProfilerCategoryAudio;
 
 // end of global group
 /// @}
@@ -0,0 +1,155 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/CCWorkerPool.h"
+#include <algorithm>
+
+NS_CC_BEGIN
+
+WorkerPool* WorkerPool::s_workerPool = nullptr;
+
+WorkerPool* WorkerPool::getInstance()
+{
+    if (s_workerPool == nullptr)
+    {
+        s_workerPool = new (std::nothrow) WorkerPool();
+    }
+    return s_workerPool;
+}
+
+void WorkerPool::destroyInstance()
+{
+    delete s_workerPool;
+    s_workerPool = nullptr;
+}
+
+WorkerPool::WorkerPool(int workerCount)
+: _job(nullptr)
+, _count(0)
+, _grainSize(1)
+, _next(0)
+, _loopRunning(false)
+, _generation(0)
+, _runningWorkers(0)
+, _stop(false)
+{
+    if (workerCount < 0)
+    {
+        // hardware_concurrency may return 0 when it is unknown
+        workerCount = std::max((int)std::thread::hardware_concurrency() - 1, 0);
+    }
+    
+    _threads.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++i)
+    {
+        _threads.push_back(std::thread(&WorkerPool::threadLoop, this));
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _startCondition.notify_all();
+    for (auto& thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+void WorkerPool::parallelFor(int count, int grainSize, const RangeJob& job)
+{
+    if (count <= 0)
+        return;
+    grainSize = std::max(grainSize, 1);
+    
+    // a single range, no worker or a loop already running: no need to wake the workers
+    // the flag isn't a mutex, the thread running a loop may start a nested one from its iterations
+    bool loopRunning = false;
+    if (count <= grainSize || _threads.empty() || !_loopRunning.compare_exchange_strong(loopRunning, true))
+    {
+        job(0, count);
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _job = &job;
+        _count = count;
+        _grainSize = grainSize;
+        _next = 0;
+        _runningWorkers = (int)_threads.size();
+        ++_generation;
+    }
+    _startCondition.notify_all();
+    
+    runRanges();
+    
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _endCondition.wait(lock, [this]{ return _runningWorkers == 0; });
+        _job = nullptr;
+    }
+    _loopRunning.store(false);
+}
+
+void WorkerPool::runRanges()
+{
+    for (;;)
+    {
+        int begin = _next.fetch_add(_grainSize);
+        if (begin >= _count)
+            break;
+        (*_job)(begin, std::min(begin + _grainSize, _count));
+    }
+}
+
+void WorkerPool::threadLoop()
+{
+    unsigned int generation = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _startCondition.wait(lock, [&]{ return _stop || _generation != generation; });
+            if (_stop)
+                return;
+            generation = _generation;
+        }
+        
+        runRanges();
+        
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            last = --_runningWorkers == 0;
+        }
+        if (last)
+            _endCondition.notify_one();
+    }
+}
+
+NS_CC_END
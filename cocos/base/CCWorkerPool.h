@@ -0,0 +1,112 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCWORKER_POOL_H_
+#define __CCWORKER_POOL_H_
+
+#include "platform/CCPlatformMacros.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+* @addtogroup base
+* @{
+*/
+NS_CC_BEGIN
+
+/**
+ * @class WorkerPool
+ * @brief Threads splitting a loop between them, the calling thread waits for the end of the loop.
+ *
+ * Unlike AsyncTaskPool, the jobs are run synchronously: parallelFor returns once all the iterations are done,
+ * the calling thread takes its part of the iterations. The loops are run one at a time, a loop started while
+ * another one is running, for example from one of its iterations, is run by the calling thread alone.
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL WorkerPool
+{
+public:
+    typedef std::function<void(int begin, int end)> RangeJob;
+    
+    /**
+     * Returns the shared instance of the worker pool, it has one thread less than the hardware threads.
+     */
+    static WorkerPool* getInstance();
+    
+    /**
+     * Destroys the worker pool.
+     */
+    static void destroyInstance();
+    
+    /**
+     * Call job on ranges of [0, count) until all the range is done, from the workers and the calling thread.
+     *
+     * @param count number of iterations.
+     * @param grainSize number of iterations given to a thread at once, the ranges are smaller only at the end.
+     * @param job called with the first and past the last iteration of a range, from any thread.
+     */
+    void parallelFor(int count, int grainSize, const RangeJob& job);
+    
+    /** Number of threads of the pool, without the calling thread. */
+    int getWorkerCount() const { return (int)_threads.size(); }
+    
+CC_CONSTRUCTOR_ACCESS:
+    /** @param workerCount number of threads, the hardware threads minus one if it is negative. */
+    explicit WorkerPool(int workerCount = -1);
+    ~WorkerPool();
+    
+protected:
+    void threadLoop();
+    void runRanges();
+    
+    std::vector<std::thread> _threads;
+    
+    // the loop being run
+    const RangeJob* _job;
+    int _count;
+    int _grainSize;
+    std::atomic<int> _next;
+    
+    // synchronization
+    /** Set while a loop uses the workers, the loops started meanwhile, nested ones included, run serially. */
+    std::atomic<bool> _loopRunning;
+    std::mutex _mutex;
+    std::condition_variable _startCondition;
+    std::condition_variable _endCondition;
+    unsigned int _generation;
+    int _runningWorkers;
+    bool _stop;
+    
+    static WorkerPool* s_workerPool;
+};
+
+NS_CC_END
+// end group
+/// @}
+#endif //__CCWORKER_POOL_H_
@@ -25,10 +25,174 @@ THE SOFTWARE.
 #include "editor-support/cocostudio/ActionTimeline/CCTimeLine.h"
 #include "editor-support/cocostudio/ActionTimeline/CCActionTimeline.h"
 
+#include <algorithm>
+#include <typeinfo>
+
 USING_NS_CC;
 
 NS_TIMELINE_BEGIN
 
+static const int TRACK_SEGMENT_NONE = -2;
+
+// the subclasses of the frames may apply them differently, only the frames of these classes have a track
+static bool getTrackValue(TimelineTrack::Property property, Frame* frame, float* value)
+{
+    switch (property)
+    {
+        case TimelineTrack::Property::POSITION:
+        {
+            if (typeid(*frame) != typeid(PositionFrame))
+                return false;
+            auto positionFrame = static_cast<PositionFrame*>(frame);
+            value[0] = positionFrame->getX();
+            value[1] = positionFrame->getY();
+            return true;
+        }
+        case TimelineTrack::Property::SCALE:
+        {
+            if (typeid(*frame) != typeid(ScaleFrame))
+                return false;
+            auto scaleFrame = static_cast<ScaleFrame*>(frame);
+            value[0] = scaleFrame->getScaleX();
+            value[1] = scaleFrame->getScaleY();
+            return true;
+        }
+        case TimelineTrack::Property::ROTATION:
+        {
+            if (typeid(*frame) != typeid(RotationFrame))
+                return false;
+            value[0] = static_cast<RotationFrame*>(frame)->getRotation();
+            return true;
+        }
+        case TimelineTrack::Property::SKEW:
+        case TimelineTrack::Property::ROTATION_SKEW:
+        {
+            if (typeid(*frame) != (property == TimelineTrack::Property::SKEW ? typeid(SkewFrame) : typeid(RotationSkewFrame)))
+                return false;
+            auto skewFrame = static_cast<SkewFrame*>(frame);
+            value[0] = skewFrame->getSkewX();
+            value[1] = skewFrame->getSkewY();
+            return true;
+        }
+        case TimelineTrack::Property::ANCHOR_POINT:
+        {
+            if (typeid(*frame) != typeid(AnchorPointFrame))
+                return false;
+            auto anchorPoint = static_cast<AnchorPointFrame*>(frame)->getAnchorPoint();
+            value[0] = anchorPoint.x;
+            value[1] = anchorPoint.y;
+            return true;
+        }
+        case TimelineTrack::Property::COLOR:
+        {
+            if (typeid(*frame) != typeid(ColorFrame))
+                return false;
+            auto color = static_cast<ColorFrame*>(frame)->getColor();
+            value[0] = color.r;
+            value[1] = color.g;
+            value[2] = color.b;
+            return true;
+        }
+        case TimelineTrack::Property::ALPHA:
+        {
+            if (typeid(*frame) != typeid(AlphaFrame))
+                return false;
+            value[0] = static_cast<AlphaFrame*>(frame)->getAlpha();
+            return true;
+        }
+    }
+    return false;
+}
+
+// TimelineTrack
+std::shared_ptr<TimelineTrack> TimelineTrack::create(const Vector<Frame*>& frames)
+{
+    if (frames.empty())
+        return nullptr;
+
+    auto track = std::make_shared<TimelineTrack>();
+
+    const std::type_info& type = typeid(*frames.at(0));
+    if (type == typeid(PositionFrame))
+    {
+        track->property = Property::POSITION;
+        track->components = 2;
+    }
+    else if (type == typeid(ScaleFrame))
+    {
+        track->property = Property::SCALE;
+        track->components = 2;
+    }
+    else if (type == typeid(RotationFrame))
+    {
+        track->property = Property::ROTATION;
+        track->components = 1;
+    }
+    else if (type == typeid(SkewFrame))
+    {
+        track->property = Property::SKEW;
+        track->components = 2;
+    }
+    else if (type == typeid(RotationSkewFrame))
+    {
+        track->property = Property::ROTATION_SKEW;
+        track->components = 2;
+    }
+    else if (type == typeid(AnchorPointFrame))
+    {
+        track->property = Property::ANCHOR_POINT;
+        track->components = 2;
+    }
+    else if (type == typeid(ColorFrame))
+    {
+        track->property = Property::COLOR;
+        track->components = 3;
+    }
+    else if (type == typeid(AlphaFrame))
+    {
+        track->property = Property::ALPHA;
+        track->components = 1;
+    }
+    else
+    {
+        return nullptr;
+    }
+
+    size_t count = frames.size();
+    track->frameIndices.reserve(count);
+    track->values.reserve(count * track->components);
+    track->tweenTypes.reserve(count);
+    for (auto frame : frames)
+    {
+        float value[3];
+        if (!getTrackValue(track->property, frame, value))
+            return nullptr;
+
+        // the key frames out of order keep the search of the frames
+        if (!track->frameIndices.empty() && frame->getFrameIndex() < track->frameIndices.back())
+            return nullptr;
+
+        track->frameIndices.push_back(frame->getFrameIndex());
+        track->values.insert(track->values.end(), value, value + track->components);
+        track->tweenTypes.push_back(frame->getTweenType());
+        track->frames.pushBack(frame->clone());
+    }
+
+    // a segment is constant if its key frame doesn't tween or the next one has the same values
+    track->tweens.resize(count, 0);
+    for (size_t i = 0; i + 1 < count; ++i)
+    {
+        if (!frames.at(i)->isTween())
+            continue;
+
+        const float* from = &track->values[i * track->components];
+        const float* to = from + track->components;
+        track->tweens[i] = !std::equal(from, to, to);
+    }
+
+    return track;
+}
+
 Timeline* Timeline::create()
 {
     Timeline* object = new (std::nothrow) Timeline();
@@ -50,6 +214,7 @@ Timeline::Timeline()
     , _actionTag(0)
     , _ActionTimeline(nullptr)
     , _node(nullptr)
+    , _trackSegment(TRACK_SEGMENT_NONE)
 {
 }
 
@@ -60,7 +225,11 @@ Timeline::~Timeline()
 void Timeline::gotoFrame(int frameIndex)
 {
     if(_frames.size() == 0)
+    {
+        if (_track)
+            updateTrack(frameIndex);
         return;
+    }
 
     binarySearchKeyFrame(frameIndex);
     apply(frameIndex);
@@ -69,7 +238,11 @@ void Timeline::gotoFrame(int frameIndex)
 void Timeline::stepToFrame(int frameIndex)
 {
     if(_frames.size() == 0)
+    {
+        if (_track)
+            updateTrack(frameIndex);
         return;
+    }
 
     updateCurrentKeyFrame(frameIndex);
     apply(frameIndex);
@@ -80,6 +253,18 @@ Timeline* Timeline::clone()
     Timeline* timeline = Timeline::create();
     timeline->_actionTag = _actionTag;
 
+    if (!_track)
+    {
+        _track = TimelineTrack::create(_frames);
+    }
+
+    if (_track)
+    {
+        // the clone only creates its frames if they are asked for
+        timeline->_track = _track;
+        return timeline;
+    }
+
     for (auto frame : _frames)
     {
         Frame* newFrame = frame->clone();
@@ -89,26 +274,64 @@ Timeline* Timeline::clone()
     return timeline;
 }
 
+const Vector<Frame*>& Timeline::getFrames() const
+{
+    return _track ? _track->frames : _frames;
+}
+
+const Vector<Frame*>& Timeline::getFrames()
+{
+    detachTrack();
+    return _frames;
+}
+
 void Timeline::addFrame(Frame* frame)
 {
+    detachTrack();
     _frames.pushBack(frame);
     frame->setTimeline(this);
 }
 
 void Timeline::insertFrame(Frame* frame, int index)
 {
+    detachTrack();
     _frames.insert(index, frame);
     frame->setTimeline(this);
 }
 
 void Timeline::removeFrame(Frame* frame)
 {
+    detachTrack();
     _frames.eraseObject(frame);
     frame->setTimeline(nullptr);
 }
 
+void Timeline::detachTrack()
+{
+    if (!_track)
+        return;
+
+    if (_frames.empty())
+    {
+        for (auto frame : _track->frames)
+        {
+            Frame* newFrame = frame->clone();
+            _frames.pushBack(newFrame);
+            newFrame->setTimeline(this);
+            newFrame->setNode(_node);
+        }
+    }
+
+    _track.reset();
+    _trackSegment = TRACK_SEGMENT_NONE;
+}
+
 void Timeline::setNode(Node* node)
 {
+    _node = node;
+    // the property of the new node is set from the segment of the next frame
+    _trackSegment = TRACK_SEGMENT_NONE;
+
     for (auto frame : _frames)
     {
         frame->setNode(node);
@@ -268,4 +491,98 @@ void Timeline::updateCurrentKeyFrame(unsigned int frameIndex)
     }
 }
 
+void Timeline::updateTrack(unsigned int frameIndex)
+{
+    const TimelineTrack& track = *_track;
+    const auto& frameIndices = track.frameIndices;
+    int last = (int)frameIndices.size() - 1;
+
+    // -1 before the first key frame, last from the last key frame
+    auto containsFrame = [&frameIndices, last, frameIndex](int segment) {
+        if (segment < -1 || segment > last)
+            return false;
+        if (segment >= 0 && frameIndex < frameIndices[segment])
+            return false;
+        return segment == last || frameIndex < frameIndices[segment + 1];
+    };
+
+    // playing stays in the segment or enters the next one, the others are searched
+    int segment = _trackSegment;
+    if (!containsFrame(segment))
+    {
+        if (segment != TRACK_SEGMENT_NONE && containsFrame(segment + 1))
+        {
+            segment = segment + 1;
+        }
+        else
+        {
+            segment = (int)(std::upper_bound(frameIndices.begin(), frameIndices.end(), frameIndex) - frameIndices.begin()) - 1;
+        }
+    }
+
+    if (segment != _trackSegment)
+    {
+        _trackSegment = segment;
+        if (_node)
+        {
+            setTrackValue(&track.values[std::max(segment, 0) * track.components]);
+        }
+    }
+
+    // the constant segments were set when they were entered
+    if (segment < 0 || segment >= last || !track.tweens[segment] || _node == nullptr)
+        return;
+
+    float percent = (frameIndex - frameIndices[segment]) / (float)(frameIndices[segment + 1] - frameIndices[segment]);
+    auto tweenType = track.tweenTypes[segment];
+    if (tweenType != tweenfunc::TWEEN_EASING_MAX && tweenType != tweenfunc::Linear)
+    {
+        auto& easingParams = track.frames.at(segment)->getEasingParams();
+        percent = tweenfunc::tweenTo(percent, tweenType, const_cast<float*>(easingParams.data()));
+    }
+
+    const float* from = &track.values[segment * track.components];
+    const float* to = from + track.components;
+    float value[3];
+    for (int i = 0; i < track.components; ++i)
+    {
+        value[i] = from[i] + (to[i] - from[i]) * percent;
+    }
+    setTrackValue(value);
+}
+
+void Timeline::setTrackValue(const float* value)
+{
+    switch (_track->property)
+    {
+        case TimelineTrack::Property::POSITION:
+            _node->setPosition(Vec2(value[0], value[1]));
+            break;
+        case TimelineTrack::Property::SCALE:
+            _node->setScaleX(value[0]);
+            _node->setScaleY(value[1]);
+            break;
+        case TimelineTrack::Property::ROTATION:
+            _node->setRotation(value[0]);
+            break;
+        case TimelineTrack::Property::SKEW:
+            _node->setSkewX(value[0]);
+            _node->setSkewY(value[1]);
+            break;
+        case TimelineTrack::Property::ROTATION_SKEW:
+            _node->setRotationSkewX(value[0]);
+            _node->setRotationSkewY(value[1]);
+            break;
+        case TimelineTrack::Property::ANCHOR_POINT:
+            _node->setAnchorPoint(Vec2(value[0], value[1]));
+            break;
+        case TimelineTrack::Property::COLOR:
+            _node->setColor(Color3B((GLubyte)value[0], (GLubyte)value[1], (GLubyte)value[2]));
+            break;
+        case TimelineTrack::Property::ALPHA:
+            _node->setOpacity((GLubyte)value[0]);
+            break;
+    }
+}
+
 NS_TIMELINE_END
@@ -25,6 +25,8 @@ THE SOFTWARE.
 #ifndef __CCTIMELINE_H__
 #define __CCTIMELINE_H__
 
+#include <memory>
+
 #include "editor-support/cocostudio/ActionTimeline/CCFrame.h"
 #include "editor-support/cocostudio/ActionTimeline/CCTimelineMacro.h"
 #include "editor-support/cocostudio/CocosStudioExport.h"
@@ -33,6 +35,41 @@ NS_TIMELINE_BEGIN
 
 class ActionTimeline;
 
+/**
+ * The key frames of a timeline animating a property of its node, in arrays shared by the clones
+ * of the timeline. The timelines of position, scale, rotation, skew, anchor point, color and alpha
+ * frames have one, not the subclasses of these frames.
+ */
+class CC_STUDIO_DLL TimelineTrack
+{
+public:
+    enum class Property
+    {
+        POSITION,
+        SCALE,
+        ROTATION,
+        SKEW,
+        ROTATION_SKEW,
+        ANCHOR_POINT,
+        COLOR,
+        ALPHA
+    };
+
+    /** Return nullptr if the frames have no track. */
+    static std::shared_ptr<TimelineTrack> create(const cocos2d::Vector<Frame*>& frames);
+
+    Property property;
+    /** Number of values of a key frame. */
+    int components;
+    std::vector<unsigned int> frameIndices;
+    std::vector<float> values;
+    /** Whether the property changes between a key frame and the next one. */
+    std::vector<char> tweens;
+    std::vector<cocos2d::tweenfunc::TweenType> tweenTypes;
+    /** Copies of the key frames, for their easing parameters and the frames of the clones. */
+    cocos2d::Vector<Frame*> frames;
+};
+
 class CC_STUDIO_DLL Timeline : public cocos2d::Ref
 {
 public:
@@ -44,7 +81,13 @@ public:
     virtual void gotoFrame(int frameIndex);
     virtual void stepToFrame(int frameIndex);
 
-    virtual const cocos2d::Vector<Frame*>& getFrames() const { return _frames; }
+    /** The key frames, those shared with the timeline it was cloned from if it wasn't detached, they must not be modified. */
+    virtual const cocos2d::Vector<Frame*>& getFrames() const;
+    /** The key frames of this timeline, they are created by detachTrack if it shares them. */
+    virtual const cocos2d::Vector<Frame*>& getFrames();
+
+    /** Create the key frames of a timeline cloned with the key frames of another one, so they can be modified. */
+    void detachTrack();
 
     virtual void addFrame(Frame* frame);
     virtual void insertFrame(Frame* frame, int index);
@@ -67,6 +110,10 @@ protected:
     virtual void binarySearchKeyFrame (unsigned int frameIndex);
     virtual void updateCurrentKeyFrame(unsigned int frameIndex);
 
+    // find the segment of frameIndex in the track and set the property when it changes
+    void updateTrack(unsigned int frameIndex);
+    void setTrackValue(const float* value);
+
     cocos2d::Vector<Frame*> _frames;
     Frame* _currentKeyFrame;
     unsigned int _currentKeyFrameIndex;
@@ -78,6 +125,11 @@ protected:
 
     ActionTimeline*  _ActionTimeline;
     cocos2d::Node* _node;
+
+    /** The key frames shared with the timeline it was cloned from, used while _frames is empty. */
+    std::shared_ptr<const TimelineTrack> _track;
+    /** Key frame of the track the property was set from, -1 before the first key frame. */
+    int _trackSegment;
 };
 
 NS_TIMELINE_END
@@ -26,12 +26,14 @@
 
 #include "base/ObjectFactory.h"
 #include "base/CCDirector.h"
+#include "base/CCAsyncTaskPool.h"
 #include "base/ccUTF8.h"
 #include "ui/CocosGUI.h"
 #include "2d/CCSpriteFrameCache.h"
 #include "2d/CCParticleSystemQuad.h"
 #include "2d/CCTMXTiledMap.h"
 #include "platform/CCFileUtils.h"
+#include "renderer/CCTextureCache.h"
 
 #include "editor-support/cocostudio/ActionTimeline/CCActionTimelineCache.h"
 #include "editor-support/cocostudio/ActionTimeline/CCActionTimeline.h"
@@ -83,6 +85,7 @@
 #include "editor-support/cocostudio/WidgetCallBackHandlerProtocol.h"
 
 #include <fstream>
+#include <chrono>
 
 using namespace cocos2d::ui;
 using namespace cocostudio;
@@ -174,6 +177,107 @@ static const char* MONO_COCOS2D_VERSION     = "cocos2dVersion";
 // CSLoader
 static CSLoader* _sharedCSLoader = nullptr;
 
+// A node of a csb file with its reader already looked up
+struct CSLoader::NodePrototype
+{
+    enum class Type
+    {
+        READER,
+        PROJECT_NODE,
+        AUDIO
+    };
+
+    Type type;
+    const flatbuffers::NodeTree* nodeTree;
+    NodeReaderProtocol* reader;
+    // the file of a project node, null if it doesn't exist
+    std::shared_ptr<FilePrototype> project;
+    std::vector<NodePrototype> children;
+};
+
+// A parsed csb file, the node trees point into its data
+struct CSLoader::FilePrototype
+{
+    FilePrototype() : timeline(nullptr) {}
+    ~FilePrototype() { CC_SAFE_RELEASE(timeline); }
+
+    Data data;
+    std::vector<std::string> textures;
+    NodePrototype root;
+    // cloned for the project nodes of the file
+    ActionTimeline* timeline;
+};
+
+// The files used by the nodes of csb files, found by the workers of createNodeAsync
+struct AsyncResourceFiles
+{
+    std::vector<std::string> spriteFiles;
+    std::vector<std::string> images;
+    // the nested csb files of the project nodes
+    std::vector<std::string> projectFiles;
+    std::vector<std::string> particleFiles;
+    std::vector<std::string> fontFiles;
+    std::vector<std::string> mapFiles;
+};
+
+// A csb file loaded by createNodeAsync, only the file data is shared with the workers
+struct CSLoader::AsyncNodeLoad
+{
+    enum class State
+    {
+        READING_FILE,
+        READING_SPRITE_FILES,
+        LOADING_TEXTURES,
+        INSTANTIATING
+    };
+
+    // filled by the workers, read on the cocos thread once they are done
+    struct FileData
+    {
+        // the csb files read by the current worker, the file of the load is read first on its own
+        std::vector<std::string> csbFiles;
+        std::vector<std::string> csbFullPaths;
+        // the data of the csb files read so far, by file name
+        std::unordered_map<std::string, Data> csbData;
+        AsyncResourceFiles resources;
+        // the plist files not loaded yet, the particle, font and map files
+        std::vector<std::string> spriteFileFullPaths;
+        std::vector<std::string> particleFullPaths;
+        std::vector<std::string> fontFullPaths;
+        std::vector<std::string> mapFullPaths;
+        // the textures used by these files
+        std::vector<std::string> textures;
+    };
+
+    // a node whose children are being created, retained until it is added to its parent
+    struct Frame
+    {
+        const NodePrototype* prototype;
+        Node* node;
+        size_t nextChild;
+    };
+
+    AsyncNodeLoad() : id(0), state(State::READING_FILE), pendingTextures(0), started(false), root(nullptr), callbackHandler(nullptr) {}
+
+    int id;
+    State state;
+    std::string filename;
+    std::function<void(Node*)> callback;
+    ccNodeLoadCallback nodeCallback;
+    std::shared_ptr<FileData> file;
+    int pendingTextures;
+    std::shared_ptr<FilePrototype> prototype;
+    bool started;
+    std::vector<Frame> frames;
+    // retained once the tree is complete
+    Node* root;
+    // _rootNode and _callbackHandlers while the nodes of the load are created
+    Node* callbackHandler;
+    cocos2d::Vector<Node*> callbackHandlers;
+};
+
+static int s_asyncNodeLoadId = 0;
+
 CSLoader* CSLoader::getInstance()
 {
     if (! _sharedCSLoader)
@@ -197,6 +301,7 @@ CSLoader::CSLoader()
 , _monoCocos2dxVersion("")
 , _rootNode(nullptr)
 , _csBuildID("2.1.0.0")
+, _asyncTimeSlice(0.004f)
 {
     CREATE_CLASS_NODE_READER_INFO(NodeReader);
     CREATE_CLASS_NODE_READER_INFO(SingleNodeReader);
@@ -231,6 +336,23 @@ CSLoader::CSLoader()
     CREATE_CLASS_NODE_READER_INFO(SkeletonNodeReader);
 }
 
+CSLoader::~CSLoader()
+{
+    if (_asyncLoads.empty())
+        return;
+
+    // the pending worker and texture callbacks find no load and do nothing
+    for (const auto& load : _asyncLoads)
+    {
+        for (const auto& frame : load->frames)
+        {
+            frame.node->release();
+        }
+    }
+    _asyncLoads.clear();
+    Director::getInstance()->getScheduler()->unschedule("CSLoaderAsyncLoads", this);
+}
+
 void CSLoader::purge()
 {
 }
@@ -916,6 +1038,14 @@ Node* CSLoader::createNodeWithFlatBuffersFile(const std::string &filename)
 
 Node* CSLoader::createNodeWithFlatBuffersFile(const std::string &filename, const ccNodeLoadCallback &callback)
 {
+    auto prototypeIter = _prototypes.find(filename);
+    if (prototypeIter != _prototypes.end())
+    {
+        // kept alive even if the callback removes the prototype
+        auto prototype = prototypeIter->second;
+        return nodeWithPrototype(*prototype, callback);
+    }
+
     Node* node = nodeWithFlatBuffersFile(filename, callback);
 
     reconstructNestNode(node);
@@ -1020,7 +1150,19 @@ Node* CSLoader::nodeWithFlatBuffers(const flatbuffers::NodeTree *nodetree, const
             std::string filePath = projectNodeOptions->fileName()->c_str();
             
             cocostudio::timeline::ActionTimeline* action = nullptr;
-            if (filePath != "" && FileUtils::getInstance()->isFileExist(filePath))
+            auto prototypeIter = _prototypes.find(filePath);
+            if (prototypeIter != _prototypes.end())
+            {
+                auto prototype = prototypeIter->second;
+                node = nodeWithPrototype(*prototype, callback);
+                if (!prototype->timeline)
+                {
+                    prototype->timeline = createTimeline(prototype->data, filePath);
+                    CC_SAFE_RETAIN(prototype->timeline);
+                }
+                action = prototype->timeline ? prototype->timeline->clone() : nullptr;
+            }
+            else if (filePath != "" && FileUtils::getInstance()->isFileExist(filePath))
             {
                 Data buf = FileUtils::getInstance()->getDataFromFile(filePath);
                 node = createNode(buf, callback);
@@ -1066,23 +1208,7 @@ Node* CSLoader::nodeWithFlatBuffers(const flatbuffers::NodeTree *nodetree, const
                 node = reader->createNodeWithFlatBuffers(options->data());
             }
             
-            Widget* widget = dynamic_cast<Widget*>(node);
-            if (widget)
-            {
-                std::string callbackName = widget->getCallbackName();
-                std::string callbackType = widget->getCallbackType();
-                
-                bindCallback(callbackName, callbackType, widget, _rootNode);
-            }
-            
-            /* To reconstruct nest node as WidgetCallBackHandlerProtocol. */
-            auto callbackHandler = dynamic_cast<WidgetCallBackHandlerProtocol *>(node);
-            if (callbackHandler)
-            {
-                _callbackHandlers.pushBack(node);
-                _rootNode = _callbackHandlers.back();
-            }
-            /**/
+            bindNodeCallbacks(node);
             //        _loadingNodeParentHierarchy.push_back(node);
         }
         
@@ -1100,28 +1226,7 @@ Node* CSLoader::nodeWithFlatBuffers(const flatbuffers::NodeTree *nodetree, const
             Node* child = nodeWithFlatBuffers(subNodeTree, callback);
             if (child)
             {
-                PageView* pageView = dynamic_cast<PageView*>(node);
-                ListView* listView = dynamic_cast<ListView*>(node);
-                if (pageView)
-                {
-                    Layout* layout = dynamic_cast<Layout*>(child);
-                    if (layout)
-                    {
-                        pageView->addPage(layout);
-                    }
-                }
-                else if (listView)
-                {
-                    Widget* widget = dynamic_cast<Widget*>(child);
-                    if (widget)
-                    {
-                        listView->pushBackCustomItem(widget);
-                    }
-                }
-                else
-                {
-                    node->addChild(child);
-                }
+                addLoadedChild(node, child);
                 
                 if (callback)
                 {
@@ -1136,6 +1241,905 @@ Node* CSLoader::nodeWithFlatBuffers(const flatbuffers::NodeTree *nodetree, const
     }
 }
 
+void CSLoader::bindNodeCallbacks(Node* node)
+{
+    Widget* widget = dynamic_cast<Widget*>(node);
+    if (widget)
+    {
+        std::string callbackName = widget->getCallbackName();
+        std::string callbackType = widget->getCallbackType();
+        
+        bindCallback(callbackName, callbackType, widget, _rootNode);
+    }
+    
+    /* To reconstruct nest node as WidgetCallBackHandlerProtocol. */
+    auto callbackHandler = dynamic_cast<WidgetCallBackHandlerProtocol *>(node);
+    if (callbackHandler)
+    {
+        _callbackHandlers.pushBack(node);
+        _rootNode = _callbackHandlers.back();
+    }
+}
+
+void CSLoader::addLoadedChild(Node* parent, Node* child)
+{
+    PageView* pageView = dynamic_cast<PageView*>(parent);
+    ListView* listView = dynamic_cast<ListView*>(parent);
+    if (pageView)
+    {
+        Layout* layout = dynamic_cast<Layout*>(child);
+        if (layout)
+        {
+            pageView->addPage(layout);
+        }
+    }
+    else if (listView)
+    {
+        Widget* widget = dynamic_cast<Widget*>(child);
+        if (widget)
+        {
+            listView->pushBackCustomItem(widget);
+        }
+    }
+    else
+    {
+        parent->addChild(child);
+    }
+}
+
+void CSLoader::prewarmPrototypes(const std::vector<std::string>& filenames)
+{
+    for (const auto& filename : filenames)
+    {
+        if (getExtentionName(filename) == "csb")
+        {
+            getPrototype(filename);
+        }
+        else
+        {
+            CCLOG("CSLoader::prewarmPrototypes - only the csb files have prototypes: %s", filename.c_str());
+        }
+    }
+}
+
+bool CSLoader::addPrototype(const std::string& filename, const Data& data)
+{
+    if (data.isNull())
+    {
+        return false;
+    }
+
+    _prototypes[filename] = createPrototype(filename, data);
+    return true;
+}
+
+bool CSLoader::hasPrototype(const std::string& filename) const
+{
+    return _prototypes.find(filename) != _prototypes.end();
+}
+
+void CSLoader::removePrototype(const std::string& filename)
+{
+    _prototypes.erase(filename);
+}
+
+void CSLoader::removeAllPrototypes()
+{
+    _prototypes.clear();
+}
+
+std::shared_ptr<CSLoader::FilePrototype> CSLoader::getPrototype(const std::string& filename)
+{
+    auto prototypeIter = _prototypes.find(filename);
+    if (prototypeIter != _prototypes.end())
+    {
+        return prototypeIter->second;
+    }
+
+    Data buf;
+    auto dataIter = _asyncCsbData.find(filename);
+    if (dataIter != _asyncCsbData.end())
+    {
+        buf = dataIter->second;
+    }
+    else
+    {
+        std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
+        buf = FileUtils::getInstance()->getDataFromFile(fullPath);
+    }
+    if (buf.isNull())
+    {
+        CCLOG("CSLoader::getPrototype - failed read file: %s", filename.c_str());
+        return nullptr;
+    }
+
+    auto prototype = createPrototype(filename, buf);
+    _prototypes[filename] = prototype;
+    return prototype;
+}
+
+std::shared_ptr<CSLoader::FilePrototype> CSLoader::createPrototype(const std::string& filename, const Data& data)
+{
+    auto prototype = std::make_shared<FilePrototype>();
+    prototype->data = data;
+
+    auto csparsebinary = GetCSParseBinary(prototype->data.getBytes());
+    auto csBuildId = csparsebinary->version();
+    if (csBuildId && strcmp(_csBuildID.c_str(), csBuildId->c_str()) != 0)
+    {
+        CCLOG("CSLoader::createPrototype - the reader build id of %s is %s, the one of the Cocos2d-x reader is %s",
+              filename.c_str(), csBuildId->c_str(), _csBuildID.c_str());
+    }
+
+    auto textures = csparsebinary->textures();
+    int textureSize = textures->size();
+    for (int i = 0; i < textureSize; ++i)
+    {
+        std::string texture = textures->Get(i)->c_str();
+        SpriteFrameCache::getInstance()->addSpriteFramesWithFile(texture);
+        prototype->textures.push_back(texture);
+    }
+
+    initNodePrototype(prototype->root, csparsebinary->nodeTree());
+
+    return prototype;
+}
+
+void CSLoader::initNodePrototype(NodePrototype& prototype, const flatbuffers::NodeTree* nodetree)
+{
+    prototype.type = NodePrototype::Type::READER;
+    prototype.nodeTree = nodetree;
+    prototype.reader = nullptr;
+
+    if (nodetree == nullptr)
+        return;
+
+    std::string classname = nodetree->classname()->c_str();
+    if (classname == "ProjectNode")
+    {
+        prototype.type = NodePrototype::Type::PROJECT_NODE;
+
+        auto projectNodeOptions = (ProjectNodeOptions*)nodetree->options()->data();
+        std::string filePath = projectNodeOptions->fileName()->c_str();
+        if (filePath != "" && FileUtils::getInstance()->isFileExist(filePath))
+        {
+            prototype.project = getPrototype(filePath);
+            if (prototype.project && !prototype.project->timeline)
+            {
+                prototype.project->timeline = createTimeline(prototype.project->data, filePath);
+                CC_SAFE_RETAIN(prototype.project->timeline);
+            }
+        }
+    }
+    else if (classname == "SimpleAudio")
+    {
+        prototype.type = NodePrototype::Type::AUDIO;
+    }
+    else
+    {
+        std::string customClassName = nodetree->customClassName()->c_str();
+        if (customClassName != "")
+        {
+            classname = customClassName;
+        }
+        std::string readername = getGUIClassName(classname);
+        readername.append("Reader");
+
+        prototype.reader = dynamic_cast<NodeReaderProtocol*>(ObjectFactory::getInstance()->createObject(readername));
+    }
+
+    auto children = nodetree->children();
+    int size = children->size();
+    prototype.children.resize(size);
+    for (int i = 0; i < size; ++i)
+    {
+        initNodePrototype(prototype.children[i], children->Get(i));
+    }
+}
+
+void CSLoader::addPrototypeSpriteFrames(const FilePrototype& prototype)
+{
+    // the sprite frames may have been removed since the file was parsed
+    auto spriteFrameCache = SpriteFrameCache::getInstance();
+    for (const auto& texture : prototype.textures)
+    {
+        if (!spriteFrameCache->isSpriteFramesWithFileLoaded(texture))
+        {
+            spriteFrameCache->addSpriteFramesWithFile(texture);
+        }
+    }
+}
+
+Node* CSLoader::nodeWithPrototype(const FilePrototype& prototype, const ccNodeLoadCallback& callback)
+{
+    addPrototypeSpriteFrames(prototype);
+
+    Node* node = nodeWithPrototype(prototype.root, callback);
+
+    reconstructNestNode(node);
+
+    return node;
+}
+
+Node* CSLoader::nodeWithPrototype(const NodePrototype& prototype, const ccNodeLoadCallback& callback)
+{
+    Node* node = createNodeWithPrototype(prototype, callback);
+
+    // If node is invalid, there is no necessity to process children of node.
+    if (!node)
+    {
+        return nullptr;
+    }
+
+    for (const auto& childPrototype : prototype.children)
+    {
+        Node* child = nodeWithPrototype(childPrototype, callback);
+        if (child)
+        {
+            addLoadedChild(node, child);
+
+            if (callback)
+            {
+                callback(child);
+            }
+        }
+    }
+
+    return node;
+}
+
+Node* CSLoader::createNodeWithPrototype(const NodePrototype& prototype, const ccNodeLoadCallback& callback)
+{
+    if (prototype.nodeTree == nullptr)
+        return nullptr;
+
+    Node* node = nullptr;
+    auto options = prototype.nodeTree->options();
+
+    switch (prototype.type)
+    {
+        case NodePrototype::Type::PROJECT_NODE:
+        {
+            auto projectNodeOptions = (ProjectNodeOptions*)options->data();
+
+            ActionTimeline* action = nullptr;
+            if (prototype.project)
+            {
+                node = nodeWithPrototype(*prototype.project, callback);
+                action = prototype.project->timeline ? prototype.project->timeline->clone() : nullptr;
+            }
+            else
+            {
+                node = Node::create();
+            }
+            ProjectNodeReader::getInstance()->setPropsWithFlatBuffers(node, options->data());
+            if (action)
+            {
+                action->setTimeSpeed(projectNodeOptions->innerActionSpeed());
+                node->runAction(action);
+                action->gotoFrameAndPause(0);
+            }
+            break;
+        }
+        case NodePrototype::Type::AUDIO:
+        {
+            node = Node::create();
+            auto reader = ComAudioReader::getInstance();
+            Component* component = reader->createComAudioWithFlatBuffers(options->data());
+            if (component)
+            {
+                component->setName(PlayableFrame::PLAYABLE_EXTENTION);
+                node->addComponent(component);
+                reader->setPropsWithFlatBuffers(node, options->data());
+            }
+            break;
+        }
+        default:
+        {
+            if (prototype.reader)
+            {
+                node = prototype.reader->createNodeWithFlatBuffers(options->data());
+            }
+            bindNodeCallbacks(node);
+            break;
+        }
+    }
+
+    return node;
+}
+
+static void addResourceFile(const flatbuffers::ResourceData* resourceData, AsyncResourceFiles& files)
+{
+    if (resourceData == nullptr || resourceData->path() == nullptr)
+        return;
+
+    std::string path = resourceData->path()->c_str();
+    if (path.empty())
+        return;
+
+    switch (resourceData->resourceType())
+    {
+        case 0:
+            files.images.push_back(path);
+            break;
+
+        case 1:
+            if (resourceData->plistFile() && resourceData->plistFile()->size() > 0)
+            {
+                files.spriteFiles.push_back(resourceData->plistFile()->c_str());
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+// the particle, font and map files are only read from the file system
+static void addDescriptionFile(const flatbuffers::ResourceData* resourceData, std::vector<std::string>& files)
+{
+    if (resourceData == nullptr || resourceData->path() == nullptr || resourceData->resourceType() != 0)
+        return;
+
+    std::string path = resourceData->path()->c_str();
+    if (!path.empty())
+    {
+        files.push_back(path);
+    }
+}
+
+// Collect the files used by the nodes of a tree
+static void collectResourceFiles(const flatbuffers::NodeTree* nodetree, AsyncResourceFiles& files)
+{
+    if (nodetree == nullptr || nodetree->classname() == nullptr)
+        return;
+
+    std::string classname = nodetree->classname()->c_str();
+    auto data = nodetree->options() ? nodetree->options()->data() : nullptr;
+    if (data)
+    {
+        if (classname == "Sprite")
+        {
+            addResourceFile(((SpriteOptions*)data)->fileNameData(), files);
+        }
+        else if (classname == "ImageView")
+        {
+            addResourceFile(((ImageViewOptions*)data)->fileNameData(), files);
+        }
+        else if (classname == "Button")
+        {
+            auto options = (ButtonOptions*)data;
+            addResourceFile(options->normalData(), files);
+            addResourceFile(options->pressedData(), files);
+            addResourceFile(options->disabledData(), files);
+        }
+        else if (classname == "CheckBox")
+        {
+            auto options = (CheckBoxOptions*)data;
+            addResourceFile(options->backGroundBoxData(), files);
+            addResourceFile(options->backGroundBoxSelectedData(), files);
+            addResourceFile(options->frontCrossData(), files);
+            addResourceFile(options->backGroundBoxDisabledData(), files);
+            addResourceFile(options->frontCrossDisabledData(), files);
+        }
+        else if (classname == "Slider")
+        {
+            auto options = (SliderOptions*)data;
+            addResourceFile(options->barFileNameData(), files);
+            addResourceFile(options->ballNormalData(), files);
+            addResourceFile(options->ballPressedData(), files);
+            addResourceFile(options->ballDisabledData(), files);
+            addResourceFile(options->progressBarData(), files);
+        }
+        else if (classname == "LoadingBar")
+        {
+            addResourceFile(((LoadingBarOptions*)data)->textureData(), files);
+        }
+        else if (classname == "Panel")
+        {
+            addResourceFile(((PanelOptions*)data)->backGroundImageData(), files);
+        }
+        else if (classname == "ScrollView")
+        {
+            addResourceFile(((ScrollViewOptions*)data)->backGroundImageData(), files);
+        }
+        else if (classname == "PageView")
+        {
+            addResourceFile(((PageViewOptions*)data)->backGroundImageData(), files);
+        }
+        else if (classname == "ListView")
+        {
+            addResourceFile(((ListViewOptions*)data)->backGroundImageData(), files);
+        }
+        else if (classname == "TextAtlas")
+        {
+            addResourceFile(((TextAtlasOptions*)data)->charMapFileData(), files);
+        }
+        else if (classname == "Particle")
+        {
+            addDescriptionFile(((ParticleSystemOptions*)data)->fileNameData(), files.particleFiles);
+        }
+        else if (classname == "TextBMFont")
+        {
+            addDescriptionFile(((TextBMFontOptions*)data)->fileNameData(), files.fontFiles);
+        }
+        else if (classname == "GameMap")
+        {
+            addDescriptionFile(((GameMapOptions*)data)->fileNameData(), files.mapFiles);
+        }
+        else if (classname == "ProjectNode")
+        {
+            auto fileName = ((ProjectNodeOptions*)data)->fileName();
+            if (fileName && fileName->size() > 0)
+            {
+                files.projectFiles.push_back(fileName->c_str());
+            }
+        }
+    }
+
+    auto children = nodetree->children();
+    if (children)
+    {
+        int size = children->size();
+        for (int i = 0; i < size; ++i)
+        {
+            collectResourceFiles(children->Get(i), files);
+        }
+    }
+}
+
+static void removeDuplicates(std::vector<std::string>& files)
+{
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+}
+
+// Find the values of an attribute in the elements of a text file, without parsing the whole file
+static void findAttributeValues(const std::string& content, const std::string& elementStart, char elementEnd,
+                                const std::string& attribute, std::vector<std::string>& values)
+{
+    std::string attributeStart = " " + attribute + "=\"";
+    size_t pos = content.find(elementStart);
+    while (pos != std::string::npos)
+    {
+        size_t end = content.find(elementEnd, pos);
+        if (end == std::string::npos)
+        {
+            end = content.size();
+        }
+
+        size_t valuePos = content.find(attributeStart, pos);
+        if (valuePos != std::string::npos && valuePos < end)
+        {
+            valuePos += attributeStart.size();
+            size_t valueEnd = content.find('"', valuePos);
+            if (valueEnd != std::string::npos && valueEnd < end)
+            {
+                values.push_back(content.substr(valuePos, valueEnd - valuePos));
+            }
+        }
+        pos = content.find(elementStart, end);
+    }
+}
+
+void CSLoader::createNodeAsync(const std::string& filename, const std::function<void(Node*)>& callback)
+{
+    createNodeAsync(filename, callback, nullptr);
+}
+
+void CSLoader::createNodeAsync(const std::string& filename, const std::function<void(Node*)>& callback, const ccNodeLoadCallback& nodeCallback)
+{
+    CSLoader::getInstance()->loadNodeAsync(filename, callback, nodeCallback);
+}
+
+void CSLoader::loadNodeAsync(const std::string& filename, const std::function<void(Node*)>& callback, const ccNodeLoadCallback& nodeCallback)
+{
+    auto load = std::make_shared<AsyncNodeLoad>();
+    load->id = ++s_asyncNodeLoadId;
+    load->filename = filename;
+    load->callback = callback;
+    load->nodeCallback = nodeCallback;
+    _asyncLoads.push_back(load);
+
+    auto prototypeIter = _prototypes.find(filename);
+    if (prototypeIter != _prototypes.end())
+    {
+        load->prototype = prototypeIter->second;
+        startAsyncInstantiation(load);
+        return;
+    }
+
+    // the paths are resolved on the cocos thread, the file cache of FileUtils isn't thread safe
+    auto file = std::make_shared<AsyncNodeLoad::FileData>();
+    file->csbFiles.push_back(filename);
+    file->csbFullPaths.push_back(FileUtils::getInstance()->fullPathForFilename(filename));
+    load->file = file;
+
+    readAsyncCsbFiles(load);
+}
+
+void CSLoader::readAsyncCsbFiles(const std::shared_ptr<AsyncNodeLoad>& load)
+{
+    int id = load->id;
+    auto file = load->file;
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [id](void*) {
+        if (_sharedCSLoader)
+        {
+            _sharedCSLoader->onAsyncFileRead(id);
+        }
+    }, nullptr, [file]() {
+        for (size_t i = 0; i < file->csbFiles.size(); ++i)
+        {
+            // the files failing to load are reported when their prototype is created, as with createNode
+            Data data = FileUtils::getInstance()->getDataFromFile(file->csbFullPaths[i]);
+            if (data.isNull())
+                continue;
+
+            flatbuffers::Verifier verifier(data.getBytes(), data.getSize());
+            if (!VerifyCSParseBinaryBuffer(verifier))
+                continue;
+
+            auto csparsebinary = GetCSParseBinary(data.getBytes());
+            auto textures = csparsebinary->textures();
+            if (textures)
+            {
+                int textureSize = textures->size();
+                for (int j = 0; j < textureSize; ++j)
+                {
+                    file->resources.spriteFiles.push_back(textures->Get(j)->c_str());
+                }
+            }
+            collectResourceFiles(csparsebinary->nodeTree(), file->resources);
+            file->csbData[file->csbFiles[i]] = data;
+        }
+    });
+}
+
+std::shared_ptr<CSLoader::AsyncNodeLoad> CSLoader::getAsyncLoad(int id) const
+{
+    for (const auto& load : _asyncLoads)
+    {
+        if (load->id == id)
+            return load;
+    }
+    return nullptr;
+}
+
+// resolve the full paths of the files whose textures are found by the workers
+static void resolveFullPaths(std::vector<std::string>& files, std::vector<std::string>& fullPaths)
+{
+    removeDuplicates(files);
+    for (const auto& file : files)
+    {
+        std::string fullPath = FileUtils::getInstance()->fullPathForFilename(file);
+        if (!fullPath.empty())
+        {
+            fullPaths.push_back(fullPath);
+        }
+    }
+}
+
+void CSLoader::onAsyncFileRead(int id)
+{
+    auto load = getAsyncLoad(id);
+    if (!load)
+        return;
+
+    auto file = load->file;
+    if (file->csbData.find(load->filename) == file->csbData.end())
+    {
+        CCLOG("CSLoader::createNodeAsync - failed read file: %s", load->filename.c_str());
+        finishAsyncLoad(load, nullptr);
+        return;
+    }
+
+    // read the nested csb files not parsed yet, a level of nesting per worker
+    auto& resources = file->resources;
+    file->csbFiles.clear();
+    file->csbFullPaths.clear();
+    removeDuplicates(resources.projectFiles);
+    for (const auto& projectFile : resources.projectFiles)
+    {
+        if (file->csbData.find(projectFile) != file->csbData.end() || _prototypes.find(projectFile) != _prototypes.end())
+            continue;
+
+        // as initNodePrototype, the missing files are skipped
+        if (FileUtils::getInstance()->isFileExist(projectFile))
+        {
+            file->csbFiles.push_back(projectFile);
+            file->csbFullPaths.push_back(FileUtils::getInstance()->fullPathForFilename(projectFile));
+        }
+    }
+    resources.projectFiles.clear();
+    if (!file->csbFiles.empty())
+    {
+        readAsyncCsbFiles(load);
+        return;
+    }
+
+    removeDuplicates(resources.spriteFiles);
+    auto spriteFrameCache = SpriteFrameCache::getInstance();
+    for (const auto& spriteFile : resources.spriteFiles)
+    {
+        if (!spriteFrameCache->isSpriteFramesWithFileLoaded(spriteFile))
+        {
+            std::string fullPath = FileUtils::getInstance()->fullPathForFilename(spriteFile);
+            if (!fullPath.empty())
+            {
+                file->spriteFileFullPaths.push_back(fullPath);
+            }
+        }
+    }
+    resolveFullPaths(resources.particleFiles, file->particleFullPaths);
+    resolveFullPaths(resources.fontFiles, file->fontFullPaths);
+    resolveFullPaths(resources.mapFiles, file->mapFullPaths);
+
+    if (file->spriteFileFullPaths.empty() && file->particleFullPaths.empty()
+        && file->fontFullPaths.empty() && file->mapFullPaths.empty())
+    {
+        onAsyncSpriteFilesRead(id);
+        return;
+    }
+
+    load->state = AsyncNodeLoad::State::READING_SPRITE_FILES;
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [id](void*) {
+        if (_sharedCSLoader)
+        {
+            _sharedCSLoader->onAsyncSpriteFilesRead(id);
+        }
+    }, nullptr, [file]() {
+        auto fileUtils = FileUtils::getInstance();
+
+        // the texture of a sprite sheet is found the way SpriteFrameCache does
+        for (const auto& fullPath : file->spriteFileFullPaths)
+        {
+            ValueMap dict = fileUtils->getValueMapFromFile(fullPath);
+            std::string texturePath;
+            auto metadataIter = dict.find("metadata");
+            if (metadataIter != dict.end() && metadataIter->second.getType() == Value::Type::MAP)
+            {
+                const ValueMap& metadata = metadataIter->second.asValueMap();
+                auto textureIter = metadata.find("textureFileName");
+                if (textureIter != metadata.end())
+                {
+                    texturePath = textureIter->second.asString();
+                }
+            }
+
+            if (!texturePath.empty())
+            {
+                texturePath = fileUtils->fullPathFromRelativeFile(texturePath, fullPath);
+            }
+            else
+            {
+                texturePath = fullPath.substr(0, fullPath.find_last_of('.')) + ".png";
+            }
+            file->textures.push_back(texturePath);
+        }
+
+        // as ParticleSystem, the texture embedded in the file is decoded by the node
+        for (const auto& fullPath : file->particleFullPaths)
+        {
+            ValueMap dict = fileUtils->getValueMapFromFile(fullPath);
+            auto textureIter = dict.find("textureFileName");
+            auto imageDataIter = dict.find("textureImageData");
+            if (textureIter == dict.end() || (imageDataIter != dict.end() && !imageDataIter->second.asString().empty()))
+                continue;
+
+            std::string texturePath = textureIter->second.asString();
+            if (!texturePath.empty())
+            {
+                file->textures.push_back(fileUtils->fullPathFromRelativeFile(texturePath, fullPath));
+            }
+        }
+
+        // the pages of the text fonts, as FNTConfig
+        for (const auto& fullPath : file->fontFullPaths)
+        {
+            std::string content = fileUtils->getStringFromFile(fullPath);
+            if (content.compare(0, 3, "BMF") == 0)
+                continue;
+
+            std::vector<std::string> pages;
+            findAttributeValues(content, "page ", '\n', "file", pages);
+            for (const auto& page : pages)
+            {
+                file->textures.push_back(fileUtils->fullPathFromRelativeFile(page, fullPath));
+            }
+        }
+
+        // the images of the tile sets and the image layers, as TMXMapInfo
+        for (const auto& fullPath : file->mapFullPaths)
+        {
+            std::string content = fileUtils->getStringFromFile(fullPath);
+            std::vector<std::string> images;
+            findAttributeValues(content, "<image ", '>', "source", images);
+            for (const auto& image : images)
+            {
+                file->textures.push_back(fileUtils->fullPathFromRelativeFile(image, fullPath));
+            }
+        }
+    });
+}
+
+void CSLoader::onAsyncSpriteFilesRead(int id)
+{
+    auto load = getAsyncLoad(id);
+    if (!load)
+        return;
+
+    auto file = load->file;
+    std::vector<std::string> textures(file->resources.images);
+    textures.insert(textures.end(), file->textures.begin(), file->textures.end());
+    removeDuplicates(textures);
+
+    load->state = AsyncNodeLoad::State::LOADING_TEXTURES;
+    load->pendingTextures = (int)textures.size();
+    if (textures.empty())
+    {
+        onAsyncTexturesLoaded(id);
+        return;
+    }
+
+    // the cached textures call back at once, the last one may start the instantiation in this loop
+    auto textureCache = Director::getInstance()->getTextureCache();
+    for (const auto& texture : textures)
+    {
+        textureCache->addImageAsync(texture, [id](Texture2D*) {
+            // a texture failing to load is reported when its node is created, as with createNode
+            if (!_sharedCSLoader)
+                return;
+
+            auto load = _sharedCSLoader->getAsyncLoad(id);
+            if (load && --load->pendingTextures == 0)
+            {
+                _sharedCSLoader->onAsyncTexturesLoaded(id);
+            }
+        });
+    }
+}
+
+void CSLoader::onAsyncTexturesLoaded(int id)
+{
+    auto load = getAsyncLoad(id);
+    if (!load)
+        return;
+
+    // the textures are cached, adding the sprite frames of the files doesn't decode them again,
+    // and the nested csb files are parsed from the data read by the workers
+    _asyncCsbData.swap(load->file->csbData);
+    Data data = _asyncCsbData[load->filename];
+    load->prototype = createPrototype(load->filename, data);
+    _asyncCsbData.clear();
+    load->file.reset();
+
+    startAsyncInstantiation(load);
+}
+
+void CSLoader::startAsyncInstantiation(const std::shared_ptr<AsyncNodeLoad>& load)
+{
+    load->state = AsyncNodeLoad::State::INSTANTIATING;
+
+    auto scheduler = Director::getInstance()->getScheduler();
+    if (!scheduler->isScheduled("CSLoaderAsyncLoads", this))
+    {
+        scheduler->schedule(CC_CALLBACK_1(CSLoader::updateAsyncLoads, this), this, 0, false, "CSLoaderAsyncLoads");
+    }
+}
+
+bool CSLoader::stepAsyncInstantiation(AsyncNodeLoad& load)
+{
+    if (!load.started)
+    {
+        load.started = true;
+        addPrototypeSpriteFrames(*load.prototype);
+
+        Node* root = createNodeWithPrototype(load.prototype->root, load.nodeCallback);
+        if (!root)
+            return true;
+
+        root->retain();
+        load.frames.push_back({ &load.prototype->root, root, 0 });
+        return false;
+    }
+
+    auto& frame = load.frames.back();
+    if (frame.nextChild < frame.prototype->children.size())
+    {
+        const NodePrototype& childPrototype = frame.prototype->children[frame.nextChild++];
+        Node* child = createNodeWithPrototype(childPrototype, load.nodeCallback);
+        if (child)
+        {
+            child->retain();
+            load.frames.push_back({ &childPrototype, child, 0 });
+        }
+        return false;
+    }
+
+    // the node and its children are complete
+    Node* node = frame.node;
+    load.frames.pop_back();
+    if (load.frames.empty())
+    {
+        load.root = node;
+        return true;
+    }
+
+    addLoadedChild(load.frames.back().node, node);
+    if (load.nodeCallback)
+    {
+        load.nodeCallback(node);
+    }
+    node->release();
+    return false;
+}
+
+void CSLoader::finishAsyncLoad(const std::shared_ptr<AsyncNodeLoad>& load, Node* node)
+{
+    _asyncLoads.erase(std::find(_asyncLoads.begin(), _asyncLoads.end(), load));
+
+    // as the nodes returned by createNode, the root is released at the end of the frame
+    if (node)
+    {
+        node->autorelease();
+    }
+
+    if (load->callback)
+    {
+        load->callback(node);
+    }
+}
+
+void CSLoader::updateAsyncLoads(float dt)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto timeSlice = std::chrono::microseconds((long long)(_asyncTimeSlice * 1000000));
+
+    // the loads started by the callbacks wait for the next frame
+    auto loads = _asyncLoads;
+    bool instantiated = false;
+    for (const auto& load : loads)
+    {
+        if (load->state != AsyncNodeLoad::State::INSTANTIATING)
+            continue;
+
+        // at least one node is created per frame
+        if (instantiated && std::chrono::steady_clock::now() - start >= timeSlice)
+            break;
+        instantiated = true;
+
+        // the callback handlers of a load only apply to its nodes, its handler stack is kept between frames
+        Node* rootNode = _rootNode;
+        _rootNode = load->callbackHandler;
+        std::swap(_callbackHandlers, load->callbackHandlers);
+
+        bool complete = false;
+        do
+        {
+            complete = stepAsyncInstantiation(*load);
+        } while (!complete && std::chrono::steady_clock::now() - start < timeSlice);
+
+        load->callbackHandler = _rootNode;
+        std::swap(_callbackHandlers, load->callbackHandlers);
+        _rootNode = rootNode;
+
+        if (complete)
+        {
+            finishAsyncLoad(load, load->root);
+        }
+    }
+
+    bool instantiating = false;
+    for (const auto& load : _asyncLoads)
+    {
+        instantiating = instantiating || load->state == AsyncNodeLoad::State::INSTANTIATING;
+    }
+    if (!instantiating)
+    {
+        Director::getInstance()->getScheduler()->unschedule("CSLoaderAsyncLoads", this);
+    }
+}
+
 bool CSLoader::bindCallback(const std::string &callbackName,
                             const std::string &callbackType,
                             cocos2d::ui::Widget *sender,
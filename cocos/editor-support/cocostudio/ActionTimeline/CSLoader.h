@@ -28,6 +28,8 @@
 #include "editor-support/cocostudio/DictionaryHelper.h"
 #include "editor-support/cocostudio/CocosStudioExport.h"
 
+#include <memory>
+
 #include "base/ObjectFactory.h"
 #include "base/CCData.h"
 #include "ui/UIWidget.h"
@@ -74,6 +76,7 @@ public:
     static void destroyInstance();
     
     CSLoader();
+    ~CSLoader();
     /** @deprecated Use method destroyInstance() instead */
     CC_DEPRECATED_ATTRIBUTE void purge();    
     
@@ -86,6 +89,16 @@ public:
     static cocos2d::Node* createNodeWithVisibleSize(const std::string& filename);
     static cocos2d::Node* createNodeWithVisibleSize(const std::string& filename, const ccNodeLoadCallback& callback);
 
+    /**
+     * Create the nodes of a csb file without blocking. The file and its nested csb files are read, and the
+     * textures they use, those of their particles, bitmap fonts and tile maps included, are decoded on other
+     * threads, then the nodes are created on the cocos thread a few at a time, for at most
+     * the async time slice per frame. callback receives the root node once the whole tree is created, or
+     * nullptr if the file can't be loaded.
+     */
+    static void createNodeAsync(const std::string& filename, const std::function<void(cocos2d::Node*)>& callback);
+    static void createNodeAsync(const std::string& filename, const std::function<void(cocos2d::Node*)>& callback, const ccNodeLoadCallback& nodeCallback);
+
     static cocostudio::timeline::ActionTimeline* createTimeline(const std::string& filename);
     static cocostudio::timeline::ActionTimeline* createTimeline(const Data& data, const std::string& filename);
 
@@ -119,7 +132,57 @@ public:
     cocos2d::Node* createNodeWithFlatBuffersForSimulator(const std::string& filename);
     cocos2d::Node* nodeWithFlatBuffersForSimulator(const flatbuffers::NodeTree* nodetree);
 
+    /**
+     * Parse csb files once and keep them as prototypes, the nested csb files are parsed too.
+     * createNode creates the nodes of a file with a prototype from the parsed data, without
+     * reading the file nor looking for the reader of each node again.
+     */
+    void prewarmPrototypes(const std::vector<std::string>& filenames);
+
+    /** Add the prototype of a csb file already in memory, filename is the one given to createNode. */
+    bool addPrototype(const std::string& filename, const Data& data);
+
+    bool hasPrototype(const std::string& filename) const;
+
+    void removePrototype(const std::string& filename);
+
+    void removeAllPrototypes();
+
+    /** Time spent creating the nodes of the asynchronous loads in a frame, in seconds, 4 ms by default. */
+    void setAsyncTimeSlice(float seconds) { _asyncTimeSlice = seconds; }
+    float getAsyncTimeSlice() const { return _asyncTimeSlice; }
+
 protected:
+    struct NodePrototype;
+    struct FilePrototype;
+
+    std::shared_ptr<FilePrototype> getPrototype(const std::string& filename);
+    std::shared_ptr<FilePrototype> createPrototype(const std::string& filename, const Data& data);
+    void initNodePrototype(NodePrototype& prototype, const flatbuffers::NodeTree* nodetree);
+    cocos2d::Node* nodeWithPrototype(const FilePrototype& prototype, const ccNodeLoadCallback& callback);
+    cocos2d::Node* nodeWithPrototype(const NodePrototype& prototype, const ccNodeLoadCallback& callback);
+    // create the node of a prototype without its children
+    cocos2d::Node* createNodeWithPrototype(const NodePrototype& prototype, const ccNodeLoadCallback& callback);
+    void addPrototypeSpriteFrames(const FilePrototype& prototype);
+
+    struct AsyncNodeLoad;
+
+    void loadNodeAsync(const std::string& filename, const std::function<void(cocos2d::Node*)>& callback, const ccNodeLoadCallback& nodeCallback);
+    // read the csb files of the load on a worker and collect the files they use
+    void readAsyncCsbFiles(const std::shared_ptr<AsyncNodeLoad>& load);
+    std::shared_ptr<AsyncNodeLoad> getAsyncLoad(int id) const;
+    void onAsyncFileRead(int id);
+    void onAsyncSpriteFilesRead(int id);
+    void onAsyncTexturesLoaded(int id);
+    void startAsyncInstantiation(const std::shared_ptr<AsyncNodeLoad>& load);
+    // create one node of the tree, return true once the tree is complete
+    bool stepAsyncInstantiation(AsyncNodeLoad& load);
+    void finishAsyncLoad(const std::shared_ptr<AsyncNodeLoad>& load, cocos2d::Node* node);
+    void updateAsyncLoads(float dt);
+
+    // bind the callbacks of a widget created from a csb and push the callback handlers
+    void bindNodeCallbacks(cocos2d::Node* node);
+    void addLoadedChild(cocos2d::Node* parent, cocos2d::Node* child);
 
     cocos2d::Node* createNodeWithFlatBuffersFile(const std::string& filename, const ccNodeLoadCallback& callback);
     cocos2d::Node* nodeWithFlatBuffersFile(const std::string& fileName, const ccNodeLoadCallback& callback);
@@ -174,7 +237,13 @@ protected:
     cocos2d::Vector<cocos2d::Node*> _callbackHandlers;
     
     std::string _csBuildID;
-    
+
+    std::unordered_map<std::string, std::shared_ptr<FilePrototype>> _prototypes;
+
+    std::vector<std::shared_ptr<AsyncNodeLoad>> _asyncLoads;
+    // the csb files read by the workers of the load whose prototype is being created
+    std::unordered_map<std::string, cocos2d::Data> _asyncCsbData;
+    float _asyncTimeSlice;
 };
 
 NS_CC_END
@@ -88,6 +88,7 @@ Armature::Armature()
     , _batchNode(nullptr)
     , _parentBone(nullptr)
     , _armatureTransformDirty(true)
+    , _boneOrderDirty(true)
     , _animation(nullptr)
 {
 }
@@ -97,6 +98,7 @@ Armature::~Armature(void)
 {
     _boneDic.clear();
     _topBoneList.clear();
+    _boneOrder.clear();
 
     CC_SAFE_DELETE(_animation);
 }
@@ -121,6 +123,8 @@ bool Armature::init(const std::string& name)
 
         _boneDic.clear();
         _topBoneList.clear();
+        _boneOrder.clear();
+        _boneOrderDirty = true;
 
         _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
 
@@ -257,6 +261,7 @@ void Armature::addBone(Bone *bone, const std::string& parentName)
 
     _boneDic.insert(bone->getName(), bone);
     addChild(bone);
+    _boneOrderDirty = true;
 }
 
 
@@ -273,6 +278,7 @@ void Armature::removeBone(Bone *bone, bool recursion)
     }
     _boneDic.erase(bone->getName());
     removeChild(bone, true);
+    _boneOrderDirty = true;
 }
 
 
@@ -309,6 +315,7 @@ void Armature::changeBoneParent(Bone *bone, const std::string& parentName)
             _topBoneList.pushBack(bone);
         }
     }
+    _boneOrderDirty = true;
 }
 
 const cocos2d::Map<std::string, Bone*>& Armature::getBoneDic() const
@@ -376,13 +383,44 @@ void Armature::update(float dt)
 {
     _animation->update(dt);
 
-    for(const auto &bone : _topBoneList) {
-        bone->update(dt);
+    if (_boneOrderDirty)
+    {
+        updateBoneOrder();
+    }
+
+    // A bone reads the transform and the dirty flag of its parent, which is updated before it.
+    for (const auto &bone : _boneOrder)
+    {
+        bone->updateBone(dt);
+    }
+    for (const auto &bone : _boneOrder)
+    {
+        bone->setTransformDirty(false);
     }
 
     _armatureTransformDirty = false;
 }
 
+void Armature::updateBoneOrder()
+{
+    _boneOrder.clear();
+    _boneOrder.reserve(_boneDic.size());
+    for (const auto &bone : _topBoneList)
+    {
+        addBoneToOrder(bone);
+    }
+    _boneOrderDirty = false;
+}
+
+void Armature::addBoneToOrder(Bone *bone)
+{
+    _boneOrder.push_back(bone);
+    for (const auto &child : bone->getChildren())
+    {
+        addBoneToOrder(static_cast<Bone *>(child));
+    }
+}
+
 void Armature::draw(cocos2d::Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
     if (_parentBone == nullptr && _batchNode == nullptr)
@@ -424,16 +462,23 @@ void Armature::draw(cocos2d::Renderer *renderer, const Mat4 &transform, uint32_t
                         skin->setBlendFunc(_blendFunc);
                     }
                 }
-                skin->draw(renderer, transform, flags);
+
+                // The skins of the armatures in a batch node are drawn together.
+                if (_batchNode == nullptr || !_batchNode->addQuad(renderer, skin, getNodeToParentTransform()))
+                {
+                    skin->draw(renderer, transform, flags);
+                }
             }
             break;
             case CS_DISPLAY_ARMATURE:
             {
+                flushBatchedQuads(renderer);
                 node->draw(renderer, transform, flags);
             }
             break;
             default:
             {
+                flushBatchedQuads(renderer);
                 node->visit(renderer, transform, flags);
 //                CC_NODE_DRAW_SETUP();
             }
@@ -442,12 +487,21 @@ void Armature::draw(cocos2d::Renderer *renderer, const Mat4 &transform, uint32_t
         }
         else if(Node *node = dynamic_cast<Node *>(object))
         {
+            flushBatchedQuads(renderer);
             node->visit(renderer, transform, flags);
 //            CC_NODE_DRAW_SETUP();
         }
     }
 }
 
+void Armature::flushBatchedQuads(cocos2d::Renderer *renderer)
+{
+    if (_batchNode)
+    {
+        _batchNode->flushQuads(renderer);
+    }
+}
+
 void Armature::onEnter()
 {
 #if CC_ENABLE_SCRIPT_BINDING
@@ -191,6 +191,13 @@ public:
     
     virtual bool getArmatureTransformDirty() const;
 
+    /**
+     * Rebuild the update order of the bones before the next update, called when the hierarchy of the bones changes.
+     * @js NA
+     * @lua NA
+     */
+    void setBoneOrderDirty() { _boneOrderDirty = true; }
+
 
 #if ENABLE_PHYSICS_BOX2D_DETECT || ENABLE_PHYSICS_CHIPMUNK_DETECT
     virtual void setColliderFilter(ColliderFilter *filter);
@@ -251,6 +258,11 @@ protected:
      */
     Bone *createBone(const std::string& boneName );
 
+    void updateBoneOrder();
+    void addBoneToOrder(Bone *bone);
+    // draw the skins added to the batch node before something not batched is drawn
+    void flushBatchedQuads(cocos2d::Renderer *renderer);
+
 protected:
     ArmatureData *_armatureData;
 
@@ -265,6 +277,9 @@ protected:
 
     cocos2d::Vector<Bone*> _topBoneList;
 
+    std::vector<Bone*> _boneOrder;                    //! All the bones, each one after its parent, in the order they are updated
+    bool _boneOrderDirty;
+
     cocos2d::BlendFunc _blendFunc;                    //! It's required for CCTextureProtocol inheritance
 
     cocos2d::Vec2 _offsetPoint;
@@ -219,7 +219,17 @@ void ArmatureDataManager::addArmatureFileInfoAsync(const std::string& imagePath,
 
     _autoLoadSpriteFile = false;
     DataReaderHelper::getInstance()->addDataFromFileAsync(imagePath, plistPath, configFilePath, target, selector);
-    addSpriteFrameFromFile(plistPath, imagePath, configFilePath);
+}
+
+void ArmatureDataManager::addArmatureFileInfoAsync(const std::vector<std::string>& configFilePaths, const std::function<void(float)>& progressCallback)
+{
+    for (const auto& configFilePath : configFilePaths)
+    {
+        addRelativeData(configFilePath);
+    }
+
+    _autoLoadSpriteFile = true;
+    DataReaderHelper::getInstance()->addDataFromFilesAsync(configFilePaths, progressCallback);
 }
 
 void ArmatureDataManager::addSpriteFrameFromFile(const std::string& plistPath, const std::string& imagePath, const std::string& configFilePath)
@@ -231,6 +241,15 @@ void ArmatureDataManager::addSpriteFrameFromFile(const std::string& plistPath, c
     SpriteFrameCacheHelper::getInstance()->addSpriteFrameFromFile(plistPath, imagePath);
 }
 
+void ArmatureDataManager::addSpriteFrameFromFile(const std::string& plistPath, const std::string& imagePath, ValueMap& dictionary, const std::string& configFilePath)
+{
+    if (RelativeData *data = getRelativeData(configFilePath))
+    {
+        data->plistFiles.push_back(plistPath);
+    }
+    SpriteFrameCacheHelper::getInstance()->addSpriteFrameFromFile(plistPath, imagePath, dictionary);
+}
+
 
 bool ArmatureDataManager::isAutoLoadSpriteFile()
 {
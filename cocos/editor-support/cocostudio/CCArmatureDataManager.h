@@ -154,11 +154,25 @@ public:
      */
     void addArmatureFileInfoAsync(const std::string& imagePath, const std::string& plistPath, const std::string& configFilePath, cocos2d::Ref *target, cocos2d::SEL_SCHEDULE selector);
 
+    /**
+     *    @brief    Add the ArmatureFileInfo of several config files, they are parsed by the loading threads
+     *            of DataReaderHelper and the textures of their sprite files are decoded asynchronously.
+     *            progressCallback is called after each file with the part of the files loaded, between 0 and 1.
+     *  @js NA
+     *  @lua NA
+     */
+    void addArmatureFileInfoAsync(const std::vector<std::string>& configFilePaths, const std::function<void(float)>& progressCallback);
+
     /**
      *    @brief    Add sprite frame to CCSpriteFrameCache, it will save display name and it's relative image name
      */
     void addSpriteFrameFromFile(const std::string& plistPath, const std::string& imagePath, const std::string& configFilePath = "");
 
+    /**
+     *    @brief    Add sprite frame to CCSpriteFrameCache from the content of the plist file, read beforehand
+     */
+    void addSpriteFrameFromFile(const std::string& plistPath, const std::string& imagePath, cocos2d::ValueMap& dictionary, const std::string& configFilePath);
+
     virtual void removeArmatureFileInfo(const std::string& configFilePath);
 
 
@@ -28,6 +28,7 @@ THE SOFTWARE.
 
 #include "renderer/CCRenderer.h"
 #include "renderer/CCGroupCommand.h"
+#include "renderer/CCQuadCommand.h"
 #include "renderer/CCGLProgramState.h"
 #include "base/CCDirector.h"
 
@@ -49,12 +50,26 @@ BatchNode *BatchNode::create()
 
 BatchNode::BatchNode()
 : _groupCommand(nullptr)
+, _quads(nullptr)
+, _usedQuadBuffers(0)
+, _usedQuadCommands(0)
+, _frame(0)
+, _pendingQuadsStart(0)
+, _pendingTexture(nullptr)
+, _pendingGLProgramState(nullptr)
+, _pendingGlobalZOrder(0)
+, _drawFlags(0)
 {
 }
 
 BatchNode::~BatchNode()
 {
     CC_SAFE_DELETE(_groupCommand);
+
+    for (auto command : _quadCommands)
+    {
+        delete command;
+    }
 }
 
 bool BatchNode::init()
@@ -143,6 +158,35 @@ void BatchNode::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 
 //    CC_NODE_DRAW_SETUP();
 
+    // The commands of a frame are rendered after all the draws, each draw of the frame fills its own buffer.
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    if (frame != _frame)
+    {
+        _frame = frame;
+        _usedQuadBuffers = 0;
+        _usedQuadCommands = 0;
+    }
+    if (_usedQuadBuffers == _quadBuffers.size())
+    {
+        _quadBuffers.emplace_back();
+    }
+    _quads = &_quadBuffers[_usedQuadBuffers++];
+    _quads->clear();
+
+    // An armature draws at most a skin per bone, the buffer isn't reallocated while the commands point into it.
+    size_t capacity = 0;
+    for (auto object : _children)
+    {
+        if (Armature *armature = dynamic_cast<Armature *>(object))
+        {
+            capacity += armature->getBoneDic().size();
+        }
+    }
+    _quads->reserve(capacity);
+    _pendingQuadsStart = 0;
+    _drawTransform = transform;
+    _drawFlags = flags;
+
     bool pushed = false;
     for(auto object : _children)
     {
@@ -159,12 +203,77 @@ void BatchNode::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
         }
         else
         {
+            flushQuads(renderer);
             renderer->popGroup();
             pushed = false;
             
             ((Node *)object)->visit(renderer, transform, flags);
         }
     }
+
+    flushQuads(renderer);
+    _quads = nullptr;
+}
+
+bool BatchNode::addQuad(Renderer *renderer, Skin *skin, const Mat4 &transform)
+{
+    if (_quads == nullptr)
+    {
+        return false;
+    }
+    if (_quads->size() == _quads->capacity())
+    {
+        flushQuads(renderer);
+        return false;
+    }
+
+    Texture2D *texture = skin->getTexture();
+    GLProgramState *glProgramState = skin->getGLProgramState();
+    const BlendFunc &blendFunc = skin->getBlendFunc();
+    float globalZOrder = skin->getGlobalZOrder();
+
+    size_t pendingQuads = _quads->size() - _pendingQuadsStart;
+    if (pendingQuads > 0 && (texture != _pendingTexture || glProgramState != _pendingGLProgramState
+        || blendFunc != _pendingBlendFunc || globalZOrder != _pendingGlobalZOrder
+        || (pendingQuads + 1) * 4 > Renderer::VBO_SIZE))
+    {
+        flushQuads(renderer);
+    }
+    if (_quads->size() == _pendingQuadsStart)
+    {
+        _pendingTexture = texture;
+        _pendingGLProgramState = glProgramState;
+        _pendingBlendFunc = blendFunc;
+        _pendingGlobalZOrder = globalZOrder;
+    }
+
+    // The quads of all the armatures are drawn with the transform of the batch node.
+    _quads->push_back(skin->getQuad());
+    V3F_C4B_T2F_Quad &quad = _quads->back();
+    transform.transformPoint(&quad.bl.vertices);
+    transform.transformPoint(&quad.br.vertices);
+    transform.transformPoint(&quad.tl.vertices);
+    transform.transformPoint(&quad.tr.vertices);
+    return true;
+}
+
+void BatchNode::flushQuads(Renderer *renderer)
+{
+    if (_quads == nullptr || _quads->size() == _pendingQuadsStart)
+    {
+        return;
+    }
+
+    if (_usedQuadCommands == _quadCommands.size())
+    {
+        _quadCommands.push_back(new (std::nothrow) QuadCommand());
+    }
+    QuadCommand *command = _quadCommands[_usedQuadCommands++];
+    command->init(_pendingGlobalZOrder, _pendingTexture, _pendingGLProgramState, _pendingBlendFunc,
+        _quads->data() + _pendingQuadsStart, _quads->size() - _pendingQuadsStart, _drawTransform, _drawFlags);
+    renderer->addCommand(command);
+
+    _pendingQuadsStart = _quads->size();
 }
 
 void BatchNode::generateGroupCommand()
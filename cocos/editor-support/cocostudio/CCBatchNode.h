@@ -31,10 +31,14 @@ THE SOFTWARE.
 
 namespace cocos2d {
     class GroupCommand;
+    class QuadCommand;
+    class Texture2D;
 }
 
 namespace cocostudio {
 
+class Skin;
+
 class CC_STUDIO_DLL BatchNode : public cocos2d::Node
 {
 public:
@@ -59,11 +63,46 @@ public:
     virtual void removeChild(cocos2d::Node* child, bool cleanup) override;
     virtual void visit(cocos2d::Renderer *renderer, const cocos2d::Mat4 &parentTransform, uint32_t parentFlags) override;
     virtual void draw(cocos2d::Renderer *renderer, const cocos2d::Mat4 &transform, uint32_t flags) override;
+
+    /**
+     * Add the quad of a skin of an armature child to the quads drawn together, the consecutive quads sharing a texture,
+     * a shader and a blend function are drawn by a single command.
+     * Return false if the skin must draw itself, the quads added before are then already drawn.
+     *
+     * @param transform The transform from the armature to the batch node.
+     * @js NA
+     * @lua NA
+     */
+    bool addQuad(cocos2d::Renderer *renderer, Skin *skin, const cocos2d::Mat4 &transform);
+    /**
+     * Draw the quads added, called before anything else is drawn by the armatures.
+     * @js NA
+     * @lua NA
+     */
+    void flushQuads(cocos2d::Renderer *renderer);
     
 protected:
     void generateGroupCommand();
 
     cocos2d::GroupCommand* _groupCommand;
+
+    // The quads of a draw, several draws in a frame use different buffers as the commands point into them.
+    std::vector<std::vector<cocos2d::V3F_C4B_T2F_Quad>> _quadBuffers;
+    std::vector<cocos2d::V3F_C4B_T2F_Quad> *_quads;
+    size_t _usedQuadBuffers;
+    std::vector<cocos2d::QuadCommand*> _quadCommands;
+    size_t _usedQuadCommands;
+    unsigned int _frame;
+
+    // The quads not drawn yet
+    size_t _pendingQuadsStart;
+    cocos2d::Texture2D *_pendingTexture;
+    cocos2d::GLProgramState *_pendingGLProgramState;
+    cocos2d::BlendFunc _pendingBlendFunc;
+    float _pendingGlobalZOrder;
+
+    cocos2d::Mat4 _drawTransform;
+    uint32_t _drawFlags;
 };
 
 }
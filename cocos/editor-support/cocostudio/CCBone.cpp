@@ -78,6 +78,11 @@ Bone::Bone()
 
     _armatureParentBone = nullptr;
     _dataVersion = 0;
+
+    _localX = _localY = 0;
+    _localScaleX = _localScaleY = 1;
+    _localSkewX = _localSkewY = 0;
+    _localTransformValid = false;
 }
 
 
@@ -146,6 +151,7 @@ void Bone::setBoneData(BoneData *boneData)
     _localZOrder = _boneData->zOrder;
 
     _displayManager->initDisplayList(boneData);
+    invalidateTransform();
 }
 
 BoneData *Bone::getBoneData() const
@@ -166,6 +172,7 @@ void Bone::setArmature(Armature *armature)
     {
         _armatureParentBone = nullptr;
     }
+    invalidateTransform();
 }
 
 
@@ -176,59 +183,96 @@ Armature *Bone::getArmature() const
 
 void Bone::update(float delta)
 {
-    if (_parentBone)
-        _boneTransformDirty = _boneTransformDirty || _parentBone->isTransformDirty();
+    updateBone(delta);
 
-    if (_armatureParentBone && !_boneTransformDirty)
-    {
-        _boneTransformDirty = _armatureParentBone->isTransformDirty();
+    for(const auto &obj: _children) {
+        Bone *childBone = static_cast<Bone*>(obj);
+        childBone->update(delta);
     }
 
-    if (_boneTransformDirty)
+    _boneTransformDirty = false;
+}
+
+void Bone::updateBone(float delta)
+{
+    bool parentDirty = (_parentBone && _parentBone->isTransformDirty())
+        || (_armatureParentBone && (_armatureParentBone->isTransformDirty() || _armature->getArmatureTransformDirty()));
+
+    if (_boneTransformDirty || parentDirty)
     {
-        _worldInfo->copy(_tweenData);
+        float x = _tweenData->x;
+        float y = _tweenData->y;
+        float scaleX = _tweenData->scaleX;
+        float scaleY = _tweenData->scaleY;
+        float skewX = _tweenData->skewX;
+        float skewY = _tweenData->skewY;
         if (_dataVersion >= VERSION_COMBINED)
         {
-            TransformHelp::nodeConcat(*_worldInfo, *_boneData);
-            _worldInfo->scaleX -= 1;
-            _worldInfo->scaleY -= 1;
+            x += _boneData->x;
+            y += _boneData->y;
+            skewX += _boneData->skewX;
+            skewY += _boneData->skewY;
+            scaleX += _boneData->scaleX;
+            scaleY += _boneData->scaleY;
+            scaleX -= 1;
+            scaleY -= 1;
         }
 
-        _worldInfo->x = _worldInfo->x + _position.x;
-        _worldInfo->y = _worldInfo->y + _position.y;
-        _worldInfo->scaleX = _worldInfo->scaleX * _scaleX;
-        _worldInfo->scaleY = _worldInfo->scaleY * _scaleY;
-        _worldInfo->skewX = _worldInfo->skewX + _skewX + CC_DEGREES_TO_RADIANS(_rotationZ_X);
-        _worldInfo->skewY = _worldInfo->skewY + _skewY - CC_DEGREES_TO_RADIANS(_rotationZ_Y);
-
-        if(_parentBone)
+        x += _position.x;
+        y += _position.y;
+        scaleX *= _scaleX;
+        scaleY *= _scaleY;
+        skewX += _skewX + CC_DEGREES_TO_RADIANS(_rotationZ_X);
+        skewY += _skewY - CC_DEGREES_TO_RADIANS(_rotationZ_Y);
+
+        // The tween marks its bone dirty on every frame it plays, even on the segments where the bone doesn't move.
+        if (!parentDirty && _localTransformValid
+            && x == _localX && y == _localY && scaleX == _localScaleX && scaleY == _localScaleY
+            && skewX == _localSkewX && skewY == _localSkewY)
         {
-            applyParentTransform(_parentBone);
+            _boneTransformDirty = false;
         }
         else
         {
-            if (_armatureParentBone)
+            _boneTransformDirty = true;
+            _localX = x;
+            _localY = y;
+            _localScaleX = scaleX;
+            _localScaleY = scaleY;
+            _localSkewX = skewX;
+            _localSkewY = skewY;
+            _localTransformValid = true;
+
+            _worldInfo->copy(_tweenData);
+            _worldInfo->x = x;
+            _worldInfo->y = y;
+            _worldInfo->scaleX = scaleX;
+            _worldInfo->scaleY = scaleY;
+            _worldInfo->skewX = skewX;
+            _worldInfo->skewY = skewY;
+
+            if(_parentBone)
             {
-                applyParentTransform(_armatureParentBone);
+                applyParentTransform(_parentBone);
+            }
+            else
+            {
+                if (_armatureParentBone)
+                {
+                    applyParentTransform(_armatureParentBone);
+                }
             }
-        }
 
-        TransformHelp::nodeToMatrix(*_worldInfo, _worldTransform);
+            TransformHelp::nodeToMatrix(*_worldInfo, _worldTransform);
 
-        if (_armatureParentBone)
-        {
-            _worldTransform = TransformConcat(_worldTransform, _armature->getNodeToParentTransform());
+            if (_armatureParentBone)
+            {
+                _worldTransform = TransformConcat(_worldTransform, _armature->getNodeToParentTransform());
+            }
         }
     }
 
     DisplayFactory::updateDisplay(this, delta, _boneTransformDirty || _armature->getArmatureTransformDirty());
-
-    for(const auto &obj: _children) {
-        Bone *childBone = static_cast<Bone*>(obj);
-        childBone->update(delta);
-    }
-
-    _boneTransformDirty = false;
 }
 
 void Bone::applyParentTransform(Bone *parent) 
@@ -306,6 +350,11 @@ void Bone::addChildBone(Bone *child)
     {
         _children.pushBack(child);
         child->setParentBone(this);
+
+        if (_armature)
+        {
+            _armature->setBoneOrderDirty();
+        }
     }
 }
 
@@ -329,6 +378,11 @@ void Bone::removeChildBone(Bone *bone, bool recursion)
         bone->getDisplayManager()->setCurrentDecorativeDisplay(nullptr);
 
         _children.eraseObject(bone);
+
+        if (_armature)
+        {
+            _armature->setBoneOrderDirty();
+        }
     }
 }
 
@@ -343,6 +397,13 @@ void Bone::removeFromParent(bool recursion)
 void Bone::setParentBone(Bone *parent)
 {
     _parentBone = parent;
+    invalidateTransform();
+}
+
+void Bone::invalidateTransform()
+{
+    _localTransformValid = false;
+    _boneTransformDirty = true;
 }
 
 Bone *Bone::getParentBone()
@@ -136,6 +136,12 @@ public:
 
     void update(float delta) override;
 
+    /**
+     * Update the transform and the display of this bone but not of its child bones, the parent bone must be updated before.
+     * The transform dirty flag is left set for the child bones, Armature clears it once all the bones were updated.
+     */
+    virtual void updateBone(float delta);
+
     void updateDisplayedColor(const cocos2d::Color3B &parentColor) override;
     void updateDisplayedOpacity(GLubyte parentOpacity) override;
 
@@ -155,6 +161,12 @@ public:
     virtual void setTransformDirty(bool dirty) { _boneTransformDirty = dirty; }
     virtual bool isTransformDirty() { return _boneTransformDirty; }
 
+    /*
+     * Compute the world transform and apply it to the display on the next update, even if the local transform didn't change.
+     * Called when the parent, the data or the display of the bone change.
+     */
+    void invalidateTransform();
+
     virtual cocos2d::Mat4 getNodeToArmatureTransform() const;
     virtual cocos2d::Mat4 getNodeToWorldTransform() const override;
 
@@ -247,6 +259,10 @@ protected:
     cocos2d::Mat4 _worldTransform;
 
     BaseData *_worldInfo;
+
+    //! Local transform _worldInfo was computed from, the world transform of a bone whose tween didn't move is kept
+    float _localX, _localY, _localScaleX, _localScaleY, _localSkewX, _localSkewY;
+    bool _localTransformValid;
     
     //! Armature's parent bone
     Bone *_armatureParentBone;
@@ -22,10 +22,14 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 ****************************************************************************/
 
+#include <algorithm>
+
 #include "platform/CCFileUtils.h"
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
 #include "base/ccUtils.h"
+#include "2d/CCSpriteFrameCache.h"
+#include "renderer/CCTextureCache.h"
 
 #include "tinyxml2.h"
 
@@ -163,6 +167,46 @@ DataReaderHelper *DataReaderHelper::_dataReaderHelper = nullptr;
 
 
 
+static int getDefaultLoadingThreadCount()
+{
+    // leave a core to the cocos thread
+    int count = (int)std::thread::hardware_concurrency() - 1;
+    return std::min(std::max(count, 1), 4);
+}
+
+static Texture2D::PixelFormat getSpriteFilePixelFormat(const ValueMap& dict)
+{
+    static std::unordered_map<std::string, Texture2D::PixelFormat> pixelFormats = {
+        {"RGBA8888", Texture2D::PixelFormat::RGBA8888},
+        {"RGBA4444", Texture2D::PixelFormat::RGBA4444},
+        {"RGB5A1", Texture2D::PixelFormat::RGB5A1},
+        {"RGBA5551", Texture2D::PixelFormat::RGB5A1},
+        {"RGB565", Texture2D::PixelFormat::RGB565},
+        {"A8", Texture2D::PixelFormat::A8},
+        {"ALPHA", Texture2D::PixelFormat::A8},
+        {"I8", Texture2D::PixelFormat::I8},
+        {"AI88", Texture2D::PixelFormat::AI88},
+        {"ALPHA_INTENSITY", Texture2D::PixelFormat::AI88},
+        {"RGB888", Texture2D::PixelFormat::RGB888}
+    };
+
+    auto metadataIter = dict.find("metadata");
+    if (metadataIter != dict.end())
+    {
+        const ValueMap& metadataDict = metadataIter->second.asValueMap();
+        auto formatIter = metadataDict.find("pixelFormat");
+        if (formatIter != metadataDict.end())
+        {
+            auto pixelFormatIter = pixelFormats.find(formatIter->second.asString());
+            if (pixelFormatIter != pixelFormats.end())
+            {
+                return pixelFormatIter->second;
+            }
+        }
+    }
+    return Texture2D::getDefaultAlphaPixelFormat();
+}
+
 //! Async load
 void DataReaderHelper::loadData()
 {
@@ -170,34 +214,46 @@ void DataReaderHelper::loadData()
 
     while (true)
     {
-        std::queue<AsyncStruct *> *pQueue = _asyncStructQueue;
-        _asyncStructQueueMutex.lock(); // get async struct from queue
-        if (pQueue->empty())
+        DataInfo *pSpriteDataInfo = nullptr;
         {
-            _asyncStructQueueMutex.unlock();
+            std::unique_lock<std::mutex> lk(_asyncStructQueueMutex); // get async struct from queue
+            _sleepCondition.wait(lk, [this]{ return need_quit || !_asyncStructQueue->empty() || !_spriteFileQueue.empty(); });
             if (need_quit)
             {
                 break;
             }
+            if (!_spriteFileQueue.empty())
+            {
+                pSpriteDataInfo = _spriteFileQueue.front();
+                _spriteFileQueue.pop();
+            }
             else
             {
-				std::unique_lock<std::mutex> lk(_sleepMutex);
-				_sleepCondition.wait(lk);
-                continue;
+                pAsyncStruct = _asyncStructQueue->front();
+                _asyncStructQueue->pop();
             }
         }
-        else
+
+        // the plists of a parsed file, its textures are decoded in their pixel format
+        if (pSpriteDataInfo)
         {
-            pAsyncStruct = pQueue->front();
-            pQueue->pop();
-            _asyncStructQueueMutex.unlock();
+            readSpriteFiles(pSpriteDataInfo);
+
+            _dataInfoMutex.lock();
+            _dataQueue->push(pSpriteDataInfo);
+            _dataInfoMutex.unlock();
+            continue;
         }
 
+        // the loading threads read the files with their full path, it doesn't need the lock of the cocos thread
+        pAsyncStruct->fileContent = readFileContent(pAsyncStruct->fullPath, pAsyncStruct->configType == CocoStudio_Binary);
+
         // generate data info
         DataInfo *pDataInfo = new (std::nothrow) DataInfo();
         pDataInfo->asyncStruct = pAsyncStruct;
         pDataInfo->filename = pAsyncStruct->filename;
         pDataInfo->baseFilePath = pAsyncStruct->baseFilePath;
+        pDataInfo->spriteFilesRead = false;
 
         if (pAsyncStruct->configType == DragonBone_XML)
         {
@@ -211,20 +267,13 @@ void DataReaderHelper::loadData()
         {
             DataReaderHelper::addDataFromBinaryCache(pAsyncStruct->fileContent.c_str(),pDataInfo);
         }
+        pAsyncStruct->fileContent.clear();
 
         // put the image info into the queue
         _dataInfoMutex.lock();
         _dataQueue->push(pDataInfo);
         _dataInfoMutex.unlock();
     }
-
-    if( _asyncStructQueue != nullptr )
-    {
-        delete _asyncStructQueue;
-        _asyncStructQueue = nullptr;
-        delete _dataQueue;
-        _dataQueue = nullptr;
-    }
 }
 
 
@@ -257,7 +306,7 @@ void DataReaderHelper::purge()
 
 
 DataReaderHelper::DataReaderHelper()
-	: _loadingThread(nullptr)
+	: _loadingThreadCount(getDefaultLoadingThreadCount())
 	, _asyncRefCount(0)
 	, _asyncRefTotalCount(0)
 	, need_quit(false)
@@ -269,15 +318,61 @@ DataReaderHelper::DataReaderHelper()
 
 DataReaderHelper::~DataReaderHelper()
 {
+    _asyncStructQueueMutex.lock();
     need_quit = true;
+    _asyncStructQueueMutex.unlock();
 
-	_sleepCondition.notify_one();
-	if (_loadingThread) _loadingThread->join();
+	_sleepCondition.notify_all();
+	for (auto& thread : _loadingThreads)
+	{
+		thread.join();
+	}
+
+    if (_asyncRefCount > 0)
+    {
+        Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(DataReaderHelper::addDataAsyncCallBack), this);
+    }
+
+    // the files still loading are dropped
+    if (_asyncStructQueue != nullptr)
+    {
+        while (!_dataQueue->empty())
+        {
+            _decodingDataInfos.push_back(_dataQueue->front());
+            _dataQueue->pop();
+        }
+        while (!_spriteFileQueue.empty())
+        {
+            _decodingDataInfos.push_back(_spriteFileQueue.front());
+            _spriteFileQueue.pop();
+        }
+        for (auto dataInfo : _decodingDataInfos)
+        {
+            _asyncStructQueue->push(dataInfo->asyncStruct);
+            delete dataInfo;
+        }
+        while (!_asyncStructQueue->empty())
+        {
+            CC_SAFE_RELEASE(_asyncStructQueue->front()->target);
+            delete _asyncStructQueue->front();
+            _asyncStructQueue->pop();
+        }
+
+        delete _asyncStructQueue;
+        _asyncStructQueue = nullptr;
+        delete _dataQueue;
+        _dataQueue = nullptr;
+    }
 
-	CC_SAFE_DELETE(_loadingThread);
 	_dataReaderHelper = nullptr;
 }
 
+void DataReaderHelper::setLoadingThreadCount(int count)
+{
+    _loadingThreadCount = std::max(count, 1);
+}
+
+
 void DataReaderHelper::addDataFromFile(const std::string& filePath)
 {
     /*
@@ -334,29 +429,9 @@ void DataReaderHelper::addDataFromFile(const std::string& filePath)
     }
 }
 
-void DataReaderHelper::addDataFromFileAsync(const std::string& imagePath, const std::string& plistPath, const std::string& filePath, Ref *target, SEL_SCHEDULE selector)
+
+DataReaderHelper::AsyncStruct *DataReaderHelper::createAsyncStruct(const std::string& filePath)
 {
-    /*
-    * Check if file is already added to ArmatureDataManager, if then return.
-    */
-    for(unsigned int i = 0; i < _configFileList.size(); i++)
-    {
-        if (_configFileList[i] == filePath)
-        {
-            if (target && selector)
-            {
-                if (_asyncRefTotalCount == 0 && _asyncRefCount == 0)
-                {
-                    (target->*selector)(1);
-                }
-                else
-                {
-                    (target->*selector)((_asyncRefTotalCount - _asyncRefCount) / (float)_asyncRefTotalCount);
-                }
-            }
-            return;
-        }
-    }
     _configFileList.push_back(filePath);
 
     //! find the base file path
@@ -372,17 +447,44 @@ void DataReaderHelper::addDataFromFileAsync(const std::string& imagePath, const
         basefilePath = "";
     }
 
+    // generate async struct
+    AsyncStruct *data = new (std::nothrow) AsyncStruct();
+    data->filename = filePath;
+    data->baseFilePath = basefilePath;
+    data->target = nullptr;
+    data->selector = nullptr;
+    data->autoLoadSpriteFile = ArmatureDataManager::getInstance()->isAutoLoadSpriteFile();
+
+    // only the path is resolved here, the file is read by a loading thread
+    std::string fileExtension = cocos2d::FileUtils::getInstance()->getFileExtension(filePath);
+    data->fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
+
+    if (fileExtension == ".xml")
+    {
+        data->configType = DragonBone_XML;
+    }
+    else if(fileExtension == ".json" || fileExtension == ".exportjson")
+    {
+        data->configType = CocoStudio_JSON;
+    }
+    else if(fileExtension == ".csb")
+    {
+        data->configType = CocoStudio_Binary;
+    }
+
+    return data;
+}
 
+void DataReaderHelper::pushAsyncStruct(AsyncStruct *asyncStruct)
+{
     // lazy init
     if (_asyncStructQueue == nullptr)
     {
-        _asyncStructQueue = new std::queue<AsyncStruct *>();
+        _asyncStructQueue = new (std::nothrow) std::queue<AsyncStruct *>();
         _dataQueue = new (std::nothrow) std::queue<DataInfo *>();
 
-		// create a new thread to load images
-		_loadingThread = new std::thread(&DataReaderHelper::loadData, this);
-
-        need_quit = false;
+        // created before the loading threads use it
+        DictionaryHelper::getInstance();
     }
 
     if (0 == _asyncRefCount)
@@ -393,53 +495,201 @@ void DataReaderHelper::addDataFromFileAsync(const std::string& imagePath, const
     ++_asyncRefCount;
     ++_asyncRefTotalCount;
 
+    // add async struct into queue
+    _asyncStructQueueMutex.lock();
+    _asyncStructQueue->push(asyncStruct);
+    _asyncStructQueueMutex.unlock();
+
+    // a thread is started for each file queued until there are _loadingThreadCount of them
+    if ((int)_loadingThreads.size() < _loadingThreadCount)
+    {
+        _loadingThreads.push_back(std::thread(&DataReaderHelper::loadData, this));
+    }
+
+    _sleepCondition.notify_one();
+}
+
+void DataReaderHelper::addDataFromFileAsync(const std::string& imagePath, const std::string& plistPath, const std::string& filePath, Ref *target, SEL_SCHEDULE selector)
+{
+    /*
+    * Check if file is already added to ArmatureDataManager, if then return.
+    */
+    for(unsigned int i = 0; i < _configFileList.size(); i++)
+    {
+        if (_configFileList[i] == filePath)
+        {
+            if (target && selector)
+            {
+                if (_asyncRefTotalCount == 0 && _asyncRefCount == 0)
+                {
+                    (target->*selector)(1);
+                }
+                else
+                {
+                    (target->*selector)((_asyncRefTotalCount - _asyncRefCount) / (float)_asyncRefTotalCount);
+                }
+            }
+            return;
+        }
+    }
+
     if (target)
     {
         target->retain();
     }
 
-    // generate async struct
-    AsyncStruct *data = new (std::nothrow) AsyncStruct();
-    data->filename = filePath;
-    data->baseFilePath = basefilePath;
+    AsyncStruct *data = createAsyncStruct(filePath);
     data->target = target;
     data->selector = selector;
-    data->autoLoadSpriteFile = ArmatureDataManager::getInstance()->isAutoLoadSpriteFile();
 
     data->imagePath = imagePath;
     data->plistPath = plistPath;
 
-    std::string fileExtension = cocos2d::FileUtils::getInstance()->getFileExtension(filePath);
-    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
+    pushAsyncStruct(data);
+}
 
-    bool isbinaryfilesrc = fileExtension == ".csb";
+void DataReaderHelper::addDataFromFilesAsync(const std::vector<std::string>& filePaths, const std::function<void(float)>& progressCallback)
+{
+    auto batch = std::make_shared<AsyncBatch>();
+    batch->callback = progressCallback;
+    batch->loadedCount = 0;
+    batch->totalCount = (int)filePaths.size();
 
-    // This only read exportJson file, it takes only a little time.
-    // Large image files are loaded in DataReaderHelper::addDataFromJsonCache(dataInfo) asynchronously.
-    _dataReaderHelper->_getFileMutex.lock();
-    data->fileContent.assign(readFileContent(fullPath, isbinaryfilesrc));
-    _dataReaderHelper->_getFileMutex.unlock();
+    for (const auto& filePath : filePaths)
+    {
+        // the files already added count as loaded
+        if (std::find(_configFileList.begin(), _configFileList.end(), filePath) != _configFileList.end())
+        {
+            ++batch->loadedCount;
+            continue;
+        }
 
-    if (fileExtension == ".xml")
+        AsyncStruct *data = createAsyncStruct(filePath);
+        data->batch = batch;
+        pushAsyncStruct(data);
+    }
+
+    if (batch->loadedCount == batch->totalCount && progressCallback)
     {
-        data->configType = DragonBone_XML;
+        progressCallback(1);
     }
-    else if(fileExtension == ".json" || fileExtension == ".exportjson")
+}
+
+bool DataReaderHelper::findSpriteFiles(DataInfo *dataInfo)
+{
+    AsyncStruct *pAsyncStruct = dataInfo->asyncStruct;
+
+    if (pAsyncStruct->imagePath != "" && pAsyncStruct->plistPath != "")
     {
-        data->configType = CocoStudio_JSON;
+        SpriteFile spriteFile;
+        spriteFile.plistPath = pAsyncStruct->plistPath;
+        spriteFile.imagePath = pAsyncStruct->imagePath;
+        dataInfo->spriteFiles.push_back(spriteFile);
     }
-    else if(isbinaryfilesrc)
+
+    while (!dataInfo->configFileQueue.empty())
     {
-        data->configType = CocoStudio_Binary;
+        std::string configPath = pAsyncStruct->baseFilePath + dataInfo->configFileQueue.front();
+        SpriteFile spriteFile;
+        spriteFile.plistPath = configPath + ".plist";
+        spriteFile.imagePath = configPath + ".png";
+        dataInfo->spriteFiles.push_back(spriteFile);
+        dataInfo->configFileQueue.pop();
     }
 
+    // the paths are resolved on the cocos thread, the file cache of FileUtils isn't thread safe
+    bool queued = false;
+    for (auto& spriteFile : dataInfo->spriteFiles)
+    {
+        if (!SpriteFrameCache::getInstance()->isSpriteFramesWithFileLoaded(spriteFile.plistPath))
+        {
+            spriteFile.fullPlistPath = FileUtils::getInstance()->fullPathForFilename(spriteFile.plistPath);
+            queued = queued || !spriteFile.fullPlistPath.empty();
+        }
+    }
 
-    // add async struct into queue
-    _asyncStructQueueMutex.lock();
-    _asyncStructQueue->push(data);
-    _asyncStructQueueMutex.unlock();
+    if (queued)
+    {
+        _asyncStructQueueMutex.lock();
+        _spriteFileQueue.push(dataInfo);
+        _asyncStructQueueMutex.unlock();
+        _sleepCondition.notify_one();
+    }
+    return queued;
+}
 
-    _sleepCondition.notify_one();
+void DataReaderHelper::readSpriteFiles(DataInfo *dataInfo)
+{
+    for (auto& spriteFile : dataInfo->spriteFiles)
+    {
+        if (!spriteFile.fullPlistPath.empty())
+        {
+            spriteFile.dict = FileUtils::getInstance()->getValueMapFromFile(spriteFile.fullPlistPath);
+        }
+    }
+    dataInfo->spriteFilesRead = true;
+}
+
+void DataReaderHelper::loadSpriteFiles(DataInfo *dataInfo)
+{
+    dataInfo->pendingTextureCount = std::make_shared<int>(0);
+
+    auto fileUtils = FileUtils::getInstance();
+    auto textureCache = Director::getInstance()->getTextureCache();
+    for (auto iter = dataInfo->spriteFiles.begin(); iter != dataInfo->spriteFiles.end(); )
+    {
+        const ValueMap& dict = iter->dict;
+        if (dict.find("particleLifespan") != dict.end())
+        {
+            iter = dataInfo->spriteFiles.erase(iter);
+            continue;
+        }
+
+        // the plists not read have no texture to decode
+        if (dict.empty())
+        {
+            ++iter;
+            continue;
+        }
+
+        std::string fullImagePath = fileUtils->fullPathForFilename(iter->imagePath);
+        if (fullImagePath.empty() || textureCache->getTextureForKey(fullImagePath))
+        {
+            ++iter;
+            continue;
+        }
+
+        // the image is decoded by the loading thread of the TextureCache, in the pixel format of the sprite file
+        const Texture2D::PixelFormat currentPixelFormat = Texture2D::getDefaultAlphaPixelFormat();
+        Texture2D::setDefaultAlphaPixelFormat(getSpriteFilePixelFormat(dict));
+
+        std::shared_ptr<int> pendingTextureCount = dataInfo->pendingTextureCount;
+        ++*pendingTextureCount;
+        textureCache->addImageAsync(fullImagePath, [pendingTextureCount](Texture2D *texture) {
+            --*pendingTextureCount;
+        });
+
+        Texture2D::setDefaultAlphaPixelFormat(currentPixelFormat);
+        ++iter;
+    }
+}
+
+void DataReaderHelper::addSpriteFiles(DataInfo *dataInfo)
+{
+    for (auto& spriteFile : dataInfo->spriteFiles)
+    {
+        _getFileMutex.lock();
+        if (spriteFile.dict.empty())
+        {
+            ArmatureDataManager::getInstance()->addSpriteFrameFromFile(spriteFile.plistPath, spriteFile.imagePath, dataInfo->filename);
+        }
+        else
+        {
+            // the plist read by the loading thread isn't parsed again
+            ArmatureDataManager::getInstance()->addSpriteFrameFromFile(spriteFile.plistPath, spriteFile.imagePath, spriteFile.dict, dataInfo->filename);
+        }
+        _getFileMutex.unlock();
+    }
 }
 
 void DataReaderHelper::addDataAsyncCallBack(float dt)
@@ -447,36 +697,48 @@ void DataReaderHelper::addDataAsyncCallBack(float dt)
     // the data is generated in loading thread
     std::queue<DataInfo *> *dataQueue = _dataQueue;
 
-    _dataInfoMutex.lock();
-    if (dataQueue->empty())
-    {
-        _dataInfoMutex.unlock();
-    }
-    else
+    while (true)
     {
+        _dataInfoMutex.lock();
+        if (dataQueue->empty())
+        {
+            _dataInfoMutex.unlock();
+            break;
+        }
         DataInfo *pDataInfo = dataQueue->front();
         dataQueue->pop();
         _dataInfoMutex.unlock();
 
-        AsyncStruct *pAsyncStruct = pDataInfo->asyncStruct;
+        // the plists of the sprite files are read by a loading thread before their textures are decoded
+        if (!pDataInfo->spriteFilesRead && findSpriteFiles(pDataInfo))
+        {
+            continue;
+        }
 
+        loadSpriteFiles(pDataInfo);
+        _decodingDataInfos.push_back(pDataInfo);
+    }
 
-        if (pAsyncStruct->imagePath != "" && pAsyncStruct->plistPath != "")
+    // the files whose textures are all in the TextureCache
+    std::vector<DataInfo *> loadedDataInfos;
+    for (auto iter = _decodingDataInfos.begin(); iter != _decodingDataInfos.end(); )
+    {
+        if (*(*iter)->pendingTextureCount > 0)
         {
-            _getFileMutex.lock();
-            ArmatureDataManager::getInstance()->addSpriteFrameFromFile(pAsyncStruct->plistPath, pAsyncStruct->imagePath, pDataInfo->filename);
-            _getFileMutex.unlock();
+            ++iter;
         }
-
-        while (!pDataInfo->configFileQueue.empty())
+        else
         {
-            std::string configPath = pDataInfo->configFileQueue.front();
-            _getFileMutex.lock();
-            ArmatureDataManager::getInstance()->addSpriteFrameFromFile((pAsyncStruct->baseFilePath + configPath + ".plist"), (pAsyncStruct->baseFilePath + configPath + ".png"), pDataInfo->filename);
-            _getFileMutex.unlock();
-            pDataInfo->configFileQueue.pop();
+            loadedDataInfos.push_back(*iter);
+            iter = _decodingDataInfos.erase(iter);
         }
+    }
+
+    for (auto pDataInfo : loadedDataInfos)
+    {
+        AsyncStruct *pAsyncStruct = pDataInfo->asyncStruct;
 
+        addSpriteFiles(pDataInfo);
 
         Ref* target = pAsyncStruct->target;
         SEL_SCHEDULE selector = pAsyncStruct->selector;
@@ -486,18 +748,27 @@ void DataReaderHelper::addDataAsyncCallBack(float dt)
         if (target && selector)
         {
             (target->*selector)((_asyncRefTotalCount - _asyncRefCount) / (float)_asyncRefTotalCount);
-            target->release();
         }
+        CC_SAFE_RELEASE(target);
 
+        if (pAsyncStruct->batch)
+        {
+            AsyncBatch& batch = *pAsyncStruct->batch;
+            ++batch.loadedCount;
+            if (batch.callback)
+            {
+                batch.callback(batch.loadedCount / (float)batch.totalCount);
+            }
+        }
 
         delete pAsyncStruct;
         delete pDataInfo;
+    }
 
-        if (0 == _asyncRefCount)
-        {
-            _asyncRefTotalCount = 0;
-            Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(DataReaderHelper::addDataAsyncCallBack), this);
-        }
+    if (0 == _asyncRefCount)
+    {
+        _asyncRefTotalCount = 0;
+        Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(DataReaderHelper::addDataAsyncCallBack), this);
     }
 }
 
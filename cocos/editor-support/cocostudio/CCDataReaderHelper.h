@@ -35,6 +35,9 @@ THE SOFTWARE.
 
 #include <string>
 #include <queue>
+#include <vector>
+#include <memory>
+#include <functional>
 #include <mutex>
 #include <thread>
 #include <condition_variable>
@@ -62,9 +65,18 @@ protected:
         CocoStudio_Binary
     };
 
+    /** Files loaded by one call of addDataFromFilesAsync. */
+    typedef struct _AsyncBatch
+    {
+        std::function<void(float)> callback;
+        int            loadedCount;
+        int            totalCount;
+    } AsyncBatch;
+
     typedef struct _AsyncStruct
     {
         std::string    filename;
+        std::string    fullPath;
         std::string    fileContent;
         ConfigType     configType;
         std::string    baseFilePath;
@@ -74,8 +86,20 @@ protected:
 
         std::string    imagePath;
         std::string    plistPath;
+
+        std::shared_ptr<AsyncBatch> batch;
     } AsyncStruct;
 
+    /** A sprite file of a parsed file, the plist is read by a loading thread. */
+    typedef struct _SpriteFile
+    {
+        std::string    plistPath;
+        std::string    imagePath;
+        /** Empty if the plist isn't read, the sprite frames of the file are already loaded for instance. */
+        std::string    fullPlistPath;
+        cocos2d::ValueMap dict;
+    } SpriteFile;
+
     typedef struct _DataInfo
     {
         AsyncStruct *asyncStruct;
@@ -85,6 +109,10 @@ protected:
         std::string    baseFilePath;
         float flashToolVersion;
         float cocoStudioVersion;
+        /** Textures of the sprite files still decoded by the TextureCache. */
+        std::shared_ptr<int> pendingTextureCount;
+        std::vector<SpriteFile> spriteFiles;
+        bool spriteFilesRead;
     } DataInfo;
 
 public:
@@ -116,6 +144,20 @@ public:
     void addDataFromFile(const std::string& filePath);
     void addDataFromFileAsync(const std::string& imagePath, const std::string& plistPath, const std::string& filePath, cocos2d::Ref *target, cocos2d::SEL_SCHEDULE selector);
 
+    /**
+     * Load several files asynchronously, the loading threads read and parse them while the
+     * TextureCache decodes the images of their sprite files.
+     * progressCallback is called after each file with the part of the files loaded, between 0 and 1.
+     */
+    void addDataFromFilesAsync(const std::vector<std::string>& filePaths, const std::function<void(float)>& progressCallback);
+
+    /**
+     * Set the number of threads parsing the files loaded asynchronously, the threads already
+     * started are kept. By default it is the number of cores minus one, at most 4.
+     */
+    void setLoadingThreadCount(int count);
+    int getLoadingThreadCount() const { return _loadingThreadCount; }
+
     void addDataAsyncCallBack(float dt);
 
     void removeConfigFile(const std::string& configFile);
@@ -195,15 +237,25 @@ public:
     
 protected:
     void loadData();
+    // add filePath to the config file list and return the struct loading it
+    AsyncStruct *createAsyncStruct(const std::string& filePath);
+    void pushAsyncStruct(AsyncStruct *asyncStruct);
+    // look for the sprite files of a parsed file, return true if their plists are queued for the loading threads
+    bool findSpriteFiles(DataInfo *dataInfo);
+    // read the plists of the sprite files, called by a loading thread
+    void readSpriteFiles(DataInfo *dataInfo);
+    // start decoding the textures of the sprite files of a parsed file
+    void loadSpriteFiles(DataInfo *dataInfo);
+    // add the sprite frames of a file whose textures are decoded, called once per file
+    void addSpriteFiles(DataInfo *dataInfo);
 
 
 
 
     std::condition_variable        _sleepCondition;
 
-    std::thread     *_loadingThread;
-
-    std::mutex      _sleepMutex;
+    std::vector<std::thread> _loadingThreads;
+    int             _loadingThreadCount;
 
     std::mutex      _asyncStructQueueMutex;
     std::mutex      _dataInfoMutex;
@@ -220,6 +272,10 @@ protected:
 
     std::queue<AsyncStruct *> *_asyncStructQueue;
     std::queue<DataInfo *>   *_dataQueue;
+    // parsed files whose plists are read by the loading threads, guarded by _asyncStructQueueMutex
+    std::queue<DataInfo *>   _spriteFileQueue;
+    // parsed files waiting for their textures, only used by the cocos thread
+    std::vector<DataInfo *>  _decodingDataInfos;
 
     static std::vector<std::string> _configFileList;
 
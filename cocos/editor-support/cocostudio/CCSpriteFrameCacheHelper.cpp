@@ -99,6 +99,12 @@ void SpriteFrameCacheHelper::addSpriteFrameFromFile(const std::string& plistPath
     retainSpriteFrames(plistPath);
 }
 
+void SpriteFrameCacheHelper::addSpriteFrameFromFile(const std::string& plistPath, const std::string& imagePath, ValueMap& dictionary)
+{
+    SpriteFrameCache::getInstance()->addSpriteFramesWithFile(plistPath, dictionary, imagePath);
+    retainSpriteFrames(plistPath);
+}
+
 SpriteFrameCacheHelper::SpriteFrameCacheHelper()
 {
 }
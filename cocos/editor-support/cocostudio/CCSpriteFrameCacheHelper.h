@@ -25,6 +25,7 @@ THE SOFTWARE.
 #define __CCSPRITEFRAMECACHEHELPER_H__
 
 #include "platform/CCPlatformMacros.h"
+#include "base/CCValue.h"
 #include "editor-support/cocostudio/CCArmatureDefine.h"
 #include "editor-support/cocostudio/CocosStudioExport.h"
 #include <string>
@@ -56,6 +57,10 @@ public:
      *    @brief    Add sprite frame to CCSpriteFrameCache, it will save display name and it's relative image name
      */
     void addSpriteFrameFromFile(const std::string& plistPath, const std::string& imagePath);
+    /**
+     *    @brief    Add sprite frame to CCSpriteFrameCache from the content of the plist file, read beforehand
+     */
+    void addSpriteFrameFromFile(const std::string& plistPath, const std::string& imagePath, cocos2d::ValueMap& dictionary);
     void removeSpriteFrameFromFile(const std::string& plistPath);
 
 private:
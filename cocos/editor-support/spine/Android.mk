@@ -33,8 +33,10 @@ RegionAttachment.c \
 Skeleton.c \
 SkeletonAnimation.cpp \
 SkeletonBatch.cpp \
+SkeletonBinary.c \
 SkeletonBounds.c \
 SkeletonData.c \
+SkeletonDataCache.cpp \
 SkeletonJson.c \
 SkeletonRenderer.cpp \
 Skin.c \
@@ -30,6 +30,7 @@
  *****************************************************************************/
 
 #include <spine/SkeletonAnimation.h>
+#include <spine/SkeletonBatch.h>
 #include <spine/spine-cocos2dx.h>
 #include <spine/extension.h>
 #include <algorithm>
@@ -42,11 +43,19 @@ using std::vector;
 namespace spine {
 
 void animationCallback (spAnimationState* state, int trackIndex, spEventType type, spEvent* event, int loopCount) {
-	((SkeletonAnimation*)state->rendererObject)->onAnimationStateEvent(trackIndex, type, event, loopCount);
+	SkeletonAnimation* animation = (SkeletonAnimation*)state->rendererObject;
+	if (animation->_queueEvents)
+		animation->_queuedEvents.push_back({state->tracks[trackIndex], trackIndex, type, event, loopCount, false});
+	else
+		animation->onAnimationStateEvent(trackIndex, type, event, loopCount);
 }
 
 void trackEntryCallback (spAnimationState* state, int trackIndex, spEventType type, spEvent* event, int loopCount) {
-	((SkeletonAnimation*)state->rendererObject)->onTrackEntryEvent(trackIndex, type, event, loopCount);
+	SkeletonAnimation* animation = (SkeletonAnimation*)state->rendererObject;
+	if (animation->_queueEvents)
+		animation->_queuedEvents.push_back({state->tracks[trackIndex], trackIndex, type, event, loopCount, true});
+	else
+		animation->onTrackEntryEvent(trackIndex, type, event, loopCount);
 }
 
 typedef struct _TrackEntryListeners {
@@ -100,21 +109,21 @@ void SkeletonAnimation::initialize () {
 }
 
 SkeletonAnimation::SkeletonAnimation ()
-		: SkeletonRenderer() {
+		: SkeletonRenderer(), _queueEvents(false) {
 }
 
 SkeletonAnimation::SkeletonAnimation (spSkeletonData *skeletonData, bool ownsSkeletonData)
-		: SkeletonRenderer(skeletonData, ownsSkeletonData) {
+		: SkeletonRenderer(skeletonData, ownsSkeletonData), _queueEvents(false) {
 	initialize();
 }
 
 SkeletonAnimation::SkeletonAnimation (const std::string& skeletonDataFile, spAtlas* atlas, float scale)
-		: SkeletonRenderer(skeletonDataFile, atlas, scale) {
+		: SkeletonRenderer(skeletonDataFile, atlas, scale), _queueEvents(false) {
 	initialize();
 }
 
 SkeletonAnimation::SkeletonAnimation (const std::string& skeletonDataFile, const std::string& atlasFile, float scale)
-		: SkeletonRenderer(skeletonDataFile, atlasFile, scale) {
+		: SkeletonRenderer(skeletonDataFile, atlasFile, scale), _queueEvents(false) {
 	initialize();
 }
 
@@ -128,10 +137,31 @@ void SkeletonAnimation::update (float deltaTime) {
 
 	deltaTime *= _timeScale;
 	spAnimationState_update(_state, deltaTime);
+	if (SkeletonBatch::getInstance()->deferAnimation(this)) return;
 	spAnimationState_apply(_state, _skeleton);
 	spSkeleton_updateWorldTransform(_skeleton);
 }
 
+void SkeletonAnimation::applyAnimation () {
+	_queueEvents = true;
+	spAnimationState_apply(_state, _skeleton);
+	spSkeleton_updateWorldTransform(_skeleton);
+	_queueEvents = false;
+}
+
+void SkeletonAnimation::dispatchQueuedEvents () {
+	for (size_t i = 0; i < _queuedEvents.size(); ++i) {
+		_QueuedEvent queued = _queuedEvents[i];
+		// Like spAnimationState_apply, the events left are dropped once a listener replaced the entry of the track.
+		if (spAnimationState_getCurrent(_state, queued.trackIndex) != queued.entry) continue;
+		if (queued.trackEntryEvent)
+			onTrackEntryEvent(queued.trackIndex, queued.type, queued.event, queued.loopCount);
+		else
+			onAnimationStateEvent(queued.trackIndex, queued.type, queued.event, queued.loopCount);
+	}
+	_queuedEvents.clear();
+}
+
 void SkeletonAnimation::setAnimationStateData (spAnimationStateData* stateData) {
 	CCASSERT(stateData, "stateData cannot be null.");
 
@@ -46,6 +46,10 @@ typedef std::function<void(int trackIndex, spEvent* event)> EventListener;
 /** Draws an animated skeleton, providing an AnimationState for applying one or more animations and queuing animations to be
   * played later. */
 class SkeletonAnimation: public SkeletonRenderer {
+	friend class SkeletonBatch;
+	friend void animationCallback (spAnimationState* state, int trackIndex, spEventType type, spEvent* event, int loopCount);
+	friend void trackEntryCallback (spAnimationState* state, int trackIndex, spEventType type, spEvent* event, int loopCount);
+
 public:
 	CREATE_FUNC(SkeletonAnimation);
 	static SkeletonAnimation* createWithData (spSkeletonData* skeletonData, bool ownsSkeletonData = false);
@@ -88,6 +92,11 @@ CC_CONSTRUCTOR_ACCESS:
 	void initialize ();
 
 protected:
+	/* Applies the animation state and updates the world transform, the events are queued. Called on a worker by SkeletonBatch. */
+	void applyAnimation ();
+	/* Dispatches the events queued by applyAnimation. */
+	void dispatchQueuedEvents ();
+
 	spAnimationState* _state;
 
 	bool _ownsAnimationStateData;
@@ -97,6 +106,17 @@ protected:
 	CompleteListener _completeListener;
 	EventListener _eventListener;
 
+	typedef struct _QueuedEvent {
+		spTrackEntry* entry;
+		int trackIndex;
+		spEventType type;
+		spEvent* event;
+		int loopCount;
+		bool trackEntryEvent;
+	} _QueuedEvent;
+	bool _queueEvents;
+	std::vector<_QueuedEvent> _queuedEvents;
+
 private:
 	typedef SkeletonRenderer super;
 };
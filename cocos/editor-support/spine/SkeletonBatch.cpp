@@ -30,15 +30,20 @@
  *****************************************************************************/
 
 #include <spine/SkeletonBatch.h>
+#include <spine/SkeletonAnimation.h>
 #include <spine/extension.h>
 #include <algorithm>
+#include <cfloat>
 
 USING_NS_CC;
-#define EVENT_AFTER_DRAW_RESET_POSITION "director_after_draw"
 using std::max;
 
 namespace spine {
 
+/* Number of skeletons given at once to a worker, applying an animation or computing the vertices of a skeleton takes a few
+ * tens of microseconds. */
+static const int JOB_GRAIN_SIZE = 4;
+
 static SkeletonBatch* instance = nullptr;
 
 void SkeletonBatch::setBufferSize (int vertexCount) {
@@ -52,19 +57,48 @@ SkeletonBatch* SkeletonBatch::getInstance () {
 }
 
 SkeletonBatch::SkeletonBatch (int capacity) :
-	_capacity(capacity), _position(0)
+	_vertices(capacity), _indices(capacity * 6 / 4), _commandCount(0), _lastCommandCount(0),
+	_parallel(false), _deferAnimations(false), _deferVertices(false), _computeVerticesQueued(false)
 {
-	_buffer = new V3F_C4B_T2F[capacity];
 	_firstCommand = new Command();
 	_command = _firstCommand;
 
-    Director::getInstance()->getEventDispatcher()->addCustomEventListener(EVENT_AFTER_DRAW_RESET_POSITION, [this](EventCustom* eventCustom){
-        this->update(0);
-    });;
+	// Scene::render renders each camera right after visiting it, the vertices drawn during a visit are computed first thing of
+	// its render. The lowest global Z order of the main queue is processed before the triangles of every queue and group.
+	_computeVerticesCommand.init(-FLT_MAX);
+	_computeVerticesCommand.func = [this] () {
+		this->computeVertices();
+	};
+
+	EventDispatcher* dispatcher = Director::getInstance()->getEventDispatcher();
+	_beforeUpdateListener = dispatcher->addCustomEventListener(Director::EVENT_BEFORE_UPDATE, [this](EventCustom* eventCustom){
+		_deferAnimations = _parallel;
+	});
+	_afterUpdateListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_UPDATE, [this](EventCustom* eventCustom){
+		this->applyAnimations();
+		_deferVertices = _parallel;
+	});
+	_afterVisitListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_VISIT, [this](EventCustom* eventCustom){
+		// The scene was rendered, the skeletons drawn by the notification node are computed when they are drawn.
+		_deferVertices = false;
+		this->computeVertices();
+	});
+	_afterDrawListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_DRAW, [this](EventCustom* eventCustom){
+		this->update(0);
+	});
 }
 
 SkeletonBatch::~SkeletonBatch () {
-	Director::getInstance()->getEventDispatcher()->removeCustomEventListeners(EVENT_AFTER_DRAW_RESET_POSITION);
+	EventDispatcher* dispatcher = Director::getInstance()->getEventDispatcher();
+	dispatcher->removeEventListener(_beforeUpdateListener);
+	dispatcher->removeEventListener(_afterUpdateListener);
+	dispatcher->removeEventListener(_afterVisitListener);
+	dispatcher->removeEventListener(_afterDrawListener);
+
+	for (auto animation : _animations)
+		animation->release();
+	for (auto& job : _verticesJobs)
+		job.renderer->release();
 
 	Command* command = _firstCommand;
 	while (command) {
@@ -72,51 +106,177 @@ SkeletonBatch::~SkeletonBatch () {
 		delete command;
 		command = next;
 	}
-
-	delete [] _buffer;
 }
 
 void SkeletonBatch::update (float delta) {
-	_position = 0;
+	_vertices.reset();
+	_indices.reset();
+	_lastCommandCount = _commandCount;
+	_commandCount = 0;
 	_command = _firstCommand;
 }
 
+V3F_C4B_T2F* SkeletonBatch::reserveVertices (int vertexCount) {
+	return _vertices.reserve(vertexCount);
+}
+
+unsigned short* SkeletonBatch::reserveIndices (int indexCount) {
+	return _indices.reserve(indexCount);
+}
+
 void SkeletonBatch::addCommand (cocos2d::Renderer* renderer, float globalZOrder, GLuint textureID, GLProgramState* glProgramState,
 	BlendFunc blendFunc, const TrianglesCommand::Triangles& triangles, const Mat4& transform, uint32_t transformFlags
 ) {
-	if (_position + triangles.vertCount > _capacity) {
-		int newCapacity = max(_capacity + _capacity / 2, _position + triangles.vertCount);
-		V3F_C4B_T2F* newBuffer = new V3F_C4B_T2F[newCapacity];
-		memcpy(newBuffer, _buffer, _position);
-
-		int newPosition = 0;
-		Command* command = _firstCommand;
-		while (newPosition < _position) {
-			command->triangles->verts = newBuffer + newPosition;
-			newPosition += command->triangles->vertCount;
-			command = command->next;
-		}
+	V3F_C4B_T2F* vertices = reserveVertices(triangles.vertCount);
+	memcpy(vertices, triangles.verts, sizeof(V3F_C4B_T2F) * triangles.vertCount);
 
-		delete [] _buffer;
-		_buffer = newBuffer;
-		_capacity = newCapacity;
-	}
-
-	memcpy(_buffer + _position, triangles.verts, sizeof(V3F_C4B_T2F) * triangles.vertCount);
-	_command->triangles->verts = _buffer + _position;
-	_position += triangles.vertCount;
+	TrianglesCommand::Triangles reserved = triangles;
+	reserved.verts = vertices;
+	addReservedCommand(renderer, globalZOrder, textureID, glProgramState, blendFunc, reserved, transform, transformFlags);
+}
 
+void SkeletonBatch::addReservedCommand (cocos2d::Renderer* renderer, float globalZOrder, GLuint textureID, GLProgramState* glProgramState,
+	BlendFunc blendFunc, const TrianglesCommand::Triangles& triangles, const Mat4& transform, uint32_t transformFlags
+) {
+	_command->triangles->verts = triangles.verts;
 	_command->triangles->vertCount = triangles.vertCount;
 	_command->triangles->indexCount = triangles.indexCount;
 	_command->triangles->indices = triangles.indices;
 
 	_command->trianglesCommand->init(globalZOrder, textureID, glProgramState, blendFunc, *_command->triangles, transform, transformFlags);
+	// A pooled command keeps skipping batching once it was used with a GLProgramState having uniforms.
+	_command->trianglesCommand->setSkipBatching(glProgramState->getUniformCount() > 0);
 	renderer->addCommand(_command->trianglesCommand);
+	_commandCount++;
 
 	if (!_command->next) _command->next = new Command();
 	_command = _command->next;
 }
 
+void SkeletonBatch::setParallelEnabled (bool enabled) {
+	_parallel = enabled;
+}
+
+bool SkeletonBatch::isParallelEnabled () const {
+	return _parallel;
+}
+
+int SkeletonBatch::getCommandCount () const {
+	return _lastCommandCount;
+}
+
+bool SkeletonBatch::deferAnimation (SkeletonAnimation* animation) {
+	// Only the updates done by the scheduler are deferred, the animation is applied before anything else reads the bones.
+	if (!_deferAnimations) return false;
+	animation->retain();
+	_animations.push_back(animation);
+	return true;
+}
+
+bool SkeletonBatch::deferVertices (Renderer* renderer, SkeletonRenderer* skeleton, V3F_C4B_T2F* vertices, int vertexCount) {
+	// Only the skeletons drawn while the scene is visited are deferred, the vertices are computed before the pass is rendered.
+	if (!_deferVertices) return false;
+
+	// The jobs of a skeleton would share its world vertices, a skeleton drawn again in the pass copies the first vertices.
+	auto found = _verticesJobRenderers.find(skeleton);
+	if (found != _verticesJobRenderers.end()) {
+		_verticesCopies.push_back({found->second, vertices, vertexCount});
+		return true;
+	}
+
+	skeleton->retain();
+	_verticesJobs.push_back({skeleton, vertices, vertexCount});
+	_verticesJobRenderers[skeleton] = vertices;
+
+	if (!_computeVerticesQueued) {
+		renderer->addCommand(&_computeVerticesCommand, 0);
+		_computeVerticesQueued = true;
+	}
+	return true;
+}
+
+void SkeletonBatch::applyAnimations () {
+	_deferAnimations = false;
+	if (_animations.empty()) return;
+
+	// Each skeleton only writes its own bones and slots, the skeleton data is shared read only.
+	std::vector<SkeletonAnimation*>& animations = _animations;
+	WorkerPool::getInstance()->parallelFor((int)animations.size(), JOB_GRAIN_SIZE, [&animations] (int begin, int end) {
+		for (int i = begin; i < end; ++i)
+			animations[i]->applyAnimation();
+	});
+
+	// The listeners may change the animation state, they are called on this thread once all the animations were applied.
+	for (auto animation : _animations) {
+		animation->dispatchQueuedEvents();
+		animation->release();
+	}
+	_animations.clear();
+}
+
+void SkeletonBatch::computeVertices () {
+	_computeVerticesQueued = false;
+	if (_verticesJobs.empty()) return;
+
+	std::vector<VerticesJob>& jobs = _verticesJobs;
+	WorkerPool::getInstance()->parallelFor((int)jobs.size(), JOB_GRAIN_SIZE, [&jobs] (int begin, int end) {
+		for (int i = begin; i < end; ++i)
+			jobs[i].renderer->computeVertices(jobs[i].vertices);
+	});
+
+	for (auto& copy : _verticesCopies)
+		memcpy(copy.target, copy.source, sizeof(V3F_C4B_T2F) * copy.vertexCount);
+	_verticesCopies.clear();
+
+	for (auto& job : _verticesJobs)
+		job.renderer->release();
+	_verticesJobs.clear();
+	_verticesJobRenderers.clear();
+}
+
+template <typename T> SkeletonBatch::FrameBuffer<T>::FrameBuffer (int capacity) :
+	_capacity(capacity), _position(0), _fullBuffersPosition(0)
+{
+	_buffer = new T[capacity];
+}
+
+template <typename T> SkeletonBatch::FrameBuffer<T>::~FrameBuffer () {
+	for (auto buffer : _fullBuffers)
+		delete [] buffer;
+	delete [] _buffer;
+}
+
+template <typename T> T* SkeletonBatch::FrameBuffer<T>::reserve (int count) {
+	if (_position + count > _capacity) {
+		// The commands already added point into the buffer, it is kept until the end of the frame.
+		_fullBuffers.push_back(_buffer);
+		_fullBuffersPosition += _position;
+		_capacity = max(_capacity + _capacity / 2, count);
+		_buffer = new T[_capacity];
+		_position = 0;
+	}
+
+	T* data = _buffer + _position;
+	_position += count;
+	return data;
+}
+
+template <typename T> void SkeletonBatch::FrameBuffer<T>::reset () {
+	if (!_fullBuffers.empty()) {
+		int capacity = _fullBuffersPosition + _position;
+		for (auto buffer : _fullBuffers)
+			delete [] buffer;
+		_fullBuffers.clear();
+		if (capacity > _capacity) {
+			delete [] _buffer;
+			_buffer = new T[capacity];
+			_capacity = capacity;
+		}
+	}
+	_fullBuffersPosition = 0;
+	_position = 0;
+}
+
 SkeletonBatch::Command::Command () :
 	next(nullptr)
 {
@@ -34,14 +34,18 @@
 
 #include <spine/spine.h>
 #include "cocos2d.h"
+#include <unordered_map>
 
 namespace spine {
 
+class SkeletonRenderer;
+class SkeletonAnimation;
+
 class SkeletonBatch {
 public:
 	/* Sets the max number of vertices that can be drawn in a single frame. The buffer will grow automatically as needed, but
 	 * setting it to the appropriate is more efficient. Best to call before getInstance is called for the first time. Default is
-	 * 8192. */
+	 * 8192. The index buffer is sized for quads, 6 indices for 4 vertices. */
 	static void setBufferSize (int vertexCount);
 
 	static SkeletonBatch* getInstance ();
@@ -51,13 +55,91 @@ public:
 	void addCommand (cocos2d::Renderer* renderer, float globalOrder, GLuint textureID, cocos2d::GLProgramState* glProgramState,
 		cocos2d::BlendFunc blendType, const cocos2d::TrianglesCommand:: Triangles& triangles, const cocos2d::Mat4& mv, uint32_t flags);
 
+	/* Returns vertexCount vertices of the buffer of the frame. They are not moved until the end of the frame, so they can be
+	 * filled after the commands using them were added. */
+	cocos2d::V3F_C4B_T2F* reserveVertices (int vertexCount);
+
+	/* Returns indexCount indices of the buffer of the frame, not moved until the end of the frame either. */
+	unsigned short* reserveIndices (int indexCount);
+
+	/* Adds a command for triangles whose vertices were returned by reserveVertices, the vertices are not copied. The material ID
+	 * only depends on the texture, the shader and the blending, not on the skeleton, so the commands of the skeletons sharing an
+	 * atlas are batched by the renderer as long as their GLProgramState has no uniforms. */
+	void addReservedCommand (cocos2d::Renderer* renderer, float globalOrder, GLuint textureID, cocos2d::GLProgramState* glProgramState,
+		cocos2d::BlendFunc blendType, const cocos2d::TrianglesCommand:: Triangles& triangles, const cocos2d::Mat4& mv, uint32_t flags);
+
+	/* When enabled, the animations of the skeletons updated by the scheduler are applied after all the updates, and the vertices
+	 * of the skeletons drawn by the scene are computed before each camera renders them, both in parallel on the WorkerPool. The
+	 * commands are still added in the order the skeletons are drawn. The animation events are dispatched after all the
+	 * animations were applied, in the order the skeletons were updated. Default is false. */
+	void setParallelEnabled (bool enabled);
+	bool isParallelEnabled () const;
+
+	/* Returns true if the animation will be applied with the others of the frame, false if it must be applied now. */
+	bool deferAnimation (SkeletonAnimation* animation);
+	/* Returns true if the vertices will be computed with the others of the render pass, false if they must be computed now. */
+	bool deferVertices (cocos2d::Renderer* renderer, SkeletonRenderer* skeleton, cocos2d::V3F_C4B_T2F* vertices, int vertexCount);
+
+	/* Returns the number of commands added during the last frame. */
+	int getCommandCount () const;
+
 protected:
 	SkeletonBatch (int capacity);
 	virtual ~SkeletonBatch ();
 
-	cocos2d::V3F_C4B_T2F* _buffer;
-	int _capacity;
-	int _position;
+	void applyAnimations ();
+	void computeVertices ();
+
+	/* Storage for the vertices or the indices of a frame. */
+	template <typename T> class FrameBuffer {
+	public:
+		FrameBuffer (int capacity);
+		~FrameBuffer ();
+
+		T* reserve (int count);
+		/* Called at the end of the frame, grows the buffer so that the next frame fits in it. */
+		void reset ();
+
+	private:
+		T* _buffer;
+		int _capacity;
+		int _position;
+		/* The buffers filled before _buffer during the frame, deleted at the end of the frame. */
+		std::vector<T*> _fullBuffers;
+		int _fullBuffersPosition;
+	};
+
+	FrameBuffer<cocos2d::V3F_C4B_T2F> _vertices;
+	FrameBuffer<unsigned short> _indices;
+	int _commandCount;
+	int _lastCommandCount;
+
+	bool _parallel;
+	bool _deferAnimations;
+	bool _deferVertices;
+	std::vector<SkeletonAnimation*> _animations;
+	struct VerticesJob {
+		SkeletonRenderer* renderer;
+		cocos2d::V3F_C4B_T2F* vertices;
+		int vertexCount;
+	};
+	std::vector<VerticesJob> _verticesJobs;
+	/* A skeleton drawn several times in a pass is computed once, its other ranges are copies. */
+	struct VerticesCopy {
+		cocos2d::V3F_C4B_T2F* source;
+		cocos2d::V3F_C4B_T2F* target;
+		int vertexCount;
+	};
+	std::vector<VerticesCopy> _verticesCopies;
+	std::unordered_map<SkeletonRenderer*, cocos2d::V3F_C4B_T2F*> _verticesJobRenderers;
+	/* Added to the main queue before any other command of the pass, computes the deferred vertices. */
+	cocos2d::CustomCommand _computeVerticesCommand;
+	bool _computeVerticesQueued;
+
+	cocos2d::EventListenerCustom* _beforeUpdateListener;
+	cocos2d::EventListenerCustom* _afterUpdateListener;
+	cocos2d::EventListenerCustom* _afterVisitListener;
+	cocos2d::EventListenerCustom* _afterDrawListener;
 
 	class Command {
 	public:
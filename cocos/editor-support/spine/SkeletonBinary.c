@@ -0,0 +1,1213 @@
+/******************************************************************************
+ * Spine Runtimes Software License
+ * Version 2.3
+ * 
+ * Copyright (c) 2013-2015, Esoteric Software
+ * All rights reserved.
+ * 
+ * You are granted a perpetual, non-exclusive, non-sublicensable and
+ * non-transferable license to use, install, execute and perform the Spine
+ * Runtimes Software (the "Software") and derivative works solely for personal
+ * or internal use. Without the written permission of Esoteric Software (see
+ * Section 2 of the Spine Software License Agreement), you may not (a) modify,
+ * translate, adapt or otherwise create derivative works, improvements of the
+ * Software or develop new applications using the Software or (b) remove,
+ * delete, alter or obscure any trademarks or any copyright, trademark, patent
+ * or other intellectual property or proprietary rights notices on or in the
+ * Software, including any copy thereof. Redistributions in binary or source
+ * form must include this license and terms.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ESOTERIC SOFTWARE "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ESOTERIC SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#include <spine/SkeletonBinary.h>
+#include <stdio.h>
+#include <spine/extension.h>
+#include <spine/AtlasAttachmentLoader.h>
+#include <spine/Animation.h>
+
+/* Timeline types, as written by the Spine editor. */
+#define BONE_ROTATE 0
+#define BONE_TRANSLATE 1
+#define BONE_SCALE 2
+#define BONE_SHEAR 3
+
+#define SLOT_ATTACHMENT 0
+#define SLOT_COLOR 1
+
+#define PATH_POSITION 0
+#define PATH_SPACING 1
+#define PATH_MIX 2
+
+#define CURVE_LINEAR 0
+#define CURVE_STEPPED 1
+#define CURVE_BEZIER 2
+
+typedef struct {
+	const unsigned char* cursor;
+	const unsigned char* end;
+	int/*bool*/overflow;
+} _dataInput;
+
+typedef struct {
+	char* parent;
+	char* skin;
+	int slotIndex;
+	spMeshAttachment* mesh;
+} _spLinkedMesh;
+
+typedef struct {
+	spSkeletonBinary super;
+	int ownsLoader;
+
+	int linkedMeshCount;
+	int linkedMeshCapacity;
+	_spLinkedMesh* linkedMeshes;
+} _spSkeletonBinary;
+
+spSkeletonBinary* spSkeletonBinary_createWithLoader (spAttachmentLoader* attachmentLoader) {
+	spSkeletonBinary* self = SUPER(NEW(_spSkeletonBinary));
+	self->scale = 1;
+	self->attachmentLoader = attachmentLoader;
+	return self;
+}
+
+spSkeletonBinary* spSkeletonBinary_create (spAtlas* atlas) {
+	spAtlasAttachmentLoader* attachmentLoader = spAtlasAttachmentLoader_create(atlas);
+	spSkeletonBinary* self = spSkeletonBinary_createWithLoader(SUPER(attachmentLoader));
+	SUB_CAST(_spSkeletonBinary, self)->ownsLoader = 1;
+	return self;
+}
+
+static void _spSkeletonBinary_clearLinkedMeshes (spSkeletonBinary* self) {
+	int i;
+	_spSkeletonBinary* internal = SUB_CAST(_spSkeletonBinary, self);
+	for (i = 0; i < internal->linkedMeshCount; ++i) {
+		FREE(internal->linkedMeshes[i].parent);
+		FREE(internal->linkedMeshes[i].skin);
+	}
+	internal->linkedMeshCount = 0;
+}
+
+void spSkeletonBinary_dispose (spSkeletonBinary* self) {
+	_spSkeletonBinary* internal = SUB_CAST(_spSkeletonBinary, self);
+	if (internal->ownsLoader) spAttachmentLoader_dispose(self->attachmentLoader);
+	_spSkeletonBinary_clearLinkedMeshes(self);
+	FREE(internal->linkedMeshes);
+	FREE(self->error);
+	FREE(self);
+}
+
+static void _spSkeletonBinary_setError (spSkeletonBinary* self, const char* value1, const char* value2) {
+	char message[256];
+	int length;
+	FREE(self->error);
+	strcpy(message, value1);
+	length = (int)strlen(value1);
+	if (value2) strncat(message + length, value2, 255 - length);
+	MALLOC_STR(self->error, message);
+}
+
+/* The values are big endian, the counts and indices are variable length integers. */
+
+static unsigned char readByte (_dataInput* input) {
+	if (input->cursor >= input->end) {
+		input->overflow = 1;
+		return 0;
+	}
+	return *input->cursor++;
+}
+
+static signed char readSByte (_dataInput* input) {
+	return (signed char)readByte(input);
+}
+
+static int readBoolean (_dataInput* input) {
+	return readByte(input) != 0;
+}
+
+static int readInt (_dataInput* input) {
+	unsigned int result = readByte(input);
+	result <<= 8;
+	result |= readByte(input);
+	result <<= 8;
+	result |= readByte(input);
+	result <<= 8;
+	result |= readByte(input);
+	return (int)result;
+}
+
+static int readVarint (_dataInput* input, int/*bool*/optimizePositive) {
+	unsigned char b = readByte(input);
+	unsigned int value = b & 0x7F;
+	if (b & 0x80) {
+		b = readByte(input);
+		value |= (unsigned int)(b & 0x7F) << 7;
+		if (b & 0x80) {
+			b = readByte(input);
+			value |= (unsigned int)(b & 0x7F) << 14;
+			if (b & 0x80) {
+				b = readByte(input);
+				value |= (unsigned int)(b & 0x7F) << 21;
+				if (b & 0x80) value |= (unsigned int)readByte(input) << 28;
+			}
+		}
+	}
+	if (!optimizePositive) value = (value >> 1) ^ (0u - (value & 1));
+	return (int)value;
+}
+
+/* Returns 0 if the count doesn't fit in the remaining data, each element taking at least one byte. */
+static int readCount (_dataInput* input) {
+	int count = readVarint(input, 1);
+	if (count < 0 || count > input->end - input->cursor) {
+		input->overflow = 1;
+		input->cursor = input->end;
+		return 0;
+	}
+	return count;
+}
+
+/* Returns -1 if the index is not less than count. */
+static int readIndex (_dataInput* input, int count) {
+	int index = readVarint(input, 1);
+	if (index < 0 || index >= count) {
+		input->overflow = 1;
+		return -1;
+	}
+	return index;
+}
+
+static float readFloat (_dataInput* input) {
+	union {
+		int intValue;
+		float floatValue;
+	} intToFloat;
+	intToFloat.intValue = readInt(input);
+	return intToFloat.floatValue;
+}
+
+/* Returns 0 for a null string. */
+static char* readString (_dataInput* input) {
+	char* string;
+	int length = readVarint(input, 1);
+	if (length == 0) return 0;
+	--length;
+	if (length < 0 || length > input->end - input->cursor) {
+		input->overflow = 1;
+		input->cursor = input->end;
+		return 0;
+	}
+	string = MALLOC(char, length + 1);
+	memcpy(string, input->cursor, length);
+	string[length] = '\0';
+	input->cursor += length;
+	return string;
+}
+
+static void readColor (_dataInput* input, float* r, float* g, float* b, float* a) {
+	*r = readByte(input) / (float)255;
+	*g = readByte(input) / (float)255;
+	*b = readByte(input) / (float)255;
+	*a = readByte(input) / (float)255;
+}
+
+static float* readFloatArray (_dataInput* input, int length, float scale) {
+	int i;
+	float* array = MALLOC(float, length);
+	if (scale == 1) {
+		for (i = 0; i < length; ++i)
+			array[i] = readFloat(input);
+	} else {
+		for (i = 0; i < length; ++i)
+			array[i] = readFloat(input) * scale;
+	}
+	return array;
+}
+
+static unsigned short* readShortArray (_dataInput* input, int* length) {
+	int i;
+	unsigned short* array;
+	*length = readCount(input);
+	array = MALLOC(unsigned short, *length);
+	for (i = 0; i < *length; ++i) {
+		array[i] = (unsigned short)(readByte(input) << 8);
+		array[i] |= readByte(input);
+	}
+	return array;
+}
+
+static void readCurve (_dataInput* input, spCurveTimeline* timeline, int frameIndex) {
+	switch (readByte(input)) {
+	case CURVE_STEPPED:
+		spCurveTimeline_setStepped(timeline, frameIndex);
+		break;
+	case CURVE_BEZIER: {
+		float cx1 = readFloat(input);
+		float cy1 = readFloat(input);
+		float cx2 = readFloat(input);
+		float cy2 = readFloat(input);
+		spCurveTimeline_setCurve(timeline, frameIndex, cx1, cy1, cx2, cy2);
+		break;
+	}
+	}
+}
+
+static void _spSkeletonBinary_addLinkedMesh (spSkeletonBinary* self, spMeshAttachment* mesh, char* skin, int slotIndex, char* parent) {
+	_spLinkedMesh* linkedMesh;
+	_spSkeletonBinary* internal = SUB_CAST(_spSkeletonBinary, self);
+
+	if (internal->linkedMeshCount == internal->linkedMeshCapacity) {
+		_spLinkedMesh* linkedMeshes;
+		internal->linkedMeshCapacity *= 2;
+		if (internal->linkedMeshCapacity < 8) internal->linkedMeshCapacity = 8;
+		linkedMeshes = MALLOC(_spLinkedMesh, internal->linkedMeshCapacity);
+		if (internal->linkedMeshCount) memcpy(linkedMeshes, internal->linkedMeshes, sizeof(_spLinkedMesh) * internal->linkedMeshCount);
+		FREE(internal->linkedMeshes);
+		internal->linkedMeshes = linkedMeshes;
+	}
+
+	linkedMesh = internal->linkedMeshes + internal->linkedMeshCount++;
+	linkedMesh->mesh = mesh;
+	linkedMesh->skin = skin;
+	linkedMesh->slotIndex = slotIndex;
+	linkedMesh->parent = parent;
+}
+
+typedef struct {
+	int count;
+	int capacity;
+	spTimeline** timelines;
+} _spTimelineArray;
+
+static void _spTimelineArray_add (_spTimelineArray* self, spTimeline* timeline) {
+	if (self->count == self->capacity) {
+		spTimeline** timelines;
+		self->capacity *= 2;
+		if (self->capacity < 8) self->capacity = 8;
+		timelines = MALLOC(spTimeline*, self->capacity);
+		if (self->count) memcpy(timelines, self->timelines, sizeof(spTimeline*) * self->count);
+		FREE(self->timelines);
+		self->timelines = timelines;
+	}
+	self->timelines[self->count++] = timeline;
+}
+
+static spAnimation* _spSkeletonBinary_readAnimation (spSkeletonBinary* self, const char* name, _dataInput* input,
+		spSkeletonData* skeletonData) {
+	int i, ii, iii, n, nn, nnn, frameIndex;
+	float duration = 0;
+	spAnimation* animation;
+	_spTimelineArray timelines = {0, 0, 0};
+
+	/* Slot timelines. */
+	for (i = 0, n = readCount(input); i < n; ++i) {
+		int slotIndex = readIndex(input, skeletonData->slotsCount);
+		if (slotIndex < 0) goto invalid;
+		for (ii = 0, nn = readCount(input); ii < nn; ++ii) {
+			unsigned char timelineType = readByte(input);
+			int frameCount = readCount(input);
+			if (frameCount == 0) goto invalid;
+			switch (timelineType) {
+			case SLOT_COLOR: {
+				spColorTimeline* timeline = spColorTimeline_create(frameCount);
+				timeline->slotIndex = slotIndex;
+				for (frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+					float r, g, b, a;
+					float time = readFloat(input);
+					readColor(input, &r, &g, &b, &a);
+					spColorTimeline_setFrame(timeline, frameIndex, time, r, g, b, a);
+					if (frameIndex < frameCount - 1) readCurve(input, SUPER(timeline), frameIndex);
+				}
+				_spTimelineArray_add(&timelines, SUPER_CAST(spTimeline, timeline));
+				duration = MAX(duration, timeline->frames[(frameCount - 1) * COLOR_ENTRIES]);
+				break;
+			}
+			case SLOT_ATTACHMENT: {
+				spAttachmentTimeline* timeline = spAttachmentTimeline_create(frameCount);
+				timeline->slotIndex = slotIndex;
+				for (frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+					float time = readFloat(input);
+					char* attachmentName = readString(input);
+					spAttachmentTimeline_setFrame(timeline, frameIndex, time, attachmentName);
+					FREE(attachmentName);
+				}
+				_spTimelineArray_add(&timelines, SUPER_CAST(spTimeline, timeline));
+				duration = MAX(duration, timeline->frames[frameCount - 1]);
+				break;
+			}
+			default:
+				_spSkeletonBinary_setError(self, "Invalid timeline type for a slot: ", skeletonData->slots[slotIndex]->name);
+				goto error;
+			}
+		}
+	}
+
+	/* Bone timelines. */
+	for (i = 0, n = readCount(input); i < n; ++i) {
+		int boneIndex = readIndex(input, skeletonData->bonesCount);
+		if (boneIndex < 0) goto invalid;
+		for (ii = 0, nn = readCount(input); ii < nn; ++ii) {
+			unsigned char timelineType = readByte(input);
+			int frameCount = readCount(input);
+			if (frameCount == 0) goto invalid;
+			switch (timelineType) {
+			case BONE_ROTATE: {
+				spRotateTimeline* timeline = spRotateTimeline_create(frameCount);
+				timeline->boneIndex = boneIndex;
+				for (frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+					float time = readFloat(input);
+					float angle = readFloat(input);
+					spRotateTimeline_setFrame(timeline, frameIndex, time, angle);
+					if (frameIndex < frameCount - 1) readCurve(input, SUPER(timeline), frameIndex);
+				}
+				_spTimelineArray_add(&timelines, SUPER_CAST(spTimeline, timeline));
+				duration = MAX(duration, timeline->frames[(frameCount - 1) * ROTATE_ENTRIES]);
+				break;
+			}
+			case BONE_TRANSLATE:
+			case BONE_SCALE:
+			case BONE_SHEAR: {
+				spTranslateTimeline* timeline;
+				float timelineScale = 1;
+				if (timelineType == BONE_SCALE)
+					timeline = spScaleTimeline_create(frameCount);
+				else if (timelineType == BONE_SHEAR)
+					timeline = spShearTimeline_create(frameCount);
+				else {
+					timeline = spTranslateTimeline_create(frameCount);
+					timelineScale = self->scale;
+				}
+				timeline->boneIndex = boneIndex;
+				for (frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+					float time = readFloat(input);
+					float x = readFloat(input) * timelineScale;
+					float y = readFloat(input) * timelineScale;
+					spTranslateTimeline_setFrame(timeline, frameIndex, time, x, y);
+					if (frameIndex < frameCount - 1) readCurve(input, SUPER(timeline), frameIndex);
+				}
+				_spTimelineArray_add(&timelines, SUPER_CAST(spTimeline, timeline));
+				duration = MAX(duration, timeline->frames[(frameCount - 1) * TRANSLATE_ENTRIES]);
+				break;
+			}
+			default:
+				_spSkeletonBinary_setError(self, "Invalid timeline type for a bone: ", skeletonData->bones[boneIndex]->name);
+				goto error;
+			}
+		}
+	}
+
+	/* IK constraint timelines. */
+	for (i = 0, n = readCount(input); i < n; ++i) {
+		int index = readIndex(input, skeletonData->ikConstraintsCount);
+		int frameCount = readCount(input);
+		spIkConstraintTimeline* timeline;
+		if (index < 0 || frameCount == 0) goto invalid;
+		timeline = spIkConstraintTimeline_create(frameCount);
+		timeline->ikConstraintIndex = index;
+		for (frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+			float time = readFloat(input);
+			float mix = readFloat(input);
+			signed char bendDirection = readSByte(input);
+			spIkConstraintTimeline_setFrame(timeline, frameIndex, time, mix, bendDirection);
+			if (frameIndex < frameCount - 1) readCurve(input, SUPER(timeline), frameIndex);
+		}
+		_spTimelineArray_add(&timelines, SUPER_CAST(spTimeline, timeline));
+		duration = MAX(duration, timeline->frames[(frameCount - 1) * IKCONSTRAINT_ENTRIES]);
+	}
+
+	/* Transform constraint timelines. */
+	for (i = 0, n = readCount(input); i < n; ++i) {
+		int index = readIndex(input, skeletonData->transformConstraintsCount);
+		int frameCount = readCount(input);
+		spTransformConstraintTimeline* timeline;
+		if (index < 0 || frameCount == 0) goto invalid;
+		timeline = spTransformConstraintTimeline_create(frameCount);
+		timeline->transformConstraintIndex = index;
+		for (frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+			float time = readFloat(input);
+			float rotateMix = readFloat(input);
+			float translateMix = readFloat(input);
+			float scaleMix = readFloat(input);
+			float shearMix = readFloat(input);
+			spTransformConstraintTimeline_setFrame(timeline, frameIndex, time, rotateMix, translateMix, scaleMix, shearMix);
+			if (frameIndex < frameCount - 1) readCurve(input, SUPER(timeline), frameIndex);
+		}
+		_spTimelineArray_add(&timelines, SUPER_CAST(spTimeline, timeline));
+		duration = MAX(duration, timeline->frames[(frameCount - 1) * TRANSFORMCONSTRAINT_ENTRIES]);
+	}
+
+	/* Path constraint timelines. */
+	for (i = 0, n = readCount(input); i < n; ++i) {
+		spPathConstraintData* data;
+		int index = readIndex(input, skeletonData->pathConstraintsCount);
+		if (index < 0) goto invalid;
+		data = skeletonData->pathConstraints[index];
+		for (ii = 0, nn = readCount(input); ii < nn; ++ii) {
+			unsigned char timelineType = readByte(input);
+			int frameCount = readCount(input);
+			if (frameCount == 0) goto invalid;
+			switch (timelineType) {
+			case PATH_POSITION:
+			case PATH_SPACING: {
+				spPathConstraintPositionTimeline* timeline;
+				float timelineScale = 1;
+				if (timelineType == PATH_SPACING) {
+					timeline = (spPathConstraintPositionTimeline*)spPathConstraintSpacingTimeline_create(frameCount);
+					if (data->spacingMode == SP_SPACING_MODE_LENGTH || data->spacingMode == SP_SPACING_MODE_FIXED) timelineScale = self->scale;
+				} else {
+					timeline = spPathConstraintPositionTimeline_create(frameCount);
+					if (data->positionMode == SP_POSITION_MODE_FIXED) timelineScale = self->scale;
+				}
+				timeline->pathConstraintIndex = index;
+				for (frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+					float time = readFloat(input);
+					float value = readFloat(input) * timelineScale;
+					spPathConstraintPositionTimeline_setFrame(timeline, frameIndex, time, value);
+					if (frameIndex < frameCount - 1) readCurve(input, SUPER(timeline), frameIndex);
+				}
+				_spTimelineArray_add(&timelines, SUPER_CAST(spTimeline, timeline));
+				duration = MAX(duration, timeline->frames[(frameCount - 1) * PATHCONSTRAINTPOSITION_ENTRIES]);
+				break;
+			}
+			case PATH_MIX: {
+				spPathConstraintMixTimeline* timeline = spPathConstraintMixTimeline_create(frameCount);
+				timeline->pathConstraintIndex = index;
+				for (frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+					float time = readFloat(input);
+					float rotateMix = readFloat(input);
+					float translateMix = readFloat(input);
+					spPathConstraintMixTimeline_setFrame(timeline, frameIndex, time, rotateMix, translateMix);
+					if (frameIndex < frameCount - 1) readCurve(input, SUPER(timeline), frameIndex);
+				}
+				_spTimelineArray_add(&timelines, SUPER_CAST(spTimeline, timeline));
+				duration = MAX(duration, timeline->frames[(frameCount - 1) * PATHCONSTRAINTMIX_ENTRIES]);
+				break;
+			}
+			default:
+				_spSkeletonBinary_setError(self, "Invalid timeline type for a path constraint: ", data->name);
+				goto error;
+			}
+		}
+	}
+
+	/* Deform timelines. */
+	for (i = 0, n = readCount(input); i < n; ++i) {
+		spSkin* skin;
+		int skinIndex = readIndex(input, skeletonData->skinsCount);
+		if (skinIndex < 0) goto invalid;
+		skin = skeletonData->skins[skinIndex];
+		for (ii = 0, nn = readCount(input); ii < nn; ++ii) {
+			int slotIndex = readIndex(input, skeletonData->slotsCount);
+			if (slotIndex < 0) goto invalid;
+			for (iii = 0, nnn = readCount(input); iii < nnn; ++iii) {
+				float* tempDeform;
+				spDeformTimeline* timeline;
+				int weighted, deformLength, frameCount;
+
+				char* attachmentName = readString(input);
+				spVertexAttachment* attachment = attachmentName ?
+						SUB_CAST(spVertexAttachment, spSkin_getAttachment(skin, slotIndex, attachmentName)) : 0;
+				if (!attachment) {
+					_spSkeletonBinary_setError(self, "Attachment not found: ", attachmentName);
+					FREE(attachmentName);
+					goto error;
+				}
+				FREE(attachmentName);
+
+				weighted = attachment->bones != 0;
+				deformLength = weighted ? attachment->verticesCount / 3 * 2 : attachment->verticesCount;
+				tempDeform = MALLOC(float, deformLength);
+
+				frameCount = readCount(input);
+				if (frameCount == 0) {
+					FREE(tempDeform);
+					goto invalid;
+				}
+				timeline = spDeformTimeline_create(frameCount, deformLength);
+				timeline->slotIndex = slotIndex;
+				timeline->attachment = SUPER(attachment);
+
+				for (frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+					float* deform;
+					float time = readFloat(input);
+					int end = readVarint(input, 1);
+					if (end == 0) {
+						if (weighted) {
+							deform = tempDeform;
+							memset(deform, 0, sizeof(float) * deformLength);
+						} else
+							deform = attachment->vertices;
+					} else {
+						int v, start = readVarint(input, 1);
+						end += start;
+						if (start < 0 || end > deformLength) {
+							FREE(tempDeform);
+							_spTimelineArray_add(&timelines, SUPER_CAST(spTimeline, timeline));
+							_spSkeletonBinary_setError(self, "Invalid deform offsets for attachment: ", SUPER(attachment)->name);
+							goto error;
+						}
+						deform = tempDeform;
+						memset(deform, 0, sizeof(float) * deformLength);
+						if (self->scale == 1) {
+							for (v = start; v < end; ++v)
+								deform[v] = readFloat(input);
+						} else {
+							for (v = start; v < end; ++v)
+								deform[v] = readFloat(input) * self->scale;
+						}
+						if (!weighted) {
+							float* vertices = attachment->vertices;
+							for (v = 0; v < deformLength; ++v)
+								deform[v] += vertices[v];
+						}
+					}
+					spDeformTimeline_setFrame(timeline, frameIndex, time, deform);
+					if (frameIndex < frameCount - 1) readCurve(input, SUPER(timeline), frameIndex);
+				}
+				FREE(tempDeform);
+
+				_spTimelineArray_add(&timelines, SUPER_CAST(spTimeline, timeline));
+				duration = MAX(duration, timeline->frames[frameCount - 1]);
+			}
+		}
+	}
+
+	/* Draw order timeline. */
+	n = readCount(input);
+	if (n > 0) {
+		int slotsCount = skeletonData->slotsCount;
+		spDrawOrderTimeline* timeline = spDrawOrderTimeline_create(n, slotsCount);
+		for (i = 0; i < n; ++i) {
+			float time = readFloat(input);
+			int offsetCount = readCount(input);
+			int* drawOrder = MALLOC(int, slotsCount);
+			int* unchanged = MALLOC(int, slotsCount);
+			int originalIndex = 0, unchangedIndex = 0;
+			for (ii = slotsCount - 1; ii >= 0; --ii)
+				drawOrder[ii] = -1;
+			for (ii = 0; ii < offsetCount; ++ii) {
+				int offset, slotIndex = readVarint(input, 1);
+				if (slotIndex < originalIndex || slotIndex >= slotsCount) {
+					input->overflow = 1;
+					break;
+				}
+				/* Collect unchanged items. */
+				while (originalIndex < slotIndex)
+					unchanged[unchangedIndex++] = originalIndex++;
+				/* Set changed items. */
+				offset = readVarint(input, 1);
+				if (originalIndex + offset >= 0 && originalIndex + offset < slotsCount) drawOrder[originalIndex + offset] = originalIndex;
+				++originalIndex;
+			}
+			/* Collect remaining unchanged items. */
+			while (originalIndex < slotsCount)
+				unchanged[unchangedIndex++] = originalIndex++;
+			/* Fill in unchanged items. */
+			for (ii = slotsCount - 1; ii >= 0; --ii)
+				if (drawOrder[ii] == -1 && unchangedIndex > 0) drawOrder[ii] = unchanged[--unchangedIndex];
+			spDrawOrderTimeline_setFrame(timeline, i, time, drawOrder);
+			FREE(unchanged);
+			FREE(drawOrder);
+		}
+		_spTimelineArray_add(&timelines, SUPER_CAST(spTimeline, timeline));
+		duration = MAX(duration, timeline->frames[n - 1]);
+	}
+
+	/* Event timeline. */
+	n = readCount(input);
+	if (n > 0) {
+		spEventTimeline* timeline = spEventTimeline_create(n);
+		for (i = 0; i < n; ++i) {
+			spEvent* event;
+			float time = readFloat(input);
+			int eventIndex = readIndex(input, skeletonData->eventsCount);
+			if (eventIndex < 0) {
+				/* Only the events read are disposed. */
+				CONST_CAST(int, timeline->framesCount) = i;
+				spTimeline_dispose(SUPER_CAST(spTimeline, timeline));
+				goto invalid;
+			}
+			event = spEvent_create(time, skeletonData->events[eventIndex]);
+			event->intValue = readVarint(input, 0);
+			event->floatValue = readFloat(input);
+			if (readBoolean(input))
+				event->stringValue = readString(input);
+			else if (event->data->stringValue)
+				MALLOC_STR(event->stringValue, event->data->stringValue);
+			spEventTimeline_setFrame(timeline, i, event);
+		}
+		_spTimelineArray_add(&timelines, SUPER_CAST(spTimeline, timeline));
+		duration = MAX(duration, timeline->frames[n - 1]);
+	}
+
+	animation = spAnimation_create(name, timelines.count);
+	if (timelines.count) memcpy(animation->timelines, timelines.timelines, sizeof(spTimeline*) * timelines.count);
+	animation->duration = duration;
+	FREE(timelines.timelines);
+	return animation;
+
+invalid:
+	_spSkeletonBinary_setError(self, "Invalid skeleton binary: ", "index or count out of range.");
+error:
+	for (i = 0; i < timelines.count; ++i)
+		spTimeline_dispose(timelines.timelines[i]);
+	FREE(timelines.timelines);
+	return 0;
+}
+
+static void _readVertices (spSkeletonBinary* self, _dataInput* input, spVertexAttachment* attachment, int vertexCount) {
+	int i, ii, b, w;
+	_dataInput weights;
+	int verticesLength = vertexCount << 1;
+
+	attachment->worldVerticesLength = verticesLength;
+
+	if (!readBoolean(input)) {
+		attachment->verticesCount = verticesLength;
+		attachment->vertices = readFloatArray(input, verticesLength, self->scale);
+		attachment->bonesCount = 0;
+		attachment->bones = 0;
+		return;
+	}
+
+	/* Count the bones and weights first, then read them again into arrays of the right size. */
+	attachment->verticesCount = 0;
+	attachment->bonesCount = 0;
+	weights = *input;
+	for (i = 0; i < vertexCount; ++i) {
+		int bonesCount = readCount(input);
+		attachment->bonesCount += 1 + bonesCount;
+		attachment->verticesCount += 3 * bonesCount;
+		for (ii = 0; ii < bonesCount; ++ii) {
+			readVarint(input, 1);
+			if (input->end - input->cursor < 12) {
+				input->overflow = 1;
+				input->cursor = input->end;
+				attachment->verticesCount = attachment->bonesCount = 0;
+				attachment->vertices = 0;
+				attachment->bones = 0;
+				return;
+			}
+			input->cursor += 12;
+		}
+	}
+	*input = weights;
+
+	attachment->vertices = MALLOC(float, attachment->verticesCount);
+	attachment->bones = MALLOC(int, attachment->bonesCount);
+	for (i = 0, b = 0, w = 0; i < vertexCount; ++i) {
+		int bonesCount = readCount(input);
+		attachment->bones[b++] = bonesCount;
+		for (ii = 0; ii < bonesCount; ++ii) {
+			attachment->bones[b++] = readVarint(input, 1);
+			attachment->vertices[w++] = readFloat(input) * self->scale;
+			attachment->vertices[w++] = readFloat(input) * self->scale;
+			attachment->vertices[w++] = readFloat(input);
+		}
+	}
+}
+
+static void _moveVertices (spVertexAttachment* to, spVertexAttachment* from) {
+	to->bonesCount = from->bonesCount;
+	to->bones = from->bones;
+	to->verticesCount = from->verticesCount;
+	to->vertices = from->vertices;
+	to->worldVerticesLength = from->worldVerticesLength;
+	from->bones = 0;
+	from->vertices = 0;
+}
+
+/* Returns 0 and sets the error if the attachment loader failed, returns 0 without error if it didn't load the attachment. */
+static spAttachment* _spSkeletonBinary_readAttachment (spSkeletonBinary* self, _dataInput* input, spSkin* skin, int slotIndex,
+		const char* attachmentName, int/*bool*/nonessential) {
+	int i;
+	spAttachment* attachment = 0;
+	spVertexAttachment vertices;
+	char* name = readString(input);
+	unsigned char type = readByte(input);
+	if (!name) MALLOC_STR(name, attachmentName);
+	memset(&vertices, 0, sizeof(vertices));
+
+	switch (type) {
+	case SP_ATTACHMENT_REGION: {
+		spRegionAttachment* region;
+		char* path = readString(input);
+		float rotation = readFloat(input);
+		float x = readFloat(input) * self->scale;
+		float y = readFloat(input) * self->scale;
+		float scaleX = readFloat(input);
+		float scaleY = readFloat(input);
+		float width = readFloat(input) * self->scale;
+		float height = readFloat(input) * self->scale;
+		float r, g, b, a;
+		readColor(input, &r, &g, &b, &a);
+		if (!path) MALLOC_STR(path, name);
+
+		attachment = spAttachmentLoader_createAttachment(self->attachmentLoader, skin, SP_ATTACHMENT_REGION, name, path);
+		if (!attachment) {
+			FREE(path);
+			break;
+		}
+		region = SUB_CAST(spRegionAttachment, attachment);
+		region->path = path;
+		region->rotation = rotation;
+		region->x = x;
+		region->y = y;
+		region->scaleX = scaleX;
+		region->scaleY = scaleY;
+		region->width = width;
+		region->height = height;
+		region->r = r;
+		region->g = g;
+		region->b = b;
+		region->a = a;
+		spRegionAttachment_updateOffset(region);
+		spAttachmentLoader_configureAttachment(self->attachmentLoader, attachment);
+		break;
+	}
+	case SP_ATTACHMENT_BOUNDING_BOX: {
+		int vertexCount = readCount(input);
+		_readVertices(self, input, &vertices, vertexCount);
+		if (nonessential) readInt(input); /* Color. */
+
+		attachment = spAttachmentLoader_createAttachment(self->attachmentLoader, skin, SP_ATTACHMENT_BOUNDING_BOX, name, name);
+		if (!attachment) break;
+		_moveVertices(SUB_CAST(spVertexAttachment, attachment), &vertices);
+		spAttachmentLoader_configureAttachment(self->attachmentLoader, attachment);
+		break;
+	}
+	case SP_ATTACHMENT_MESH: {
+		spMeshAttachment* mesh;
+		int trianglesCount, edgesCount = 0, hullLength;
+		unsigned short* triangles;
+		unsigned short* edges = 0;
+		float* regionUVs;
+		float width = 0, height = 0;
+		float r, g, b, a;
+		char* path = readString(input);
+		int vertexCount;
+		readColor(input, &r, &g, &b, &a);
+		vertexCount = readCount(input);
+		regionUVs = readFloatArray(input, vertexCount << 1, 1);
+		triangles = readShortArray(input, &trianglesCount);
+		_readVertices(self, input, &vertices, vertexCount);
+		hullLength = readVarint(input, 1);
+		if (nonessential) {
+			edges = readShortArray(input, &edgesCount);
+			width = readFloat(input) * self->scale;
+			height = readFloat(input) * self->scale;
+		}
+		if (!path) MALLOC_STR(path, name);
+
+		attachment = spAttachmentLoader_createAttachment(self->attachmentLoader, skin, SP_ATTACHMENT_MESH, name, path);
+		if (!attachment) {
+			FREE(path);
+			FREE(regionUVs);
+			FREE(triangles);
+			FREE(edges);
+			break;
+		}
+		mesh = SUB_CAST(spMeshAttachment, attachment);
+		mesh->path = path;
+		mesh->r = r;
+		mesh->g = g;
+		mesh->b = b;
+		mesh->a = a;
+		mesh->regionUVs = regionUVs;
+		mesh->trianglesCount = trianglesCount;
+		mesh->triangles = triangles;
+		_moveVertices(SUPER(mesh), &vertices);
+		spMeshAttachment_updateUVs(mesh);
+		mesh->hullLength = hullLength;
+		if (edges) {
+			mesh->edgesCount = edgesCount;
+			mesh->edges = MALLOC(int, edgesCount);
+			for (i = 0; i < edgesCount; ++i)
+				mesh->edges[i] = edges[i];
+			FREE(edges);
+		}
+		mesh->width = width;
+		mesh->height = height;
+		spAttachmentLoader_configureAttachment(self->attachmentLoader, attachment);
+		break;
+	}
+	case SP_ATTACHMENT_LINKED_MESH: {
+		spMeshAttachment* mesh;
+		float width = 0, height = 0;
+		float r, g, b, a;
+		char* path = readString(input);
+		char* skinName;
+		char* parent;
+		int inheritDeform;
+		readColor(input, &r, &g, &b, &a);
+		skinName = readString(input);
+		parent = readString(input);
+		inheritDeform = readBoolean(input);
+		if (nonessential) {
+			width = readFloat(input) * self->scale;
+			height = readFloat(input) * self->scale;
+		}
+		if (!path) MALLOC_STR(path, name);
+
+		attachment = spAttachmentLoader_createAttachment(self->attachmentLoader, skin, SP_ATTACHMENT_LINKED_MESH, name, path);
+		if (!attachment) {
+			FREE(path);
+			FREE(skinName);
+			FREE(parent);
+			break;
+		}
+		mesh = SUB_CAST(spMeshAttachment, attachment);
+		mesh->path = path;
+		mesh->r = r;
+		mesh->g = g;
+		mesh->b = b;
+		mesh->a = a;
+		mesh->inheritDeform = inheritDeform;
+		mesh->width = width;
+		mesh->height = height;
+		/* Configured once the parent mesh is known. */
+		_spSkeletonBinary_addLinkedMesh(self, mesh, skinName, slotIndex, parent);
+		break;
+	}
+	case SP_ATTACHMENT_PATH: {
+		spPathAttachment* path;
+		int closed = readBoolean(input);
+		int constantSpeed = readBoolean(input);
+		int vertexCount = readCount(input);
+		float* lengths;
+		_readVertices(self, input, &vertices, vertexCount);
+		lengths = readFloatArray(input, vertexCount / 3, self->scale);
+		if (nonessential) readInt(input); /* Color. */
+
+		attachment = spAttachmentLoader_createAttachment(self->attachmentLoader, skin, SP_ATTACHMENT_PATH, name, name);
+		if (!attachment) {
+			FREE(lengths);
+			break;
+		}
+		path = SUB_CAST(spPathAttachment, attachment);
+		path->closed = closed;
+		path->constantSpeed = constantSpeed;
+		_moveVertices(SUPER(path), &vertices);
+		path->lengthsLength = vertexCount / 3;
+		path->lengths = lengths;
+		break;
+	}
+	default:
+		_spSkeletonBinary_setError(self, "Unknown attachment type: ", name);
+		FREE(name);
+		return 0;
+	}
+
+	FREE(vertices.bones);
+	FREE(vertices.vertices);
+	if (!attachment && self->attachmentLoader->error1)
+		_spSkeletonBinary_setError(self, self->attachmentLoader->error1, self->attachmentLoader->error2);
+	FREE(name);
+	return attachment;
+}
+
+/* Returns 0 if the skin has no attachment or if the error was set. */
+static spSkin* _spSkeletonBinary_readSkin (spSkeletonBinary* self, _dataInput* input, const char* skinName,
+		spSkeletonData* skeletonData, int/*bool*/nonessential) {
+	int i, ii, nn;
+	spSkin* skin;
+	int slotsCount = readCount(input);
+	if (slotsCount == 0) return 0;
+
+	skin = spSkin_create(skinName);
+	for (i = 0; i < slotsCount; ++i) {
+		int slotIndex = readIndex(input, skeletonData->slotsCount);
+		if (slotIndex < 0) {
+			_spSkeletonBinary_setError(self, "Invalid skeleton binary: ", "slot index out of range.");
+			spSkin_dispose(skin);
+			return 0;
+		}
+		for (ii = 0, nn = readCount(input); ii < nn; ++ii) {
+			spAttachment* attachment;
+			char* name = readString(input);
+			if (!name) MALLOC_STR(name, "");
+			attachment = _spSkeletonBinary_readAttachment(self, input, skin, slotIndex, name, nonessential);
+			if (attachment) spSkin_addAttachment(skin, slotIndex, name, attachment);
+			FREE(name);
+			if (self->error) {
+				spSkin_dispose(skin);
+				return 0;
+			}
+		}
+	}
+	return skin;
+}
+
+spSkeletonData* spSkeletonBinary_readSkeletonDataFile (spSkeletonBinary* self, const char* path) {
+	int length;
+	spSkeletonData* skeletonData;
+	const char* binary = _spUtil_readFile(path, &length);
+	if (length == 0 || !binary) {
+		_spSkeletonBinary_setError(self, "Unable to read skeleton file: ", path);
+		return 0;
+	}
+	skeletonData = spSkeletonBinary_readSkeletonData(self, (const unsigned char*)binary, length);
+	FREE(binary);
+	return skeletonData;
+}
+
+spSkeletonData* spSkeletonBinary_readSkeletonData (spSkeletonBinary* self, const unsigned char* binary, const int length) {
+	int i, ii, n, index;
+	int nonessential;
+	char* name;
+	spSkin* defaultSkin;
+	spSkeletonData* skeletonData;
+	_spSkeletonBinary* internal = SUB_CAST(_spSkeletonBinary, self);
+	_dataInput input;
+	input.cursor = binary;
+	input.end = binary + length;
+	input.overflow = 0;
+
+	FREE(self->error);
+	CONST_CAST(char*, self->error) = 0;
+	_spSkeletonBinary_clearLinkedMeshes(self);
+
+	skeletonData = spSkeletonData_create();
+
+	skeletonData->hash = readString(&input);
+	skeletonData->version = readString(&input);
+	skeletonData->width = readFloat(&input);
+	skeletonData->height = readFloat(&input);
+
+	nonessential = readBoolean(&input);
+	if (nonessential) FREE(readString(&input)); /* Images path. */
+
+	/* Bones. */
+	n = readCount(&input);
+	skeletonData->bones = MALLOC(spBoneData*, n);
+	for (i = 0; i < n; ++i) {
+		spBoneData* data;
+		spBoneData* parent = 0;
+		name = readString(&input);
+		if (i > 0) {
+			int parentIndex = readIndex(&input, i);
+			if (parentIndex < 0) {
+				_spSkeletonBinary_setError(self, "Parent bone not found for bone: ", name);
+				FREE(name);
+				goto error;
+			}
+			parent = skeletonData->bones[parentIndex];
+		}
+		data = spBoneData_create(i, name ? name : "", parent);
+		FREE(name);
+		data->rotation = readFloat(&input);
+		data->x = readFloat(&input) * self->scale;
+		data->y = readFloat(&input) * self->scale;
+		data->scaleX = readFloat(&input);
+		data->scaleY = readFloat(&input);
+		data->shearX = readFloat(&input);
+		data->shearY = readFloat(&input);
+		data->length = readFloat(&input) * self->scale;
+		data->inheritRotation = readBoolean(&input);
+		data->inheritScale = readBoolean(&input);
+		if (nonessential) readInt(&input); /* Color. */
+
+		skeletonData->bones[i] = data;
+		skeletonData->bonesCount++;
+	}
+
+	/* Slots. */
+	n = readCount(&input);
+	skeletonData->slots = MALLOC(spSlotData*, n);
+	for (i = 0; i < n; ++i) {
+		spSlotData* data;
+		char* attachmentName;
+		int boneIndex;
+		name = readString(&input);
+		boneIndex = readIndex(&input, skeletonData->bonesCount);
+		if (boneIndex < 0) {
+			_spSkeletonBinary_setError(self, "Slot bone not found for slot: ", name);
+			FREE(name);
+			goto error;
+		}
+		data = spSlotData_create(i, name ? name : "", skeletonData->bones[boneIndex]);
+		FREE(name);
+		readColor(&input, &data->r, &data->g, &data->b, &data->a);
+		attachmentName = readString(&input);
+		if (attachmentName) spSlotData_setAttachmentName(data, attachmentName);
+		FREE(attachmentName);
+		data->blendMode = (spBlendMode)readVarint(&input, 1);
+
+		skeletonData->slots[i] = data;
+		skeletonData->slotsCount++;
+	}
+
+	/* IK constraints. */
+	n = readCount(&input);
+	skeletonData->ikConstraints = MALLOC(spIkConstraintData*, n);
+	for (i = 0; i < n; ++i) {
+		spIkConstraintData* data;
+		name = readString(&input);
+		data = spIkConstraintData_create(name ? name : "");
+		FREE(name);
+		skeletonData->ikConstraints[i] = data;
+		skeletonData->ikConstraintsCount++;
+
+		data->bonesCount = readCount(&input);
+		data->bones = MALLOC(spBoneData*, data->bonesCount);
+		for (ii = 0; ii < data->bonesCount; ++ii) {
+			if ((index = readIndex(&input, skeletonData->bonesCount)) < 0) goto invalid;
+			data->bones[ii] = skeletonData->bones[index];
+		}
+		if ((index = readIndex(&input, skeletonData->bonesCount)) < 0) goto invalid;
+		data->target = skeletonData->bones[index];
+		data->mix = readFloat(&input);
+		data->bendDirection = readSByte(&input);
+	}
+
+	/* Transform constraints. */
+	n = readCount(&input);
+	skeletonData->transformConstraints = MALLOC(spTransformConstraintData*, n);
+	for (i = 0; i < n; ++i) {
+		spTransformConstraintData* data;
+		name = readString(&input);
+		data = spTransformConstraintData_create(name ? name : "");
+		FREE(name);
+		skeletonData->transformConstraints[i] = data;
+		skeletonData->transformConstraintsCount++;
+
+		data->bonesCount = readCount(&input);
+		CONST_CAST(spBoneData**, data->bones) = MALLOC(spBoneData*, data->bonesCount);
+		for (ii = 0; ii < data->bonesCount; ++ii) {
+			if ((index = readIndex(&input, skeletonData->bonesCount)) < 0) goto invalid;
+			data->bones[ii] = skeletonData->bones[index];
+		}
+		if ((index = readIndex(&input, skeletonData->bonesCount)) < 0) goto invalid;
+		data->target = skeletonData->bones[index];
+		data->offsetRotation = readFloat(&input);
+		data->offsetX = readFloat(&input) * self->scale;
+		data->offsetY = readFloat(&input) * self->scale;
+		data->offsetScaleX = readFloat(&input);
+		data->offsetScaleY = readFloat(&input);
+		data->offsetShearY = readFloat(&input);
+		data->rotateMix = readFloat(&input);
+		data->translateMix = readFloat(&input);
+		data->scaleMix = readFloat(&input);
+		data->shearMix = readFloat(&input);
+	}
+
+	/* Path constraints. */
+	n = readCount(&input);
+	skeletonData->pathConstraints = MALLOC(spPathConstraintData*, n);
+	for (i = 0; i < n; ++i) {
+		spPathConstraintData* data;
+		name = readString(&input);
+		data = spPathConstraintData_create(name ? name : "");
+		FREE(name);
+		skeletonData->pathConstraints[i] = data;
+		skeletonData->pathConstraintsCount++;
+
+		data->bonesCount = readCount(&input);
+		CONST_CAST(spBoneData**, data->bones) = MALLOC(spBoneData*, data->bonesCount);
+		for (ii = 0; ii < data->bonesCount; ++ii) {
+			if ((index = readIndex(&input, skeletonData->bonesCount)) < 0) goto invalid;
+			data->bones[ii] = skeletonData->bones[index];
+		}
+		if ((index = readIndex(&input, skeletonData->slotsCount)) < 0) goto invalid;
+		data->target = skeletonData->slots[index];
+		data->positionMode = (spPositionMode)readVarint(&input, 1);
+		data->spacingMode = (spSpacingMode)readVarint(&input, 1);
+		data->rotateMode = (spRotateMode)readVarint(&input, 1);
+		data->offsetRotation = readFloat(&input);
+		data->position = readFloat(&input);
+		if (data->positionMode == SP_POSITION_MODE_FIXED) data->position *= self->scale;
+		data->spacing = readFloat(&input);
+		if (data->spacingMode == SP_SPACING_MODE_LENGTH || data->spacingMode == SP_SPACING_MODE_FIXED) data->spacing *= self->scale;
+		data->rotateMix = readFloat(&input);
+		data->translateMix = readFloat(&input);
+	}
+
+	/* Skins, the default skin is written first without its name. */
+	defaultSkin = _spSkeletonBinary_readSkin(self, &input, "default", skeletonData, nonessential);
+	if (self->error) goto error;
+	n = readCount(&input);
+	skeletonData->skins = MALLOC(spSkin*, n + (defaultSkin ? 1 : 0));
+	if (defaultSkin) {
+		skeletonData->defaultSkin = defaultSkin;
+		skeletonData->skins[skeletonData->skinsCount++] = defaultSkin;
+	}
+	for (i = 0; i < n; ++i) {
+		spSkin* skin;
+		name = readString(&input);
+		skin = _spSkeletonBinary_readSkin(self, &input, name ? name : "", skeletonData, nonessential);
+		FREE(name);
+		if (self->error) goto error;
+		if (skin) skeletonData->skins[skeletonData->skinsCount++] = skin;
+	}
+
+	/* Linked meshes. */
+	for (i = 0; i < internal->linkedMeshCount; ++i) {
+		spAttachment* parent;
+		_spLinkedMesh* linkedMesh = internal->linkedMeshes + i;
+		spSkin* skin = !linkedMesh->skin ? skeletonData->defaultSkin : spSkeletonData_findSkin(skeletonData, linkedMesh->skin);
+		if (!skin) {
+			_spSkeletonBinary_setError(self, "Skin not found: ", linkedMesh->skin);
+			goto error;
+		}
+		parent = linkedMesh->parent ? spSkin_getAttachment(skin, linkedMesh->slotIndex, linkedMesh->parent) : 0;
+		if (!parent) {
+			_spSkeletonBinary_setError(self, "Parent mesh not found: ", linkedMesh->parent);
+			goto error;
+		}
+		spMeshAttachment_setParentMesh(linkedMesh->mesh, SUB_CAST(spMeshAttachment, parent));
+		spMeshAttachment_updateUVs(linkedMesh->mesh);
+		spAttachmentLoader_configureAttachment(self->attachmentLoader, SUPER(SUPER(linkedMesh->mesh)));
+	}
+	_spSkeletonBinary_clearLinkedMeshes(self);
+
+	/* Events. */
+	n = readCount(&input);
+	skeletonData->events = MALLOC(spEventData*, n);
+	for (i = 0; i < n; ++i) {
+		spEventData* eventData;
+		name = readString(&input);
+		eventData = spEventData_create(name ? name : "");
+		FREE(name);
+		eventData->intValue = readVarint(&input, 0);
+		eventData->floatValue = readFloat(&input);
+		eventData->stringValue = readString(&input);
+
+		skeletonData->events[i] = eventData;
+		skeletonData->eventsCount++;
+	}
+
+	/* Animations. */
+	n = readCount(&input);
+	skeletonData->animations = MALLOC(spAnimation*, n);
+	for (i = 0; i < n; ++i) {
+		spAnimation* animation;
+		name = readString(&input);
+		animation = _spSkeletonBinary_readAnimation(self, name ? name : "", &input, skeletonData);
+		FREE(name);
+		if (!animation) goto error;
+		skeletonData->animations[skeletonData->animationsCount++] = animation;
+	}
+
+	if (input.overflow) {
+		_spSkeletonBinary_setError(self, "Invalid skeleton binary: ", "unexpected end of data.");
+		goto error;
+	}
+	return skeletonData;
+
+invalid:
+	_spSkeletonBinary_setError(self, "Invalid skeleton binary: ", "index or count out of range.");
+error:
+	_spSkeletonBinary_clearLinkedMeshes(self);
+	spSkeletonData_dispose(skeletonData);
+	return 0;
+}
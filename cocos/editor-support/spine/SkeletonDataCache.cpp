@@ -0,0 +1,165 @@
+/******************************************************************************
+ * Spine Runtimes Software License
+ * Version 2.3
+ * 
+ * Copyright (c) 2013-2015, Esoteric Software
+ * All rights reserved.
+ * 
+ * You are granted a perpetual, non-exclusive, non-sublicensable and
+ * non-transferable license to use, install, execute and perform the Spine
+ * Runtimes Software (the "Software") and derivative works solely for personal
+ * or internal use. Without the written permission of Esoteric Software (see
+ * Section 2 of the Spine Software License Agreement), you may not (a) modify,
+ * translate, adapt or otherwise create derivative works, improvements of the
+ * Software or develop new applications using the Software or (b) remove,
+ * delete, alter or obscure any trademarks or any copyright, trademark, patent
+ * or other intellectual property or proprietary rights notices on or in the
+ * Software, including any copy thereof. Redistributions in binary or source
+ * form must include this license and terms.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ESOTERIC SOFTWARE "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ESOTERIC SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#include <spine/SkeletonDataCache.h>
+#include <spine/extension.h>
+#include <spine/Cocos2dAttachmentLoader.h>
+#include "cocos2d.h"
+
+USING_NS_CC;
+
+namespace spine {
+
+static SkeletonDataCache* s_sharedCache = nullptr;
+
+SkeletonDataCache* SkeletonDataCache::getInstance () {
+	if (!s_sharedCache) s_sharedCache = new (std::nothrow) SkeletonDataCache();
+	return s_sharedCache;
+}
+
+void SkeletonDataCache::destroyInstance () {
+	CC_SAFE_DELETE(s_sharedCache);
+}
+
+SkeletonDataCache::SkeletonDataCache () : _destroyWhenUnused(false) {
+	/* The scenes are released after the event, the cache is destroyed by the release of the last skeleton data. */
+	_resetListener = Director::getInstance()->getEventDispatcher()->addCustomEventListener(Director::EVENT_RESET, [this](EventCustom*) {
+		/* The Director removes all the listeners after the event. */
+		_resetListener = nullptr;
+		if (_entries.empty())
+			destroyInstance();
+		else
+			_destroyWhenUnused = true;
+	});
+}
+
+SkeletonDataCache::~SkeletonDataCache () {
+	if (_resetListener) Director::getInstance()->getEventDispatcher()->removeEventListener(_resetListener);
+	for (auto& pair : _entries) {
+		spSkeletonData_dispose(pair.second.skeletonData);
+		spAttachmentLoader_dispose(pair.second.attachmentLoader);
+	}
+	for (auto& pair : _atlases)
+		spAtlas_dispose(pair.second.atlas);
+}
+
+spSkeletonData* SkeletonDataCache::readSkeletonData (const std::string& skeletonDataFile, spAttachmentLoader* attachmentLoader, float scale) {
+	spSkeletonData* skeletonData;
+	const size_t length = skeletonDataFile.length();
+	if (length > 5 && skeletonDataFile.compare(length - 5, 5, ".skel") == 0) {
+		spSkeletonBinary* binary = spSkeletonBinary_createWithLoader(attachmentLoader);
+		binary->scale = scale;
+		skeletonData = spSkeletonBinary_readSkeletonDataFile(binary, skeletonDataFile.c_str());
+		if (!skeletonData) CCLOG("Error reading skeleton data file %s: %s", skeletonDataFile.c_str(), binary->error ? binary->error : "");
+		spSkeletonBinary_dispose(binary);
+	} else {
+		spSkeletonJson* json = spSkeletonJson_createWithLoader(attachmentLoader);
+		json->scale = scale;
+		skeletonData = spSkeletonJson_readSkeletonDataFile(json, skeletonDataFile.c_str());
+		if (!skeletonData) CCLOG("Error reading skeleton data file %s: %s", skeletonDataFile.c_str(), json->error ? json->error : "");
+		spSkeletonJson_dispose(json);
+	}
+	return skeletonData;
+}
+
+spSkeletonData* SkeletonDataCache::retain (const std::string& skeletonDataFile, const std::string& atlasFile, float scale) {
+	Key key(skeletonDataFile, atlasFile, scale);
+	auto it = _entries.find(key);
+	if (it != _entries.end()) {
+		++it->second.referenceCount;
+		return it->second.skeletonData;
+	}
+
+	spAtlas* atlas = retainAtlas(atlasFile);
+	if (!atlas) return nullptr;
+
+	spAttachmentLoader* attachmentLoader = SUPER(Cocos2dAttachmentLoader_create(atlas));
+	spSkeletonData* skeletonData = readSkeletonData(skeletonDataFile, attachmentLoader, scale);
+	if (!skeletonData) {
+		spAttachmentLoader_dispose(attachmentLoader);
+		releaseAtlas(atlasFile);
+		return nullptr;
+	}
+
+	Entry& entry = _entries[key];
+	entry.skeletonData = skeletonData;
+	entry.attachmentLoader = attachmentLoader;
+	entry.atlasFile = atlasFile;
+	entry.referenceCount = 1;
+	_keys[skeletonData] = key;
+	return skeletonData;
+}
+
+void SkeletonDataCache::release (spSkeletonData* skeletonData) {
+	auto keyIt = _keys.find(skeletonData);
+	CCASSERT(keyIt != _keys.end(), "The skeleton data was not retained from the cache.");
+	if (keyIt == _keys.end()) return;
+
+	auto it = _entries.find(keyIt->second);
+	Entry& entry = it->second;
+	if (--entry.referenceCount > 0) return;
+
+	spSkeletonData_dispose(entry.skeletonData);
+	spAttachmentLoader_dispose(entry.attachmentLoader);
+	releaseAtlas(entry.atlasFile);
+	_keys.erase(keyIt);
+	_entries.erase(it);
+
+	if (_destroyWhenUnused && _entries.empty()) destroyInstance();
+}
+
+spAtlas* SkeletonDataCache::retainAtlas (const std::string& atlasFile) {
+	auto it = _atlases.find(atlasFile);
+	if (it != _atlases.end()) {
+		++it->second.referenceCount;
+		return it->second.atlas;
+	}
+
+	spAtlas* atlas = spAtlas_createFromFile(atlasFile.c_str(), 0);
+	if (!atlas) {
+		CCLOG("Error reading atlas file %s", atlasFile.c_str());
+		return nullptr;
+	}
+	AtlasEntry& entry = _atlases[atlasFile];
+	entry.atlas = atlas;
+	entry.referenceCount = 1;
+	return atlas;
+}
+
+void SkeletonDataCache::releaseAtlas (const std::string& atlasFile) {
+	auto it = _atlases.find(atlasFile);
+	if (it == _atlases.end()) return;
+	if (--it->second.referenceCount > 0) return;
+	spAtlas_dispose(it->second.atlas);
+	_atlases.erase(it);
+}
+
+}
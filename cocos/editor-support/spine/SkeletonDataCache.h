@@ -0,0 +1,102 @@
+/******************************************************************************
+ * Spine Runtimes Software License
+ * Version 2.3
+ * 
+ * Copyright (c) 2013-2015, Esoteric Software
+ * All rights reserved.
+ * 
+ * You are granted a perpetual, non-exclusive, non-sublicensable and
+ * non-transferable license to use, install, execute and perform the Spine
+ * Runtimes Software (the "Software") and derivative works solely for personal
+ * or internal use. Without the written permission of Esoteric Software (see
+ * Section 2 of the Spine Software License Agreement), you may not (a) modify,
+ * translate, adapt or otherwise create derivative works, improvements of the
+ * Software or develop new applications using the Software or (b) remove,
+ * delete, alter or obscure any trademarks or any copyright, trademark, patent
+ * or other intellectual property or proprietary rights notices on or in the
+ * Software, including any copy thereof. Redistributions in binary or source
+ * form must include this license and terms.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY ESOTERIC SOFTWARE "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL ESOTERIC SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#ifndef SPINE_SKELETONDATACACHE_H_
+#define SPINE_SKELETONDATACACHE_H_
+
+#include <spine/spine.h>
+#include <map>
+#include <string>
+#include <tuple>
+
+namespace cocos2d {
+class EventListenerCustom;
+}
+
+namespace spine {
+
+/* Shares the skeleton data loaded from the same files, with the same scale, between skeletons. The skeleton data and the atlas
+ * are never modified by a skeleton, they are disposed with their attachment loader when the last reference is released. The
+ * atlases are shared by all the skeleton data using the same atlas file.
+ *
+ * Files ending with ".skel" are read with spSkeletonBinary, the others with spSkeletonJson. Only used from the cocos thread.
+ *
+ * The cache is destroyed when the Director is reset, once the skeletons still alive have released their skeleton data. */
+class SkeletonDataCache {
+public:
+	static SkeletonDataCache* getInstance ();
+	static void destroyInstance ();
+
+	/* Returns the cached skeleton data, loading it on the first call. Returns 0 if the files could not be read. Each successful
+	 * call must be balanced by a call to release. */
+	spSkeletonData* retain (const std::string& skeletonDataFile, const std::string& atlasFile, float scale = 1);
+	void release (spSkeletonData* skeletonData);
+
+	/* Number of skeleton data loaded. */
+	int getSkeletonDataCount () const { return (int)_entries.size(); }
+	/* Number of atlases loaded. */
+	int getAtlasCount () const { return (int)_atlases.size(); }
+
+	/* Reads the skeleton data without caching it, as JSON or as binary depending on the file extension. The attachment loader
+	 * must not be disposed before the skeleton data. Returns 0 and logs the error if the file could not be read. */
+	static spSkeletonData* readSkeletonData (const std::string& skeletonDataFile, spAttachmentLoader* attachmentLoader, float scale);
+
+private:
+	SkeletonDataCache ();
+	~SkeletonDataCache ();
+
+	typedef std::tuple<std::string, std::string, float> Key;
+
+	struct AtlasEntry {
+		spAtlas* atlas;
+		int referenceCount;
+	};
+
+	struct Entry {
+		spSkeletonData* skeletonData;
+		spAttachmentLoader* attachmentLoader;
+		std::string atlasFile;
+		int referenceCount;
+	};
+
+	spAtlas* retainAtlas (const std::string& atlasFile);
+	void releaseAtlas (const std::string& atlasFile);
+
+	std::map<Key, Entry> _entries;
+	std::map<spSkeletonData*, Key> _keys;
+	std::map<std::string, AtlasEntry> _atlases;
+	cocos2d::EventListenerCustom* _resetListener;
+	bool _destroyWhenUnused;
+};
+
+}
+
+#endif /* SPINE_SKELETONDATACACHE_H_ */
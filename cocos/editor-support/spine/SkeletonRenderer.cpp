@@ -34,6 +34,7 @@
 #include <spine/SkeletonBatch.h>
 #include <spine/AttachmentVertices.h>
 #include <spine/Cocos2dAttachmentLoader.h>
+#include <spine/SkeletonDataCache.h>
 #include <algorithm>
 
 USING_NS_CC;
@@ -61,7 +62,9 @@ SkeletonRenderer* SkeletonRenderer::createWithFile (const std::string& skeletonD
 }
 
 void SkeletonRenderer::initialize () {
-	_worldVertices = new float[1000]; // Max number of vertices per mesh.
+	_worldVertices = nullptr;
+	_worldVerticesCapacity = 0;
+	ensureWorldVertices(1000);
 
 	_blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
 	setOpacityModifyRGB(true);
@@ -75,30 +78,39 @@ void SkeletonRenderer::setSkeletonData (spSkeletonData *skeletonData, bool ownsS
 }
 
 SkeletonRenderer::SkeletonRenderer ()
-	: _atlas(nullptr), _attachmentLoader(nullptr), _debugSlots(false), _debugBones(false), _timeScale(1) {
+	: _cachedSkeletonData(false), _atlas(nullptr), _attachmentLoader(nullptr), _debugSlots(false), _debugBones(false), _timeScale(1) {
 }
 
 SkeletonRenderer::SkeletonRenderer (spSkeletonData *skeletonData, bool ownsSkeletonData)
-	: _atlas(nullptr), _attachmentLoader(nullptr), _debugSlots(false), _debugBones(false), _timeScale(1) {
+	: _cachedSkeletonData(false), _atlas(nullptr), _attachmentLoader(nullptr), _debugSlots(false), _debugBones(false), _timeScale(1) {
 	initWithData(skeletonData, ownsSkeletonData);
 }
 
 SkeletonRenderer::SkeletonRenderer (const std::string& skeletonDataFile, spAtlas* atlas, float scale)
-	: _atlas(nullptr), _attachmentLoader(nullptr), _debugSlots(false), _debugBones(false), _timeScale(1) {
+	: _cachedSkeletonData(false), _atlas(nullptr), _attachmentLoader(nullptr), _debugSlots(false), _debugBones(false), _timeScale(1) {
 	initWithFile(skeletonDataFile, atlas, scale);
 }
 
 SkeletonRenderer::SkeletonRenderer (const std::string& skeletonDataFile, const std::string& atlasFile, float scale)
-	: _atlas(nullptr), _attachmentLoader(nullptr), _debugSlots(false), _debugBones(false), _timeScale(1) {
+	: _cachedSkeletonData(false), _atlas(nullptr), _attachmentLoader(nullptr), _debugSlots(false), _debugBones(false), _timeScale(1) {
 	initWithFile(skeletonDataFile, atlasFile, scale);
 }
 
 SkeletonRenderer::~SkeletonRenderer () {
-	if (_ownsSkeletonData) spSkeletonData_dispose(_skeleton->data);
+	spSkeletonData* skeletonData = _skeleton->data;
 	spSkeleton_dispose(_skeleton);
+	if (_cachedSkeletonData) SkeletonDataCache::getInstance()->release(skeletonData);
+	else if (_ownsSkeletonData) spSkeletonData_dispose(skeletonData);
 	if (_atlas) spAtlas_dispose(_atlas);
 	if (_attachmentLoader) spAttachmentLoader_dispose(_attachmentLoader);
-	delete _worldVertices;
+	delete [] _worldVertices;
+}
+
+void SkeletonRenderer::ensureWorldVertices (int count) const {
+	if (count <= _worldVerticesCapacity) return;
+	delete [] _worldVertices;
+	_worldVertices = new float[count];
+	_worldVerticesCapacity = count;
 }
 
 void SkeletonRenderer::initWithData (spSkeletonData* skeletonData, bool ownsSkeletonData) {
@@ -111,11 +123,8 @@ void SkeletonRenderer::initWithFile (const std::string& skeletonDataFile, spAtla
     _atlas = atlas;
 	_attachmentLoader = SUPER(Cocos2dAttachmentLoader_create(_atlas));
 
-	spSkeletonJson* json = spSkeletonJson_createWithLoader(_attachmentLoader);
-	json->scale = scale;
-	spSkeletonData* skeletonData = spSkeletonJson_readSkeletonDataFile(json, skeletonDataFile.c_str());
-	CCASSERT(skeletonData, json->error ? json->error : "Error reading skeleton data.");
-	spSkeletonJson_dispose(json);
+	spSkeletonData* skeletonData = SkeletonDataCache::readSkeletonData(skeletonDataFile, _attachmentLoader, scale);
+	CCASSERT(skeletonData, "Error reading skeleton data.");
 
 	setSkeletonData(skeletonData, true);
 
@@ -123,18 +132,12 @@ void SkeletonRenderer::initWithFile (const std::string& skeletonDataFile, spAtla
 }
 
 void SkeletonRenderer::initWithFile (const std::string& skeletonDataFile, const std::string& atlasFile, float scale) {
-	_atlas = spAtlas_createFromFile(atlasFile.c_str(), 0);
-	CCASSERT(_atlas, "Error reading atlas file.");
+	// The skeleton data and the atlas are shared with the other skeletons loaded from the same files.
+	spSkeletonData* skeletonData = SkeletonDataCache::getInstance()->retain(skeletonDataFile, atlasFile, scale);
+	CCASSERT(skeletonData, "Error reading skeleton data file.");
 
-	_attachmentLoader = SUPER(Cocos2dAttachmentLoader_create(_atlas));
-
-	spSkeletonJson* json = spSkeletonJson_createWithLoader(_attachmentLoader);
-	json->scale = scale;
-	spSkeletonData* skeletonData = spSkeletonJson_readSkeletonDataFile(json, skeletonDataFile.c_str());
-	CCASSERT(skeletonData, json->error ? json->error : "Error reading skeleton data file.");
-	spSkeletonJson_dispose(json);
-
-	setSkeletonData(skeletonData, true);
+	setSkeletonData(skeletonData, false);
+	_cachedSkeletonData = true;
 
 	initialize();
 }
@@ -153,35 +156,125 @@ void SkeletonRenderer::draw (Renderer* renderer, const Mat4& transform, uint32_t
 	_skeleton->b = nodeColor.b / (float)255;
 	_skeleton->a = getDisplayedOpacity() / (float)255;
 
+	int verticesCount = 0, worldVerticesLength = 8;
+	for (int i = 0, n = _skeleton->slotsCount; i < n; ++i) {
+		spSlot* slot = _skeleton->drawOrder[i];
+		AttachmentVertices* attachmentVertices = getAttachmentVertices(slot);
+		if (!attachmentVertices) continue;
+		verticesCount += attachmentVertices->_triangles->vertCount;
+		if (slot->attachment->type == SP_ATTACHMENT_MESH)
+			worldVerticesLength = max(worldVerticesLength, ((spMeshAttachment*)slot->attachment)->super.worldVerticesLength);
+	}
+
+	if (verticesCount > 0) {
+		// Grown now so that computeVertices doesn't allocate when it runs on a worker.
+		ensureWorldVertices(worldVerticesLength);
+
+		// The commands point into the range reserved for the skeleton, it is filled now or with the other skeletons of the frame.
+		V3F_C4B_T2F* vertices = batch->reserveVertices(verticesCount);
+
+		// The consecutive attachments drawn with the same texture and blending are drawn by a single command, their indices are
+		// copied to the frame and offset to the vertices of the run. A command can't address more vertices than the renderer VBO.
+		TrianglesCommand::Triangles triangles;
+		triangles.verts = vertices;
+		triangles.vertCount = 0;
+		triangles.indexCount = 0;
+		int runStart = 0, runAttachments = 0;
+		GLuint textureID = 0;
+		BlendFunc blendFunc = BlendFunc::DISABLE;
+		auto addCommand = [&] (int runEnd) {
+			if (runAttachments == 1)
+				triangles.indices = getAttachmentVertices(_skeleton->drawOrder[runStart])->_triangles->indices;
+			else {
+				unsigned short* indices = batch->reserveIndices(triangles.indexCount);
+				triangles.indices = indices;
+				unsigned short offset = 0;
+				for (int i = runStart; i < runEnd; ++i) {
+					AttachmentVertices* attachmentVertices = getAttachmentVertices(_skeleton->drawOrder[i]);
+					if (!attachmentVertices) continue;
+					const TrianglesCommand::Triangles* attachmentTriangles = attachmentVertices->_triangles;
+					for (int ii = 0, nn = attachmentTriangles->indexCount; ii < nn; ++ii)
+						*indices++ = attachmentTriangles->indices[ii] + offset;
+					offset += attachmentTriangles->vertCount;
+				}
+			}
+			batch->addReservedCommand(renderer, _globalZOrder, textureID, _glProgramState, blendFunc, triangles, transform, transformFlags);
+			triangles.verts += triangles.vertCount;
+			triangles.vertCount = 0;
+			triangles.indexCount = 0;
+			runAttachments = 0;
+		};
+
+		for (int i = 0, n = _skeleton->slotsCount; i < n; ++i) {
+			spSlot* slot = _skeleton->drawOrder[i];
+			AttachmentVertices* attachmentVertices = getAttachmentVertices(slot);
+			if (!attachmentVertices) continue;
+
+			BlendFunc slotBlendFunc;
+			switch (slot->data->blendMode) {
+			case SP_BLEND_MODE_ADDITIVE:
+				slotBlendFunc.src = _premultipliedAlpha ? GL_ONE : GL_SRC_ALPHA;
+				slotBlendFunc.dst = GL_ONE;
+				break;
+			case SP_BLEND_MODE_MULTIPLY:
+				slotBlendFunc.src = GL_DST_COLOR;
+				slotBlendFunc.dst = GL_ONE_MINUS_SRC_ALPHA;
+				break;
+			case SP_BLEND_MODE_SCREEN:
+				slotBlendFunc.src = GL_ONE;
+				slotBlendFunc.dst = GL_ONE_MINUS_SRC_COLOR;
+				break;
+			default:
+				slotBlendFunc.src = _premultipliedAlpha ? GL_ONE : GL_SRC_ALPHA;
+				slotBlendFunc.dst = GL_ONE_MINUS_SRC_ALPHA;
+			}
+			GLuint slotTextureID = attachmentVertices->_texture->getName();
+			const TrianglesCommand::Triangles* attachmentTriangles = attachmentVertices->_triangles;
+
+			if (runAttachments > 0 && (slotTextureID != textureID || slotBlendFunc != blendFunc
+				|| triangles.vertCount + attachmentTriangles->vertCount > Renderer::VBO_SIZE
+				|| triangles.indexCount + attachmentTriangles->indexCount > Renderer::INDEX_VBO_SIZE))
+				addCommand(i);
+			if (runAttachments == 0) {
+				runStart = i;
+				textureID = slotTextureID;
+				blendFunc = slotBlendFunc;
+			}
+			runAttachments++;
+			triangles.vertCount += attachmentTriangles->vertCount;
+			triangles.indexCount += attachmentTriangles->indexCount;
+		}
+		if (runAttachments > 0) addCommand(_skeleton->slotsCount);
+
+		if (!batch->deferVertices(renderer, this, vertices, verticesCount)) computeVertices(vertices);
+	}
+
+	if (_debugSlots || _debugBones) {
+        drawDebug(renderer, transform, transformFlags);
+	}
+}
+
+void SkeletonRenderer::computeVertices (V3F_C4B_T2F* vertices) {
 	Color4B color;
-	AttachmentVertices* attachmentVertices = nullptr;
 	for (int i = 0, n = _skeleton->slotsCount; i < n; ++i) {
 		spSlot* slot = _skeleton->drawOrder[i];
-		if (!slot->attachment) continue;
+		AttachmentVertices* attachmentVertices = getAttachmentVertices(slot);
+		if (!attachmentVertices) continue;
 
-		switch (slot->attachment->type) {
-		case SP_ATTACHMENT_REGION: {
+		if (slot->attachment->type == SP_ATTACHMENT_REGION) {
 			spRegionAttachment* attachment = (spRegionAttachment*)slot->attachment;
 			spRegionAttachment_computeWorldVertices(attachment, slot->bone, _worldVertices);
-			attachmentVertices = getAttachmentVertices(attachment);
 			color.r = attachment->r;
 			color.g = attachment->g;
 			color.b = attachment->b;
 			color.a = attachment->a;
-			break;
-		}
-		case SP_ATTACHMENT_MESH: {
+		} else {
 			spMeshAttachment* attachment = (spMeshAttachment*)slot->attachment;
 			spMeshAttachment_computeWorldVertices(attachment, slot, _worldVertices);
-			attachmentVertices = getAttachmentVertices(attachment);
 			color.r = attachment->r;
 			color.g = attachment->g;
 			color.b = attachment->b;
 			color.a = attachment->a;
-			break;
-		}
-		default:
-			continue;
 		}
 
 		color.a *= _skeleton->a * slot->a * 255;
@@ -190,38 +283,15 @@ void SkeletonRenderer::draw (Renderer* renderer, const Mat4& transform, uint32_t
 		color.g *= _skeleton->g * slot->g * multiplier;
 		color.b *= _skeleton->b * slot->b * multiplier;
 
-		for (int v = 0, w = 0, vn = attachmentVertices->_triangles->vertCount; v < vn; ++v, w += 2) {
-			V3F_C4B_T2F* vertex = attachmentVertices->_triangles->verts + v;
-			vertex->vertices.x = _worldVertices[w];
-			vertex->vertices.y = _worldVertices[w + 1];
-			vertex->colors = color;
-		}
-
-		BlendFunc blendFunc;
-		switch (slot->data->blendMode) {
-		case SP_BLEND_MODE_ADDITIVE:
-			blendFunc.src = _premultipliedAlpha ? GL_ONE : GL_SRC_ALPHA;
-			blendFunc.dst = GL_ONE;
-			break;
-		case SP_BLEND_MODE_MULTIPLY:
-			blendFunc.src = GL_DST_COLOR;
-			blendFunc.dst = GL_ONE_MINUS_SRC_ALPHA;
-			break;
-		case SP_BLEND_MODE_SCREEN:
-			blendFunc.src = GL_ONE;
-			blendFunc.dst = GL_ONE_MINUS_SRC_COLOR;
-			break;
-		default:
-			blendFunc.src = _premultipliedAlpha ? GL_ONE : GL_SRC_ALPHA;
-			blendFunc.dst = GL_ONE_MINUS_SRC_ALPHA;
+		// The attachment vertices are shared by the skeletons, they only provide the texture coordinates.
+		const V3F_C4B_T2F* attachmentVertex = attachmentVertices->_triangles->verts;
+		for (int v = 0, w = 0, vn = attachmentVertices->_triangles->vertCount; v < vn; ++v, w += 2, ++vertices, ++attachmentVertex) {
+			vertices->vertices.x = _worldVertices[w];
+			vertices->vertices.y = _worldVertices[w + 1];
+			vertices->vertices.z = attachmentVertex->vertices.z;
+			vertices->colors = color;
+			vertices->texCoords = attachmentVertex->texCoords;
 		}
-
-		batch->addCommand(renderer, _globalZOrder, attachmentVertices->_texture->getName(), _glProgramState, blendFunc,
-			*attachmentVertices->_triangles, transform, transformFlags);
-	}
-
-	if (_debugSlots || _debugBones) {
-        drawDebug(renderer, transform, transformFlags);
 	}
 }
 
@@ -281,6 +351,18 @@ AttachmentVertices* SkeletonRenderer::getAttachmentVertices (spMeshAttachment* a
 	return (AttachmentVertices*)attachment->rendererObject;
 }
 
+AttachmentVertices* SkeletonRenderer::getAttachmentVertices (spSlot* slot) const {
+	if (!slot->attachment) return nullptr;
+	switch (slot->attachment->type) {
+	case SP_ATTACHMENT_REGION:
+		return getAttachmentVertices((spRegionAttachment*)slot->attachment);
+	case SP_ATTACHMENT_MESH:
+		return getAttachmentVertices((spMeshAttachment*)slot->attachment);
+	default:
+		return nullptr;
+	}
+}
+
 Rect SkeletonRenderer::getBoundingBox () const {
 	float minX = FLT_MAX, minY = FLT_MAX, maxX = FLT_MIN, maxY = FLT_MIN;
 	float scaleX = getScaleX(), scaleY = getScaleY();
@@ -294,6 +376,7 @@ Rect SkeletonRenderer::getBoundingBox () const {
 			verticesCount = 8;
 		} else if (slot->attachment->type == SP_ATTACHMENT_MESH) {
 			spMeshAttachment* mesh = (spMeshAttachment*)slot->attachment;
+			ensureWorldVertices(mesh->super.worldVerticesLength);
 			spMeshAttachment_computeWorldVertices(mesh, slot, _worldVertices);
 			verticesCount = mesh->super.worldVerticesLength;
 		} else
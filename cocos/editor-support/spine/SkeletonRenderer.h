@@ -41,10 +41,14 @@ class AttachmentVertices;
 
 /* Draws a skeleton. */
 class SkeletonRenderer: public cocos2d::Node, public cocos2d::BlendProtocol {
+	friend class SkeletonBatch;
+
 public:
 	CREATE_FUNC(SkeletonRenderer);
 	static SkeletonRenderer* createWithData (spSkeletonData* skeletonData, bool ownsSkeletonData = false);
 	static SkeletonRenderer* createWithFile (const std::string& skeletonDataFile, spAtlas* atlas, float scale = 1);
+	/* The skeleton data is shared with the other skeletons created from the same files and scale, see SkeletonDataCache. The
+	 * skeleton data file may be JSON or binary (".skel"). */
 	static SkeletonRenderer* createWithFile (const std::string& skeletonDataFile, const std::string& atlasFile, float scale = 1);
 
 	virtual void update (float deltaTime) override;
@@ -117,13 +121,22 @@ protected:
 	void setSkeletonData (spSkeletonData* skeletonData, bool ownsSkeletonData);
 	virtual AttachmentVertices* getAttachmentVertices (spRegionAttachment* attachment) const;
 	virtual AttachmentVertices* getAttachmentVertices (spMeshAttachment* attachment) const;
+	/* Returns 0 if the slot has no attachment drawn. */
+	AttachmentVertices* getAttachmentVertices (spSlot* slot) const;
+	/* Fills the vertices of all the attachments drawn, in draw order. Only reads the skeleton, can be called on a worker. */
+	void computeVertices (cocos2d::V3F_C4B_T2F* vertices);
+	/* Grows the scratch buffer of the world vertices to hold count floats. */
+	void ensureWorldVertices (int count) const;
 
 	bool _ownsSkeletonData;
+	/* The skeleton data was retained from the SkeletonDataCache. */
+	bool _cachedSkeletonData;
 	spAtlas* _atlas;
 	spAttachmentLoader* _attachmentLoader;
 	cocos2d::CustomCommand _debugCommand;
 	cocos2d::BlendFunc _blendFunc;
-	float* _worldVertices;
+	mutable float* _worldVertices;
+	mutable int _worldVerticesCapacity;
 	bool _premultipliedAlpha;
 	spSkeleton* _skeleton;
 	float _timeScale;
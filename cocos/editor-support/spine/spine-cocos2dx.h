@@ -38,5 +38,6 @@
 #include <spine/SkeletonRenderer.h>
 #include <spine/SkeletonAnimation.h>
 #include <spine/SkeletonBatch.h>
+#include <spine/SkeletonDataCache.h>
 
 #endif /* SPINE_COCOS2DX_H_ */
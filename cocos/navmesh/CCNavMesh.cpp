@@ -28,6 +28,9 @@
 #include "renderer/CCRenderer.h"
 #include "recast/Detour/DetourCommon.h"
 #include "recast/DebugUtils/DetourDebugDraw.h"
+#include "base/CCWorkerPool.h"
+#include "base/CCAsyncTaskPool.h"
+#include <chrono>
 #include <sstream>
 
 NS_CC_BEGIN
@@ -82,12 +85,18 @@ static unsigned char* parseRow(unsigned char* buf, unsigned char* bufEnd, char*
 
 static const int TILECACHESET_MAGIC = 'T' << 24 | 'S' << 16 | 'E' << 8 | 'T'; //'TSET';
 static const int TILECACHESET_VERSION = 1;
-static const int MAX_AGENTS = 128;
+static const int MAX_SEARCH_NODES = 2048;
+static const int PATH_QUERY_GRAIN_SIZE = 4;
 
-NavMesh* NavMesh::create(const std::string &navFilePath, const std::string &geomFilePath)
+static float elapsedMilliseconds(const std::chrono::steady_clock::time_point &start)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0f;
+}
+
+NavMesh* NavMesh::create(const std::string &navFilePath, const std::string &geomFilePath, int maxAgents)
 {
     auto ref = new (std::nothrow) NavMesh();
-    if (ref && ref->initWithFilePath(navFilePath, geomFilePath))
+    if (ref && ref->initWithFilePath(navFilePath, geomFilePath, maxAgents))
     {
         ref->autorelease();
         return ref;
@@ -106,7 +115,14 @@ NavMesh::NavMesh()
     , _meshProcess(nullptr)
     , _geomData(nullptr)
     , _isDebugDrawEnabled(false)
+    , _maxAgents(0)
+    , _maxPathQueriesPerUpdate(0)
+    , _crowdUpdateInterval(0.0f)
+    , _crowdElapsedTime(0.0f)
+    , _buildingTileCount(0)
+    , _tileRebuildBudget(1.0f)
 {
+    memset(&_stats, 0, sizeof(_stats));
 
 }
 
@@ -116,6 +132,13 @@ NavMesh::~NavMesh()
     dtFreeCrowd(_crowed);
     dtFreeNavMesh(_navMesh);
     dtFreeNavMeshQuery(_navMeshQuery);
+    for (auto query : _workerQueries){
+        dtFreeNavMeshQuery(query);
+    }
+    for (auto &tile : _rebuiltTiles){
+        for (auto &layer : tile.layers)
+            dtFree(layer.data);
+    }
     CC_SAFE_DELETE(_allocator);
     CC_SAFE_DELETE(_compressor);
     CC_SAFE_DELETE(_meshProcess);
@@ -132,10 +155,11 @@ NavMesh::~NavMesh()
     _obstacleList.clear();
 }
 
-bool NavMesh::initWithFilePath(const std::string &navFilePath, const std::string &geomFilePath)
+bool NavMesh::initWithFilePath(const std::string &navFilePath, const std::string &geomFilePath, int maxAgents)
 {
     _navFilePath = navFilePath;
     _geomFilePath = geomFilePath;
+    _maxAgents = maxAgents;
     if (!read()) return false;
     return true;
 }
@@ -215,13 +239,13 @@ bool NavMesh::loadNavMeshFile()
 
     //create crowed
     _crowed = dtAllocCrowd();
-    _crowed->init(MAX_AGENTS, header.cacheParams.walkableRadius, _navMesh);
+    _crowed->init(_maxAgents, header.cacheParams.walkableRadius, _navMesh);
 
     //create NavMeshQuery
     _navMeshQuery = dtAllocNavMeshQuery();
-    _navMeshQuery->init(_navMesh, 2048);
+    _navMeshQuery->init(_navMesh, MAX_SEARCH_NODES);
 
-    _agentList.assign(MAX_AGENTS, nullptr);
+    _agentList.assign(_maxAgents, nullptr);
     _obstacleList.assign(header.cacheParams.maxObstacles, nullptr);
     //duDebugDrawNavMesh(&_debugDraw, *_navMesh, DU_DRAWNAVMESH_OFFMESHCONS);
     return true;
@@ -454,9 +478,15 @@ void NavMesh::debugDraw(Renderer* renderer)
 
 void NavMesh::update(float dt)
 {
+    //the path queries run before the tile cache changes the navmesh
+    runPathQueries();
+
+    _stats.agentCount = 0;
     for (auto iter : _agentList){
-        if (iter)
+        if (iter){
             iter->preUpdate(dt);
+            ++_stats.agentCount;
+        }
     }
 
     for (auto iter : _obstacleList){
@@ -464,11 +494,25 @@ void NavMesh::update(float dt)
             iter->preUpdate(dt);
     }
 
-    if (_crowed)
-        _crowed->update(dt, nullptr);
+    _stats.crowdUpdateTime = 0.0f;
+    if (_crowed){
+        _crowdElapsedTime += dt;
+        if (_crowdElapsedTime >= _crowdUpdateInterval){
+            auto start = std::chrono::steady_clock::now();
+            _crowed->update(_crowdElapsedTime, nullptr);
+            _stats.crowdUpdateTime = elapsedMilliseconds(start);
+            _crowdElapsedTime = 0.0f;
+        }
+    }
 
-    if (_tileCache)
+    _stats.tileCacheUpdateTime = 0.0f;
+    if (_tileCache){
+        auto start = std::chrono::steady_clock::now();
         _tileCache->update(dt, _navMesh);
+        _stats.tileCacheUpdateTime = elapsedMilliseconds(start);
+    }
+
+    addRebuiltTiles();
 
     for (auto iter : _agentList){
         if (iter)
@@ -481,7 +525,7 @@ void NavMesh::update(float dt)
     }
 }
 
-void cocos2d::NavMesh::findPath(const Vec3 &start, const Vec3 &end, std::vector<Vec3> &pathPoints)
+static void findPathWithQuery(dtNavMesh *navMesh, dtNavMeshQuery *navMeshQuery, const Vec3 &start, const Vec3 &end, std::vector<Vec3> &pathPoints)
 {
     static const int MAX_POLYS = 256;
     static const int MAX_SMOOTH = 2048;
@@ -491,9 +535,9 @@ void cocos2d::NavMesh::findPath(const Vec3 &start, const Vec3 &end, std::vector<
     dtPolyRef startRef, endRef;
     dtPolyRef polys[MAX_POLYS];
     int npolys = 0;
-    _navMeshQuery->findNearestPoly(&start.x, ext, &filter, &startRef, 0);
-    _navMeshQuery->findNearestPoly(&end.x, ext, &filter, &endRef, 0);
-    _navMeshQuery->findPath(startRef, endRef, &start.x, &end.x, &filter, polys, &npolys, MAX_POLYS);
+    navMeshQuery->findNearestPoly(&start.x, ext, &filter, &startRef, 0);
+    navMeshQuery->findNearestPoly(&end.x, ext, &filter, &endRef, 0);
+    navMeshQuery->findPath(startRef, endRef, &start.x, &end.x, &filter, polys, &npolys, MAX_POLYS);
 
     if (npolys)
     {
@@ -503,8 +547,8 @@ void cocos2d::NavMesh::findPath(const Vec3 &start, const Vec3 &end, std::vector<
         //int npolys = npolys;
 
         float iterPos[3], targetPos[3];
-        _navMeshQuery->closestPointOnPoly(startRef, &start.x, iterPos, 0);
-        _navMeshQuery->closestPointOnPoly(polys[npolys - 1], &end.x, targetPos, 0);
+        navMeshQuery->closestPointOnPoly(startRef, &start.x, iterPos, 0);
+        navMeshQuery->closestPointOnPoly(polys[npolys - 1], &end.x, targetPos, 0);
 
         static const float STEP_SIZE = 0.5f;
         static const float SLOP = 0.01f;
@@ -525,7 +569,7 @@ void cocos2d::NavMesh::findPath(const Vec3 &start, const Vec3 &end, std::vector<
             unsigned char steerPosFlag;
             dtPolyRef steerPosRef;
 
-            if (!getSteerTarget(_navMeshQuery, iterPos, targetPos, SLOP,
+            if (!getSteerTarget(navMeshQuery, iterPos, targetPos, SLOP,
                 polys, npolys, steerPos, steerPosFlag, steerPosRef))
                 break;
 
@@ -548,14 +592,14 @@ void cocos2d::NavMesh::findPath(const Vec3 &start, const Vec3 &end, std::vector<
             float result[3];
             dtPolyRef visited[16];
             int nvisited = 0;
-            _navMeshQuery->moveAlongSurface(polys[0], iterPos, moveTgt, &filter,
+            navMeshQuery->moveAlongSurface(polys[0], iterPos, moveTgt, &filter,
                 result, visited, &nvisited, 16);
 
             npolys = fixupCorridor(polys, npolys, MAX_POLYS, visited, nvisited);
-            npolys = fixupShortcuts(polys, npolys, _navMeshQuery);
+            npolys = fixupShortcuts(polys, npolys, navMeshQuery);
 
             float h = 0;
-            _navMeshQuery->getPolyHeight(polys[0], result, &h);
+            navMeshQuery->getPolyHeight(polys[0], result, &h);
             result[1] = h;
             dtVcopy(iterPos, result);
 
@@ -592,7 +636,7 @@ void cocos2d::NavMesh::findPath(const Vec3 &start, const Vec3 &end, std::vector<
                 npolys -= npos;
 
                 // Handle the connection.
-                dtStatus status = _navMesh->getOffMeshConnectionPolyEndPoints(prevRef, polyRef, startPos, endPos);
+                dtStatus status = navMesh->getOffMeshConnectionPolyEndPoints(prevRef, polyRef, startPos, endPos);
                 if (dtStatusSucceed(status))
                 {
                     if (nsmoothPath < MAX_SMOOTH)
@@ -613,7 +657,7 @@ void cocos2d::NavMesh::findPath(const Vec3 &start, const Vec3 &end, std::vector<
                     // Move position at the other side of the off-mesh link.
                     dtVcopy(iterPos, endPos);
                     float eh = 0.0f;
-                    _navMeshQuery->getPolyHeight(polys[0], iterPos, &eh);
+                    navMeshQuery->getPolyHeight(polys[0], iterPos, &eh);
                     iterPos[1] = eh;
                 }
             }
@@ -631,6 +675,199 @@ void cocos2d::NavMesh::findPath(const Vec3 &start, const Vec3 &end, std::vector<
     }
 }
 
+void NavMesh::findPath(const Vec3 &start, const Vec3 &end, std::vector<Vec3> &pathPoints)
+{
+    findPathWithQuery(_navMesh, _navMeshQuery, start, end, pathPoints);
+}
+
+void NavMesh::findPathAsync(const Vec3 &start, const Vec3 &end, const FindPathCallback &callback)
+{
+    PathQuery query;
+    query.start = start;
+    query.end = end;
+    query.callback = callback;
+    _pathQueries.push_back(std::move(query));
+}
+
+void NavMesh::runPathQueries()
+{
+    int count = (int)_pathQueries.size();
+    if (0 < _maxPathQueriesPerUpdate && _maxPathQueriesPerUpdate < count)
+        count = _maxPathQueriesPerUpdate;
+    _stats.pathQueryCount = count;
+    _stats.pendingPathQueryCount = (int)_pathQueries.size() - count;
+    _stats.pathQueryTime = 0.0f;
+    if (count == 0 || !_navMesh)
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+
+    //the callbacks may ask for new paths, they are run by the next update
+    _runningPathQueries.assign(std::make_move_iterator(_pathQueries.begin()), std::make_move_iterator(_pathQueries.begin() + count));
+    _pathQueries.erase(_pathQueries.begin(), _pathQueries.begin() + count);
+
+    WorkerPool::getInstance()->parallelFor(count, PATH_QUERY_GRAIN_SIZE, [this](int begin, int end){
+        auto navMeshQuery = acquireWorkerQuery();
+        for (int i = begin; i < end; ++i){
+            auto &query = _runningPathQueries[i];
+            findPathWithQuery(_navMesh, navMeshQuery, query.start, query.end, query.pathPoints);
+        }
+        releaseWorkerQuery(navMeshQuery);
+    });
+
+    for (auto &query : _runningPathQueries){
+        if (query.callback)
+            query.callback(query.pathPoints);
+    }
+    _runningPathQueries.clear();
+
+    _stats.pathQueryTime = elapsedMilliseconds(start);
+}
+
+void NavMesh::setGeometry(const std::vector<Vec3> &triangles)
+{
+    auto geometry = std::make_shared<std::vector<float>>();
+    geometry->reserve(triangles.size() * 3);
+    for (const auto &vertex : triangles){
+        geometry->push_back(vertex.x);
+        geometry->push_back(vertex.y);
+        geometry->push_back(vertex.z);
+    }
+    _geometry = geometry;
+}
+
+void NavMesh::rebuildTiles(const Vec3 &min, const Vec3 &max)
+{
+    if (!_tileCache || !_geometry)
+        return;
+
+    const dtTileCacheParams params = *_tileCache->getParams();
+    const float tileWidth = params.width * params.cs;
+    const float tileHeight = params.height * params.cs;
+    const int minx = (int)floorf((min.x - params.orig[0]) / tileWidth);
+    const int maxx = (int)floorf((max.x - params.orig[0]) / tileWidth);
+    const int miny = (int)floorf((min.z - params.orig[2]) / tileHeight);
+    const int maxy = (int)floorf((max.z - params.orig[2]) / tileHeight);
+
+    for (int ty = miny; ty <= maxy; ++ty){
+        for (int tx = minx; tx <= maxx; ++tx){
+            //the tiles are built in the order of the requests by a single thread, the last request of a tile wins
+            auto tile = std::make_shared<RebuiltTile>();
+            tile->tx = tx;
+            tile->ty = ty;
+            tile->built = false;
+            auto geometry = _geometry;
+            ++_buildingTileCount;
+            retain();
+            AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_OTHER, [this, tile](void*){
+                --_buildingTileCount;
+                //a failed build keeps the old tile, a tile without layers replaces it: its geometry is gone
+                if (tile->built)
+                    _rebuiltTiles.push_back(std::move(*tile));
+                else
+                    CCLOG("NavMesh: failed to build the tile %d %d", tile->tx, tile->ty);
+                release();
+            }, nullptr, [params, geometry, tile](){
+                tile->built = buildTileCacheLayers(params, geometry->data(), (int)geometry->size() / 9, tile->tx, tile->ty, tile->layers);
+            });
+        }
+    }
+}
+
+void NavMesh::addRebuiltTiles()
+{
+    _stats.tileRebuildTime = 0.0f;
+    _stats.pendingTileCount = _buildingTileCount + (int)_rebuiltTiles.size();
+    if (_rebuiltTiles.empty() || !_tileCache)
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    while (!_rebuiltTiles.empty()){
+        auto &tile = _rebuiltTiles.front();
+        replaceTile(tile.tx, tile.ty, tile.layers);
+        _rebuiltTiles.pop_front();
+
+        _stats.tileRebuildTime = elapsedMilliseconds(start);
+        if (_tileRebuildBudget <= _stats.tileRebuildTime)
+            break;
+    }
+}
+
+void NavMesh::replaceTile(int tx, int ty, std::vector<TileCacheLayer> &layers)
+{
+    //the old layers are removed and the new ones added in the same update, the queries never see a half built tile
+    //without new layers the tile is only removed
+    dtCompressedTileRef compressedTiles[NAVMESH_MAX_TILE_LAYERS];
+    int count = _tileCache->getTilesAt(tx, ty, compressedTiles, NAVMESH_MAX_TILE_LAYERS);
+    for (int i = 0; i < count; ++i){
+        _tileCache->removeTile(compressedTiles[i], nullptr, nullptr);
+    }
+
+    const dtMeshTile *meshTiles[NAVMESH_MAX_TILE_LAYERS];
+    dtTileRef meshTileRefs[NAVMESH_MAX_TILE_LAYERS];
+    count = _navMesh->getTilesAt(tx, ty, meshTiles, NAVMESH_MAX_TILE_LAYERS);
+    for (int i = 0; i < count; ++i){
+        meshTileRefs[i] = _navMesh->getTileRef(meshTiles[i]);
+    }
+    for (int i = 0; i < count; ++i){
+        _navMesh->removeTile(meshTileRefs[i], nullptr, nullptr);
+    }
+
+    count = 0;
+    for (auto &layer : layers){
+        dtStatus status = _tileCache->addTile(layer.data, layer.dataSize, DT_COMPRESSEDTILE_FREE_DATA, &compressedTiles[count]);
+        if (dtStatusFailed(status)){
+            dtFree(layer.data);
+            continue;
+        }
+        ++count;
+    }
+    layers.clear();
+
+    //the obstacles touching the tile still refer to the removed layers, the new layers get new refs
+    const dtTileCacheParams *params = _tileCache->getParams();
+    const float tileWidth = params->width * params->cs;
+    const float tileHeight = params->height * params->cs;
+    const float tileMinX = params->orig[0] + tx * tileWidth;
+    const float tileMinZ = params->orig[2] + ty * tileHeight;
+    for (int i = 0; i < _tileCache->getObstacleCount(); ++i){
+        auto obstacle = const_cast<dtTileCacheObstacle*>(_tileCache->getObstacle(i));
+        if (obstacle->state != DT_OBSTACLE_PROCESSING && obstacle->state != DT_OBSTACLE_PROCESSED)
+            continue;
+        float bmin[3], bmax[3];
+        _tileCache->getObstacleBounds(obstacle, bmin, bmax);
+        if (bmax[0] < tileMinX || tileMinX + tileWidth < bmin[0] || bmax[2] < tileMinZ || tileMinZ + tileHeight < bmin[2])
+            continue;
+        int touchedCount = 0;
+        _tileCache->queryTiles(bmin, bmax, obstacle->touched, &touchedCount, DT_MAX_TOUCHED_TILES);
+        obstacle->ntouched = (unsigned char)touchedCount;
+    }
+
+    for (int i = 0; i < count; ++i){
+        _tileCache->buildNavMeshTile(compressedTiles[i], _navMesh);
+    }
+}
+
+dtNavMeshQuery* NavMesh::acquireWorkerQuery()
+{
+    std::lock_guard<std::mutex> lock(_workerQueryMutex);
+    if (_freeWorkerQueries.empty()){
+        auto navMeshQuery = dtAllocNavMeshQuery();
+        navMeshQuery->init(_navMesh, MAX_SEARCH_NODES);
+        _workerQueries.push_back(navMeshQuery);
+        return navMeshQuery;
+    }
+    auto navMeshQuery = _freeWorkerQueries.back();
+    _freeWorkerQueries.pop_back();
+    return navMeshQuery;
+}
+
+void NavMesh::releaseWorkerQuery(dtNavMeshQuery *query)
+{
+    std::lock_guard<std::mutex> lock(_workerQueryMutex);
+    _freeWorkerQueries.push_back(query);
+}
+
 NS_CC_END
 
 #endif //CC_USE_NAVMESH
@@ -34,6 +34,10 @@
 #include "recast/Detour/DetourNavMeshQuery.h"
 #include "recast/DetourCrowd/DetourCrowd.h"
 #include "recast/DetourTileCache/DetourTileCache.h"
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -55,13 +59,30 @@ class CC_DLL NavMesh : public Ref
 {
 public:
 
+    /** The callback of findPathAsync, pathPoints is empty if no path was found. */
+    typedef std::function<void(const std::vector<Vec3> &pathPoints)> FindPathCallback;
+
+    /** The cost of the last update, the times are in milliseconds. */
+    struct Stats
+    {
+        int agentCount;
+        int pathQueryCount; //number of queries of findPathAsync run by the update
+        int pendingPathQueryCount; //number of queries left for the next updates
+        int pendingTileCount; //number of tiles of rebuildTiles being built or waiting to be added
+        float pathQueryTime;
+        float crowdUpdateTime;
+        float tileCacheUpdateTime;
+        float tileRebuildTime; //time spent adding the rebuilt tiles
+    };
+
     /**
     Create navmesh
 
     @param navFilePath The NavMesh File path.
     @param geomFilePath The geometry File Path,include offmesh information,etc.
+    @param maxAgents The maximum number of agents of the navmesh.
     */
-    static NavMesh* create(const std::string &navFilePath, const std::string &geomFilePath);
+    static NavMesh* create(const std::string &navFilePath, const std::string &geomFilePath, int maxAgents = 128);
 
     /** update navmesh. */
     void update(float dt);
@@ -96,13 +117,65 @@ public:
     */
     void findPath(const Vec3 &start, const Vec3 &end, std::vector<Vec3> &pathPoints);
 
+    /**
+    find a path on navmesh in the next update, the queries of an update are run together on the threads of WorkerPool
+
+    @param start The start search position in world coordinate system.
+    @param end The end search position in world coordinate system.
+    @param callback called by the update with the key points of path, the callbacks are called in the order of the queries.
+    */
+    void findPathAsync(const Vec3 &start, const Vec3 &end, const FindPathCallback &callback);
+
+    /** Set the maximum number of queries of findPathAsync run by an update, the others are left to the next updates, 0 for no limit. */
+    void setMaxPathQueriesPerUpdate(int count) { _maxPathQueriesPerUpdate = count; }
+
+    /** Get the maximum number of queries of findPathAsync run by an update. */
+    int getMaxPathQueriesPerUpdate() const { return _maxPathQueriesPerUpdate; }
+
+    /**
+    Update the crowd once the interval elapsed instead of in every update, 0 by default.
+    This lowers the rate of the crowd updates, it does not time slice them: an update of the crowd still moves all the agents
+    with the elapsed time, and its cost is the same as with an interval of 0.
+    */
+    void setCrowdUpdateInterval(float interval) { _crowdUpdateInterval = interval; }
+
+    /** Get the interval of the crowd updates. */
+    float getCrowdUpdateInterval() const { return _crowdUpdateInterval; }
+
+    /**
+    Set the geometry rasterized by rebuildTiles, the triangles of the level in world coordinate system,
+    for example the ones given to Physics3DShape::createMesh.
+
+    @param triangles The vertices of the triangles, 3 vertices per triangle.
+    */
+    void setGeometry(const std::vector<Vec3> &triangles);
+
+    /**
+    Rebuild from the geometry the tiles overlapping a box, after the level changed.
+    The tiles are rasterized on a thread of AsyncTaskPool, then each of them replaces the old tile in a later update,
+    the obstacles are applied to the new tiles. A tile left without geometry is removed, a tile whose build failed is kept.
+
+    @param min The minimum corner of the box in world coordinate system.
+    @param max The maximum corner of the box in world coordinate system.
+    */
+    void rebuildTiles(const Vec3 &min, const Vec3 &max);
+
+    /** Set the time in milliseconds an update may spend adding the rebuilt tiles, an update adds at least a tile, 1 by default. */
+    void setTileRebuildBudget(float milliseconds) { _tileRebuildBudget = milliseconds; }
+
+    /** Get the time an update may spend adding the rebuilt tiles. */
+    float getTileRebuildBudget() const { return _tileRebuildBudget; }
+
+    /** Get the cost of the last update. */
+    const Stats& getStats() const { return _stats; }
+
 CC_CONSTRUCTOR_ACCESS:
     NavMesh();
     virtual ~NavMesh();
 
 protected:
 
-    bool initWithFilePath(const std::string &navFilePath, const std::string &geomFilePath);
+    bool initWithFilePath(const std::string &navFilePath, const std::string &geomFilePath, int maxAgents = 128);
     bool read();
     bool loadNavMeshFile();
     bool loadGeomFile();
@@ -110,9 +183,30 @@ protected:
     void drawAgents();
     void drawObstacles();
     void drawOffMeshConnections();
+    void runPathQueries();
+    dtNavMeshQuery* acquireWorkerQuery();
+    void releaseWorkerQuery(dtNavMeshQuery *query);
+    void addRebuiltTiles();
+    void replaceTile(int tx, int ty, std::vector<TileCacheLayer> &layers);
 
 protected:
 
+    struct PathQuery
+    {
+        Vec3 start;
+        Vec3 end;
+        FindPathCallback callback;
+        std::vector<Vec3> pathPoints;
+    };
+
+    struct RebuiltTile
+    {
+        int tx;
+        int ty;
+        bool built;
+        std::vector<TileCacheLayer> layers;
+    };
+
     dtNavMesh *_navMesh;
     dtNavMeshQuery *_navMeshQuery;
     dtCrowd *_crowed;
@@ -128,6 +222,25 @@ protected:
     std::string _navFilePath;
     std::string _geomFilePath;
     bool _isDebugDrawEnabled;
+    int _maxAgents;
+
+    std::vector<PathQuery> _pathQueries;
+    std::vector<PathQuery> _runningPathQueries;
+    int _maxPathQueriesPerUpdate;
+    //the queries of the worker threads, a thread takes one for a range of queries
+    std::vector<dtNavMeshQuery*> _workerQueries;
+    std::vector<dtNavMeshQuery*> _freeWorkerQueries;
+    std::mutex _workerQueryMutex;
+
+    float _crowdUpdateInterval;
+    float _crowdElapsedTime;
+
+    //shared with the tiles being built, replaced by setGeometry
+    std::shared_ptr<const std::vector<float>> _geometry;
+    std::deque<RebuiltTile> _rebuiltTiles;
+    int _buildingTileCount;
+    float _tileRebuildBudget;
+    Stats _stats;
 };
 
 /** @} */
@@ -26,7 +26,9 @@
 
 #include "recast/Detour/DetourCommon.h"
 #include "recast/Detour/DetourNavMeshBuilder.h"
+#include "recast/Recast/Recast.h"
 #include "recast/fastlz/fastlz.h"
+#include <float.h>
 
 NS_CC_BEGIN
 
@@ -284,6 +286,148 @@ bool inRange(const float* v1, const float* v2, const float r, const float h)
     return (dx*dx + dz*dz) < r*r && fabsf(dy) < h;
 }
 
+// the slope of the triangles above which they aren't walkable, in degrees
+static const float WALKABLE_SLOPE_ANGLE = 45.0f;
+
+namespace {
+    struct RasterizationContext
+    {
+        RasterizationContext()
+            : solid(nullptr)
+            , chf(nullptr)
+            , lset(nullptr)
+        {
+        }
+
+        ~RasterizationContext()
+        {
+            rcFreeHeightField(solid);
+            rcFreeCompactHeightfield(chf);
+            rcFreeHeightfieldLayerSet(lset);
+        }
+
+        rcHeightfield* solid;
+        rcCompactHeightfield* chf;
+        rcHeightfieldLayerSet* lset;
+    };
+}
+
+bool buildTileCacheLayers(const dtTileCacheParams& params, const float* verts, int triCount,
+    int tx, int ty, std::vector<TileCacheLayer>& layers)
+{
+    layers.clear();
+
+    // the configuration the tile cache was built with
+    rcConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.cs = params.cs;
+    cfg.ch = params.ch;
+    cfg.walkableSlopeAngle = WALKABLE_SLOPE_ANGLE;
+    cfg.walkableHeight = (int)ceilf(params.walkableHeight / cfg.ch);
+    cfg.walkableClimb = (int)floorf(params.walkableClimb / cfg.ch);
+    cfg.walkableRadius = (int)ceilf(params.walkableRadius / cfg.cs);
+    cfg.tileSize = params.width;
+    cfg.borderSize = cfg.walkableRadius + 3;
+    cfg.width = cfg.tileSize + cfg.borderSize * 2;
+    cfg.height = params.height + cfg.borderSize * 2;
+
+    // the bounds of the tile with its border
+    const float border = cfg.borderSize * cfg.cs;
+    cfg.bmin[0] = params.orig[0] + tx * params.width * cfg.cs - border;
+    cfg.bmin[2] = params.orig[2] + ty * params.height * cfg.cs - border;
+    cfg.bmax[0] = params.orig[0] + (tx + 1) * params.width * cfg.cs + border;
+    cfg.bmax[2] = params.orig[2] + (ty + 1) * params.height * cfg.cs + border;
+    cfg.bmin[1] = FLT_MAX;
+    cfg.bmax[1] = -FLT_MAX;
+
+    // the triangles overlapping the tile
+    std::vector<int> tris;
+    for (int i = 0; i < triCount; ++i)
+    {
+        const float* v = &verts[i * 9];
+        float tmin[3], tmax[3];
+        dtVcopy(tmin, v);
+        dtVcopy(tmax, v);
+        dtVmin(tmin, v + 3);
+        dtVmax(tmax, v + 3);
+        dtVmin(tmin, v + 6);
+        dtVmax(tmax, v + 6);
+        if (tmax[0] < cfg.bmin[0] || cfg.bmax[0] < tmin[0] || tmax[2] < cfg.bmin[2] || cfg.bmax[2] < tmin[2])
+            continue;
+
+        tris.push_back(i * 3);
+        tris.push_back(i * 3 + 1);
+        tris.push_back(i * 3 + 2);
+        cfg.bmin[1] = dtMin(cfg.bmin[1], tmin[1]);
+        cfg.bmax[1] = dtMax(cfg.bmax[1], tmax[1]);
+    }
+    if (tris.empty())
+        return true;
+
+    const int ntris = (int)tris.size() / 3;
+    std::vector<unsigned char> triareas(ntris, 0);
+
+    rcContext ctx(false);
+    RasterizationContext rc;
+    rc.solid = rcAllocHeightfield();
+    if (!rc.solid || !rcCreateHeightfield(&ctx, *rc.solid, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch))
+        return false;
+
+    rcMarkWalkableTriangles(&ctx, cfg.walkableSlopeAngle, verts, triCount * 3, tris.data(), ntris, triareas.data());
+    rcRasterizeTriangles(&ctx, verts, triCount * 3, tris.data(), triareas.data(), ntris, *rc.solid, cfg.walkableClimb);
+
+    rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *rc.solid);
+    rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *rc.solid);
+    rcFilterWalkableLowHeightSpans(&ctx, cfg.walkableHeight, *rc.solid);
+
+    rc.chf = rcAllocCompactHeightfield();
+    if (!rc.chf || !rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb, *rc.solid, *rc.chf))
+        return false;
+    if (!rcErodeWalkableArea(&ctx, cfg.walkableRadius, *rc.chf))
+        return false;
+
+    rc.lset = rcAllocHeightfieldLayerSet();
+    if (!rc.lset || !rcBuildHeightfieldLayers(&ctx, *rc.chf, cfg.borderSize, cfg.walkableHeight, *rc.lset))
+        return false;
+
+    FastLZCompressor compressor;
+    for (int i = 0; i < dtMin(rc.lset->nlayers, NAVMESH_MAX_TILE_LAYERS); ++i)
+    {
+        const rcHeightfieldLayer* layer = &rc.lset->layers[i];
+
+        dtTileCacheLayerHeader header;
+        header.magic = DT_TILECACHE_MAGIC;
+        header.version = DT_TILECACHE_VERSION;
+        header.tx = tx;
+        header.ty = ty;
+        header.tlayer = i;
+        dtVcopy(header.bmin, layer->bmin);
+        dtVcopy(header.bmax, layer->bmax);
+        header.width = (unsigned char)layer->width;
+        header.height = (unsigned char)layer->height;
+        header.minx = (unsigned char)layer->minx;
+        header.maxx = (unsigned char)layer->maxx;
+        header.miny = (unsigned char)layer->miny;
+        header.maxy = (unsigned char)layer->maxy;
+        header.hmin = (unsigned short)layer->hmin;
+        header.hmax = (unsigned short)layer->hmax;
+
+        TileCacheLayer tileLayer = { nullptr, 0 };
+        dtStatus status = dtBuildTileCacheLayer(&compressor, &header, layer->heights, layer->areas, layer->cons,
+            &tileLayer.data, &tileLayer.dataSize);
+        if (dtStatusFailed(status))
+        {
+            for (auto& built : layers)
+                dtFree(built.data);
+            layers.clear();
+            return false;
+        }
+        layers.push_back(tileLayer);
+    }
+
+    return true;
+}
+
 NS_CC_END
 
 #endif //CC_USE_NAVMESH
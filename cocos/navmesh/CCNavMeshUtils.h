@@ -37,6 +37,8 @@
 #include "recast/DetourTileCache/DetourTileCache.h"
 #include "recast/DetourTileCache/DetourTileCacheBuilder.h"
 
+#include <vector>
+
 NS_CC_BEGIN
 
 /**
@@ -103,6 +105,26 @@ struct MeshProcess : public dtTileCacheMeshProcess
         unsigned char* polyAreas, unsigned short* polyFlags) override;
 };
 
+/** The maximum number of layers of a tile of the tile cache. */
+static const int NAVMESH_MAX_TILE_LAYERS = 32;
+
+/** A compressed layer of the tile cache, the data is allocated with dtAlloc. */
+struct TileCacheLayer
+{
+    unsigned char* data;
+    int dataSize;
+};
+
+/**
+ * Rasterize the triangles overlapping the tile (tx, ty) of the tile cache into compressed layers with Recast,
+ * it doesn't use any shared state and may be called from any thread.
+ *
+ * @param verts the vertices of the triangles, 3 vertices per triangle.
+ * @return false if the tile couldn't be built, layers is empty if no triangle overlaps the tile.
+ */
+bool buildTileCacheLayers(const dtTileCacheParams& params, const float* verts, int triCount,
+    int tx, int ty, std::vector<TileCacheLayer>& layers);
+
 bool inRange(const float* v1, const float* v2, const float r, const float h);
 
 int fixupCorridor(dtPolyRef* path, const int npath, const int maxPath,
@@ -8,6 +8,8 @@ LOCAL_MODULE_FILENAME := libnetwork
 LOCAL_ARM_MODE := arm
 
 LOCAL_SRC_FILES := HttpClient-android.cpp \
+HttpCache.cpp \
+NetworkMetrics.cpp \
 SocketIO.cpp \
 WebSocket.cpp \
 CCDownloader.cpp \
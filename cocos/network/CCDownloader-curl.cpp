@@ -32,6 +32,8 @@
 #include "base/CCScheduler.h"
 #include "platform/CCFileUtils.h"
 #include "network/CCDownloader.h"
+#include "network/HttpCache.h"
+#include "network/NetworkMetrics-curl.h"
 
 // **NOTE**
 // In the file:
@@ -41,6 +43,24 @@
 namespace cocos2d { namespace network {
     using namespace std;
 
+    // fseek takes a long offset, 32 bits on Windows and the 32 bits platforms
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
+    static const int64_t MAX_SEEK_OFFSET = INT64_MAX;
+
+    static int seekFile(FILE* fp, int64_t offset)
+    {
+        return _fseeki64(fp, offset, SEEK_SET);
+    }
+#else
+    // off_t is still 32 bits on the platforms built without _FILE_OFFSET_BITS=64, 32 bits Android for instance
+    static const int64_t MAX_SEEK_OFFSET = sizeof(off_t) < sizeof(int64_t) ? INT32_MAX : INT64_MAX;
+
+    static int seekFile(FILE* fp, int64_t offset)
+    {
+        return fseeko(fp, (off_t)offset, SEEK_SET);
+    }
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 //  Implementation DownloadTaskCURL
 
@@ -54,9 +74,22 @@ namespace cocos2d { namespace network {
     public:
         int serialId;
 
+        // a byte range of the file downloaded by its own connection
+        struct Segment
+        {
+            DownloadTaskCURL* coTask;
+            CURL*   handle;
+            int64_t begin;
+            int64_t end;        // inclusive
+            int64_t pos;
+        };
+
         DownloadTaskCURL()
         : serialId(_sSerialId++)
         , _fp(nullptr)
+        , _preempted(false)
+        , _cached(false)
+        , _cacheHeaders(nullptr)
         {
             _initInternal();
             DLLOG("Construct DownloadTaskCURL %p", this);
@@ -75,6 +108,11 @@ namespace cocos2d { namespace network {
                 fclose(_fp);
                 _fp = nullptr;
             }
+            if (_cacheHeaders)
+            {
+                curl_slist_free_all(_cacheHeaders);
+                _cacheHeaders = nullptr;
+            }
             DLLOG("Destruct DownloadTaskCURL %p", this);
         }
 
@@ -188,6 +226,26 @@ namespace cocos2d { namespace network {
             return ret;
         }
 
+        size_t writeSegmentDataProc(Segment& segment, unsigned char *buffer, size_t size, size_t count)
+        {
+            lock_guard<mutex> lock(_mutex);
+            size_t len = size * count;
+            if (nullptr == _fp || segment.pos + (int64_t)len > segment.end + 1)
+            {
+                // abort the transfer if the server sends more than the requested range
+                return 0;
+            }
+            if (0 != seekFile(_fp, segment.pos))
+            {
+                return 0;
+            }
+            size_t ret = fwrite(buffer, 1, len, _fp);
+            segment.pos += ret;
+            _bytesReceived += ret;
+            _totalBytesReceived += ret;
+            return ret;
+        }
+
     private:
         friend class DownloaderCURL;
 
@@ -216,6 +274,15 @@ namespace cocos2d { namespace network {
         vector<unsigned char> _buf;
         FILE*  _fp;
 
+        // only used in thread proc
+        vector<Segment> _segments;
+        bool _preempted;
+
+        // cached response of a data task, only used in thread proc
+        bool _cached;
+        HttpCache::Entry _cacheEntry;
+        struct curl_slist* _cacheHeaders;
+
         void _initInternal()
         {
             _acceptRanges = (false);
@@ -257,8 +324,9 @@ namespace cocos2d { namespace network {
         {
             if (DownloadTask::ERROR_NO_ERROR == coTask->_errCode)
             {
+                NetworkMetrics::getInstance()->requestQueued(NetworkMetrics::Source::DOWNLOADER, coTask, "GET", task->requestURL);
                 lock_guard<mutex> lock(_requestMutex);
-                _requestQueue.push_back(make_pair(task, coTask));
+                _enqueueRequest(make_pair(task, coTask));
             }
             else
             {
@@ -308,6 +376,18 @@ namespace cocos2d { namespace network {
         }
 
     private:
+        // keep the request queue sorted by priority, tasks with same priority are processed in FIFO order
+        // _requestMutex should be locked by caller
+        void _enqueueRequest(const TaskWrapper& wrapper)
+        {
+            auto it = _requestQueue.begin();
+            while (it != _requestQueue.end() && it->first->priority >= wrapper.first->priority)
+            {
+                ++it;
+            }
+            _requestQueue.insert(it, wrapper);
+        }
+
         static size_t _outputHeaderCallbackProc(void *buffer, size_t size, size_t count, void *userdata)
         {
             int strLen = int(size * count);
@@ -326,10 +406,17 @@ namespace cocos2d { namespace network {
             return coTask->writeDataProc((unsigned char *)buffer, size, count);
         }
 
+        static size_t _outputSegmentCallbackProc(void *buffer, size_t size, size_t count, void *userdata)
+        {
+            DownloadTaskCURL::Segment *segment = (DownloadTaskCURL::Segment*)userdata;
+            return segment->coTask->writeSegmentDataProc(*segment, (unsigned char *)buffer, size, count);
+        }
+
         // this function designed call in work thread
         // the curl handle destroyed in _threadProc
         // handle inited for get header
-        void _initCurlHandleProc(CURL *handle, TaskWrapper& wrapper, bool forContent = false)
+        // handle inited for a range segment if segment is not null
+        void _initCurlHandleProc(CURL *handle, TaskWrapper& wrapper, bool forContent = false, DownloadTaskCURL::Segment *segment = nullptr)
         {
             const DownloadTask& task = *wrapper.first;
             const DownloadTaskCURL* coTask = wrapper.second;
@@ -338,15 +425,27 @@ namespace cocos2d { namespace network {
             curl_easy_setopt(handle, CURLOPT_URL, task.requestURL.c_str());
 
             // set write func
-            if (forContent)
+            if (segment)
             {
-                curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, DownloaderCURL::Impl::_outputDataCallbackProc);
+                char range[64];
+                sprintf(range, "%lld-%lld", (long long)segment->begin, (long long)segment->end);
+                curl_easy_setopt(handle, CURLOPT_RANGE, range);
+                curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, DownloaderCURL::Impl::_outputSegmentCallbackProc);
+                curl_easy_setopt(handle, CURLOPT_WRITEDATA, segment);
+                curl_easy_setopt(handle, CURLOPT_PRIVATE, segment);
             }
             else
             {
-                curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, DownloaderCURL::Impl::_outputHeaderCallbackProc);
+                if (forContent)
+                {
+                    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, DownloaderCURL::Impl::_outputDataCallbackProc);
+                }
+                else
+                {
+                    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, DownloaderCURL::Impl::_outputHeaderCallbackProc);
+                }
+                curl_easy_setopt(handle, CURLOPT_WRITEDATA, coTask);
             }
-            curl_easy_setopt(handle, CURLOPT_WRITEDATA, coTask);
 
             curl_easy_setopt(handle, CURLOPT_NOPROGRESS, true);
 //            curl_easy_setopt(handle, CURLOPT_XFERINFOFUNCTION, DownloaderCURL::Impl::_progressCallbackProc);
@@ -358,7 +457,7 @@ namespace cocos2d { namespace network {
             if (forContent)
             {
                 /** if server acceptRanges and local has part of file, we continue to download **/
-                if (coTask->_acceptRanges && coTask->_totalBytesReceived > 0)
+                if (nullptr == segment && coTask->_acceptRanges && coTask->_totalBytesReceived > 0)
                 {
                     curl_easy_setopt(handle, CURLOPT_RESUME_FROM_LARGE,(curl_off_t)coTask->_totalBytesReceived);
                 }
@@ -368,6 +467,11 @@ namespace cocos2d { namespace network {
                 // get header options
                 curl_easy_setopt(handle, CURLOPT_HEADER, 1);
                 curl_easy_setopt(handle, CURLOPT_NOBODY, 1);
+                if (coTask->_cacheHeaders)
+                {
+                    // conditional request, the server replies 304 if the cached response is still valid
+                    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, coTask->_cacheHeaders);
+                }
             }
 
 //            if (!sProxy.empty())
@@ -405,6 +509,16 @@ namespace cocos2d { namespace network {
                 {
                     break;
                 }
+                if (304 == httpResponseCode && coTask._cached)
+                {
+                    vector<char> header(coTask._header.begin(), coTask._header.end());
+                    if (HttpCache::getInstance()->revalidate(wrapper.first->requestURL, header, coTask._cacheEntry))
+                    {
+                        // no content to download, the task finishes with the cached data
+                        _serveFromCacheProc(coTask);
+                        return false;
+                    }
+                }
                 if (200 != httpResponseCode)
                 {
                     char buf[256] = {0};
@@ -451,6 +565,298 @@ namespace cocos2d { namespace network {
             return coTask._headerAchieved;
         }
 
+        // data tasks use HttpCache when it is enabled, as HttpClient does
+        // return true if the task is served by a fresh cached response and needs no request
+        bool _lookupCacheProc(TaskWrapper& wrapper)
+        {
+            DownloadTaskCURL& coTask = *wrapper.second;
+            HttpCache* cache = HttpCache::getInstance();
+            if (coTask._fileName.length() || !cache->isEnabled())
+            {
+                return false;
+            }
+
+            coTask._cached = cache->lookup(wrapper.first->requestURL, coTask._cacheEntry);
+            if (!coTask._cached)
+            {
+                return false;
+            }
+            if (HttpCache::isFresh(coTask._cacheEntry))
+            {
+                _serveFromCacheProc(coTask);
+                return true;
+            }
+
+            // stale, revalidate it with the header request
+            if (coTask._cacheHeaders)
+            {
+                curl_slist_free_all(coTask._cacheHeaders);
+                coTask._cacheHeaders = nullptr;
+            }
+            for (const auto& header : HttpCache::getValidationHeaders(coTask._cacheEntry))
+            {
+                coTask._cacheHeaders = curl_slist_append(coTask._cacheHeaders, header.c_str());
+            }
+            return false;
+        }
+
+        // set the cached response as the downloaded data of the task
+        void _serveFromCacheProc(DownloadTaskCURL& coTask)
+        {
+            lock_guard<mutex> lock(coTask._mutex);
+            const vector<char>& data = coTask._cacheEntry.data;
+            coTask._buf.assign(data.begin(), data.end());
+            coTask._bytesReceived = coTask._totalBytesReceived = coTask._totalBytesExpected = (int64_t)data.size();
+            coTask._cacheEntry = HttpCache::Entry();
+        }
+
+        // store the downloaded data of a data task
+        void _storeInCacheProc(TaskWrapper& wrapper)
+        {
+            DownloadTaskCURL& coTask = *wrapper.second;
+            HttpCache* cache = HttpCache::getInstance();
+            if (coTask._fileName.length() || !cache->isEnabled())
+            {
+                return;
+            }
+
+            vector<char> data;
+            {
+                lock_guard<mutex> lock(coTask._mutex);
+                // the progress callback may have transferred part of the data to the user already
+                if ((int64_t)coTask._buf.size() != coTask._totalBytesReceived)
+                {
+                    return;
+                }
+                data.assign(coTask._buf.begin(), coTask._buf.end());
+            }
+            vector<char> header(coTask._header.begin(), coTask._header.end());
+            cache->store(wrapper.first->requestURL, header, data);
+        }
+
+        // check whether the task should be downloaded by several range requests
+        bool _shouldSegmentProc(const DownloadTaskCURL& coTask)
+        {
+            return hints.countOfSegmentsPerTask > 1
+                && coTask._acceptRanges
+                && coTask._fp
+                && 0 == coTask._totalBytesReceived
+                && coTask._totalBytesExpected > 0
+                && coTask._totalBytesExpected >= hints.minSegmentedFileSize
+                && coTask._totalBytesExpected >= (int64_t)hints.countOfSegmentsPerTask
+                && coTask._totalBytesExpected <= MAX_SEEK_OFFSET;
+        }
+
+        // split the content into range segments, each segment writes into its own part of the temp file
+        // return false if failed, the error info has been set to coTask and no segment handle left in curl multi-handle
+        bool _startSegmentsProc(CURLM *curlmHandle, TaskWrapper& wrapper, unordered_map<CURL*, TaskWrapper>& coTaskMap)
+        {
+            DownloadTaskCURL& coTask = *wrapper.second;
+            {
+                // reopen temp file for writing at random position
+                lock_guard<mutex> lock(coTask._mutex);
+                fclose(coTask._fp);
+                coTask._fp = fopen(FileUtils::getInstance()->getSuitableFOpen(coTask._tempFileName).c_str(), "wb+");
+                if (nullptr == coTask._fp)
+                {
+                    coTask._errCode = DownloadTask::ERROR_FILE_OP_FAILED;
+                    coTask._errCodeInternal = 0;
+                    coTask._errDescription = "Can't open file:";
+                    coTask._errDescription.append(coTask._tempFileName);
+                    return false;
+                }
+            }
+
+            uint32_t count = hints.countOfSegmentsPerTask;
+            int64_t total = coTask._totalBytesExpected;
+            int64_t segmentSize = total / count;
+            coTask._segments.resize(count);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                DownloadTaskCURL::Segment& segment = coTask._segments[i];
+                segment.coTask = &coTask;
+                segment.handle = nullptr;
+                segment.begin = i * segmentSize;
+                segment.end = (i + 1 == count) ? total - 1 : (i + 1) * segmentSize - 1;
+                segment.pos = segment.begin;
+            }
+
+            for (auto& segment : coTask._segments)
+            {
+                CURL* curlHandle = curl_easy_init();
+                if (nullptr == curlHandle)
+                {
+                    coTask.setErrorProc(DownloadTask::ERROR_IMPL_INTERNAL, 0, "Alloc curl handle failed.");
+                    break;
+                }
+                _initCurlHandleProc(curlHandle, wrapper, true, &segment);
+                CURLMcode mcode = curl_multi_add_handle(curlmHandle, curlHandle);
+                if (CURLM_OK != mcode)
+                {
+                    curl_easy_cleanup(curlHandle);
+                    coTask.setErrorProc(DownloadTask::ERROR_IMPL_INTERNAL, mcode, curl_multi_strerror(mcode));
+                    break;
+                }
+                segment.handle = curlHandle;
+                coTaskMap[curlHandle] = wrapper;
+            }
+
+            if (DownloadTask::ERROR_NO_ERROR != coTask._errCode)
+            {
+                _cancelSegmentsProc(curlmHandle, coTask, coTaskMap);
+                return false;
+            }
+            DLLOG("    _threadProc task split into %u segments", count);
+            return true;
+        }
+
+        void _cancelSegmentsProc(CURLM *curlmHandle, DownloadTaskCURL& coTask, unordered_map<CURL*, TaskWrapper>& coTaskMap)
+        {
+            for (auto& segment : coTask._segments)
+            {
+                if (segment.handle)
+                {
+                    curl_multi_remove_handle(curlmHandle, segment.handle);
+                    curl_easy_cleanup(segment.handle);
+                    coTaskMap.erase(segment.handle);
+                    segment.handle = nullptr;
+                }
+            }
+        }
+
+        // called when a segment handle is done, the handle has been removed from curl multi-handle
+        // return true if all segments of the task are done
+        bool _finishSegmentProc(CURLM *curlmHandle, CURL *curlHandle, CURLcode errCode, DownloadTaskCURL& coTask, unordered_map<CURL*, TaskWrapper>& coTaskMap)
+        {
+            char *priv = nullptr;
+            curl_easy_getinfo(curlHandle, CURLINFO_PRIVATE, &priv);
+            DownloadTaskCURL::Segment *segment = (DownloadTaskCURL::Segment*)priv;
+            segment->handle = nullptr;
+
+            if (CURLE_OK != errCode)
+            {
+                coTask.setErrorProc(DownloadTask::ERROR_IMPL_INTERNAL, errCode, curl_easy_strerror(errCode));
+            }
+            else
+            {
+                long httpResponseCode = 0;
+                curl_easy_getinfo(curlHandle, CURLINFO_RESPONSE_CODE, &httpResponseCode);
+                if (206 != httpResponseCode || segment->pos != segment->end + 1)
+                {
+                    coTask.setErrorProc(DownloadTask::ERROR_IMPL_INTERNAL, CURLE_OK, "Range request is not honored by server.");
+                }
+            }
+
+            // one segment failed, the whole task failed
+            if (DownloadTask::ERROR_NO_ERROR != coTask._errCode)
+            {
+                _cancelSegmentsProc(curlmHandle, coTask, coTaskMap);
+            }
+
+            for (auto& seg : coTask._segments)
+            {
+                if (seg.handle)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // share the bandwidth limit between all handles downloading content
+        void _applySpeedLimitProc(unordered_map<CURL*, TaskWrapper>& coTaskMap)
+        {
+            if (0 == hints.maxBytesPerSecond)
+            {
+                return;
+            }
+            int64_t count = 0;
+            for (auto& it : coTaskMap)
+            {
+                if (it.second.second->_headerAchieved)
+                {
+                    ++count;
+                }
+            }
+            if (0 == count)
+            {
+                return;
+            }
+            curl_off_t speed = (curl_off_t)std::max<int64_t>(hints.maxBytesPerSecond / count, 1);
+            for (auto& it : coTaskMap)
+            {
+                if (it.second.second->_headerAchieved)
+                {
+                    curl_easy_setopt(it.first, CURLOPT_MAX_RECV_SPEED_LARGE, speed);
+                }
+            }
+        }
+
+        // pause the running task with lowest priority to give its slot to a waiting task with higher priority,
+        // only single connection content download which could be resumed by range request can be preempted.
+        // return true if a task has been preempted
+        bool _preemptProc(CURLM *curlmHandle, unordered_map<CURL*, TaskWrapper>& coTaskMap)
+        {
+            int waitingPriority = 0;
+            {
+                lock_guard<mutex> lock(_requestMutex);
+                if (_requestQueue.empty())
+                {
+                    return false;
+                }
+                waitingPriority = _requestQueue.front().first->priority;
+            }
+
+            CURL* victim = nullptr;
+            for (auto& it : coTaskMap)
+            {
+                const TaskWrapper& wrapper = it.second;
+                if (wrapper.first->priority < waitingPriority
+                    && wrapper.second->_headerAchieved
+                    && wrapper.second->_acceptRanges
+                    && wrapper.second->_segments.empty()
+                    && (nullptr == victim || wrapper.first->priority < coTaskMap[victim].first->priority))
+                {
+                    victim = it.first;
+                }
+            }
+            if (nullptr == victim)
+            {
+                return false;
+            }
+
+            TaskWrapper wrapper = coTaskMap[victim];
+            curl_multi_remove_handle(curlmHandle, victim);
+            curl_easy_cleanup(victim);
+            coTaskMap.erase(victim);
+            // the received data is kept, the task continues from it when resumed
+            wrapper.second->_preempted = true;
+            DLLOG("    _threadProc task preempted: Id(%d)", wrapper.second->serialId);
+
+            lock_guard<mutex> lock(_requestMutex);
+            _enqueueRequest(wrapper);
+            return true;
+        }
+
+        void _finishTaskProc(TaskWrapper& wrapper)
+        {
+            NetworkMetrics::getInstance()->requestFinished(wrapper.second, 0, DownloadTask::ERROR_NO_ERROR == wrapper.second->_errCode);
+
+            // remove from _processSet
+            {
+                lock_guard<mutex> lock(_processMutex);
+                if (_processSet.end() != _processSet.find(wrapper)) {
+                    _processSet.erase(wrapper);
+                }
+            }
+
+            // add to finishedQueue
+            {
+                lock_guard<mutex> lock(_finishedMutex);
+                _finishedQueue.push_back(wrapper);
+            }
+        }
+
         void _threadProc()
         {
             DLLOG("++++DownloaderCURL::Impl::_threadProc begin %p", this);
@@ -461,9 +867,10 @@ namespace cocos2d { namespace network {
             // init curl content
             CURLM* curlmHandle = curl_multi_init();
             unordered_map<CURL*, TaskWrapper> coTaskMap;
+            // segments of one task share the same task slot
+            uint32_t countOfProcessingTasks = 0;
             int runningHandles = 0;
             CURLMcode mcode = CURLM_OK;
-            int rc = 0;                 // select return code
 
             do
             {
@@ -477,6 +884,8 @@ namespace cocos2d { namespace network {
                     }
                 }
 
+                bool handlesChanged = false;
+
                 if (runningHandles)
                 {
                     // get timeout setting from multi-handle
@@ -488,42 +897,14 @@ namespace cocos2d { namespace network {
                         timeoutMS = 1000;
                     }
 
-                    /* get file descriptors from the transfers */
-                    fd_set fdread;
-                    fd_set fdwrite;
-                    fd_set fdexcep;
-                    int maxfd = -1;
-
-                    FD_ZERO(&fdread);
-                    FD_ZERO(&fdwrite);
-                    FD_ZERO(&fdexcep);
-
-                    mcode = curl_multi_fdset(curlmHandle, &fdread, &fdwrite, &fdexcep, &maxfd);
+                    // sleep until there is activity on the transfers instead of polling
+                    int numfds = 0;
+                    mcode = curl_multi_wait(curlmHandle, nullptr, 0, (int)timeoutMS, &numfds);
                     if (CURLM_OK != mcode)
                     {
+                        DLLOG("    _threadProc: curl_multi_wait return unexpect code: %d", mcode);
                         break;
                     }
-
-                    // do wait action
-                    if(maxfd == -1)
-                    {
-                        this_thread::sleep_for(chrono::milliseconds(timeoutMS));
-                        rc = 0;
-                    }
-                    else
-                    {
-                        struct timeval timeout;
-
-                        timeout.tv_sec = timeoutMS / 1000;
-                        timeout.tv_usec = (timeoutMS % 1000) * 1000;
-
-                        rc = select(maxfd+1, &fdread, &fdwrite, &fdexcep, &timeout);
-                    }
-
-                    if (rc < 0)
-                    {
-                        DLLOG("    _threadProc: select return unexpect code: %d", rc);
-                    }
                 }
 
                 if (coTaskMap.size())
@@ -548,10 +929,28 @@ namespace cocos2d { namespace network {
                             CURLcode errCode = m->data.result;
 
                             TaskWrapper wrapper = coTaskMap[curlHandle];
+                            handlesChanged = true;
+                            reportCurlTransfer(curlHandle, wrapper.second);
 
                             // remove from multi-handle
                             curl_multi_remove_handle(curlmHandle, curlHandle);
+
+                            // the task is downloaded by range segments
+                            if (wrapper.second->_segments.size())
+                            {
+                                bool finished = _finishSegmentProc(curlmHandle, curlHandle, errCode, *wrapper.second, coTaskMap);
+                                curl_easy_cleanup(curlHandle);
+                                coTaskMap.erase(curlHandle);
+                                if (finished)
+                                {
+                                    --countOfProcessingTasks;
+                                    _finishTaskProc(wrapper);
+                                }
+                                continue;
+                            }
+
                             bool reinited = false;
+                            bool segmented = false;
                             do
                             {
                                 if (CURLE_OK != errCode)
@@ -563,6 +962,7 @@ namespace cocos2d { namespace network {
                                 // if the task is content download task, cleanup the handle
                                 if (wrapper.second->_headerAchieved)
                                 {
+                                    _storeInCacheProc(wrapper);
                                     break;
                                 }
 
@@ -584,6 +984,14 @@ namespace cocos2d { namespace network {
                                     // break to move this task to finish queue
                                     break;
                                 }
+
+                                // big file, download it with several connections
+                                if (_shouldSegmentProc(*wrapper.second))
+                                {
+                                    segmented = _startSegmentsProc(curlmHandle, wrapper, coTaskMap);
+                                    break;
+                                }
+
                                 // reinit curl handle for download content
                                 curl_easy_reset(curlHandle);
                                 _initCurlHandleProc(curlHandle, wrapper, true);
@@ -606,25 +1014,26 @@ namespace cocos2d { namespace network {
                            // remove from coTaskMap
                             coTaskMap.erase(curlHandle);
 
-                            // remove from _processSet
+                            if (segmented)
                             {
-                                lock_guard<mutex> lock(_processMutex);
-                                if (_processSet.end() != _processSet.find(wrapper)) {
-                                    _processSet.erase(wrapper);
-                                }
-                            }
-
-                            // add to finishedQueue
-                            {
-                                lock_guard<mutex> lock(_finishedMutex);
-                                _finishedQueue.push_back(wrapper);
+                                continue;
                             }
+                            --countOfProcessingTasks;
+                            _finishTaskProc(wrapper);
                         }
                     } while(m);
                 }
 
+                // give the slot of a low priority task to a waiting task with higher priority
+                if (countOfMaxProcessingTasks && countOfProcessingTasks >= countOfMaxProcessingTasks
+                    && _preemptProc(curlmHandle, coTaskMap))
+                {
+                    --countOfProcessingTasks;
+                    handlesChanged = true;
+                }
+
                 // process tasks in _requestList
-                while (0 == countOfMaxProcessingTasks || coTaskMap.size() < countOfMaxProcessingTasks)
+                while (0 == countOfMaxProcessingTasks || countOfProcessingTasks < countOfMaxProcessingTasks)
                 {
                     // get task wrapper from request queue
                     TaskWrapper wrapper;
@@ -643,7 +1052,19 @@ namespace cocos2d { namespace network {
                         break;
                     }
 
-                    wrapper.second->initProc();
+                    // preempted task continues with its header info and received data
+                    bool resumed = wrapper.second->_preempted;
+                    wrapper.second->_preempted = false;
+                    if (!resumed)
+                    {
+                        wrapper.second->initProc();
+                        NetworkMetrics::getInstance()->requestStarted(wrapper.second);
+                        if (_lookupCacheProc(wrapper))
+                        {
+                            _finishTaskProc(wrapper);
+                            continue;
+                        }
+                    }
 
                     // create curl handle from task and add into curl multi handle
                     CURL* curlHandle = curl_easy_init();
@@ -651,29 +1072,35 @@ namespace cocos2d { namespace network {
                     if (nullptr == curlHandle)
                     {
                         wrapper.second->setErrorProc(DownloadTask::ERROR_IMPL_INTERNAL, 0, "Alloc curl handle failed.");
-                        lock_guard<mutex> lock(_finishedMutex);
-                        _finishedQueue.push_back(wrapper);
+                        _finishTaskProc(wrapper);
                         continue;
                     }
 
-                    // init curl handle for get header info
-                    _initCurlHandleProc(curlHandle, wrapper);
+                    // init curl handle for get header info, or for content if the task is resumed
+                    _initCurlHandleProc(curlHandle, wrapper, resumed);
 
                     // add curl handle to process list
                     mcode = curl_multi_add_handle(curlmHandle, curlHandle);
                     if (CURLM_OK != mcode)
                     {
+                        curl_easy_cleanup(curlHandle);
                         wrapper.second->setErrorProc(DownloadTask::ERROR_IMPL_INTERNAL, mcode, curl_multi_strerror(mcode));
-                        lock_guard<mutex> lock(_finishedMutex);
-                        _finishedQueue.push_back(wrapper);
+                        _finishTaskProc(wrapper);
                         continue;
                     }
 
                     DLLOG("    _threadProc task create curl handle:%p", curlHandle);
                     coTaskMap[curlHandle] = wrapper;
+                    ++countOfProcessingTasks;
+                    handlesChanged = true;
                     lock_guard<mutex> lock(_processMutex);
                     _processSet.insert(wrapper);
                 }
+
+                if (handlesChanged)
+                {
+                    _applySpeedLimitProc(coTaskMap);
+                }
             } while (coTaskMap.size());
 
             curl_multi_cleanup(curlmHandle);
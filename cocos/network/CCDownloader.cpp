@@ -51,6 +51,7 @@
 namespace cocos2d { namespace network {
 
     DownloadTask::DownloadTask()
+    : priority(0)
     {
         DLLOG("Construct DownloadTask %p", this);
     }
@@ -68,7 +69,10 @@ namespace cocos2d { namespace network {
         {
             6,
             45,
-            ".tmp"
+            ".tmp",
+            0,
+            0,
+            0
         };
         new(this)Downloader(hints);
     }
@@ -128,7 +132,7 @@ namespace cocos2d { namespace network {
         DLLOG("Destruct Downloader %p", this);
     }
 
-    std::shared_ptr<const DownloadTask> Downloader::createDownloadDataTask(const std::string& srcUrl, const std::string& identifier/* = ""*/)
+    std::shared_ptr<const DownloadTask> Downloader::createDownloadDataTask(const std::string& srcUrl, const std::string& identifier/* = ""*/, int priority/* = 0*/)
     {
         DownloadTask *task_ = new (std::nothrow) DownloadTask();
         std::shared_ptr<const DownloadTask> task(task_);
@@ -136,6 +140,7 @@ namespace cocos2d { namespace network {
         {
             task_->requestURL    = srcUrl;
             task_->identifier    = identifier;
+            task_->priority      = priority;
             if (0 == srcUrl.length())
             {
                 if (onTaskError)
@@ -153,7 +158,8 @@ namespace cocos2d { namespace network {
 
     std::shared_ptr<const DownloadTask> Downloader::createDownloadFileTask(const std::string& srcUrl,
                                                                            const std::string& storagePath,
-                                                                           const std::string& identifier/* = ""*/)
+                                                                           const std::string& identifier/* = ""*/,
+                                                                           int priority/* = 0*/)
     {
         DownloadTask *task_ = new (std::nothrow) DownloadTask();
         std::shared_ptr<const DownloadTask> task(task_);
@@ -162,6 +168,7 @@ namespace cocos2d { namespace network {
             task_->requestURL    = srcUrl;
             task_->storagePath   = storagePath;
             task_->identifier    = identifier;
+            task_->priority      = priority;
             if (0 == srcUrl.length() || 0 == storagePath.length())
             {
                 if (onTaskError)
@@ -48,6 +48,9 @@ namespace cocos2d { namespace network {
         std::string identifier;
         std::string requestURL;
         std::string storagePath;
+        // tasks with higher priority are processed first, and may preempt running tasks
+        // with lower priority when the count of processing tasks reaches the limit
+        int priority;
 
         DownloadTask();
         virtual ~DownloadTask();
@@ -63,6 +66,12 @@ namespace cocos2d { namespace network {
         uint32_t countOfMaxProcessingTasks;
         uint32_t timeoutInSeconds;
         std::string tempFileNameSuffix;
+        // count of concurrent range requests used to download one big file, 0 or 1 to disable
+        uint32_t countOfSegmentsPerTask;
+        // files smaller than this size are never split into range requests
+        int64_t minSegmentedFileSize;
+        // bandwidth shared by all processing tasks in bytes per second, 0 for unlimited
+        int64_t maxBytesPerSecond;
     };
 
     class CC_DLL Downloader final
@@ -87,9 +96,9 @@ namespace cocos2d { namespace network {
                            int errorCodeInternal,
                            const std::string& errorStr)> onTaskError;
 
-        std::shared_ptr<const DownloadTask> createDownloadDataTask(const std::string& srcUrl, const std::string& identifier = "");
+        std::shared_ptr<const DownloadTask> createDownloadDataTask(const std::string& srcUrl, const std::string& identifier = "", int priority = 0);
 
-        std::shared_ptr<const DownloadTask> createDownloadFileTask(const std::string& srcUrl, const std::string& storagePath, const std::string& identifier = "");
+        std::shared_ptr<const DownloadTask> createDownloadFileTask(const std::string& srcUrl, const std::string& storagePath, const std::string& identifier = "", int priority = 0);
 
     private:
         std::unique_ptr<IDownloaderImpl> _impl;
@@ -0,0 +1,658 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "network/HttpCache.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/CCAsyncTaskPool.h"
+#include "platform/CCFileUtils.h"
+
+#define CACHE_FILE_MAGIC        "CCHTTPCACHE1"
+#define CACHE_FILE_SUFFIX       ".cache"
+#define CACHE_INDEX_FILENAME    "index"
+#define CACHE_JOURNAL_FILENAME  "journal"
+// the index is rewritten when the journal has more lines than this and than the disk items
+#define MIN_JOURNAL_COMPACT_LENGTH 256
+// seconds between two journaled accesses of an entry, the accesses in between only update the index in memory
+#define ACCESS_JOURNAL_INTERVAL 60
+
+#define DEFAULT_MAX_MEMORY_SIZE (1024 * 1024)
+#define DEFAULT_MAX_DISK_SIZE   (10 * 1024 * 1024)
+
+NS_CC_BEGIN
+
+namespace network {
+
+static HttpCache* s_httpCache = nullptr; // pointer to singleton
+
+static bool headerNameEquals(const std::string& line, const char* name, size_t nameLen)
+{
+    if (line.length() <= nameLen || line[nameLen] != ':')
+        return false;
+    for (size_t i = 0; i < nameLen; ++i)
+    {
+        if (tolower(line[i]) != tolower(name[i]))
+            return false;
+    }
+    return true;
+}
+
+static std::string headerValue(const std::string& line, size_t nameLen)
+{
+    size_t begin = line.find_first_not_of(" \t", nameLen + 1);
+    if (begin == std::string::npos)
+        return "";
+    size_t end = line.find_last_not_of(" \t\r\n");
+    return line.substr(begin, end - begin + 1);
+}
+
+// RFC 1123 dates, "Sun, 06 Nov 1994 08:49:37 GMT", 0 for the obsolete formats and the invalid dates
+static time_t parseHttpDate(const std::string& value)
+{
+    static const char* months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    int day, year, hour, minute, second;
+    char month[4] = {0};
+    if (sscanf(value.c_str(), "%*[^,], %d %3s %d %d:%d:%d", &day, month, &year, &hour, &minute, &second) != 6)
+        return 0;
+    const char* found = strstr(months, month);
+    if (found == nullptr || strlen(month) != 3 || (found - months) % 3 != 0)
+        return 0;
+    int mon = (int)(found - months) / 3 + 1;
+
+    // days since 1970-01-01 of the date in UTC, mktime would use the local time zone
+    int y = year - (mon <= 2 ? 1 : 0);
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yearOfEra = y - era * 400;
+    int dayOfYear = (153 * (mon > 2 ? mon - 3 : mon + 9) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    long long days = (long long)era * 146097 + dayOfEra - 719468;
+    return (time_t)(days * 86400 + hour * 3600 + minute * 60 + second);
+}
+
+HttpCache* HttpCache::getInstance()
+{
+    if (s_httpCache == nullptr)
+    {
+        s_httpCache = new (std::nothrow) HttpCache();
+    }
+    return s_httpCache;
+}
+
+void HttpCache::destroyInstance()
+{
+    CC_SAFE_DELETE(s_httpCache);
+}
+
+HttpCache::HttpCache()
+: _enabled(false)
+, _maxMemorySize(DEFAULT_MAX_MEMORY_SIZE)
+, _maxDiskSize(DEFAULT_MAX_DISK_SIZE)
+, _memorySize(0)
+, _diskSize(0)
+, _journal(nullptr)
+, _journalLength(0)
+{
+}
+
+HttpCache::~HttpCache()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    saveDiskIndex();
+}
+
+void HttpCache::setEnabled(bool enabled)
+{
+    _enabled = enabled;
+}
+
+void HttpCache::setCachePath(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    saveDiskIndex();
+
+    _cachePath = path;
+    if (!_cachePath.empty() && _cachePath[_cachePath.length() - 1] != '/')
+    {
+        _cachePath.append("/");
+    }
+    _diskItems.clear();
+    _diskSize = 0;
+
+    if (!_cachePath.empty())
+    {
+        FileUtils::getInstance()->createDirectory(_cachePath);
+        loadDiskIndex();
+    }
+}
+
+void HttpCache::setMaxMemorySize(size_t size)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _maxMemorySize = size;
+    evictMemory();
+}
+
+void HttpCache::setMaxDiskSize(size_t size)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _maxDiskSize = size;
+    evictDisk();
+}
+
+bool HttpCache::lookup(const std::string& url, Entry& entry)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _memoryItems.find(url);
+    if (it != _memoryItems.end())
+    {
+        // move to the most recently used position
+        _memoryLRU.splice(_memoryLRU.begin(), _memoryLRU, it->second.lru);
+        entry = *it->second.entry;
+        // the disk evicts the least recently used entries too, a hot entry served from memory stays on disk
+        if (!_cachePath.empty())
+        {
+            touchDiskItem(getDiskFileName(url));
+        }
+        return true;
+    }
+
+    if (readFromDisk(url, entry))
+    {
+        putInMemory(std::make_shared<Entry>(entry));
+        return true;
+    }
+    return false;
+}
+
+void HttpCache::store(const std::string& url, const std::vector<char>& header, const std::vector<char>& data)
+{
+    auto entry = std::make_shared<Entry>();
+    entry->url = url;
+    if (!parseHeader(header, *entry))
+    {
+        remove(url);
+        return;
+    }
+    entry->header = header;
+    entry->data = data;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    putInMemory(entry);
+    writeToDisk(*entry);
+}
+
+bool HttpCache::revalidate(const std::string& url, const std::vector<char>& header, Entry& entry)
+{
+    if (!lookup(url, entry))
+        return false;
+
+    // 304 carries the new freshness information only
+    Entry refreshed;
+    if (!parseHeader(header, refreshed))
+    {
+        remove(url);
+        return true;
+    }
+    entry.expires = refreshed.expires;
+    if (!refreshed.etag.empty())
+        entry.etag = refreshed.etag;
+    if (!refreshed.lastModified.empty())
+        entry.lastModified = refreshed.lastModified;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    putInMemory(std::make_shared<Entry>(entry));
+    writeToDisk(entry);
+    return true;
+}
+
+void HttpCache::remove(const std::string& url)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _memoryItems.find(url);
+    if (it != _memoryItems.end())
+    {
+        _memorySize -= it->second.entry->data.size() + it->second.entry->header.size();
+        _memoryLRU.erase(it->second.lru);
+        _memoryItems.erase(it);
+    }
+
+    if (!_cachePath.empty())
+    {
+        std::string filename = getDiskFileName(url);
+        auto diskIt = _diskItems.find(filename);
+        if (diskIt != _diskItems.end())
+        {
+            _diskSize -= diskIt->second.size;
+            _diskItems.erase(diskIt);
+            FileUtils::getInstance()->removeFile(_cachePath + filename);
+            journalDiskItem(filename, nullptr);
+        }
+    }
+}
+
+void HttpCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _memoryItems.clear();
+    _memoryLRU.clear();
+    _memorySize = 0;
+
+    auto fileUtils = FileUtils::getInstance();
+    for (auto& item : _diskItems)
+    {
+        fileUtils->removeFile(_cachePath + item.first);
+    }
+    _diskItems.clear();
+    _diskSize = 0;
+    saveDiskIndex();
+}
+
+void HttpCache::lookupAsync(const std::string& url, const LookupCallback& callback)
+{
+    struct AsyncData
+    {
+        std::string url;
+        bool found;
+        Entry entry;
+    };
+    AsyncData* asyncData = new (std::nothrow) AsyncData;
+    asyncData->url = url;
+    asyncData->found = false;
+
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [callback](void* param) {
+        auto data = reinterpret_cast<AsyncData*>(param);
+        if (callback)
+        {
+            callback(data->found, data->entry);
+        }
+        delete data;
+    }, (void*)asyncData, [this, asyncData]() {
+        asyncData->found = lookup(asyncData->url, asyncData->entry);
+    });
+}
+
+void HttpCache::storeAsync(const std::string& url, const std::vector<char>& header, const std::vector<char>& data)
+{
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [](void*) {}, nullptr, [this, url, header, data]() {
+        store(url, header, data);
+    });
+}
+
+bool HttpCache::isFresh(const Entry& entry)
+{
+    return entry.expires != 0 && time(nullptr) < entry.expires;
+}
+
+std::vector<std::string> HttpCache::getValidationHeaders(const Entry& entry)
+{
+    std::vector<std::string> headers;
+    if (!entry.etag.empty())
+    {
+        headers.push_back("If-None-Match: " + entry.etag);
+    }
+    if (!entry.lastModified.empty())
+    {
+        headers.push_back("If-Modified-Since: " + entry.lastModified);
+    }
+    return headers;
+}
+
+bool HttpCache::parseHeader(const std::vector<char>& header, Entry& entry)
+{
+    long maxAge = -1;
+    bool noCache = false;
+    bool hasExpires = false;
+    time_t expiresDate = 0;
+    time_t date = 0;
+
+    std::string headerString(header.begin(), header.end());
+    std::stringstream stream(headerString);
+    std::string line;
+    while (std::getline(stream, line, '\n'))
+    {
+        if (headerNameEquals(line, "Cache-Control", 13))
+        {
+            std::string directives = headerValue(line, 13);
+            std::transform(directives.begin(), directives.end(), directives.begin(), ::tolower);
+            if (directives.find("no-store") != std::string::npos)
+            {
+                return false;
+            }
+            if (directives.find("no-cache") != std::string::npos)
+            {
+                noCache = true;
+            }
+            size_t pos = directives.find("max-age=");
+            if (pos != std::string::npos)
+            {
+                maxAge = atol(directives.c_str() + pos + 8);
+            }
+        }
+        else if (headerNameEquals(line, "ETag", 4))
+        {
+            entry.etag = headerValue(line, 4);
+        }
+        else if (headerNameEquals(line, "Last-Modified", 13))
+        {
+            entry.lastModified = headerValue(line, 13);
+        }
+        else if (headerNameEquals(line, "Expires", 7))
+        {
+            hasExpires = true;
+            expiresDate = parseHttpDate(headerValue(line, 7));
+        }
+        else if (headerNameEquals(line, "Date", 4))
+        {
+            date = parseHttpDate(headerValue(line, 4));
+        }
+    }
+
+    time_t now = time(nullptr);
+    entry.expires = 0;
+    if (!noCache && maxAge > 0)
+    {
+        entry.expires = now + maxAge;
+    }
+    else if (!noCache && maxAge < 0 && hasExpires && expiresDate != 0)
+    {
+        // max-age wins over Expires, the lifetime is relative to the Date of the server whose clock may differ
+        time_t lifetime = expiresDate - (date != 0 ? date : now);
+        entry.expires = lifetime > 0 ? now + lifetime : 0;
+    }
+
+    // a response which can neither be used directly nor revalidated is useless
+    return entry.expires != 0 || !entry.etag.empty() || !entry.lastModified.empty();
+}
+
+std::string HttpCache::getDiskFileName(const std::string& url) const
+{
+    char name[32];
+    sprintf(name, "%016llx", (unsigned long long)std::hash<std::string>()(url));
+    return std::string(name) + CACHE_FILE_SUFFIX;
+}
+
+bool HttpCache::readFromDisk(const std::string& url, Entry& entry)
+{
+    if (_cachePath.empty())
+        return false;
+
+    std::string filename = getDiskFileName(url);
+    auto diskIt = _diskItems.find(filename);
+    if (diskIt == _diskItems.end())
+        return false;
+
+    auto fileUtils = FileUtils::getInstance();
+    Data content = fileUtils->getDataFromFile(_cachePath + filename);
+    const char* bytes = (const char*)content.getBytes();
+    size_t size = (size_t)content.getSize();
+
+    // layout: magic, url, etag, last modified, expires, header length, data length lines, then header and data
+    std::vector<std::string> lines;
+    size_t pos = 0;
+    while (lines.size() < 7 && pos < size)
+    {
+        const char* end = (const char*)memchr(bytes + pos, '\n', size - pos);
+        if (end == nullptr)
+            break;
+        lines.push_back(std::string(bytes + pos, end - bytes - pos));
+        pos = end - bytes + 1;
+    }
+
+    size_t headerLength = lines.size() == 7 ? strtoul(lines[5].c_str(), nullptr, 10) : 0;
+    size_t dataLength = lines.size() == 7 ? strtoul(lines[6].c_str(), nullptr, 10) : 0;
+    if (lines.size() != 7 || lines[0] != CACHE_FILE_MAGIC || lines[1] != url
+        || pos + headerLength + dataLength != size)
+    {
+        // corrupted, or another url with the same hash
+        _diskSize -= diskIt->second.size;
+        _diskItems.erase(diskIt);
+        fileUtils->removeFile(_cachePath + filename);
+        journalDiskItem(filename, nullptr);
+        return false;
+    }
+
+    entry.url = url;
+    entry.etag = lines[2];
+    entry.lastModified = lines[3];
+    entry.expires = (time_t)strtoll(lines[4].c_str(), nullptr, 10);
+    entry.header.assign(bytes + pos, bytes + pos + headerLength);
+    entry.data.assign(bytes + pos + headerLength, bytes + size);
+
+    touchDiskItem(filename);
+    return true;
+}
+
+void HttpCache::touchDiskItem(const std::string& filename)
+{
+    auto diskIt = _diskItems.find(filename);
+    if (diskIt == _diskItems.end())
+        return;
+
+    time_t now = time(nullptr);
+    bool journal = now - diskIt->second.lastAccess >= ACCESS_JOURNAL_INTERVAL;
+    diskIt->second.lastAccess = now;
+    if (journal)
+    {
+        journalDiskItem(filename, &diskIt->second);
+    }
+}
+
+void HttpCache::writeToDisk(const Entry& entry)
+{
+    if (_cachePath.empty())
+        return;
+
+    std::string filename = getDiskFileName(entry.url);
+    FILE* fp = fopen(FileUtils::getInstance()->getSuitableFOpen(_cachePath + filename).c_str(), "wb");
+    if (fp == nullptr)
+    {
+        CCLOG("HttpCache: can't write cache file %s", filename.c_str());
+        return;
+    }
+    fprintf(fp, "%s\n%s\n%s\n%s\n%lld\n%lu\n%lu\n", CACHE_FILE_MAGIC,
+            entry.url.c_str(), entry.etag.c_str(), entry.lastModified.c_str(),
+            (long long)entry.expires, (unsigned long)entry.header.size(), (unsigned long)entry.data.size());
+    if (!entry.header.empty())
+        fwrite(entry.header.data(), 1, entry.header.size(), fp);
+    if (!entry.data.empty())
+        fwrite(entry.data.data(), 1, entry.data.size(), fp);
+    size_t size = (size_t)ftell(fp);
+    fclose(fp);
+
+    auto diskIt = _diskItems.find(filename);
+    if (diskIt != _diskItems.end())
+    {
+        _diskSize -= diskIt->second.size;
+    }
+    DiskItem& item = _diskItems[filename];
+    item.size = size;
+    item.lastAccess = time(nullptr);
+    _diskSize += size;
+    journalDiskItem(filename, &item);
+
+    evictDisk();
+}
+
+void HttpCache::loadDiskIndex()
+{
+    auto fileUtils = FileUtils::getInstance();
+    std::string content = fileUtils->getStringFromFile(_cachePath + CACHE_INDEX_FILENAME);
+    std::stringstream stream(content);
+    std::string filename;
+    unsigned long size = 0;
+    long long lastAccess = 0;
+    while (stream >> filename >> size >> lastAccess)
+    {
+        DiskItem& item = _diskItems[filename];
+        item.size = size;
+        item.lastAccess = (time_t)lastAccess;
+    }
+
+    // journal lines: "+ filename size lastAccess" for a stored or accessed file, "- filename" for a removed one
+    std::stringstream journal(fileUtils->getStringFromFile(_cachePath + CACHE_JOURNAL_FILENAME));
+    std::string line;
+    while (std::getline(journal, line))
+    {
+        std::stringstream lineStream(line);
+        char change = 0;
+        if (!(lineStream >> change >> filename))
+            continue;
+        if (change == '-')
+        {
+            _diskItems.erase(filename);
+        }
+        else if (change == '+' && lineStream >> size >> lastAccess)
+        {
+            DiskItem& item = _diskItems[filename];
+            item.size = size;
+            item.lastAccess = (time_t)lastAccess;
+        }
+    }
+
+    for (auto& item : _diskItems)
+    {
+        _diskSize += item.second.size;
+    }
+    evictDisk();
+    saveDiskIndex();
+}
+
+void HttpCache::saveDiskIndex()
+{
+    if (_cachePath.empty())
+        return;
+
+    std::stringstream stream;
+    for (auto& item : _diskItems)
+    {
+        stream << item.first << ' ' << (unsigned long)item.second.size << ' ' << (long long)item.second.lastAccess << '\n';
+    }
+    auto fileUtils = FileUtils::getInstance();
+    fileUtils->writeStringToFile(stream.str(), _cachePath + CACHE_INDEX_FILENAME);
+
+    closeJournal();
+    fileUtils->removeFile(_cachePath + CACHE_JOURNAL_FILENAME);
+    _journalLength = 0;
+}
+
+void HttpCache::journalDiskItem(const std::string& filename, const DiskItem* item)
+{
+    if (_journalLength >= MIN_JOURNAL_COMPACT_LENGTH && _journalLength >= _diskItems.size())
+    {
+        saveDiskIndex();
+        return;
+    }
+
+    if (_journal == nullptr)
+    {
+        _journal = fopen(FileUtils::getInstance()->getSuitableFOpen(_cachePath + CACHE_JOURNAL_FILENAME).c_str(), "ab");
+        if (_journal == nullptr)
+        {
+            // without a journal the index is the only record
+            saveDiskIndex();
+            return;
+        }
+    }
+
+    if (item)
+        fprintf(_journal, "+ %s %lu %lld\n", filename.c_str(), (unsigned long)item->size, (long long)item->lastAccess);
+    else
+        fprintf(_journal, "- %s\n", filename.c_str());
+    fflush(_journal);
+    ++_journalLength;
+}
+
+void HttpCache::closeJournal()
+{
+    if (_journal)
+    {
+        fclose(_journal);
+        _journal = nullptr;
+    }
+}
+
+void HttpCache::evictDisk()
+{
+    auto fileUtils = FileUtils::getInstance();
+    while (_diskSize > _maxDiskSize && !_diskItems.empty())
+    {
+        auto oldest = _diskItems.begin();
+        for (auto it = _diskItems.begin(); it != _diskItems.end(); ++it)
+        {
+            if (it->second.lastAccess < oldest->second.lastAccess)
+                oldest = it;
+        }
+        std::string filename = oldest->first;
+        _diskSize -= oldest->second.size;
+        _diskItems.erase(oldest);
+        fileUtils->removeFile(_cachePath + filename);
+        journalDiskItem(filename, nullptr);
+    }
+}
+
+void HttpCache::putInMemory(const std::shared_ptr<Entry>& entry)
+{
+    auto it = _memoryItems.find(entry->url);
+    if (it != _memoryItems.end())
+    {
+        _memorySize -= it->second.entry->data.size() + it->second.entry->header.size();
+        _memoryLRU.erase(it->second.lru);
+        _memoryItems.erase(it);
+    }
+
+    size_t size = entry->data.size() + entry->header.size();
+    // too big to be kept in memory, only the disk cache holds it
+    if (size > _maxMemorySize)
+        return;
+
+    _memoryLRU.push_front(entry->url);
+    MemoryItem& item = _memoryItems[entry->url];
+    item.entry = entry;
+    item.lru = _memoryLRU.begin();
+    _memorySize += size;
+
+    evictMemory();
+}
+
+void HttpCache::evictMemory()
+{
+    while (_memorySize > _maxMemorySize && !_memoryLRU.empty())
+    {
+        auto it = _memoryItems.find(_memoryLRU.back());
+        _memorySize -= it->second.entry->data.size() + it->second.entry->header.size();
+        _memoryItems.erase(it);
+        _memoryLRU.pop_back();
+    }
+}
+
+}
+
+NS_CC_END
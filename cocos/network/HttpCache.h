@@ -0,0 +1,222 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __HTTP_CACHE_H__
+#define __HTTP_CACHE_H__
+
+#include <atomic>
+#include <ctime>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup network
+ * @{
+ */
+
+NS_CC_BEGIN
+
+namespace network {
+
+/** Singleton caching http responses in memory and on disk.
+ *
+ * Responses are stored according to their Cache-Control, Expires, ETag and Last-Modified headers.
+ * A fresh entry can be used without network access, a stale entry with validators
+ * can be revalidated with a conditional request (If-None-Match/If-Modified-Since).
+ * Both the memory and the disk cache are bounded and evict the least recently used entries.
+ *
+ * lookup, store and revalidate may access the disk, they should be called from a worker thread.
+ * The async variants run on the AsyncTaskPool and report back in the cocos thread.
+ * Scripts use the cache through XMLHttpRequest, which sends its requests with HttpClient,
+ * and configure it with the functions of cc.HttpCache in Lua and HttpCache in JavaScript:
+ * setEnabled, isEnabled, setCachePath, getCachePath, setMaxMemorySize, setMaxDiskSize and clear.
+ *
+ * @lua NA
+ */
+class CC_DLL HttpCache
+{
+public:
+    /** A cached response. */
+    struct Entry
+    {
+        std::string url;
+        std::string etag;
+        std::string lastModified;
+        /** Expiration date, 0 if the entry must be revalidated before being used. */
+        time_t expires;
+        std::vector<char> header;
+        std::vector<char> data;
+
+        Entry() : expires(0) {}
+    };
+
+    typedef std::function<void(bool found, const Entry& entry)> LookupCallback;
+
+    /**
+     * Get instance of HttpCache.
+     *
+     * @return the instance of HttpCache.
+     */
+    static HttpCache* getInstance();
+
+    /**
+     * Release the instance of HttpCache.
+     */
+    static void destroyInstance();
+
+    /**
+     * Enable or disable the cache, it is disabled by default.
+     * HttpClient caches GET responses and Downloader caches the responses of its data tasks
+     * (curl implementation) only when the cache is enabled.
+     */
+    void setEnabled(bool enabled);
+
+    bool isEnabled() const { return _enabled; }
+
+    /**
+     * Set the directory where responses are persisted, the disk cache is disabled if path is empty.
+     */
+    void setCachePath(const std::string& path);
+
+    const std::string& getCachePath() const { return _cachePath; }
+
+    /** Set the maximum bytes of responses kept in memory. Default is 1 MB. */
+    void setMaxMemorySize(size_t size);
+
+    size_t getMaxMemorySize() const { return _maxMemorySize; }
+
+    /** Set the maximum bytes of responses kept on disk. Default is 10 MB. */
+    void setMaxDiskSize(size_t size);
+
+    size_t getMaxDiskSize() const { return _maxDiskSize; }
+
+    /**
+     * Find the cached response of an url, fresh or not.
+     *
+     * @return true if found, entry is filled with the cached response.
+     */
+    bool lookup(const std::string& url, Entry& entry);
+
+    /**
+     * Store a successful response, responses with "Cache-Control: no-store" are ignored.
+     *
+     * @param header the raw header lines of the response.
+     */
+    void store(const std::string& url, const std::vector<char>& header, const std::vector<char>& data);
+
+    /**
+     * Refresh the cached response after the server replied "304 Not Modified".
+     *
+     * @param header the raw header lines of the 304 response.
+     * @return true if the entry is still cached, entry is filled with the refreshed response.
+     */
+    bool revalidate(const std::string& url, const std::vector<char>& header, Entry& entry);
+
+    /** Remove the cached response of an url. */
+    void remove(const std::string& url);
+
+    /** Remove all cached responses, in memory and on disk. */
+    void clear();
+
+    /** lookup on a worker thread, callback is invoked in the cocos thread. */
+    void lookupAsync(const std::string& url, const LookupCallback& callback);
+
+    /** store on a worker thread. */
+    void storeAsync(const std::string& url, const std::vector<char>& header, const std::vector<char>& data);
+
+    /** Whether the entry can be used without revalidation. */
+    static bool isFresh(const Entry& entry);
+
+    /** Build the conditional request headers of an entry. */
+    static std::vector<std::string> getValidationHeaders(const Entry& entry);
+
+private:
+    HttpCache();
+    ~HttpCache();
+
+    struct DiskItem
+    {
+        size_t size;
+        time_t lastAccess;
+    };
+
+    struct MemoryItem
+    {
+        std::shared_ptr<Entry> entry;
+        std::list<std::string>::iterator lru;
+    };
+
+    // parse cache related headers into entry, return false if the response must not be stored
+    static bool parseHeader(const std::vector<char>& header, Entry& entry);
+
+    std::string getDiskFileName(const std::string& url) const;
+    bool readFromDisk(const std::string& url, Entry& entry);
+    void writeToDisk(const Entry& entry);
+    void loadDiskIndex();
+    // write the whole index and empty the journal
+    void saveDiskIndex();
+    // append a change of the disk items to the journal, the index is rewritten once the journal is long
+    void journalDiskItem(const std::string& filename, const DiskItem* item);
+    void closeJournal();
+    // the entry of filename was used, from memory or from disk
+    void touchDiskItem(const std::string& filename);
+    void evictDisk();
+
+    void putInMemory(const std::shared_ptr<Entry>& entry);
+    void evictMemory();
+
+    // set on the cocos thread, read by the network threads
+    std::atomic<bool> _enabled;
+    std::string _cachePath;
+    size_t _maxMemorySize;
+    size_t _maxDiskSize;
+
+    std::unordered_map<std::string, MemoryItem> _memoryItems;
+    std::list<std::string> _memoryLRU;
+    size_t _memorySize;
+
+    std::unordered_map<std::string, DiskItem> _diskItems;
+    size_t _diskSize;
+    /** Changes of the disk items since the index was written, replayed by loadDiskIndex. */
+    FILE* _journal;
+    size_t _journalLength;
+
+    std::mutex _mutex;
+};
+
+} // namespace network
+
+NS_CC_END
+
+// end group
+/// @}
+
+#endif //__HTTP_CACHE_H__
@@ -30,6 +30,8 @@
 #include <curl/curl.h>
 #include "base/CCDirector.h"
 #include "platform/CCFileUtils.h"
+#include "network/HttpCache.h"
+#include "network/NetworkMetrics-curl.h"
 
 NS_CC_BEGIN
 
@@ -41,6 +43,18 @@ typedef int int32_t;
 
 static HttpClient* _httpClient = nullptr; // pointer to singleton
 
+static const char* getRequestMethod(HttpRequest* request)
+{
+    switch (request->getRequestType())
+    {
+    case HttpRequest::Type::GET:    return "GET";
+    case HttpRequest::Type::POST:   return "POST";
+    case HttpRequest::Type::PUT:    return "PUT";
+    case HttpRequest::Type::DELETE: return "DELETE";
+    default:                        return "UNKNOWN";
+    }
+}
+
 typedef size_t (*write_callback)(void *ptr, size_t size, size_t nmemb, void *stream);
 
 // Callback function used by libcurl for collect response data
@@ -105,7 +119,9 @@ void HttpClient::networkThread()
         // Create a HttpResponse object, the default setting is http access failed
         HttpResponse *response = new (std::nothrow) HttpResponse(request);
         
+		NetworkMetrics::getInstance()->requestStarted(request);
 		processResponse(response, _responseMessage);
+		NetworkMetrics::getInstance()->requestFinished(request, response->getResponseCode(), response->isSucceed());
         
 
         // add response packet into queue
@@ -139,7 +155,9 @@ void HttpClient::networkThreadAlone(HttpRequest* request, HttpResponse* response
 	increaseThreadCount();
 
 	char responseMessage[RESPONSE_BUFFER_SIZE] = { 0 };
+	NetworkMetrics::getInstance()->requestStarted(request);
 	processResponse(response, responseMessage);
+	NetworkMetrics::getInstance()->requestFinished(request, response->getResponseCode(), response->isSucceed());
 	
 	_schedulerMutex.lock();
 	if (nullptr != _scheduler)
@@ -213,10 +231,13 @@ class CURLRaii
     CURL *_curl;
     /// Keeps custom header data
     curl_slist *_headers;
+    /// The request reported to NetworkMetrics
+    HttpRequest *_request;
 public:
     CURLRaii()
         : _curl(curl_easy_init())
         , _headers(nullptr)
+        , _request(nullptr)
     {
     }
 
@@ -245,6 +266,7 @@ public:
     {
         if (!_curl)
             return false;
+        _request = request;
 		if (!configureCURL(client, _curl, errorBuffer))
             return false;
 
@@ -280,7 +302,9 @@ public:
     /// @param responseCode Null not allowed
     bool perform(long *responseCode)
     {
-        if (CURLE_OK != curl_easy_perform(_curl))
+        CURLcode performCode = curl_easy_perform(_curl);
+        reportCurlTransfer(_curl, _request);
+        if (CURLE_OK != performCode)
             return false;
         CURLcode code = curl_easy_getinfo(_curl, CURLINFO_RESPONSE_CODE, responseCode);
         if (code != CURLE_OK || !(*responseCode >= 200 && *responseCode < 300)) {
@@ -447,6 +471,8 @@ void HttpClient::send(HttpRequest* request)
         
     request->retain();
 
+	NetworkMetrics::getInstance()->requestQueued(NetworkMetrics::Source::HTTP_CLIENT, request, getRequestMethod(request), request->getUrl());
+
 	_requestQueueMutex.lock();
 	_requestQueue.pushBack(request);
 	_requestQueueMutex.unlock();
@@ -463,6 +489,7 @@ void HttpClient::sendImmediate(HttpRequest* request)
     }
 
     request->retain();
+    NetworkMetrics::getInstance()->requestQueued(NetworkMetrics::Source::HTTP_CLIENT, request, getRequestMethod(request), request->getUrl());
     // Create a HttpResponse object, the default setting is http access failed
     HttpResponse *response = new (std::nothrow) HttpResponse(request);
 
@@ -518,6 +545,10 @@ void HttpClient::processResponse(HttpResponse* response, char* responseMessage)
 	switch (request->getRequestType())
 	{
 	case HttpRequest::Type::GET: // HTTP GET
+		if (processCachedGetTask(request, response))
+		{
+			return;
+		}
 		retValue = processGetTask(this, request,
 			writeData,
 			response->getResponseData(),
@@ -575,6 +606,78 @@ void HttpClient::processResponse(HttpResponse* response, char* responseMessage)
 	}
 }
 
+// Serve a GET request from HttpCache, revalidating the cached response if it is stale
+bool HttpClient::processCachedGetTask(HttpRequest* request, HttpResponse* response)
+{
+	HttpCache* cache = HttpCache::getInstance();
+	if (!cache->isEnabled())
+	{
+		return false;
+	}
+
+	std::string url = request->getUrl();
+	HttpCache::Entry entry;
+	bool cached = cache->lookup(url, entry);
+	if (cached && HttpCache::isFresh(entry))
+	{
+		response->setResponseCode(200);
+		response->setResponseHeader(&entry.header);
+		response->setResponseData(&entry.data);
+		response->setFromCache(true);
+		response->setSucceed(true);
+		return true;
+	}
+
+	// send a conditional request, the user's headers are restored afterward
+	std::vector<std::string> headers = request->getHeaders();
+	std::vector<std::string> validationHeaders;
+	if (cached)
+	{
+		validationHeaders = HttpCache::getValidationHeaders(entry);
+		std::vector<std::string> conditionalHeaders = headers;
+		conditionalHeaders.insert(conditionalHeaders.end(), validationHeaders.begin(), validationHeaders.end());
+		request->setHeaders(conditionalHeaders);
+	}
+
+	char responseMessage[RESPONSE_BUFFER_SIZE] = { 0 };
+	long responseCode = -1;
+	int retValue = processGetTask(this, request,
+		writeData,
+		response->getResponseData(),
+		&responseCode,
+		writeHeaderData,
+		response->getResponseHeader(),
+		responseMessage);
+
+	if (!validationHeaders.empty())
+	{
+		request->setHeaders(headers);
+	}
+
+	if (304 == responseCode && cache->revalidate(url, *response->getResponseHeader(), entry))
+	{
+		response->setResponseCode(200);
+		response->setResponseHeader(&entry.header);
+		response->setResponseData(&entry.data);
+		response->setFromCache(true);
+		response->setSucceed(true);
+		return true;
+	}
+
+	response->setResponseCode(responseCode);
+	if (retValue != 0)
+	{
+		response->setSucceed(false);
+		response->setErrorBuffer(responseMessage);
+	}
+	else
+	{
+		cache->store(url, *response->getResponseHeader(), *response->getResponseData());
+		response->setSucceed(true);
+	}
+	return true;
+}
+
 void HttpClient::increaseThreadCount()
 {
 	_threadCountMutex.lock();
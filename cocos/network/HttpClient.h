@@ -165,6 +165,7 @@ private:
     void dispatchResponseCallbacks();
 
     void processResponse(HttpResponse* response, char* responseMessage);
+    bool processCachedGetTask(HttpRequest* request, HttpResponse* response);
     void increaseThreadCount();
     void decreaseThreadCountAndMayDeleteThis();
 
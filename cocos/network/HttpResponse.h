@@ -53,6 +53,7 @@ public:
     HttpResponse(HttpRequest* request)
         : _pHttpRequest(request)
         , _succeed(false)
+        , _fromCache(false)
         , _responseDataString("")
     {
         if (_pHttpRequest)
@@ -108,6 +109,15 @@ public:
         return _succeed;
     }
 
+    /**
+     * To see if the response is served by HttpCache instead of the network.
+     * @return bool the flag that represent whether the response comes from the cache.
+     */
+    inline bool isFromCache() const
+    {
+        return _fromCache;
+    }
+
     /**
      * Get the http response data.
      * @return std::vector<char>* the pointer that point to the _responseData.
@@ -160,6 +170,15 @@ public:
         _succeed = value;
     }
 
+    /**
+     * Set whether the response is served by HttpCache, it is used by HttpClient.
+     * @param value the flag represent whether the response comes from the cache.
+     */
+    inline void setFromCache(bool value)
+    {
+        _fromCache = value;
+    }
+
     /**
      * Set the http response data buffer, it is used by HttpClient.
      * @param data the pointer point to the response data buffer.
@@ -225,6 +244,7 @@ protected:
     // properties
     HttpRequest*        _pHttpRequest;  /// the corresponding HttpRequest pointer who leads to this response
     bool                _succeed;       /// to indicate if the http request is successful simply
+    bool                _fromCache;     /// to indicate if the response is served by HttpCache
     std::vector<char>   _responseData;  /// the returned raw data. You can also dump it as a string
     std::vector<char>   _responseHeader;  /// the returned raw header data. You can also dump it as a string
     long                _responseCode;    /// the status code returned from libcurl, e.g. 200, 404
@@ -0,0 +1,85 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __NETWORK_METRICS_CURL_H__
+#define __NETWORK_METRICS_CURL_H__
+
+#include <curl/curl.h>
+
+#include "network/NetworkMetrics.h"
+
+NS_CC_BEGIN
+
+namespace network {
+
+/** Report the transfer done by a curl easy handle to NetworkMetrics. */
+inline void reportCurlTransfer(CURL* handle, const void* key)
+{
+    NetworkMetrics* metrics = NetworkMetrics::getInstance();
+    if (!metrics->isEnabled())
+        return;
+
+    double nameLookup = 0, connect = 0, appConnect = 0, preTransfer = 0, startTransfer = 0, total = 0;
+    double uploaded = 0, downloaded = 0;
+    long requestSize = 0, headerSize = 0, connects = 0, statusCode = 0;
+
+    curl_easy_getinfo(handle, CURLINFO_NAMELOOKUP_TIME, &nameLookup);
+    curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME, &connect);
+    curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME, &appConnect);
+    curl_easy_getinfo(handle, CURLINFO_PRETRANSFER_TIME, &preTransfer);
+    curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME, &startTransfer);
+    curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME, &total);
+    curl_easy_getinfo(handle, CURLINFO_SIZE_UPLOAD, &uploaded);
+    curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD, &downloaded);
+    curl_easy_getinfo(handle, CURLINFO_REQUEST_SIZE, &requestSize);
+    curl_easy_getinfo(handle, CURLINFO_HEADER_SIZE, &headerSize);
+    curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+    curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &statusCode);
+
+    // curl reports the elapsed time since the start at the end of each phase
+    NetworkMetrics::Transfer transfer;
+    transfer.statusCode = statusCode;
+    transfer.bytesSent = requestSize + (int64_t)uploaded;
+    transfer.bytesReceived = headerSize + (int64_t)downloaded;
+    transfer.connectionReused = (connects == 0);
+    if (!transfer.connectionReused)
+    {
+        transfer.timings.dns = nameLookup * 1000;
+        transfer.timings.connect = (connect - nameLookup) * 1000;
+        if (appConnect > 0)
+            transfer.timings.ssl = (appConnect - connect) * 1000;
+    }
+    double connected = appConnect > connect ? appConnect : connect;
+    transfer.timings.send = (preTransfer > connected ? preTransfer - connected : 0) * 1000;
+    transfer.timings.wait = (startTransfer > preTransfer ? startTransfer - preTransfer : 0) * 1000;
+    transfer.timings.receive = (total > startTransfer ? total - startTransfer : 0) * 1000;
+
+    metrics->requestTransferred(key, transfer);
+}
+
+} // namespace network
+
+NS_CC_END
+
+#endif //__NETWORK_METRICS_CURL_H__
@@ -0,0 +1,594 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "network/NetworkMetrics.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#include "base/CCConsole.h"
+#include "base/CCDirector.h"
+#include "platform/CCFileUtils.h"
+
+#include "json/stringbuffer.h"
+#include "json/prettywriter.h"
+
+NS_CC_BEGIN
+
+extern const char* cocos2dVersion(void);
+
+namespace network {
+
+static NetworkMetrics* s_networkMetrics = nullptr; // pointer to singleton
+
+const double NetworkMetrics::Histogram::BUCKET_LIMITS[NetworkMetrics::Histogram::BUCKET_COUNT - 1] = {
+    5, 10, 25, 50, 100, 250, 500, 1000, 2500
+};
+
+NetworkMetrics::Histogram::Histogram()
+: count(0)
+, total(0)
+, max(0)
+{
+    memset(buckets, 0, sizeof(buckets));
+}
+
+void NetworkMetrics::Histogram::add(double ms)
+{
+    int i = 0;
+    while (i < BUCKET_COUNT - 1 && ms > BUCKET_LIMITS[i])
+        ++i;
+    ++buckets[i];
+    ++count;
+    total += ms;
+    if (ms > max)
+        max = ms;
+}
+
+double NetworkMetrics::Histogram::getPercentile(double percentile) const
+{
+    if (count == 0)
+        return 0;
+
+    uint32_t target = (uint32_t)(percentile * count + 0.5);
+    uint32_t accumulated = 0;
+    for (int i = 0; i < BUCKET_COUNT - 1; ++i)
+    {
+        accumulated += buckets[i];
+        if (accumulated >= target)
+            return std::min(BUCKET_LIMITS[i], max);
+    }
+    return max;
+}
+
+NetworkMetrics::SourceStats::SourceStats()
+: queued(0)
+, inFlight(0)
+, requests(0)
+, failures(0)
+, messagesSent(0)
+, messagesReceived(0)
+, connectionsOpened(0)
+, bytesSent(0)
+, bytesReceived(0)
+{
+}
+
+NetworkMetrics::HostStats::HostStats()
+: requests(0)
+, failures(0)
+, connectionsOpened(0)
+, connectionsReused(0)
+, bytesSent(0)
+, bytesReceived(0)
+{
+}
+
+float NetworkMetrics::HostStats::getReuseRate() const
+{
+    uint32_t connections = connectionsOpened + connectionsReused;
+    return connections ? (float)connectionsReused / connections : 0.0f;
+}
+
+NetworkMetrics* NetworkMetrics::getInstance()
+{
+    if (s_networkMetrics == nullptr)
+    {
+        s_networkMetrics = new (std::nothrow) NetworkMetrics();
+    }
+    return s_networkMetrics;
+}
+
+void NetworkMetrics::destroyInstance()
+{
+    CC_SAFE_DELETE(s_networkMetrics);
+}
+
+NetworkMetrics::NetworkMetrics()
+: _enabled(true)
+, _capturing(false)
+, _maxCaptureEntries(0)
+{
+}
+
+NetworkMetrics::~NetworkMetrics()
+{
+}
+
+const char* NetworkMetrics::getSourceName(Source source)
+{
+    switch (source)
+    {
+    case Source::HTTP_CLIENT: return "HttpClient";
+    case Source::DOWNLOADER:  return "Downloader";
+    case Source::WEBSOCKET:   return "WebSocket";
+    case Source::SOCKETIO:    return "SocketIO";
+    }
+    return "";
+}
+
+std::string NetworkMetrics::getHostFromURL(const std::string& url)
+{
+    size_t begin = url.find("://");
+    begin = (begin == std::string::npos) ? 0 : begin + 3;
+    size_t end = url.find_first_of("/?#", begin);
+    std::string host = url.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+
+    // strip the credentials
+    size_t at = host.rfind('@');
+    if (at != std::string::npos)
+        host.erase(0, at + 1);
+    return host;
+}
+
+NetworkMetrics::HostStats& NetworkMetrics::getHostStats(const std::string& host)
+{
+    return _hosts[host];
+}
+
+void NetworkMetrics::requestQueued(Source source, const void* key, const char* method, const std::string& url)
+{
+    if (!_enabled)
+        return;
+
+    auto now = std::chrono::system_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+
+    PendingRequest request;
+    request.source = source;
+    request.method = method;
+    request.url = url;
+    request.host = getHostFromURL(url);
+    request.queuedTime = Clock::now();
+    request.started = false;
+    request.startedDateTime = (time_t)(ms / 1000);
+    request.startedMilliseconds = (int)(ms % 1000);
+    request.transferred = false;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _pending.find(key);
+    if (it != _pending.end())
+    {
+        // the key was reused before the previous request finished
+        auto& stats = _sources[(int)it->second.source];
+        if (it->second.started)
+            --stats.inFlight;
+        else
+            --stats.queued;
+    }
+    _pending[key] = std::move(request);
+    ++_sources[(int)source].queued;
+}
+
+void NetworkMetrics::requestStarted(const void* key)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _pending.find(key);
+    if (it == _pending.end() || it->second.started)
+        return;
+
+    PendingRequest& request = it->second;
+    request.started = true;
+    request.startedTime = Clock::now();
+
+    auto& stats = _sources[(int)request.source];
+    --stats.queued;
+    ++stats.inFlight;
+
+    double waited = std::chrono::duration<double, std::milli>(request.startedTime - request.queuedTime).count();
+    getHostStats(request.host).queueWait.add(waited);
+}
+
+void NetworkMetrics::requestTransferred(const void* key, const Transfer& transfer)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _pending.find(key);
+    if (it == _pending.end())
+        return;
+
+    PendingRequest& request = it->second;
+    HostStats& host = getHostStats(request.host);
+    if (transfer.connectionReused)
+        ++host.connectionsReused;
+    else
+        ++host.connectionsOpened;
+    host.bytesSent += transfer.bytesSent;
+    host.bytesReceived += transfer.bytesReceived;
+
+    auto& stats = _sources[(int)request.source];
+    stats.bytesSent += transfer.bytesSent;
+    stats.bytesReceived += transfer.bytesReceived;
+
+    // keep the totals of all the transfers, and the timings of the last one
+    int64_t bytesSent = request.transfer.bytesSent + transfer.bytesSent;
+    int64_t bytesReceived = request.transfer.bytesReceived + transfer.bytesReceived;
+    request.transfer = transfer;
+    request.transfer.bytesSent = bytesSent;
+    request.transfer.bytesReceived = bytesReceived;
+    request.transferred = true;
+}
+
+void NetworkMetrics::requestFinished(const void* key, long statusCode, bool succeeded)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _pending.find(key);
+    if (it == _pending.end())
+        return;
+
+    PendingRequest& request = it->second;
+    auto now = Clock::now();
+    if (!request.started)
+    {
+        request.startedTime = now;
+        --_sources[(int)request.source].queued;
+    }
+    else
+    {
+        --_sources[(int)request.source].inFlight;
+    }
+
+    double latency = std::chrono::duration<double, std::milli>(now - request.startedTime).count();
+
+    auto& stats = _sources[(int)request.source];
+    ++stats.requests;
+    HostStats& host = getHostStats(request.host);
+    ++host.requests;
+    host.latency.add(latency);
+    if (!succeeded)
+    {
+        ++stats.failures;
+        ++host.failures;
+    }
+
+    if (_capturing)
+    {
+        CaptureEntry entry;
+        entry.source = request.source;
+        entry.method = request.method;
+        entry.url = request.url;
+        entry.startedDateTime = request.startedDateTime;
+        entry.startedMilliseconds = request.startedMilliseconds;
+        entry.statusCode = statusCode ? statusCode : request.transfer.statusCode;
+        entry.succeeded = succeeded;
+        entry.bytesSent = request.transfer.bytesSent;
+        entry.bytesReceived = request.transfer.bytesReceived;
+        entry.blocked = std::chrono::duration<double, std::milli>(request.startedTime - request.queuedTime).count();
+        entry.total = entry.blocked + latency;
+        entry.timings = request.transfer.timings;
+
+        if (_capture.size() >= _maxCaptureEntries)
+            _capture.pop_front();
+        _capture.push_back(std::move(entry));
+    }
+
+    _pending.erase(it);
+}
+
+void NetworkMetrics::connectionOpened(Source source, const std::string& host)
+{
+    if (!_enabled)
+        return;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_sources[(int)source].connectionsOpened;
+    ++getHostStats(host).connectionsOpened;
+}
+
+void NetworkMetrics::messageSent(Source source, const std::string& host, size_t bytes)
+{
+    if (!_enabled)
+        return;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& stats = _sources[(int)source];
+    ++stats.messagesSent;
+    stats.bytesSent += bytes;
+    getHostStats(host).bytesSent += bytes;
+}
+
+void NetworkMetrics::messageReceived(Source source, const std::string& host, size_t bytes)
+{
+    if (!_enabled)
+        return;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& stats = _sources[(int)source];
+    ++stats.messagesReceived;
+    stats.bytesReceived += bytes;
+    getHostStats(host).bytesReceived += bytes;
+}
+
+NetworkMetrics::Snapshot NetworkMetrics::getSnapshot()
+{
+    Snapshot snapshot;
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (int i = 0; i < SOURCE_COUNT; ++i)
+    {
+        snapshot.sources[i] = _sources[i];
+    }
+    snapshot.hosts = _hosts;
+    return snapshot;
+}
+
+std::string NetworkMetrics::getSummary()
+{
+    Snapshot snapshot = getSnapshot();
+    std::string summary;
+    char buf[256];
+
+    summary += "source       queued  flight  requests  failed  conns  msg sent  msg recv    KB sent    KB recv\n";
+    for (int i = 0; i < SOURCE_COUNT; ++i)
+    {
+        const SourceStats& s = snapshot.sources[i];
+        snprintf(buf, sizeof(buf), "%-11s %7u %7u %9u %7u %6u %9u %9u %10.1f %10.1f\n",
+                 getSourceName((Source)i), s.queued, s.inFlight, s.requests, s.failures, s.connectionsOpened,
+                 s.messagesSent, s.messagesReceived, s.bytesSent / 1024.0, s.bytesReceived / 1024.0);
+        summary += buf;
+    }
+
+    summary += "\nhost                             requests  failed  reuse   latency avg/p50/p90/max (ms)   queue avg/max (ms)\n";
+    for (auto& item : snapshot.hosts)
+    {
+        const HostStats& h = item.second;
+        snprintf(buf, sizeof(buf), "%-32.32s %8u %7u %5.0f%%   %6.1f/%6.0f/%6.0f/%7.1f   %7.1f/%7.1f\n",
+                 item.first.c_str(), h.requests, h.failures, h.getReuseRate() * 100,
+                 h.latency.getAverage(), h.latency.getPercentile(0.5), h.latency.getPercentile(0.9), h.latency.max,
+                 h.queueWait.getAverage(), h.queueWait.max);
+        summary += buf;
+    }
+
+    return summary;
+}
+
+void NetworkMetrics::reset()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (int i = 0; i < SOURCE_COUNT; ++i)
+    {
+        _sources[i] = SourceStats();
+    }
+    _hosts.clear();
+
+    // requests in flight are still accounted
+    for (auto& item : _pending)
+    {
+        auto& stats = _sources[(int)item.second.source];
+        if (item.second.started)
+            ++stats.inFlight;
+        else
+            ++stats.queued;
+    }
+}
+
+void NetworkMetrics::startCapture(size_t maxEntries)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _capture.clear();
+    _maxCaptureEntries = maxEntries > 0 ? maxEntries : 1;
+    _capturing = true;
+}
+
+void NetworkMetrics::stopCapture()
+{
+    _capturing = false;
+}
+
+std::string NetworkMetrics::getCaptureAsHAR()
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+
+    writer.StartObject();
+    writer.String("log");
+    writer.StartObject();
+    writer.String("version");
+    writer.String("1.2");
+    writer.String("creator");
+    writer.StartObject();
+    writer.String("name");
+    writer.String("cocos2d-x");
+    writer.String("version");
+    writer.String(cocos2dVersion());
+    writer.EndObject();
+
+    writer.String("entries");
+    writer.StartArray();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        char date[64];
+        for (auto& entry : _capture)
+        {
+            struct tm t;
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_WINRT
+            gmtime_s(&t, &entry.startedDateTime);
+#else
+            gmtime_r(&entry.startedDateTime, &t);
+#endif
+            snprintf(date, sizeof(date), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                     t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec, entry.startedMilliseconds);
+
+            writer.StartObject();
+            writer.String("startedDateTime");
+            writer.String(date);
+            writer.String("time");
+            writer.Double(entry.total);
+            writer.String("_source");
+            writer.String(getSourceName(entry.source));
+
+            writer.String("request");
+            writer.StartObject();
+            writer.String("method");
+            writer.String(entry.method.c_str());
+            writer.String("url");
+            writer.String(entry.url.c_str());
+            writer.String("httpVersion");
+            writer.String("HTTP/1.1");
+            writer.String("headers");
+            writer.StartArray();
+            writer.EndArray();
+            writer.String("queryString");
+            writer.StartArray();
+            writer.EndArray();
+            writer.String("headersSize");
+            writer.Int(-1);
+            writer.String("bodySize");
+            writer.Int64(entry.bytesSent);
+            writer.EndObject();
+
+            writer.String("response");
+            writer.StartObject();
+            writer.String("status");
+            writer.Int((int)entry.statusCode);
+            writer.String("statusText");
+            writer.String(entry.succeeded ? "" : "failed");
+            writer.String("httpVersion");
+            writer.String("HTTP/1.1");
+            writer.String("headers");
+            writer.StartArray();
+            writer.EndArray();
+            writer.String("content");
+            writer.StartObject();
+            writer.String("size");
+            writer.Int64(entry.bytesReceived);
+            writer.String("mimeType");
+            writer.String("");
+            writer.EndObject();
+            writer.String("redirectURL");
+            writer.String("");
+            writer.String("headersSize");
+            writer.Int(-1);
+            writer.String("bodySize");
+            writer.Int64(entry.bytesReceived);
+            writer.EndObject();
+
+            writer.String("cache");
+            writer.StartObject();
+            writer.EndObject();
+
+            writer.String("timings");
+            writer.StartObject();
+            writer.String("blocked");
+            writer.Double(entry.blocked);
+            writer.String("dns");
+            writer.Double(entry.timings.dns);
+            writer.String("connect");
+            writer.Double(entry.timings.connect);
+            writer.String("ssl");
+            writer.Double(entry.timings.ssl);
+            writer.String("send");
+            writer.Double(entry.timings.send < 0 ? 0 : entry.timings.send);
+            writer.String("wait");
+            writer.Double(entry.timings.wait < 0 ? entry.total - entry.blocked : entry.timings.wait);
+            writer.String("receive");
+            writer.Double(entry.timings.receive < 0 ? 0 : entry.timings.receive);
+            writer.EndObject();
+
+            writer.EndObject();
+        }
+    }
+    writer.EndArray();
+
+    writer.EndObject();
+    writer.EndObject();
+
+    return buffer.GetString();
+}
+
+bool NetworkMetrics::saveCapture(const std::string& filename)
+{
+    return FileUtils::getInstance()->writeStringToFile(getCaptureAsHAR(), filename);
+}
+
+void NetworkMetrics::addConsoleCommand(Console* console)
+{
+    if (console == nullptr)
+    {
+        console = Director::getInstance()->getConsole();
+    }
+
+    console->addCommand({"network", "Print the network statistics. Args: [-h | help | reset | capture start | capture stop | capture save filename | ]",
+        [](int fd, const std::string& /*args*/) {
+            Console::Utility::mydprintf(fd, "%s", NetworkMetrics::getInstance()->getSummary().c_str());
+        }});
+    console->addSubCommand("network", {"reset", "Clear the network statistics.",
+        [](int /*fd*/, const std::string& /*args*/) {
+            NetworkMetrics::getInstance()->reset();
+        }});
+    console->addSubCommand("network", {"capture", "Capture request timings. Args: [start | stop | save filename]",
+        [](int fd, const std::string& args) {
+            auto argv = Console::Utility::split(args, ' ');
+            auto metrics = NetworkMetrics::getInstance();
+            if (argv.size() >= 2 && argv[1] == "start")
+            {
+                metrics->startCapture();
+                Console::Utility::mydprintf(fd, "network capture started\n");
+            }
+            else if (argv.size() >= 2 && argv[1] == "stop")
+            {
+                metrics->stopCapture();
+                Console::Utility::mydprintf(fd, "network capture stopped\n");
+            }
+            else if (argv.size() >= 3 && argv[1] == "save")
+            {
+                std::string path = argv[2];
+                if (!FileUtils::getInstance()->isAbsolutePath(path))
+                {
+                    path = FileUtils::getInstance()->getWritablePath() + path;
+                }
+                if (metrics->saveCapture(path))
+                    Console::Utility::mydprintf(fd, "network capture saved to %s\n", path.c_str());
+                else
+                    Console::Utility::mydprintf(fd, "failed to save network capture to %s\n", path.c_str());
+            }
+            else
+            {
+                Console::Utility::mydprintf(fd, "usage: network capture [start | stop | save filename]\n");
+            }
+        }});
+}
+
+} // namespace network
+
+NS_CC_END
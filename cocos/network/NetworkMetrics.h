@@ -0,0 +1,300 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __NETWORK_METRICS_H__
+#define __NETWORK_METRICS_H__
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup network
+ * @{
+ */
+
+NS_CC_BEGIN
+
+class Console;
+
+namespace network {
+
+/** Singleton collecting traffic statistics of HttpClient, Downloader, WebSocket and SocketIO.
+ *
+ * The network classes report their requests and messages, the registry aggregates
+ * them per source and per host: requests in flight, bytes up and down, latency and
+ * queue wait histograms, and connection reuse.
+ * Request timings can also be captured and saved as a HAR 1.2 JSON file.
+ *
+ * All methods are thread safe, they can be called from the network threads.
+ *
+ * @lua NA
+ */
+class CC_DLL NetworkMetrics
+{
+public:
+    /** The network class a request or message comes from. */
+    enum class Source
+    {
+        HTTP_CLIENT,
+        DOWNLOADER,
+        WEBSOCKET,
+        SOCKETIO
+    };
+
+    static const int SOURCE_COUNT = 4;
+
+    /** Durations in milliseconds of the phases of a request, -1 if not applicable, as defined by HAR. */
+    struct Timings
+    {
+        double dns;
+        double connect;
+        double ssl;
+        double send;
+        double wait;
+        double receive;
+
+        Timings() : dns(-1), connect(-1), ssl(-1), send(-1), wait(-1), receive(-1) {}
+    };
+
+    /** The result of one network transfer of a request, a request may do several transfers. */
+    struct Transfer
+    {
+        long statusCode;
+        int64_t bytesSent;
+        int64_t bytesReceived;
+        /** Whether the transfer used a connection already opened by a previous request. */
+        bool connectionReused;
+        Timings timings;
+
+        Transfer() : statusCode(0), bytesSent(0), bytesReceived(0), connectionReused(false) {}
+    };
+
+    /** Histogram of durations in milliseconds. */
+    struct Histogram
+    {
+        static const int BUCKET_COUNT = 10;
+        /** Upper bounds of the buckets, the last bucket has no bound. */
+        static const double BUCKET_LIMITS[BUCKET_COUNT - 1];
+
+        uint32_t buckets[BUCKET_COUNT];
+        uint32_t count;
+        double total;
+        double max;
+
+        Histogram();
+        void add(double ms);
+        double getAverage() const { return count ? total / count : 0; }
+        /** Upper bound of the bucket containing the given percentile, percentile is in [0, 1]. */
+        double getPercentile(double percentile) const;
+    };
+
+    struct SourceStats
+    {
+        uint32_t queued;
+        uint32_t inFlight;
+        uint32_t requests;
+        uint32_t failures;
+        uint32_t messagesSent;
+        uint32_t messagesReceived;
+        /** Persistent connections opened, by WebSocket. */
+        uint32_t connectionsOpened;
+        uint64_t bytesSent;
+        uint64_t bytesReceived;
+
+        SourceStats();
+    };
+
+    struct HostStats
+    {
+        uint32_t requests;
+        uint32_t failures;
+        uint32_t connectionsOpened;
+        uint32_t connectionsReused;
+        uint64_t bytesSent;
+        uint64_t bytesReceived;
+        /** Time from the start of a request to its completion. */
+        Histogram latency;
+        /** Time spent by requests in the queue of their client before being started. */
+        Histogram queueWait;
+
+        HostStats();
+        /** Ratio of transfers done on an already opened connection. */
+        float getReuseRate() const;
+    };
+
+    /** A copy of all statistics, for debug overlays. */
+    struct Snapshot
+    {
+        SourceStats sources[SOURCE_COUNT];
+        std::map<std::string, HostStats> hosts;
+
+        const SourceStats& getSource(Source source) const { return sources[(int)source]; }
+    };
+
+    /**
+     * Get instance of NetworkMetrics.
+     *
+     * @return the instance of NetworkMetrics.
+     */
+    static NetworkMetrics* getInstance();
+
+    /**
+     * Release the instance of NetworkMetrics.
+     */
+    static void destroyInstance();
+
+    /**
+     * Add the "network" command to a console, Director's console is used if console is nullptr.
+     * Usage: network [reset | capture start | capture stop | capture save filename]
+     */
+    static void addConsoleCommand(Console* console = nullptr);
+
+    static const char* getSourceName(Source source);
+
+    /** Enable or disable the collection, it is enabled by default. */
+    void setEnabled(bool enabled) { _enabled = enabled; }
+
+    bool isEnabled() const { return _enabled; }
+
+    /** @name Reporting, used by the network classes
+     *  A request is identified by a key, usually the address of the request object.
+     */
+    /// @{
+
+    /** A request was added to the queue of a client. */
+    void requestQueued(Source source, const void* key, const char* method, const std::string& url);
+
+    /** A queued request is being processed. */
+    void requestStarted(const void* key);
+
+    /** A network transfer of a running request completed. */
+    void requestTransferred(const void* key, const Transfer& transfer);
+
+    /** A request completed, statusCode 0 means the status of the last transfer. */
+    void requestFinished(const void* key, long statusCode, bool succeeded);
+
+    /** A persistent connection was opened. */
+    void connectionOpened(Source source, const std::string& host);
+
+    void messageSent(Source source, const std::string& host, size_t bytes);
+
+    void messageReceived(Source source, const std::string& host, size_t bytes);
+
+    /// @}
+
+    /** Copy of the current statistics. */
+    Snapshot getSnapshot();
+
+    /** Human readable report of the current statistics. */
+    std::string getSummary();
+
+    /** Clear all statistics, requests in flight are kept. */
+    void reset();
+
+    /**
+     * Record the timings of the completed requests until stopCapture is called.
+     * At most maxEntries requests are kept, the oldest ones are dropped.
+     */
+    void startCapture(size_t maxEntries = 1000);
+
+    void stopCapture();
+
+    bool isCapturing() const { return _capturing; }
+
+    /** The captured requests as a HAR 1.2 JSON document. */
+    std::string getCaptureAsHAR();
+
+    /** Write the captured requests to a HAR 1.2 JSON file. */
+    bool saveCapture(const std::string& filename);
+
+    /** Extract "host[:port]" from an url. */
+    static std::string getHostFromURL(const std::string& url);
+
+private:
+    NetworkMetrics();
+    ~NetworkMetrics();
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct PendingRequest
+    {
+        Source source;
+        std::string method;
+        std::string url;
+        std::string host;
+        Clock::time_point queuedTime;
+        Clock::time_point startedTime;
+        bool started;
+        time_t startedDateTime;
+        int startedMilliseconds;
+        Transfer transfer;
+        bool transferred;
+    };
+
+    struct CaptureEntry
+    {
+        Source source;
+        std::string method;
+        std::string url;
+        time_t startedDateTime;
+        int startedMilliseconds;
+        long statusCode;
+        bool succeeded;
+        int64_t bytesSent;
+        int64_t bytesReceived;
+        double blocked;
+        double total;
+        Timings timings;
+    };
+
+    HostStats& getHostStats(const std::string& host);
+
+    std::atomic<bool> _enabled;
+    std::atomic<bool> _capturing;
+    size_t _maxCaptureEntries;
+
+    SourceStats _sources[SOURCE_COUNT];
+    std::map<std::string, HostStats> _hosts;
+    std::unordered_map<const void*, PendingRequest> _pending;
+    std::deque<CaptureEntry> _capture;
+
+    std::mutex _mutex;
+};
+
+} // namespace network
+
+NS_CC_END
+
+// end group
+/// @}
+
+#endif //__NETWORK_METRICS_H__
@@ -31,10 +31,15 @@
 #include <algorithm>
 #include <sstream>
 #include <iterator>
+#include <list>
+#include <unordered_map>
+#include <cctype>
+#include <cstring>
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
 #include "network/WebSocket.h"
 #include "network/HttpClient.h"
+#include "network/NetworkMetrics.h"
 
 #include "json/rapidjson.h"
 #include "json/document.h"
@@ -335,6 +340,310 @@ SocketIOPacket * SocketIOPacket::createPacketWithTypeIndex(int type, SocketIOPac
     return ret;
 }
 
+namespace {
+
+/**
+ *  @brief A non owning slice of a received frame, parsing never copies the payload
+ */
+struct SIOStringRef
+{
+    const char* data;
+    size_t size;
+
+    SIOStringRef() : data(nullptr), size(0) {}
+    SIOStringRef(const char* d, size_t s) : data(d), size(s) {}
+
+    bool empty() const { return size == 0; }
+    std::string str() const { return std::string(data, size); }
+
+    bool equals(const char* s) const
+    {
+        size_t len = strlen(s);
+        return len == size && (size == 0 || memcmp(data, s, size) == 0);
+    }
+
+    bool equals(const std::string& s) const
+    {
+        return s.size() == size && (size == 0 || memcmp(data, s.data(), size) == 0);
+    }
+
+    SIOStringRef sub(size_t pos, size_t n = std::string::npos) const
+    {
+        if (pos > size) pos = size;
+        if (n > size - pos) n = size - pos;
+        return SIOStringRef(data + pos, n);
+    }
+
+    size_t find(char c, size_t from = 0) const
+    {
+        for (size_t i = from; i < size; ++i)
+        {
+            if (data[i] == c) return i;
+        }
+        return std::string::npos;
+    }
+
+    SIOStringRef trim() const
+    {
+        size_t b = 0, e = size;
+        while (b < e && isspace((unsigned char)data[b])) ++b;
+        while (e > b && isspace((unsigned char)data[e - 1])) --e;
+        return SIOStringRef(data + b, e - b);
+    }
+};
+
+/**
+ *  @brief A socket.io 1.x frame: <engine type><packet type>[<attachments>-][<nsp>,][<id>][<json>]
+ */
+struct SIOFrameV10x
+{
+    int engineType;
+    int packetType;
+    int attachments;
+    SIOStringRef endpoint;
+    SIOStringRef ackId;
+    SIOStringRef payload;
+
+    SIOFrameV10x() : engineType(-1), packetType(-1), attachments(0) {}
+};
+
+/**
+ *  @brief A socket.io 0.9.x frame: <type>:<id>:<endpoint>:<data>
+ */
+struct SIOFrameV09x
+{
+    int type;
+    SIOStringRef msgId;
+    SIOStringRef endpoint;
+    SIOStringRef payload;
+
+    SIOFrameV09x() : type(-1) {}
+};
+
+bool parseFrameV10x(const char* data, size_t len, SIOFrameV10x& frame)
+{
+    SIOStringRef in(data, len);
+    if (in.empty() || !isdigit((unsigned char)in.data[0]))
+        return false;
+
+    frame.engineType = in.data[0] - '0';
+    if (frame.engineType != 4)
+    {
+        // not a socket.io message, the rest of the frame is the engine.io payload
+        frame.payload = in.sub(1);
+        return true;
+    }
+
+    size_t pos = 1;
+    if (pos >= in.size || !isdigit((unsigned char)in.data[pos]))
+        return false;
+    frame.packetType = in.data[pos++] - '0';
+
+    // binary packets announce their attachment count: "<n>-"
+    if (frame.packetType == 5 || frame.packetType == 6)
+    {
+        size_t dash = in.find('-', pos);
+        if (dash == std::string::npos)
+            return false;
+        frame.attachments = atoi(in.sub(pos, dash - pos).str().c_str());
+        pos = dash + 1;
+    }
+
+    if (pos < in.size && in.data[pos] == '/')
+    {
+        size_t comma = in.find(',', pos);
+        if (comma == std::string::npos)
+        {
+            frame.endpoint = in.sub(pos);
+            pos = in.size;
+        }
+        else
+        {
+            frame.endpoint = in.sub(pos, comma - pos);
+            pos = comma + 1;
+        }
+    }
+
+    size_t idStart = pos;
+    while (pos < in.size && isdigit((unsigned char)in.data[pos])) ++pos;
+    frame.ackId = in.sub(idStart, pos - idStart);
+    frame.payload = in.sub(pos);
+    return true;
+}
+
+bool parseFrameV09x(const char* data, size_t len, SIOFrameV09x& frame)
+{
+    SIOStringRef in(data, len);
+    size_t a = in.find(':');
+    if (a == std::string::npos || a == 0 || !isdigit((unsigned char)in.data[0]))
+        return false;
+    frame.type = in.data[0] - '0';
+
+    size_t b = in.find(':', a + 1);
+    if (b == std::string::npos)
+    {
+        frame.msgId = in.sub(a + 1);
+        return true;
+    }
+    frame.msgId = in.sub(a + 1, b - a - 1);
+
+    size_t c = in.find(':', b + 1);
+    if (c == std::string::npos)
+    {
+        frame.endpoint = in.sub(b + 1);
+        return true;
+    }
+    frame.endpoint = in.sub(b + 1, c - b - 1);
+    frame.payload = in.sub(c + 1);
+    return true;
+}
+
+// Find the end of the json string starting at the opening quote, honoring escapes
+size_t findStringEnd(const SIOStringRef& in, size_t quote)
+{
+    for (size_t i = quote + 1; i < in.size; ++i)
+    {
+        if (in.data[i] == '\\') ++i;
+        else if (in.data[i] == '"') return i;
+    }
+    return std::string::npos;
+}
+
+/**
+ *  @brief Split a 1.x event payload ["name",args...] into the name and the raw json of the args
+ */
+bool splitEventV10x(const SIOStringRef& payload, SIOStringRef& name, SIOStringRef& args)
+{
+    size_t open = payload.find('[');
+    if (open == std::string::npos)
+        return false;
+    size_t quote = payload.find('"', open + 1);
+    if (quote == std::string::npos)
+        return false;
+    size_t end = findStringEnd(payload, quote);
+    if (end == std::string::npos)
+        return false;
+    name = payload.sub(quote + 1, end - quote - 1);
+
+    size_t close = payload.size;
+    while (close > end && payload.data[close - 1] != ']') --close;
+    SIOStringRef rest = payload.sub(end + 1, close > end + 1 ? close - end - 2 : 0).trim();
+    if (!rest.empty() && rest.data[0] == ',')
+        rest = rest.sub(1).trim();
+    args = rest;
+    return true;
+}
+
+/**
+ *  @brief Split a 0.9.x event payload {"name":"name","args":[args...]} into the name and the raw json of the args
+ */
+bool splitEventV09x(const SIOStringRef& payload, SIOStringRef& name, SIOStringRef& args)
+{
+    size_t colon = payload.find(':');
+    if (colon == std::string::npos)
+        return false;
+    size_t quote = payload.find('"', colon + 1);
+    if (quote == std::string::npos)
+        return false;
+    size_t end = findStringEnd(payload, quote);
+    if (end == std::string::npos)
+        return false;
+    name = payload.sub(quote + 1, end - quote - 1);
+
+    size_t open = payload.find('[', end + 1);
+    size_t close = payload.size;
+    while (close > end && payload.data[close - 1] != ']') --close;
+    if (open == std::string::npos || close <= open + 1)
+        args = SIOStringRef();
+    else
+        args = payload.sub(open + 1, close - open - 2).trim();
+    return true;
+}
+
+void appendJsonString(std::string& out, const std::string& s)
+{
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    for (char ch : s)
+    {
+        unsigned char c = (unsigned char)ch;
+        switch (c)
+        {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20)
+            {
+                out += "\\u00";
+                out += hex[c >> 4];
+                out += hex[c & 0xf];
+            }
+            else
+            {
+                out += ch;
+            }
+            break;
+        }
+    }
+    out += '"';
+}
+
+/**
+ *  @brief Interned event names, a name received again resolves to the same string without allocating
+ */
+class SIONameTable
+{
+public:
+    SIONameTable() : _count(0) {}
+
+    const std::string& intern(const SIOStringRef& name)
+    {
+        // FNV-1a
+        size_t h = 2166136261u;
+        for (size_t i = 0; i < name.size; ++i)
+        {
+            h ^= (unsigned char)name.data[i];
+            h *= 16777619u;
+        }
+
+        auto found = _buckets.find(h);
+        if (found != _buckets.end())
+        {
+            for (auto& s : found->second)
+            {
+                if (name.equals(s)) return s;
+            }
+        }
+
+        // don't let a misbehaving server grow the table forever, no bucket is created past the limit either
+        if (_count >= MAX_NAMES)
+        {
+            _scratch.assign(name.data, name.size);
+            return _scratch;
+        }
+
+        auto& bucket = found != _buckets.end() ? found->second : _buckets[h];
+        bucket.push_back(name.str());
+        ++_count;
+        return bucket.back();
+    }
+
+private:
+    static const size_t MAX_NAMES = 1024;
+
+    // lists keep the returned references valid while the table grows
+    std::unordered_map<size_t, std::list<std::string>> _buckets;
+    size_t _count;
+    std::string _scratch;
+};
+
+} // namespace {
+
 /**
  *  @brief The implementation of the socket.io connection
  *         Clients/endpoints may share the same impl to accomplish multiplexing on the same websocket
@@ -353,6 +662,24 @@ private:
 
     Map<std::string, SIOClient*> _clients;
 
+    SIONameTable _eventNames;
+
+    //! A binary event or ack waiting for its attachments, they are sent as separate binary frames
+    struct BinaryPacket
+    {
+        bool isAck;
+        int expected;
+        std::string endpoint;
+        std::string payload;
+        std::vector<std::vector<char>> attachments;
+    };
+    BinaryPacket _binaryPacket;
+
+    void onMessageV09x(const char* data, size_t len);
+    void onMessageV10x(const char* data, size_t len);
+    void onBinaryAttachment(const char* data, size_t len);
+    void dispatchEventV10x(SIOClient* c, const SIOStringRef& payload, const std::vector<std::vector<char>>* attachments);
+
 public:
     SIOClientImpl(const std::string& host, int port);
     virtual ~SIOClientImpl();
@@ -381,6 +708,7 @@ public:
     void send(const std::string& endpoint, const std::string& s);
     void send(SocketIOPacket *packet);
     void emit(const std::string& endpoint, const std::string& eventname, const std::string& args);
+    void emit(const std::string& endpoint, const std::string& eventname, const std::string& args, const std::vector<std::vector<char>>& attachments);
 
 
 };
@@ -394,6 +722,9 @@ SIOClientImpl::SIOClientImpl(const std::string& host, int port) :
     _host(host),
     _connected(false)
 {
+    _binaryPacket.isAck = false;
+    _binaryPacket.expected = 0;
+
     std::stringstream s;
     s << host << ":" << port;
     _uri = s.str();
@@ -702,20 +1033,111 @@ void SIOClientImpl::send(SocketIOPacket *packet)
     if (_connected)
     {
         CCLOGINFO("-->SEND:%s", req.data());
-        _ws->send(req.data());
+        _ws->send(req);
+        NetworkMetrics::getInstance()->messageSent(NetworkMetrics::Source::SOCKETIO, _uri, req.size());
     }
     else
         CCLOGINFO("Cant send the message (%s) because disconnected", req.c_str());
+
+    delete packet;
 }
 
 void SIOClientImpl::emit(const std::string& endpoint, const std::string& eventname, const std::string& args)
 {
     CCLOGINFO("Emitting event \"%s\"", eventname.c_str());
-    SocketIOPacket *packet = SocketIOPacket::createPacketWithType("event", _version);
-    packet->setEndpoint(endpoint == "/" ? "" : endpoint);
-    packet->setEvent(eventname);
-    packet->addData(args);
-    this->send(packet);
+
+    if (!_connected)
+    {
+        CCLOGINFO("Cant emit the event (%s) because disconnected", eventname.c_str());
+        return;
+    }
+
+    // events are the hot path, the frame is built in place instead of going through SocketIOPacket
+    bool hasEndpoint = endpoint != "/" && endpoint != "";
+    std::string req;
+    req.reserve(eventname.size() + args.size() + endpoint.size() + 32);
+
+    switch (_version)
+    {
+    case SocketIOPacket::SocketIOVersion::V09x:
+        req += "5::";
+        if (hasEndpoint) req += endpoint;
+        req += ":{\"name\":";
+        appendJsonString(req, eventname);
+        req += ",\"args\":[";
+        appendJsonString(req, args);
+        req += "]}";
+        break;
+    case SocketIOPacket::SocketIOVersion::V10x:
+        req += "42";
+        if (hasEndpoint)
+        {
+            req += endpoint;
+            req += ',';
+        }
+        req += '[';
+        appendJsonString(req, eventname);
+        req += ',';
+        appendJsonString(req, args);
+        req += ']';
+        break;
+    }
+
+    CCLOGINFO("-->SEND:%s", req.c_str());
+    _ws->send(req);
+    NetworkMetrics::getInstance()->messageSent(NetworkMetrics::Source::SOCKETIO, _uri, req.size());
+}
+
+void SIOClientImpl::emit(const std::string& endpoint, const std::string& eventname, const std::string& args, const std::vector<std::vector<char>>& attachments)
+{
+    CCLOGINFO("Emitting binary event \"%s\" with %d attachments", eventname.c_str(), (int)attachments.size());
+
+    if (!_connected)
+    {
+        CCLOGINFO("Cant emit the event (%s) because disconnected", eventname.c_str());
+        return;
+    }
+
+    if (_version == SocketIOPacket::SocketIOVersion::V09x)
+    {
+        CCLOGERROR("SIOClientImpl::emit binary events aren't supported by socket.io 0.9, the event (%s) isn't sent", eventname.c_str());
+        return;
+    }
+
+    // binary event: the json refers to each attachment with a placeholder, attachments follow as binary frames
+    std::string req = "45";
+    req += std::to_string(attachments.size());
+    req += '-';
+    if (endpoint != "/" && endpoint != "")
+    {
+        req += endpoint;
+        req += ',';
+    }
+    req += '[';
+    appendJsonString(req, eventname);
+    req += ',';
+    appendJsonString(req, args);
+    for (size_t i = 0; i < attachments.size(); ++i)
+    {
+        req += ",{\"_placeholder\":true,\"num\":";
+        req += std::to_string(i);
+        req += '}';
+    }
+    req += ']';
+    _ws->send(req);
+    NetworkMetrics::getInstance()->messageSent(NetworkMetrics::Source::SOCKETIO, _uri, req.size());
+
+    std::vector<unsigned char> frame;
+    for (auto& attachment : attachments)
+    {
+        // engine.io prefixes binary messages with their packet type
+        frame.resize(attachment.size() + 1);
+        frame[0] = 4;
+        if (!attachment.empty())
+            memcpy(frame.data() + 1, attachment.data(), attachment.size());
+        _ws->send(frame.data(), (unsigned int)frame.size());
+        NetworkMetrics::getInstance()->messageSent(NetworkMetrics::Source::SOCKETIO, _uri, frame.size());
+    }
 }
 
 void SIOClientImpl::onOpen(WebSocket* ws)
@@ -743,237 +1165,239 @@ void SIOClientImpl::onOpen(WebSocket* ws)
 
 void SIOClientImpl::onMessage(WebSocket* ws, const WebSocket::Data& data)
 {
-    CCLOGINFO("SIOClientImpl::onMessage received: %s", data.bytes);
     CC_UNUSED_PARAM(ws);
 
-    std::string payload = data.bytes;
-    int control = atoi(payload.substr(0, 1).c_str());
-    payload = payload.substr(1, payload.size() - 1);
+    NetworkMetrics::getInstance()->messageReceived(NetworkMetrics::Source::SOCKETIO, _uri, (size_t)data.len);
 
-    SIOClient *c = nullptr;
+    if (data.isBinary)
+    {
+        onBinaryAttachment(data.bytes, (size_t)data.len);
+        return;
+    }
+
+    CCLOGINFO("SIOClientImpl::onMessage received: %s", data.bytes);
 
     switch (_version)
     {
         case SocketIOPacket::SocketIOVersion::V09x:
-        {
-            std::string msgid, endpoint, s_data, eventname;
-
-            std::string::size_type pos, pos2;
+            onMessageV09x(data.bytes, (size_t)data.len);
+            break;
+        case SocketIOPacket::SocketIOVersion::V10x:
+            onMessageV10x(data.bytes, (size_t)data.len);
+            break;
+    }
+}
 
-            pos = payload.find(":");
-            if (pos != std::string::npos)
-            {
-                payload.erase(0, pos + 1);
-            }
+void SIOClientImpl::onMessageV09x(const char* data, size_t len)
+{
+    SIOFrameV09x frame;
+    if (!parseFrameV09x(data, len, frame))
+    {
+        CCLOGERROR("SIOClientImpl::onMessage malformed frame");
+        return;
+    }
 
-            pos = payload.find(":");
-            if (pos != std::string::npos)
-            {
-                msgid = atoi(payload.substr(0, pos + 1).c_str());
-            }
-            payload.erase(0, pos + 1);
+    std::string endpoint = frame.endpoint.empty() ? "/" : frame.endpoint.str();
+    SIOClient *c = getClient(endpoint);
+    if (c == nullptr) CCLOGINFO("SIOClientImpl::onMessage client lookup returned nullptr");
 
-            pos = payload.find(":");
-            if (pos != std::string::npos)
-            {
-                endpoint = payload.substr(0, pos);
-                payload.erase(0, pos + 1);
-            }
+    switch (frame.type)
+    {
+    case 0:
+        CCLOGINFO("Received Disconnect Signal for Endpoint: %s\n", endpoint.c_str());
+        disconnectFromEndpoint(endpoint);
+        if (c) c->fireEvent("disconnect", frame.payload.str());
+        break;
+    case 1:
+        CCLOGINFO("Connected to endpoint: %s \n", endpoint.c_str());
+        if (c) {
+            c->onConnect();
+            c->fireEvent("connect", frame.payload.str());
+        }
+        break;
+    case 2:
+        CCLOGINFO("Heartbeat received\n");
+        break;
+    case 3:
+    case 4:
+        CCLOGINFO("%s received", frame.type == 3 ? "Message" : "JSON Message");
+        if (c)
+        {
+            std::string s_data = frame.payload.str();
+            c->getDelegate()->onMessage(c, s_data);
+            c->fireEvent(frame.type == 3 ? "message" : "json", s_data);
+        }
+        break;
+    case 5:
+        CCLOGINFO("Event Received");
+        if (c)
+        {
+            SIOStringRef name, args;
+            if (splitEventV09x(frame.payload, name, args))
+                c->fireEvent(_eventNames.intern(name), args.str());
             else
-            {
-                endpoint = payload;
-            }
-
-            if (endpoint == "") endpoint = "/";
-
-            c = getClient(endpoint);
-
-            s_data = payload;
+                c->fireEvent("", frame.payload.str());
+        }
+        break;
+    case 6:
+        CCLOGINFO("Message Ack\n");
+        break;
+    case 7:
+        CCLOGERROR("Error\n");
+        if (c) c->fireEvent("error", frame.payload.str());
+        break;
+    case 8:
+        CCLOGINFO("Noop\n");
+        break;
+    }
+}
 
-            if (c == nullptr) CCLOGINFO("SIOClientImpl::onMessage client lookup returned nullptr");
+void SIOClientImpl::onMessageV10x(const char* data, size_t len)
+{
+    SIOFrameV10x frame;
+    if (!parseFrameV10x(data, len, frame))
+    {
+        CCLOGERROR("SIOClientImpl::onMessage malformed frame");
+        return;
+    }
 
-            switch (control)
-            {
-            case 0:
-                CCLOGINFO("Received Disconnect Signal for Endpoint: %s\n", endpoint.c_str());
-                disconnectFromEndpoint(endpoint);
-                c->fireEvent("disconnect", payload);
-                break;
-            case 1:
-                CCLOGINFO("Connected to endpoint: %s \n", endpoint.c_str());
-                if (c) {
-                    c->onConnect();
-                    c->fireEvent("connect", payload);
-                }
-                break;
-            case 2:
-                CCLOGINFO("Heartbeat received\n");
-                break;
-            case 3:
-                CCLOGINFO("Message received: %s \n", s_data.c_str());
-                if (c) c->getDelegate()->onMessage(c, s_data);
-                if (c) c->fireEvent("message", s_data);
-                break;
-            case 4:
-                CCLOGINFO("JSON Message Received: %s \n", s_data.c_str());
-                if (c) c->getDelegate()->onMessage(c, s_data);
-                if (c) c->fireEvent("json", s_data);
-                break;
-            case 5:
-                CCLOGINFO("Event Received with data: %s \n", s_data.c_str());
-
-                if (c)
-                {
-                    eventname = "";
-                    pos = s_data.find(":");
-                    pos2 = s_data.find(",");
-                    if (pos2 > pos)
-                    {
-                        eventname = s_data.substr(pos + 2, pos2 - (pos + 3));
-                        s_data = s_data.substr(pos2 + 9, s_data.size() - (pos2 + 11));
-                    }
-
-                    c->fireEvent(eventname, s_data);
-                }
-
-                break;
-            case 6:
-                CCLOGINFO("Message Ack\n");
-                break;
-            case 7:
-                CCLOGERROR("Error\n");
-                //if (c) c->getDelegate()->onError(c, s_data);
-                if (c) c->fireEvent("error", s_data);
-                break;
-            case 8:
-                CCLOGINFO("Noop\n");
-                break;
-            }
+    switch (frame.engineType)
+    {
+    case 0:
+        CCLOGINFO("Not supposed to receive control 0 for websocket");
+        CCLOGINFO("That's not good");
+        break;
+    case 1:
+        CCLOGINFO("Not supposed to receive control 1 for websocket");
+        break;
+    case 2:
+    {
+        CCLOGINFO("Ping received, send pong");
+        std::string pong = "3";
+        pong.append(frame.payload.data, frame.payload.size);
+        _ws->send(pong);
+        break;
+    }
+    case 3:
+        CCLOGINFO("Pong received");
+        if (frame.payload.equals("probe"))
+        {
+            CCLOGINFO("Request Update");
+            _ws->send("5");
         }
         break;
-        case SocketIOPacket::SocketIOVersion::V10x:
+    case 4:
+    {
+        CCLOGINFO("Message code: [%i]", frame.packetType);
+
+        // we didn't find and endpoint and we are in the default namespace
+        std::string endpoint = frame.endpoint.empty() ? "/" : frame.endpoint.str();
+        SIOClient *c = getClient(endpoint);
+
+        switch (frame.packetType)
         {
-            switch (control)
+        case 0:
+            CCLOGINFO("Socket Connected");
+            if (c) {
+                c->onConnect();
+                c->fireEvent("connect", frame.payload.str());
+            }
+            break;
+        case 1:
+            CCLOGINFO("Socket Disconnected");
+            disconnectFromEndpoint(endpoint);
+            if (c) c->fireEvent("disconnect", frame.payload.str());
+            break;
+        case 2:
+            CCLOGINFO("Event Received");
+            dispatchEventV10x(c, frame.payload, nullptr);
+            break;
+        case 3:
+            CCLOGINFO("Message Ack");
+            break;
+        case 4:
+            CCLOGERROR("Error");
+            if (c) c->fireEvent("error", frame.payload.str());
+            break;
+        case 5:
+        case 6:
+            CCLOGINFO("Binary %s with %d attachments", frame.packetType == 5 ? "Event" : "Ack", frame.attachments);
+            if (frame.attachments > 0)
             {
-            case 0:
-                CCLOGINFO("Not supposed to receive control 0 for websocket");
-                CCLOGINFO("That's not good");
-                break;
-            case 1:
-                CCLOGINFO("Not supposed to receive control 1 for websocket");
-                break;
-            case 2:
-                CCLOGINFO("Ping received, send pong");
-                payload = "3" + payload;
-                _ws->send(payload);
-                break;
-            case 3:
-                CCLOGINFO("Pong received");
-                if (payload == "probe")
-                {
-                    CCLOGINFO("Request Update");
-                    _ws->send("5");
-                }
-                break;
-            case 4:
+                _binaryPacket.isAck = frame.packetType == 6;
+                _binaryPacket.expected = frame.attachments;
+                _binaryPacket.endpoint = endpoint;
+                _binaryPacket.payload.assign(frame.payload.data, frame.payload.size);
+                _binaryPacket.attachments.clear();
+                _binaryPacket.attachments.reserve(frame.attachments);
+            }
+            else if (frame.packetType == 5)
             {
-                int control2 = payload.at(0) - '0';
-                CCLOGINFO("Message code: [%i]", control2);
-
-                SocketIOPacket *packetOut = SocketIOPacket::createPacketWithType("event", _version);
-                std::string endpoint = "";
-
-                std::string::size_type a = payload.find("/");
-                std::string::size_type b = payload.find("[");
-
-                if (b != std::string::npos)
-                {
-                    if (a != std::string::npos && a < b)
-                    {
-                        //we have an endpoint and a payload
-                        endpoint = payload.substr(a, b - (a + 1));
-                    }
-                }
-                else if (a != std::string::npos) {
-                    //we have an endpoint with no payload
-                    endpoint = payload.substr(a, payload.size() - a);
-                }
-
-                // we didn't find and endpoint and we are in the default namespace
-                if (endpoint == "") endpoint = "/";
-
-                packetOut->setEndpoint(endpoint);
-
-                c = getClient(endpoint);
-
-                payload = payload.substr(1);
-
-                if (endpoint != "/") payload = payload.substr(endpoint.size());
-                if (endpoint != "/" && payload != "") payload = payload.substr(1);
-
-                switch (control2)
-                {
-                case 0:
-                    CCLOGINFO("Socket Connected");
-                    if (c) {
-                        c->onConnect();
-                        c->fireEvent("connect", payload);
-                    }
-                    break;
-                case 1:
-                    CCLOGINFO("Socket Disconnected");
-                    disconnectFromEndpoint(endpoint);
-                    c->fireEvent("disconnect", payload);
-                    break;
-                case 2:
-                {
-                    CCLOGINFO("Event Received (%s)", payload.c_str());
-
-                    std::string::size_type payloadFirstSlashPos = payload.find("\"");
-                    std::string::size_type payloadSecondSlashPos = payload.substr(payloadFirstSlashPos + 1).find("\"");
-
-                    std::string eventname = payload.substr(payloadFirstSlashPos + 1,
-                                                           payloadSecondSlashPos - payloadFirstSlashPos + 1);
-
-                    CCLOGINFO("event name %s between %i and %i", eventname.c_str(),
-                              payloadFirstSlashPos, payloadSecondSlashPos);
-
-                    payload = payload.substr(payloadSecondSlashPos + 4,
-                                             payload.size() - (payloadSecondSlashPos + 5));
-
-                    if (c) c->fireEvent(eventname, payload);
-                    if (c) c->getDelegate()->onMessage(c, payload);
-
-                }
-                break;
-                case 3:
-                    CCLOGINFO("Message Ack");
-                    break;
-                case 4:
-                    CCLOGERROR("Error");
-                    if (c) c->fireEvent("error", payload);
-                    break;
-                case 5:
-                    CCLOGINFO("Binary Event");
-                    break;
-                case 6:
-                    CCLOGINFO("Binary Ack");
-                    break;
-                }
+                dispatchEventV10x(c, frame.payload, nullptr);
             }
             break;
-            case 5:
-                CCLOGINFO("Upgrade required");
-                break;
-            case 6:
-                CCLOGINFO("Noop\n");
-                break;
-            }
         }
+    }
+    break;
+    case 5:
+        CCLOGINFO("Upgrade required");
+        break;
+    case 6:
+        CCLOGINFO("Noop\n");
         break;
     }
+}
 
-    return;
+void SIOClientImpl::onBinaryAttachment(const char* data, size_t len)
+{
+    if (_binaryPacket.expected <= 0)
+    {
+        CCLOGINFO("SIOClientImpl::onMessage unexpected binary frame of %d bytes", (int)len);
+        return;
+    }
+
+    // engine.io prefixes binary messages with their packet type
+    if (len > 0 && data[0] == 4)
+    {
+        ++data;
+        --len;
+    }
+    _binaryPacket.attachments.push_back(std::vector<char>(data, data + len));
+
+    if ((int)_binaryPacket.attachments.size() < _binaryPacket.expected)
+        return;
+
+    _binaryPacket.expected = 0;
+    if (!_binaryPacket.isAck)
+    {
+        SIOClient *c = getClient(_binaryPacket.endpoint);
+        dispatchEventV10x(c, SIOStringRef(_binaryPacket.payload.data(), _binaryPacket.payload.size()), &_binaryPacket.attachments);
+    }
+    _binaryPacket.attachments.clear();
+}
+
+void SIOClientImpl::dispatchEventV10x(SIOClient* c, const SIOStringRef& payload, const std::vector<std::vector<char>>* attachments)
+{
+    if (c == nullptr)
+        return;
+
+    SIOStringRef name, args;
+    if (!splitEventV10x(payload, name, args))
+    {
+        CCLOGERROR("SIOClientImpl::onMessage malformed event");
+        return;
+    }
+
+    const std::string& eventname = _eventNames.intern(name);
+    std::string s_data = args.str();
+
+    CCLOGINFO("event name %s with data %s", eventname.c_str(), s_data.c_str());
+
+    if (attachments)
+        c->fireEvent(eventname, s_data, *attachments);
+    else
+        c->fireEvent(eventname, s_data);
+    c->getDelegate()->onMessage(c, s_data);
 }
 
 void SIOClientImpl::onClose(WebSocket* ws)
@@ -1079,29 +1503,63 @@ void SIOClient::socketClosed()
     this->release();
 }
 
+void SIOClient::emit(const std::string& eventname, const std::string& args, const std::vector<std::vector<char>>& attachments)
+{
+    if(_connected)
+    {
+        _socket->emit(_path, eventname, args, attachments);
+    }
+    else
+    {
+        _delegate->onError(this, "Client not yet connected");
+    }
+}
+
 void SIOClient::on(const std::string& eventName, SIOEvent e)
 {
     _eventRegistry[eventName] = e;
 }
 
+void SIOClient::onBinary(const std::string& eventName, SIOBinaryEvent e)
+{
+    _binaryEventRegistry[eventName] = e;
+}
+
 void SIOClient::fireEvent(const std::string& eventName, const std::string& data)
 {
     CCLOGINFO("SIOClient::fireEvent called with event name: %s and data: %s", eventName.c_str(), data.c_str());
 
     _delegate->fireEventToScript(this, eventName, data);
 
-    if(_eventRegistry[eventName])
+    auto iter = _eventRegistry.find(eventName);
+    if (iter != _eventRegistry.end() && iter->second)
     {
-        SIOEvent e = _eventRegistry[eventName];
-
+        // the handler may register or remove handlers, which destroys the registered one, so call a copy
+        SIOEvent e = iter->second;
         e(this, data);
-
         return;
     }
 
     CCLOGINFO("SIOClient::fireEvent no native event with name %s found", eventName.c_str());
 }
 
+void SIOClient::fireEvent(const std::string& eventName, const std::string& data, const std::vector<std::vector<char>>& attachments)
+{
+    auto iter = _binaryEventRegistry.find(eventName);
+    if (iter == _binaryEventRegistry.end() || !iter->second)
+    {
+        // no binary aware callback, deliver the json part like a regular event
+        fireEvent(eventName, data);
+        return;
+    }
+
+    // the script or the handler may register or remove handlers, so call a copy
+    SIOBinaryEvent e = iter->second;
+    _delegate->fireEventToScript(this, eventName, data);
+
+    e(this, data, attachments);
+}
+
 void SIOClient::setTag(const char* tag)
 {
     _tag = tag;
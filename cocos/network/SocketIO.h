@@ -60,6 +60,7 @@ in the onClose method the pointer should be set to NULL or used to connect to a
 #define __CC_SOCKETIO_H__
 
 #include <string>
+#include <vector>
 #include "platform/CCPlatformMacros.h"
 #include "base/CCMap.h"
 
@@ -184,6 +185,9 @@ private:
 typedef std::function<void(SIOClient*, const std::string&)> SIOEvent;
 //c++11 map to callbacks
 typedef std::unordered_map<std::string, SIOEvent> EventRegistry;
+//callbacks of events carrying binary attachments (socket.io 1.x only)
+typedef std::function<void(SIOClient*, const std::string&, const std::vector<std::vector<char>>&)> SIOBinaryEvent;
+typedef std::unordered_map<std::string, SIOBinaryEvent> BinaryEventRegistry;
 
 /**
  * A single connection to a socket.io endpoint.
@@ -202,8 +206,10 @@ private:
     SocketIO::SIODelegate* _delegate;
 
     EventRegistry _eventRegistry;
+    BinaryEventRegistry _binaryEventRegistry;
 
     void fireEvent(const std::string& eventName, const std::string& data);
+    void fireEvent(const std::string& eventName, const std::string& data, const std::vector<std::vector<char>>& attachments);
 
     void onOpen();
     void onConnect();
@@ -249,6 +255,15 @@ public:
      * @param args
      */
     void emit(const std::string& eventname, const std::string& args);
+    /**
+     *  Emit an event with binary attachments, only supported by socket.io 1.x servers.
+     *  Each attachment is received by the server as a Buffer following args.
+     *  The event isn't sent on a socket.io 0.9 connection, which has no binary encoding.
+     * @param eventname
+     * @param args
+     * @param attachments the binary payloads sent along with the event.
+     */
+    void emit(const std::string& eventname, const std::string& args, const std::vector<std::vector<char>>& attachments);
     /**
      * Used to register a socket.io event callback.
      * Event argument should be passed using CC_CALLBACK2(&Base::function, this).
@@ -256,6 +271,14 @@ public:
      * @param e the callback function.
      */
     void on(const std::string& eventName, SIOEvent e);
+    /**
+     * Used to register a callback for a socket.io event carrying binary attachments.
+     * The json arguments are passed with their placeholders, attachments are passed in order.
+     * Events without a binary callback are delivered to the callback registered with on().
+     * @param eventName the name of event.
+     * @param e the callback function.
+     */
+    void onBinary(const std::string& eventName, SIOBinaryEvent e);
 
     /**
      * Set tag of SIOClient.
@@ -28,6 +28,7 @@
  ****************************************************************************/
 
 #include "network/WebSocket.h"
+#include "network/NetworkMetrics.h"
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
 #include "base/CCEventDispatcher.h"
@@ -340,6 +341,9 @@ WebSocket::~WebSocket()
     LOGD("In the destructor of WebSocket (%p)\n", this);
     CC_SAFE_DELETE(_wsHelper);
 
+    // the handshake didn't complete
+    NetworkMetrics::getInstance()->requestFinished(this, 0, false);
+
     if (_wsProtocols != nullptr)
     {
         for (int i = 0; _wsProtocols[i].callback != nullptr; ++i)
@@ -445,6 +449,10 @@ bool WebSocket::init(const Delegate& delegate,
         _wsProtocols[0].rx_buffer_size = WS_RX_BUFFER_SIZE;
     }
 
+    // the opening handshake is reported as a request
+    NetworkMetrics::getInstance()->requestQueued(NetworkMetrics::Source::WEBSOCKET, this, "GET", url);
+    NetworkMetrics::getInstance()->requestStarted(this);
+
     // WebSocket thread needs to be invoked at the end of this method.
     _wsHelper = new (std::nothrow) WsThreadHelper();
     ret = _wsHelper->createWebSocketThread(*this);
@@ -756,6 +764,7 @@ void WebSocket::onClientWritable()
         else
         {
             LOGD("Safely done, msg(%d)!\n", subThreadMsg->id);
+            NetworkMetrics::getInstance()->messageSent(NetworkMetrics::Source::WEBSOCKET, _host, data->len);
             if (remaining == frame->getFrameLength())
             {
                 LOGD("msg(%u) append: %d + %d = %d\n", subThreadMsg->id, (int)data->issued, (int)frame->getFrameLength(), (int)(data->issued + frame->getFrameLength()));
@@ -810,6 +819,7 @@ void WebSocket::onClientReceivedData(void* in, ssize_t len)
         _receivedData.reserve(WS_RESERVE_RECEIVE_BUFFER_SIZE);
 
         ssize_t frameSize = frameData->size();
+        NetworkMetrics::getInstance()->messageReceived(NetworkMetrics::Source::WEBSOCKET, _host, frameSize);
 
         bool isBinary = (lws_frame_is_binary(_wsInstance) != 0);
 
@@ -854,6 +864,9 @@ void WebSocket::onConnectionOpened()
     _readyState = State::OPEN;
     _readStateMutex.unlock();
 
+    NetworkMetrics::getInstance()->requestFinished(this, 101, true);
+    NetworkMetrics::getInstance()->connectionOpened(NetworkMetrics::Source::WEBSOCKET, _host);
+
     std::shared_ptr<std::atomic<bool>> isDestroyed = _isDestroyed;
     _wsHelper->sendMessageToCocosThread([this, isDestroyed](){
         if (*isDestroyed)
@@ -871,6 +884,8 @@ void WebSocket::onConnectionError()
 {
     LOGD("WebSocket (%p) onConnectionError ...\n", this);
 
+    NetworkMetrics::getInstance()->requestFinished(this, 0, false);
+
     _readStateMutex.lock();
     _readyState = State::CLOSING;
     _readStateMutex.unlock();
@@ -103,6 +103,8 @@ PhysicsBody::PhysicsBody()
 , _momentSetByUser(false)
 , _recordScaleX(1.f)
 , _recordScaleY(1.f)
+, _recordedWorldRotation(0.f)
+, _transformRecorded(false)
 {
     _name = COMPONENT_NAME;
 }
@@ -883,6 +885,13 @@ Vec2 PhysicsBody::local2World(const Vec2& point)
 
 void PhysicsBody::beforeSimulation(const Mat4& parentToWorldTransform, const Mat4& nodeToWorldTransform, float scaleX, float scaleY, float rotation)
 {
+    // setting the position wakes the body up, only do it when the owner or one of its ancestors moved
+    if (_transformRecorded && _recordScaleX == scaleX && _recordScaleY == scaleY && _recordedWorldRotation == rotation
+        && std::equal(nodeToWorldTransform.m, nodeToWorldTransform.m + 16, _recordedNodeToWorldTransform.m))
+    {
+        return;
+    }
+
     if (_recordScaleX != scaleX || _recordScaleY != scaleY)
     {
         _recordScaleX = scaleX;
@@ -910,6 +919,10 @@ void PhysicsBody::beforeSimulation(const Mat4& parentToWorldTransform, const Mat
         _offset.x = worldPosition.x - _owner->getPositionX();
         _offset.y = worldPosition.y - _owner->getPositionY();
     }
+
+    _recordedNodeToWorldTransform = nodeToWorldTransform;
+    _recordedWorldRotation = rotation;
+    _transformRecorded = true;
 }
 
 void PhysicsBody::afterSimulation(const Mat4& parentToWorldTransform, float parentRotation)
@@ -925,6 +938,13 @@ void PhysicsBody::afterSimulation(const Mat4& parentToWorldTransform, float pare
 
     // set Node rotation
     _owner->setRotation(getRotation() - parentRotation);
+
+    // the body and its owner are in sync until one of them moves
+    _recordPosX = tmp.x;
+    _recordPosY = tmp.y;
+    _recordedNodeToWorldTransform = parentToWorldTransform * _owner->getNodeToParentTransform();
+    _recordedWorldRotation = parentRotation + _owner->getRotation();
+    _transformRecorded = true;
 }
 
 void PhysicsBody::onEnter()
@@ -943,6 +963,7 @@ void PhysicsBody::onAdd()
     auto contentSize = _owner->getContentSize();
     _ownerCenterOffset.x = 0.5f * contentSize.width;
     _ownerCenterOffset.y = 0.5f * contentSize.height;
+    _transformRecorded = false;
 
     setRotationOffset(_owner->getRotation());
 
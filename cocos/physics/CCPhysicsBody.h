@@ -552,6 +552,11 @@ protected:
     float _recordPosX;
     float _recordPosY;
 
+    // owner's transform when the body was last synchronized with it, the body isn't set again until it changes
+    Mat4 _recordedNodeToWorldTransform;
+    float _recordedWorldRotation;
+    bool _transformRecorded;
+
     friend class PhysicsWorld;
     friend class PhysicsShape;
     friend class PhysicsJoint;
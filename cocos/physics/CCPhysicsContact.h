@@ -172,6 +172,7 @@ private:
     void* _contactInfo;
     
     friend class EventListenerPhysicsContact;
+    friend class PhysicsWorld;
 };
 
 /**
@@ -197,6 +198,28 @@ private:
     friend class EventListenerPhysicsContact;
 };
 
+/**
+ * @brief Contact recorded by PhysicsWorld when the contacts are delivered in batch.
+ *
+ * The shapes and bodies are retained until the batch callback returns. The bodies are the ones
+ * the shapes belonged to when the contact was recorded.
+ */
+struct CC_DLL PhysicsContactEvent
+{
+    PhysicsContact::EventCode eventCode;
+    PhysicsShape* shapeA;
+    PhysicsShape* shapeB;
+    PhysicsBody* bodyA;
+    PhysicsBody* bodyB;
+    /** Number of contact points, 0 for SEPARATE. */
+    int pointCount;
+    /** First contact point in world coordinates. */
+    Vec2 point;
+    Vec2 normal;
+    /** Impulse applied to resolve the contact, only set for POSTSOLVE. */
+    Vec2 impulse;
+};
+
 /** Contact listener. It will receive all the contact callbacks. */
 class CC_DLL EventListenerPhysicsContact : public EventListenerCustom
 {
@@ -26,6 +26,7 @@
 #if CC_USE_PHYSICS
 #include <algorithm>
 #include <climits>
+#include <functional>
 
 #include "chipmunk/chipmunk_private.h"
 #include "physics/CCPhysicsBody.h"
@@ -49,6 +50,9 @@ const int PhysicsWorld::DEBUGDRAW_SHAPE = 0x01;
 const int PhysicsWorld::DEBUGDRAW_JOINT = 0x02;
 const int PhysicsWorld::DEBUGDRAW_CONTACT = 0x04;
 const int PhysicsWorld::DEBUGDRAW_ALL = DEBUGDRAW_SHAPE | DEBUGDRAW_JOINT | DEBUGDRAW_CONTACT;
+const int PhysicsWorld::CONTACT_EVENT_BEGIN = 0x01;
+const int PhysicsWorld::CONTACT_EVENT_POSTSOLVE = 0x02;
+const int PhysicsWorld::CONTACT_EVENT_SEPARATE = 0x04;
 
 namespace
 {
@@ -347,6 +351,15 @@ bool PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
     
     if (contact.isNotificationEnabled())
     {
+        if (_contactBatchCallback)
+        {
+            if (_contactEventMask & CONTACT_EVENT_BEGIN)
+            {
+                recordContactEvent(contact, PhysicsContact::EventCode::BEGIN);
+            }
+            return ret;
+        }
+        
         contact.setEventCode(PhysicsContact::EventCode::BEGIN);
         contact.setWorld(this);
         _eventDispatcher->dispatchEvent(&contact);
@@ -362,6 +375,20 @@ bool PhysicsWorld::collisionPreSolveCallback(PhysicsContact& contact)
         return true;
     }
     
+    if (_contactPreSolveFunc)
+    {
+        PhysicsContactPreSolve solve(contact._contactInfo);
+        if (!_contactPreSolveFunc(contact, solve, _contactPreSolveData))
+        {
+            return false;
+        }
+    }
+    
+    if (_contactBatchCallback)
+    {
+        return true;
+    }
+    
     contact.setEventCode(PhysicsContact::EventCode::PRESOLVE);
     contact.setWorld(this);
     _eventDispatcher->dispatchEvent(&contact);
@@ -376,6 +403,15 @@ void PhysicsWorld::collisionPostSolveCallback(PhysicsContact& contact)
         return;
     }
     
+    if (_contactBatchCallback)
+    {
+        if (_contactEventMask & CONTACT_EVENT_POSTSOLVE)
+        {
+            recordContactEvent(contact, PhysicsContact::EventCode::POSTSOLVE);
+        }
+        return;
+    }
+    
     contact.setEventCode(PhysicsContact::EventCode::POSTSOLVE);
     contact.setWorld(this);
     _eventDispatcher->dispatchEvent(&contact);
@@ -388,11 +424,94 @@ void PhysicsWorld::collisionSeparateCallback(PhysicsContact& contact)
         return;
     }
     
+    if (_contactBatchCallback)
+    {
+        if (_contactEventMask & CONTACT_EVENT_SEPARATE)
+        {
+            recordContactEvent(contact, PhysicsContact::EventCode::SEPARATE);
+        }
+        return;
+    }
+    
     contact.setEventCode(PhysicsContact::EventCode::SEPARATE);
     contact.setWorld(this);
     _eventDispatcher->dispatchEvent(&contact);
 }
 
+void PhysicsWorld::recordContactEvent(PhysicsContact& contact, PhysicsContact::EventCode eventCode)
+{
+    PhysicsContactEvent event;
+    event.eventCode = eventCode;
+    event.shapeA = contact.getShapeA();
+    event.shapeB = contact.getShapeB();
+    event.bodyA = event.shapeA->getBody();
+    event.bodyB = event.shapeB->getBody();
+    event.pointCount = 0;
+    
+    // the shapes may be removed before the events are delivered
+    event.shapeA->retain();
+    event.shapeB->retain();
+    CC_SAFE_RETAIN(event.bodyA);
+    CC_SAFE_RETAIN(event.bodyB);
+    
+    auto arb = static_cast<cpArbiter*>(contact._contactInfo);
+    if (eventCode != PhysicsContact::EventCode::SEPARATE && arb != nullptr)
+    {
+        event.pointCount = cpArbiterGetCount(arb);
+        if (event.pointCount > 0)
+        {
+            event.point = PhysicsHelper::cpv2point(cpArbiterGetPointA(arb, 0));
+            event.normal = PhysicsHelper::cpv2point(cpArbiterGetNormal(arb));
+        }
+        
+        if (eventCode == PhysicsContact::EventCode::POSTSOLVE)
+        {
+            event.impulse = PhysicsHelper::cpv2point(cpArbiterTotalImpulse(arb));
+        }
+    }
+    
+    _contactEvents.push_back(event);
+}
+
+void PhysicsWorld::dispatchContactEvents()
+{
+    // the callback may record new contacts, by removing bodies for example
+    _deliveredContactEvents.swap(_contactEvents);
+    if (_contactBatchCallback)
+    {
+        _contactBatchCallback(*this, _deliveredContactEvents);
+    }
+    releaseContactEvents(_deliveredContactEvents);
+}
+
+void PhysicsWorld::releaseContactEvents(std::vector<PhysicsContactEvent>& events)
+{
+    for (auto& event : events)
+    {
+        event.shapeA->release();
+        event.shapeB->release();
+        CC_SAFE_RELEASE(event.bodyA);
+        CC_SAFE_RELEASE(event.bodyB);
+    }
+    events.clear();
+}
+
+void PhysicsWorld::setContactBatchCallback(const PhysicsContactBatchCallbackFunc& callback, int eventMask/* = CONTACT_EVENT_BEGIN | CONTACT_EVENT_SEPARATE*/)
+{
+    _contactBatchCallback = callback;
+    _contactEventMask = eventMask;
+    if (!_contactBatchCallback)
+    {
+        releaseContactEvents(_contactEvents);
+    }
+}
+
+void PhysicsWorld::setContactPreSolveFunc(PhysicsContactPreSolveFunc func, void* data/* = nullptr*/)
+{
+    _contactPreSolveFunc = func;
+    _contactPreSolveData = data;
+}
+
 void PhysicsWorld::rayCast(PhysicsRayCastCallbackFunc func, const Vec2& point1, const Vec2& point2, void* data)
 {
     CCASSERT(func != nullptr, "func shouldn't be nullptr");
@@ -526,6 +645,8 @@ void PhysicsWorld::addBody(PhysicsBody* body)
     addBodyOrDelay(body);
     _bodies.pushBack(body);
     body->_world = this;
+    body->_transformRecorded = false;
+    _bodyRegistryDirty = true;
 }
 
 void PhysicsWorld::doAddBody(PhysicsBody* body)
@@ -615,6 +736,7 @@ void PhysicsWorld::removeBody(PhysicsBody* body)
     removeBodyOrDelay(body);
     _bodies.eraseObject(body);
     body->_world = nullptr;
+    _bodyRegistryDirty = true;
 }
 
 void PhysicsWorld::removeBodyOrDelay(PhysicsBody* body)
@@ -807,6 +929,81 @@ void PhysicsWorld::removeAllBodies()
     }
     
     _bodies.clear();
+    _bodyRegistry.clear();
+    _bodyRegistryDirty = false;
+}
+
+void PhysicsWorld::setSolverThreads(int threads)
+{
+#if CC_TARGET_PLATFORM != CC_PLATFORM_WINRT && CC_TARGET_PLATFORM != CC_PLATFORM_WIN32
+    cpHastySpaceSetThreads(_cpSpace, threads > 0 ? threads : 0);
+#endif
+}
+
+int PhysicsWorld::getSolverThreads() const
+{
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+    return 1;
+#else
+    return (int)cpHastySpaceGetThreads(_cpSpace);
+#endif
+}
+
+void PhysicsWorld::setIterations(int iterations)
+{
+    if (iterations > 0)
+    {
+        cpSpaceSetIterations(_cpSpace, iterations);
+    }
+}
+
+int PhysicsWorld::getIterations() const
+{
+    return cpSpaceGetIterations(_cpSpace);
+}
+
+void PhysicsWorld::setCollisionSlop(float slop)
+{
+    cpSpaceSetCollisionSlop(_cpSpace, std::max(slop, 0.0f));
+}
+
+float PhysicsWorld::getCollisionSlop() const
+{
+    return cpSpaceGetCollisionSlop(_cpSpace);
+}
+
+void PhysicsWorld::useSpatialHash(float cellSize, int count)
+{
+    CCASSERT(cellSize > 0 && count > 0, "the cell size and count must be positive");
+    
+    if (cpSpaceIsLocked(_cpSpace))
+    {
+        CCLOG("Physics Warning: the broadphase can't be changed during a step");
+        return;
+    }
+    
+    cpSpaceUseSpatialHash(_cpSpace, cellSize, count);
+    _spatialHashCellSize = cellSize;
+}
+
+void PhysicsWorld::setSleepTimeThreshold(float threshold)
+{
+    cpSpaceSetSleepTimeThreshold(_cpSpace, threshold);
+}
+
+float PhysicsWorld::getSleepTimeThreshold() const
+{
+    return cpSpaceGetSleepTimeThreshold(_cpSpace);
+}
+
+void PhysicsWorld::setIdleSpeedThreshold(float threshold)
+{
+    cpSpaceSetIdleSpeedThreshold(_cpSpace, std::max(threshold, 0.0f));
+}
+
+float PhysicsWorld::getIdleSpeedThreshold() const
+{
+    return cpSpaceGetIdleSpeedThreshold(_cpSpace);
 }
 
 void PhysicsWorld::setDebugDrawMask(int mask)
@@ -879,8 +1076,13 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
         updateBodies();
     }
     
+    if (_bodyRegistryDirty)
+    {
+        updateBodyRegistry();
+    }
+    
     auto sceneToWorldTransform = _scene->getNodeToParentTransform();
-    beforeSimulation(_scene, sceneToWorldTransform, 1.f, 1.f, 0.f);
+    beforeSimulation(sceneToWorldTransform);
 
     if (!_delayAddJoints.empty() || !_delayRemoveJoints.empty())
     {
@@ -945,9 +1147,19 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
         debugDraw();
     }
 
-    // Update physics position, should loop as the same sequence as node tree.
-    // PhysicsWorld::afterSimulation() will depend on the sequence.
-    afterSimulation(_scene, sceneToWorldTransform, 0.f);
+    // contact callbacks may have added or removed bodies
+    if (_bodyRegistryDirty)
+    {
+        updateBodyRegistry();
+    }
+    
+    // Update physics position, parents are updated before their children.
+    afterSimulation(sceneToWorldTransform);
+    
+    if (!_contactEvents.empty())
+    {
+        dispatchContactEvents();
+    }
 }
 
 PhysicsWorld* PhysicsWorld::construct(Scene* scene)
@@ -972,6 +1184,7 @@ PhysicsWorld::PhysicsWorld()
 , _updateTime(0.0f)
 , _substeps(1)
 , _fixedRate(0)
+, _spatialHashCellSize(0.0f)
 , _cpSpace(nullptr)
 , _updateBodyTransform(false)
 , _scene(nullptr)
@@ -979,8 +1192,12 @@ PhysicsWorld::PhysicsWorld()
 , _debugDraw(nullptr)
 , _debugDrawMask(DEBUGDRAW_NONE)
 , _eventDispatcher(nullptr)
+, _contactEventMask(0)
+, _contactPreSolveFunc(nullptr)
+, _contactPreSolveData(nullptr)
+, _bodyRegistryDirty(false)
 {
-    
+    _parentTransform.parent = nullptr;
 }
 
 PhysicsWorld::~PhysicsWorld()
@@ -996,39 +1213,130 @@ PhysicsWorld::~PhysicsWorld()
 #endif 
     }
     CC_SAFE_RELEASE_NULL(_debugDraw);
+    releaseContactEvents(_contactEvents);
 }
 
-void PhysicsWorld::beforeSimulation(Node *node, const Mat4& parentToWorldTransform, float nodeParentScaleX, float nodeParentScaleY, float parentRotation)
+void PhysicsWorld::updateBodyRegistry()
 {
-    auto scaleX = nodeParentScaleX * node->getScaleX();
-    auto scaleY = nodeParentScaleY * node->getScaleY();
-    auto rotation = parentRotation + node->getRotation();
-
-    auto nodeToWorldTransform = parentToWorldTransform * node->getNodeToParentTransform();
-
-    auto physicsBody = node->getPhysicsBody();
-    if (physicsBody)
+    struct Entry
+    {
+        int depth;
+        Node* parent;
+        PhysicsBody* body;
+    };
+    std::vector<Entry> entries;
+    entries.reserve(_bodies.size());
+    
+    for (auto& body : _bodies)
+    {
+        auto node = body->getNode();
+        if (node == nullptr)
+        {
+            continue;
+        }
+        
+        int depth = 0;
+        for (auto parent = node; parent != _scene; parent = parent->getParent())
+        {
+            if (parent == nullptr)
+            {
+                depth = -1;
+                break;
+            }
+            ++depth;
+        }
+        
+        if (depth >= 0)
+        {
+            entries.push_back({depth, node->getParent(), body});
+        }
+    }
+    
+    // siblings are kept together so that they share the transform of their parent
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.depth < b.depth || (a.depth == b.depth && std::less<Node*>()(a.parent, b.parent));
+    });
+    
+    _bodyRegistry.clear();
+    for (auto& entry : entries)
     {
-        physicsBody->beforeSimulation(parentToWorldTransform, nodeToWorldTransform, scaleX, scaleY, rotation);
+        _bodyRegistry.push_back(entry.body);
     }
-
-    for (auto child : node->getChildren())
-        beforeSimulation(child, nodeToWorldTransform, scaleX, scaleY, rotation);
+    _bodyRegistryDirty = false;
 }
 
-void PhysicsWorld::afterSimulation(Node *node, const Mat4& parentToWorldTransform, float parentRotation)
+bool PhysicsWorld::updateParentTransform(Node* node, const Mat4& sceneToWorldTransform)
 {
-    auto nodeToWorldTransform = parentToWorldTransform * node->getNodeToParentTransform();
-    auto nodeRotation = parentRotation + node->getRotation();
+    auto parent = node == _scene ? nullptr : node->getParent();
+    if (parent == _parentTransform.parent && parent != nullptr)
+    {
+        return true;
+    }
+    
+    _ancestors.clear();
+    if (node != _scene)
+    {
+        for (auto ancestor = parent; ancestor != _scene; ancestor = ancestor->getParent())
+        {
+            if (ancestor == nullptr)
+            {
+                return false;
+            }
+            _ancestors.push_back(ancestor);
+        }
+        _ancestors.push_back(_scene);
+    }
+    
+    // same as walking the scene graph from the scene, whose transform is applied twice
+    auto& transform = _parentTransform;
+    transform.parent = parent;
+    transform.parentToWorld = sceneToWorldTransform;
+    transform.scaleX = 1.f;
+    transform.scaleY = 1.f;
+    transform.rotation = 0.f;
+    for (auto it = _ancestors.rbegin(); it != _ancestors.rend(); ++it)
+    {
+        auto ancestor = *it;
+        transform.parentToWorld = transform.parentToWorld * ancestor->getNodeToParentTransform();
+        transform.scaleX *= ancestor->getScaleX();
+        transform.scaleY *= ancestor->getScaleY();
+        transform.rotation += ancestor->getRotation();
+    }
+    
+    return true;
+}
 
-    auto physicsBody = node->getPhysicsBody();
-    if (physicsBody)
+void PhysicsWorld::beforeSimulation(const Mat4& sceneToWorldTransform)
+{
+    _parentTransform.parent = nullptr;
+    for (auto body : _bodyRegistry)
     {
-        physicsBody->afterSimulation(parentToWorldTransform, parentRotation);
+        auto node = body->getNode();
+        if (!updateParentTransform(node, sceneToWorldTransform))
+        {
+            continue;
+        }
+        
+        auto& parent = _parentTransform;
+        auto scaleX = parent.scaleX * node->getScaleX();
+        auto scaleY = parent.scaleY * node->getScaleY();
+        auto rotation = parent.rotation + node->getRotation();
+        auto nodeToWorldTransform = parent.parentToWorld * node->getNodeToParentTransform();
+        
+        body->beforeSimulation(parent.parentToWorld, nodeToWorldTransform, scaleX, scaleY, rotation);
     }
+}
 
-    for (auto child : node->getChildren())
-        afterSimulation(child, nodeToWorldTransform, nodeRotation);
+void PhysicsWorld::afterSimulation(const Mat4& sceneToWorldTransform)
+{
+    _parentTransform.parent = nullptr;
+    for (auto body : _bodyRegistry)
+    {
+        if (updateParentTransform(body->getNode(), sceneToWorldTransform))
+        {
+            body->afterSimulation(_parentTransform.parentToWorld, _parentTransform.rotation);
+        }
+    }
 }
 
 NS_CC_END
@@ -29,9 +29,11 @@
 #if CC_USE_PHYSICS
 
 #include <list>
+#include <vector>
 #include "base/CCVector.h"
 #include "math/CCGeometry.h"
 #include "physics/CCPhysicsBody.h"
+#include "physics/CCPhysicsContact.h"
 
 struct cpSpace;
 
@@ -83,6 +85,9 @@ typedef struct PhysicsRayCastInfo
 typedef std::function<bool(PhysicsWorld& world, const PhysicsRayCastInfo& info, void* data)> PhysicsRayCastCallbackFunc;
 typedef std::function<bool(PhysicsWorld&, PhysicsShape&, void*)> PhysicsQueryRectCallbackFunc;
 typedef PhysicsQueryRectCallbackFunc PhysicsQueryPointCallbackFunc;
+typedef std::function<void(PhysicsWorld& world, const std::vector<PhysicsContactEvent>& events)> PhysicsContactBatchCallbackFunc;
+/** Return false to ignore the contact in this step. */
+typedef bool (*PhysicsContactPreSolveFunc)(PhysicsContact& contact, PhysicsContactPreSolve& solve, void* data);
 
 /**
  * @addtogroup physics
@@ -104,6 +109,10 @@ public:
     static const int DEBUGDRAW_CONTACT;     ///< draw contact
     static const int DEBUGDRAW_ALL;         ///< draw all
     
+    static const int CONTACT_EVENT_BEGIN;       ///< record the contacts that begin
+    static const int CONTACT_EVENT_POSTSOLVE;   ///< record the contacts solved in each step
+    static const int CONTACT_EVENT_SEPARATE;    ///< record the contacts that end
+    
 public:
     /**
     * Adds a joint to this physics world.
@@ -301,6 +310,95 @@ public:
     /** get the number of substeps */
     inline int getFixedUpdateRate() const { return _fixedRate; }
 
+    /**
+     * Set the number of threads solving the simulation.
+     *
+     * The solver runs on several threads on the platforms where the world is stepped by cpHastySpace,
+     * every platform except Windows. Chipmunk uses at most 2 threads, and it only benefits scenes
+     * with many contacts or joints.
+     * @param threads 0 to use one thread per processor, default value is 0.
+     */
+    void setSolverThreads(int threads);
+
+    /** Get the number of threads solving the simulation, always 1 on Windows. */
+    int getSolverThreads() const;
+
+    /**
+     * Set the number of iterations of the solver.
+     *
+     * Fewer iterations are faster but stacks of bodies become softer.
+     * @param iterations An integer number, default value is 10.
+     */
+    void setIterations(int iterations);
+
+    /** Get the number of iterations of the solver. */
+    int getIterations() const;
+
+    /**
+     * Set the overlap allowed between shapes.
+     *
+     * A small overlap keeps the contacts persistent, which reduces jittering.
+     * @param slop A float number, default value is 0.1.
+     */
+    void setCollisionSlop(float slop);
+
+    /** Get the overlap allowed between shapes. */
+    float getCollisionSlop() const;
+
+    /**
+     * Use a spatial hash to find the shapes that may collide instead of the default bounding box tree.
+     *
+     * The spatial hash is faster when there are many shapes of similar size. The bounding box tree can't be restored.
+     * @param cellSize The size of a cell, it should match the size of the shapes.
+     * @param count The minimal number of cells in the hash table, about 10 times the number of shapes.
+     */
+    void useSpatialHash(float cellSize, int count);
+
+    /** Get the size of a cell of the spatial hash, 0 if the bounding box tree is used. */
+    inline float getSpatialHashCellSize() const { return _spatialHashCellSize; }
+
+    /**
+     * Set the time a group of bodies must stay idle before it falls asleep.
+     *
+     * Sleeping bodies aren't simulated until something touches them.
+     * @param threshold Seconds, default value is PHYSICS_INFINITY which disables sleeping.
+     */
+    void setSleepTimeThreshold(float threshold);
+
+    /** Get the time a group of bodies must stay idle before it falls asleep. */
+    float getSleepTimeThreshold() const;
+
+    /**
+     * Set the speed under which a body is considered idle.
+     *
+     * @param threshold A float number, default value is 0 which estimates it from the gravity.
+     */
+    void setIdleSpeedThreshold(float threshold);
+
+    /** Get the speed under which a body is considered idle. */
+    float getIdleSpeedThreshold() const;
+
+    /**
+     * Deliver the contacts in batch after each step instead of dispatching an event for each of them.
+     *
+     * The contacts that pass the bitmask test of their shapes are recorded in a buffer during the step,
+     * callback receives them once the nodes were updated. The EventListenerPhysicsContact listeners aren't
+     * called while a batch callback is set.
+     * @param callback The function receiving the contacts, nullptr to dispatch events again.
+     * @param eventMask CONTACT_EVENT_BEGIN, CONTACT_EVENT_POSTSOLVE and CONTACT_EVENT_SEPARATE combined, default is begin and separate.
+     */
+    void setContactBatchCallback(const PhysicsContactBatchCallbackFunc& callback, int eventMask = CONTACT_EVENT_BEGIN | CONTACT_EVENT_SEPARATE);
+    
+    /**
+     * Set a function called during the step before each contact is solved.
+     *
+     * It is called before the EventListenerPhysicsContact listeners, and is much cheaper than them
+     * since no event is dispatched. The contact data isn't generated for it.
+     * @param func The function, nullptr to remove it.
+     * @param data User defined data, it is passed to func.
+     */
+    void setContactPreSolveFunc(PhysicsContactPreSolveFunc func, void* data = nullptr);
+    
     /**
     * Set the debug draw mask of this physics world.
     * 
@@ -375,6 +473,7 @@ protected:
     float _updateTime;
     int _substeps;
     int _fixedRate;
+    float _spatialHashCellSize;
     cpSpace* _cpSpace;
     
     bool _updateBodyTransform;
@@ -388,17 +487,46 @@ protected:
     
     EventDispatcher* _eventDispatcher;
 
+    PhysicsContactBatchCallbackFunc _contactBatchCallback;
+    int _contactEventMask;
+    std::vector<PhysicsContactEvent> _contactEvents;
+    std::vector<PhysicsContactEvent> _deliveredContactEvents;
+    PhysicsContactPreSolveFunc _contactPreSolveFunc;
+    void* _contactPreSolveData;
+    
     Vector<PhysicsBody*> _delayAddBodies;
     Vector<PhysicsBody*> _delayRemoveBodies;
     std::vector<PhysicsJoint*> _delayAddJoints;
     std::vector<PhysicsJoint*> _delayRemoveJoints;
     
+    // bodies whose node is in the scene, sorted by depth so that a parent is synchronized before its children
+    std::vector<PhysicsBody*> _bodyRegistry;
+    bool _bodyRegistryDirty;
+    
+    // transform of the last parent computed, siblings are next to each other in the registry
+    struct ParentTransform
+    {
+        Node* parent;
+        Mat4 parentToWorld;
+        float scaleX;
+        float scaleY;
+        float rotation;
+    };
+    ParentTransform _parentTransform;
+    std::vector<Node*> _ancestors;
+    
 protected:
     PhysicsWorld();
     virtual ~PhysicsWorld();
     
-    void beforeSimulation(Node *node, const Mat4& parentToWorldTransform, float nodeParentScaleX, float nodeParentScaleY, float parentRotation);
-    void afterSimulation(Node* node, const Mat4& parentToWorldTransform, float parentRotation);
+    void recordContactEvent(PhysicsContact& contact, PhysicsContact::EventCode eventCode);
+    void dispatchContactEvents();
+    void releaseContactEvents(std::vector<PhysicsContactEvent>& events);
+    void updateBodyRegistry();
+    // compute the transform of the parent of node, return false if node isn't in the scene
+    bool updateParentTransform(Node* node, const Mat4& sceneToWorldTransform);
+    void beforeSimulation(const Mat4& sceneToWorldTransform);
+    void afterSimulation(const Mat4& sceneToWorldTransform);
 
     friend class Node;
     friend class Sprite;
@@ -68,11 +68,13 @@ void Physics3DComponent::setPhysics3DObject(Physics3DObject* physicsObj)
     CC_SAFE_RETAIN(physicsObj);
     CC_SAFE_RELEASE(_physics3DObj);
     _physics3DObj = physicsObj;
+    _syncedAsleep = false;
 }
 
 Physics3DComponent::Physics3DComponent()
 : _physics3DObj(nullptr)
 , _syncFlag(Physics3DComponent::PhysicsSyncFlag::NODE_AND_NODE)
+, _syncedAsleep(false)
 {
     
 }
@@ -120,6 +122,7 @@ void Physics3DComponent::onEnter()
 {
     Component::onEnter();
     
+    _syncedAsleep = false;
     if (_physics3DObj->getPhysicsWorld() == nullptr && _owner)
     {
         auto scene = _owner->getScene();
@@ -155,7 +158,19 @@ void Physics3DComponent::postSimulate()
 {
     if (((int)_syncFlag & (int)Physics3DComponent::PhysicsSyncFlag::PHYSICS_TO_NODE) && _physics3DObj && _owner)
     {
-        syncPhysicsToNode();
+        // a sleeping object doesn't move, the node is synchronized once when it falls asleep
+        const btCollisionObject* object = nullptr;
+        if (_physics3DObj->getObjType() == Physics3DObject::PhysicsObjType::RIGID_BODY)
+            object = static_cast<Physics3DRigidBody*>(_physics3DObj)->getRigidBody();
+        else if (_physics3DObj->getObjType() == Physics3DObject::PhysicsObjType::COLLIDER)
+            object = static_cast<Physics3DCollider*>(_physics3DObj)->getGhostObject();
+        
+        bool asleep = object && !object->isActive();
+        if (!asleep || !_syncedAsleep)
+        {
+            syncPhysicsToNode();
+        }
+        _syncedAsleep = asleep;
     }
 }
 
@@ -167,6 +182,7 @@ void Physics3DComponent::setTransformInPhysics(const cocos2d::Vec3& translateInP
     _transformInPhysics.m[14] = translateInPhysics.z;
     
     _invTransformInPhysics = _transformInPhysics.getInversed();
+    _syncedAsleep = false;
 }
 
 void Physics3DComponent::setSyncFlag(PhysicsSyncFlag syncFlag)
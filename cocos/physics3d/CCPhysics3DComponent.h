@@ -105,7 +105,8 @@ public:
     void setTransformInPhysics(const cocos2d::Vec3& translateInPhysics, const cocos2d::Quaternion& rotInPhsyics);
     
     /**
-     * synchronization between node and physics is time consuming, you can skip some synchronization using this function
+     * synchronization between node and physics is time consuming, you can skip some synchronization using this function.
+     * the node of a sleeping object isn't synchronized with physics after the object fell asleep
      */
     void setSyncFlag(PhysicsSyncFlag syncFlag);
     
@@ -132,6 +133,7 @@ protected:
     
     Physics3DObject*          _physics3DObj;
     PhysicsSyncFlag           _syncFlag;
+    bool                      _syncedAsleep; //the node was synchronized with the object asleep
 };
 
 // end of 3d group
@@ -24,6 +24,7 @@
 
 #include "physics3d/CCPhysics3D.h"
 #include "renderer/CCRenderer.h"
+#include "base/CCWorkerPool.h"
 
 #if CC_USE_3D_PHYSICS
 
@@ -42,6 +43,9 @@ Physics3DWorld::Physics3DWorld()
 , _needCollisionChecking(false)
 , _collisionCheckingFlag(false)
 , _needGhostPairCallbackChecking(false)
+, _collisionReportEnabled(false)
+, _maxSubSteps(3)
+, _fixedTimeStep(1.f / 60.f)
 {
     
 }
@@ -86,20 +90,29 @@ bool Physics3DWorld::init(Physics3DWorldDes* info)
     _collisionConfiguration = new (std::nothrow) btDefaultCollisionConfiguration();
     //_collisionConfiguration->setConvexConvexMultipointIterations();
     
-    ///use the default collision dispatcher. For parallel processing you can use a different dispatcher (see Extras/BulletMultiThreaded)
-    _dispatcher = new (std::nothrow) btCollisionDispatcher(_collisionConfiguration);
+    ///use the default collision dispatcher unless the description creates one, for example a parallel one (see Extras/BulletMultiThreaded)
+    if (info->createDispatcher)
+        _dispatcher = info->createDispatcher(_collisionConfiguration);
+    else
+        _dispatcher = new (std::nothrow) btCollisionDispatcher(_collisionConfiguration);
     
     _broadphase = new (std::nothrow) btDbvtBroadphase();
     
-    ///the default constraint solver. For parallel processing you can use a different solver (see Extras/BulletMultiThreaded)
-    btSequentialImpulseConstraintSolver* sol = new btSequentialImpulseConstraintSolver();
-    _solver = sol;
+    ///the default constraint solver unless the description creates one, for example a parallel one (see Extras/BulletMultiThreaded)
+    if (info->createSolver)
+        _solver = info->createSolver();
+    else
+        _solver = new btSequentialImpulseConstraintSolver();
 
     btGhostPairCallback *ghostCallback = new btGhostPairCallback();
     _ghostCallback = ghostCallback;
     
     _btPhyiscsWorld = new btDiscreteDynamicsWorld(_dispatcher,_broadphase,_solver,_collisionConfiguration);
     _btPhyiscsWorld->setGravity(convertVec3TobtVector3(info->gravity));
+    _btPhyiscsWorld->getSolverInfo().m_numIterations = info->solverIterations;
+    _maxSubSteps = info->maxSubSteps;
+    _fixedTimeStep = info->fixedTimeStep;
+    _collisionReportEnabled = info->isCollisionReportEnabled;
     if (info->isDebugDrawEnabled)
     {
         _debugDrawer = new (std::nothrow) Physics3DDebugDrawer();
@@ -235,7 +248,7 @@ void Physics3DWorld::stepSimulate(float dt)
         {
             it->preSimulate();
         }
-        _btPhyiscsWorld->stepSimulation(dt, 3);
+        _btPhyiscsWorld->stepSimulation(dt, _maxSubSteps, _fixedTimeStep);
         //sync dynamic node after simulation
         for (auto it : _physicsComponents)
         {
@@ -243,6 +256,11 @@ void Physics3DWorld::stepSimulate(float dt)
         }
         if (needCollisionChecking())
             collisionChecking();
+        else if (!_collisionReport.pairs.empty())
+        {
+            _collisionReport.pairs.clear();
+            _collisionReport.points.clear();
+        }
     }
 }
 
@@ -291,26 +309,162 @@ bool Physics3DWorld::sweepShape(Physics3DShape* shape, const cocos2d::Mat4& star
     return false;
 }
 
-Physics3DObject* Physics3DWorld::getPhysicsObject(const btCollisionObject* btObj)
-{
-    for(auto it : _objects)
+namespace {
+    
+    //the batched queries walk the trees of the broadphase themselves,
+    //btDbvtBroadphase::rayTest uses a stack shared by all the queries
+    
+    const int QUERY_GRAIN_SIZE = 64;
+    
+    struct RayQueryCollide : public btDbvt::ICollide
     {
-        if (it->getObjType() == Physics3DObject::PhysicsObjType::RIGID_BODY)
+        RayQueryCollide(const btVector3& from, const btVector3& to, btCollisionWorld::RayResultCallback& result)
+        : resultCallback(result)
         {
-            if (static_cast<Physics3DRigidBody*>(it)->getRigidBody() == btObj)
-                return it;
+            rayFromTrans.setIdentity();
+            rayFromTrans.setOrigin(from);
+            rayToTrans.setIdentity();
+            rayToTrans.setOrigin(to);
         }
-        else if (it->getObjType() == Physics3DObject::PhysicsObjType::COLLIDER)
+        
+        virtual void Process(const btDbvtNode* leaf) override
+        {
+            if (resultCallback.m_closestHitFraction == btScalar(0.f))
+                return;
+            auto object = static_cast<btCollisionObject*>(static_cast<btBroadphaseProxy*>(leaf->data)->m_clientObject);
+            if (resultCallback.needsCollision(object->getBroadphaseHandle()))
+                btCollisionWorld::rayTestSingle(rayFromTrans, rayToTrans, object, object->getCollisionShape(), object->getWorldTransform(), resultCallback);
+        }
+        
+        btTransform rayFromTrans;
+        btTransform rayToTrans;
+        btCollisionWorld::RayResultCallback& resultCallback;
+    };
+    
+    struct SweepQueryCollide : public btDbvt::ICollide
+    {
+        SweepQueryCollide(const btConvexShape* shape, const btTransform& from, const btTransform& to, btCollisionWorld::ConvexResultCallback& result)
+        : castShape(shape)
+        , convexFromTrans(from)
+        , convexToTrans(to)
+        , resultCallback(result)
+        {
+        }
+        
+        virtual void Process(const btDbvtNode* leaf) override
+        {
+            if (resultCallback.m_closestHitFraction == btScalar(0.f))
+                return;
+            auto object = static_cast<btCollisionObject*>(static_cast<btBroadphaseProxy*>(leaf->data)->m_clientObject);
+            if (resultCallback.needsCollision(object->getBroadphaseHandle()))
+                btCollisionWorld::objectQuerySingle(castShape, convexFromTrans, convexToTrans, object, object->getCollisionShape(), object->getWorldTransform(), resultCallback, btScalar(0.f));
+        }
+        
+        const btConvexShape* castShape;
+        btTransform convexFromTrans;
+        btTransform convexToTrans;
+        btCollisionWorld::ConvexResultCallback& resultCallback;
+    };
+}
+
+int Physics3DWorld::rayCastBatch(const RayQuery* rays, int count, HitResult* results)
+{
+    std::atomic<int> hitCount(0);
+    WorkerPool::getInstance()->parallelFor(count, QUERY_GRAIN_SIZE, [&](int begin, int end){
+        int hits = 0;
+        for (int i = begin; i < end; ++i)
         {
-            if (static_cast<Physics3DCollider*>(it)->getGhostObject() == btObj)
-                return it;
+            auto btStart = convertVec3TobtVector3(rays[i].startPos);
+            auto btEnd = convertVec3TobtVector3(rays[i].endPos);
+            btCollisionWorld::ClosestRayResultCallback btResult(btStart, btEnd);
+            RayQueryCollide collide(btStart, btEnd, btResult);
+            //the dynamic and the static trees
+            btDbvt::rayTest(_broadphase->m_sets[0].m_root, btStart, btEnd, collide);
+            btDbvt::rayTest(_broadphase->m_sets[1].m_root, btStart, btEnd, collide);
+            
+            auto& result = results[i];
+            if (btResult.hasHit())
+            {
+                result.hitObj = getPhysicsObject(btResult.m_collisionObject);
+                result.hitPosition = convertbtVector3ToVec3(btResult.m_hitPointWorld);
+                result.hitNormal = convertbtVector3ToVec3(btResult.m_hitNormalWorld);
+                ++hits;
+            }
+            else
+            {
+                result.hitObj = nullptr;
+            }
         }
+        hitCount += hits;
+    });
+    return hitCount;
+}
+
+int Physics3DWorld::sweepShapeBatch(Physics3DShape* shape, const SweepQuery* sweeps, int count, HitResult* results)
+{
+    CC_ASSERT(shape->getShapeType() != Physics3DShape::ShapeType::HEIGHT_FIELD && shape->getShapeType() != Physics3DShape::ShapeType::MESH);
+    auto castShape = static_cast<btConvexShape*>(shape->getbtShape());
+    std::atomic<int> hitCount(0);
+    WorkerPool::getInstance()->parallelFor(count, QUERY_GRAIN_SIZE, [&](int begin, int end){
+        int hits = 0;
+        for (int i = begin; i < end; ++i)
+        {
+            auto btStart = convertMat4TobtTransform(sweeps[i].startTransform);
+            auto btEnd = convertMat4TobtTransform(sweeps[i].endTransform);
+            btCollisionWorld::ClosestConvexResultCallback btResult(btStart.getOrigin(), btEnd.getOrigin());
+            SweepQueryCollide collide(castShape, btStart, btEnd, btResult);
+            
+            //the objects overlapping the box containing the shape at both ends
+            btVector3 minStart, maxStart, minEnd, maxEnd;
+            castShape->getAabb(btStart, minStart, maxStart);
+            castShape->getAabb(btEnd, minEnd, maxEnd);
+            minStart.setMin(minEnd);
+            maxStart.setMax(maxEnd);
+            auto volume = btDbvtVolume::FromMM(minStart, maxStart);
+            _broadphase->m_sets[0].collideTV(_broadphase->m_sets[0].m_root, volume, collide);
+            _broadphase->m_sets[1].collideTV(_broadphase->m_sets[1].m_root, volume, collide);
+            
+            auto& result = results[i];
+            if (btResult.hasHit())
+            {
+                result.hitObj = getPhysicsObject(btResult.m_hitCollisionObject);
+                result.hitPosition = convertbtVector3ToVec3(btResult.m_hitPointWorld);
+                result.hitNormal = convertbtVector3ToVec3(btResult.m_hitNormalWorld);
+                ++hits;
+            }
+            else
+            {
+                result.hitObj = nullptr;
+            }
+        }
+        hitCount += hits;
+    });
+    return hitCount;
+}
+
+Physics3DObject* Physics3DWorld::getPhysicsObject(const btCollisionObject* btObj)
+{
+    //the objects of cocos set themselves as user pointer of their bullet object
+    return btObj ? static_cast<Physics3DObject*>(btObj->getUserPointer()) : nullptr;
+}
+
+void Physics3DWorld::setCollisionReportEnabled(bool enabled)
+{
+    _collisionReportEnabled = enabled;
+    _collisionCheckingFlag = true;
+    if (!enabled)
+    {
+        _collisionReport.pairs.clear();
+        _collisionReport.points.clear();
     }
-    return nullptr;
 }
 
 void Physics3DWorld::collisionChecking()
 {
+    auto& points = _collisionReport.points;
+    _collisionReport.pairs.clear();
+    points.clear();
+    
     int numManifolds = _dispatcher->getNumManifolds();
     for (int i = 0; i < numManifolds; ++i){
         btPersistentManifold * contactManifold = _dispatcher->getManifoldByIndexInternal(i);
@@ -320,33 +474,50 @@ void Physics3DWorld::collisionChecking()
             const btCollisionObject* obB = static_cast<const btCollisionObject*>(contactManifold->getBody1());
             Physics3DObject *poA = getPhysicsObject(obA);
             Physics3DObject *poB = getPhysicsObject(obB);
-            if (poA->needCollisionCallback() || poB->needCollisionCallback()){
-                Physics3DCollisionInfo ci;
-                ci.objA = poA;
-                ci.objB = poB;
-                for (int c = 0; c < numContacts; ++c){
-                    btManifoldPoint& pt = contactManifold->getContactPoint(c);
-                    Physics3DCollisionInfo::CollisionPoint cp = {
-                          convertbtVector3ToVec3(pt.m_localPointA), convertbtVector3ToVec3(pt.m_positionWorldOnA)
-                        , convertbtVector3ToVec3(pt.m_localPointB), convertbtVector3ToVec3(pt.m_positionWorldOnB)
-                        , convertbtVector3ToVec3(pt.m_normalWorldOnB)
-                    };
-                    ci.collisionPointList.push_back(cp);
-                }
-
+            bool needCallback = poA->needCollisionCallback() || poB->needCollisionCallback();
+            if (!needCallback && !_collisionReportEnabled)
+                continue;
+            
+            int firstPoint = (int)points.size();
+            for (int c = 0; c < numContacts; ++c){
+                btManifoldPoint& pt = contactManifold->getContactPoint(c);
+                Physics3DCollisionInfo::CollisionPoint cp = {
+                      convertbtVector3ToVec3(pt.m_localPointA), convertbtVector3ToVec3(pt.m_positionWorldOnA)
+                    , convertbtVector3ToVec3(pt.m_localPointB), convertbtVector3ToVec3(pt.m_positionWorldOnB)
+                    , convertbtVector3ToVec3(pt.m_normalWorldOnB)
+                };
+                points.push_back(cp);
+            }
+            
+            if (_collisionReportEnabled){
+                Physics3DCollisionReport::ContactPair pair = { poA, poB, firstPoint, numContacts };
+                _collisionReport.pairs.push_back(pair);
+            }
+            
+            if (needCallback){
+                _collisionInfo.objA = poA;
+                _collisionInfo.objB = poB;
+                _collisionInfo.collisionPointList.assign(points.begin() + firstPoint, points.end());
+                
                 if (poA->needCollisionCallback()){
-                    poA->getCollisionCallback()(ci);
+                    poA->getCollisionCallback()(_collisionInfo);
                 }
                 if (poB->needCollisionCallback()){
-                    poB->getCollisionCallback()(ci);
+                    poB->getCollisionCallback()(_collisionInfo);
                 }
             }
+            
+            if (!_collisionReportEnabled)
+                points.resize(firstPoint);
         }
     }
 }
 
 bool Physics3DWorld::needCollisionChecking()
 {
+    if (_collisionReportEnabled)
+        return true;
+    
     if (_collisionCheckingFlag){
         _needCollisionChecking = false;
         for(auto it : _objects)
@@ -28,16 +28,20 @@
 #include "math/CCMath.h"
 #include "base/CCRef.h"
 #include "base/ccConfig.h"
+#include "physics3d/CCPhysics3DObject.h"
+
+#include <functional>
 
 #if CC_USE_3D_PHYSICS
 
 #if (CC_ENABLE_BULLET_INTEGRATION)
 
 class btDynamicsWorld;
+class btCollisionConfiguration;
 class btDefaultCollisionConfiguration;
 class btCollisionDispatcher;
 class btDbvtBroadphase;
-class btSequentialImpulseConstraintSolver;
+class btConstraintSolver;
 class btGhostPairCallback;
 class btRigidBody;
 class btCollisionObject;
@@ -62,13 +66,44 @@ struct CC_DLL Physics3DWorldDes
 {
     bool           isDebugDrawEnabled; //using physics debug draw?, false by default
     cocos2d::Vec3  gravity;//gravity, (0, -9.8, 0)
+    int            maxSubSteps; //maximum number of fixed steps simulated by stepSimulate, 3 by default
+    float          fixedTimeStep; //duration of a fixed step, 1/60 s by default
+    int            solverIterations; //iterations of the constraint solver, 10 by default
+    bool           isCollisionReportEnabled; //fill the collision report after each step?, false by default
+    
+    //create the collision dispatcher and the constraint solver, for example the parallel ones of a multithreaded bullet build,
+    //the single threaded ones are used if they aren't set. The world deletes the objects created
+    std::function<btCollisionDispatcher*(btCollisionConfiguration* configuration)> createDispatcher;
+    std::function<btConstraintSolver*()> createSolver;
+    
     Physics3DWorldDes()
     {
         isDebugDrawEnabled = false;
         gravity = cocos2d::Vec3(0.f, -9.8f, 0.f);
+        maxSubSteps = 3;
+        fixedTimeStep = 1.f / 60.f;
+        solverIterations = 10;
+        isCollisionReportEnabled = false;
     }
 };
 
+/**
+ * @brief The contacts found by a step, the arrays are reused from one step to the next.
+ */
+struct CC_DLL Physics3DCollisionReport
+{
+    struct ContactPair
+    {
+        Physics3DObject* objA;
+        Physics3DObject* objB;
+        int firstPoint; //index of the first point of the pair in points
+        int pointCount;
+    };
+    
+    std::vector<ContactPair> pairs;
+    std::vector<Physics3DCollisionInfo::CollisionPoint> points;
+};
+
 /**
  * @brief The physics information container, include Physics3DObjects, Physics3DConstraints, collision information and so on.
  */
@@ -84,6 +119,18 @@ public:
         Physics3DObject* hitObj;
     };
     
+    struct RayQuery
+    {
+        cocos2d::Vec3 startPos;
+        cocos2d::Vec3 endPos;
+    };
+    
+    struct SweepQuery
+    {
+        cocos2d::Mat4 startTransform;
+        cocos2d::Mat4 endTransform;
+    };
+    
     /**
      * Creates a Physics3DWorld with Physics3DWorldDes. 
      *
@@ -127,6 +174,18 @@ public:
     /** Internal method, the updater of debug drawing, need called each frame. */
     void debugDraw(cocos2d::Renderer* renderer);
     
+    /**
+     * Fill the collision report after each step with the contacts of all the objects, so they can be read at once instead of
+     * setting a collision callback on each object. The callbacks set on objects are still called.
+     */
+    void setCollisionReportEnabled(bool enabled);
+    
+    /** Check the collision report is filled. */
+    bool isCollisionReportEnabled() const { return _collisionReportEnabled; }
+    
+    /** Get the contacts found by the last step, it is empty if the report isn't enabled. */
+    const Physics3DCollisionReport& getCollisionReport() const { return _collisionReport; }
+    
     /** Get the list of Physics3DObjects. */
     const std::vector<Physics3DObject*>& getPhysicsObjects() const { return _objects; }
     
@@ -141,6 +200,19 @@ public:
     /** Performs a swept shape cast on all objects in the Physics3DWorld. */
     bool sweepShape(Physics3DShape* shape, const cocos2d::Mat4& startTransform, const cocos2d::Mat4& endTransform, HitResult* result);
     
+    /**
+     * Performs count ray casts at once, split between the threads of WorkerPool.
+     *
+     * @param rays the rays to cast.
+     * @param count the number of rays.
+     * @param results the closest hit of each ray, hitObj is nullptr if the ray doesn't hit anything.
+     * @return the number of rays hitting an object.
+     */
+    int rayCastBatch(const RayQuery* rays, int count, HitResult* results);
+    
+    /** Performs count swept shape casts of the same shape at once, split between the threads of WorkerPool. */
+    int sweepShapeBatch(Physics3DShape* shape, const SweepQuery* sweeps, int count, HitResult* results);
+    
 CC_CONSTRUCTOR_ACCESS:
     
     Physics3DWorld();
@@ -160,13 +232,18 @@ protected:
     bool _needCollisionChecking;
     bool _collisionCheckingFlag;
     bool _needGhostPairCallbackChecking;
+    bool _collisionReportEnabled;
+    int _maxSubSteps;
+    float _fixedTimeStep;
+    Physics3DCollisionReport _collisionReport;
+    Physics3DCollisionInfo _collisionInfo; //reused for the collision callbacks
     
 #if (CC_ENABLE_BULLET_INTEGRATION)
     btDynamicsWorld* _btPhyiscsWorld;
     btDefaultCollisionConfiguration* _collisionConfiguration;
     btCollisionDispatcher* _dispatcher;
     btDbvtBroadphase* _broadphase;
-    btSequentialImpulseConstraintSolver* _solver;
+    btConstraintSolver* _solver;
     btGhostPairCallback *_ghostCallback;
     Physics3DDebugDrawer*                _debugDrawer;
 #endif // CC_ENABLE_BULLET_INTEGRATION
@@ -32,6 +32,7 @@
 #include <sstream>
 #include "base/CCDirector.h"
 #include "scripting/js-bindings/manual/cocos2d_specifics.hpp"
+#include "network/HttpCache.h"
 
 using namespace std;
 
@@ -1033,6 +1034,75 @@ void MinXmlHttpRequest::_notify(JS::HandleObject callback)
  *  @param cx   Global Spidermonkey JS Context.
  *  @param global   Global Spidermonkey Javascript object.
  */
+// HttpCache.setEnabled(true), the cache used by XMLHttpRequest
+
+static bool js_HttpCache_setEnabled(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    JSB_PRECONDITION2(argc == 1, cx, false, "Invalid number of arguments");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    cocos2d::network::HttpCache::getInstance()->setEnabled(JS::ToBoolean(args.get(0)));
+    args.rval().setUndefined();
+    return true;
+}
+
+static bool js_HttpCache_isEnabled(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    args.rval().set(BOOLEAN_TO_JSVAL(cocos2d::network::HttpCache::getInstance()->isEnabled()));
+    return true;
+}
+
+static bool js_HttpCache_setCachePath(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    JSB_PRECONDITION2(argc == 1, cx, false, "Invalid number of arguments");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    std::string path;
+    bool ok = jsval_to_std_string(cx, args.get(0), &path);
+    JSB_PRECONDITION2(ok, cx, false, "Error processing arguments");
+    cocos2d::network::HttpCache::getInstance()->setCachePath(path);
+    args.rval().setUndefined();
+    return true;
+}
+
+static bool js_HttpCache_getCachePath(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    args.rval().set(std_string_to_jsval(cx, cocos2d::network::HttpCache::getInstance()->getCachePath()));
+    return true;
+}
+
+static bool js_HttpCache_setMaxMemorySize(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    JSB_PRECONDITION2(argc == 1, cx, false, "Invalid number of arguments");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    uint32_t size = 0;
+    bool ok = jsval_to_uint32(cx, args.get(0), &size);
+    JSB_PRECONDITION2(ok, cx, false, "Error processing arguments");
+    cocos2d::network::HttpCache::getInstance()->setMaxMemorySize(size);
+    args.rval().setUndefined();
+    return true;
+}
+
+static bool js_HttpCache_setMaxDiskSize(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    JSB_PRECONDITION2(argc == 1, cx, false, "Invalid number of arguments");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    uint32_t size = 0;
+    bool ok = jsval_to_uint32(cx, args.get(0), &size);
+    JSB_PRECONDITION2(ok, cx, false, "Error processing arguments");
+    cocos2d::network::HttpCache::getInstance()->setMaxDiskSize(size);
+    args.rval().setUndefined();
+    return true;
+}
+
+static bool js_HttpCache_clear(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    cocos2d::network::HttpCache::getInstance()->clear();
+    args.rval().setUndefined();
+    return true;
+}
+
 void MinXmlHttpRequest::_js_register(JSContext *cx, JS::HandleObject global)
 {
     JSClass jsclass = {
@@ -1079,4 +1149,17 @@ void MinXmlHttpRequest::_js_register(JSContext *cx, JS::HandleObject global)
     MinXmlHttpRequest::js_parent = nullptr;
     MinXmlHttpRequest::js_proto = JS_InitClass(cx, global, JS::NullPtr(), &MinXmlHttpRequest::js_class , MinXmlHttpRequest::_js_constructor, 0, props, funcs, nullptr, nullptr);
 
+    JS::RootedObject proto(cx);
+    JS::RootedObject parent(cx);
+    JS::RootedObject httpCache(cx, JS_NewObject(cx, nullptr, proto, parent));
+    JS::RootedValue httpCacheVal(cx, OBJECT_TO_JSVAL(httpCache));
+    JS_SetProperty(cx, global, "HttpCache", httpCacheVal);
+    JS_DefineFunction(cx, httpCache, "setEnabled", js_HttpCache_setEnabled, 1, JSPROP_READONLY | JSPROP_PERMANENT | JSPROP_ENUMERATE);
+    JS_DefineFunction(cx, httpCache, "isEnabled", js_HttpCache_isEnabled, 0, JSPROP_READONLY | JSPROP_PERMANENT | JSPROP_ENUMERATE);
+    JS_DefineFunction(cx, httpCache, "setCachePath", js_HttpCache_setCachePath, 1, JSPROP_READONLY | JSPROP_PERMANENT | JSPROP_ENUMERATE);
+    JS_DefineFunction(cx, httpCache, "getCachePath", js_HttpCache_getCachePath, 0, JSPROP_READONLY | JSPROP_PERMANENT | JSPROP_ENUMERATE);
+    JS_DefineFunction(cx, httpCache, "setMaxMemorySize", js_HttpCache_setMaxMemorySize, 1, JSPROP_READONLY | JSPROP_PERMANENT | JSPROP_ENUMERATE);
+    JS_DefineFunction(cx, httpCache, "setMaxDiskSize", js_HttpCache_setMaxDiskSize, 1, JSPROP_READONLY | JSPROP_PERMANENT | JSPROP_ENUMERATE);
+    JS_DefineFunction(cx, httpCache, "clear", js_HttpCache_clear, 0, JSPROP_READONLY | JSPROP_PERMANENT | JSPROP_ENUMERATE);
+
 }
@@ -237,6 +237,210 @@ tolua_lerror:
 #endif
 }
 
+static int lua_get_AudioProfile_keepResident(lua_State* L)
+{
+    cocos2d::experimental::AudioProfile* self = nullptr;
+
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(L,1,"ccexp.AudioProfile",0,&tolua_err)) goto tolua_lerror;
+#endif
+
+    self = (cocos2d::experimental::AudioProfile*)  tolua_tousertype(L,1,0);
+#if COCOS2D_DEBUG >= 1
+    if (nullptr == self)
+    {
+        tolua_error(L,"invalid 'self' in function 'lua_get_AudioProfile_keepResident'\n", nullptr);
+        return 0;
+    }
+#endif
+
+    tolua_pushboolean(L, self->keepResident);
+    return 1;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(L,"#ferror in function 'lua_get_AudioProfile_keepResident'.",&tolua_err);
+    return 0;
+#endif
+}
+
+static int lua_set_AudioProfile_keepResident(lua_State* L)
+{
+    int argc = 0;
+    cocos2d::experimental::AudioProfile* self = nullptr;
+
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(L,1,"ccexp.AudioProfile",0,&tolua_err)) goto tolua_lerror;
+#endif
+
+    self = (cocos2d::experimental::AudioProfile*)  tolua_tousertype(L,1,0);
+#if COCOS2D_DEBUG >= 1
+    if (nullptr == self)
+    {
+        tolua_error(L,"invalid 'self' in function 'lua_set_AudioProfile_keepResident'\n", nullptr);
+        return 0;
+    }
+#endif
+
+    argc = lua_gettop(L) - 1;
+
+    if (1 == argc)
+    {
+#if COCOS2D_DEBUG >= 1
+        if (!tolua_isboolean(L, 2, 0, &tolua_err))
+            goto tolua_lerror;
+#endif
+        self->keepResident = tolua_toboolean(L, 2, 0) != 0;
+        return 0;
+    }
+
+    return 0;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(L,"#ferror in function 'lua_set_AudioProfile_keepResident'.",&tolua_err);
+    return 0;
+#endif
+}
+
+static int lua_get_AudioProfile_stream(lua_State* L)
+{
+    cocos2d::experimental::AudioProfile* self = nullptr;
+
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(L,1,"ccexp.AudioProfile",0,&tolua_err)) goto tolua_lerror;
+#endif
+
+    self = (cocos2d::experimental::AudioProfile*)  tolua_tousertype(L,1,0);
+#if COCOS2D_DEBUG >= 1
+    if (nullptr == self)
+    {
+        tolua_error(L,"invalid 'self' in function 'lua_get_AudioProfile_stream'\n", nullptr);
+        return 0;
+    }
+#endif
+
+    tolua_pushboolean(L, self->stream);
+    return 1;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(L,"#ferror in function 'lua_get_AudioProfile_stream'.",&tolua_err);
+    return 0;
+#endif
+}
+
+static int lua_set_AudioProfile_stream(lua_State* L)
+{
+    int argc = 0;
+    cocos2d::experimental::AudioProfile* self = nullptr;
+
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(L,1,"ccexp.AudioProfile",0,&tolua_err)) goto tolua_lerror;
+#endif
+
+    self = (cocos2d::experimental::AudioProfile*)  tolua_tousertype(L,1,0);
+#if COCOS2D_DEBUG >= 1
+    if (nullptr == self)
+    {
+        tolua_error(L,"invalid 'self' in function 'lua_set_AudioProfile_stream'\n", nullptr);
+        return 0;
+    }
+#endif
+
+    argc = lua_gettop(L) - 1;
+
+    if (1 == argc)
+    {
+#if COCOS2D_DEBUG >= 1
+        if (!tolua_isboolean(L, 2, 0, &tolua_err))
+            goto tolua_lerror;
+#endif
+        self->stream = tolua_toboolean(L, 2, 0) != 0;
+        return 0;
+    }
+
+    return 0;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(L,"#ferror in function 'lua_set_AudioProfile_stream'.",&tolua_err);
+    return 0;
+#endif
+}
+
+static int lua_get_AudioProfile_priority(lua_State* L)
+{
+    cocos2d::experimental::AudioProfile* self = nullptr;
+
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(L,1,"ccexp.AudioProfile",0,&tolua_err)) goto tolua_lerror;
+#endif
+
+    self = (cocos2d::experimental::AudioProfile*)  tolua_tousertype(L,1,0);
+#if COCOS2D_DEBUG >= 1
+    if (nullptr == self)
+    {
+        tolua_error(L,"invalid 'self' in function 'lua_get_AudioProfile_priority'\n", nullptr);
+        return 0;
+    }
+#endif
+
+    tolua_pushnumber(L, (lua_Number)self->priority);
+    return 1;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(L,"#ferror in function 'lua_get_AudioProfile_priority'.",&tolua_err);
+    return 0;
+#endif
+}
+
+static int lua_set_AudioProfile_priority(lua_State* L)
+{
+    int argc = 0;
+    cocos2d::experimental::AudioProfile* self = nullptr;
+
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(L,1,"ccexp.AudioProfile",0,&tolua_err)) goto tolua_lerror;
+#endif
+
+    self = (cocos2d::experimental::AudioProfile*)  tolua_tousertype(L,1,0);
+#if COCOS2D_DEBUG >= 1
+    if (nullptr == self)
+    {
+        tolua_error(L,"invalid 'self' in function 'lua_set_AudioProfile_priority'\n", nullptr);
+        return 0;
+    }
+#endif
+
+    argc = lua_gettop(L) - 1;
+
+    if (1 == argc)
+    {
+#if COCOS2D_DEBUG >= 1
+        if (!tolua_isnumber(L, 2, 0, &tolua_err))
+            goto tolua_lerror;
+#endif
+        self->priority = (int)tolua_tonumber(L, 2, 0);
+        return 0;
+    }
+
+    return 0;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(L,"#ferror in function 'lua_set_AudioProfile_priority'.",&tolua_err);
+    return 0;
+#endif
+}
+
 int lua_cocos2dx_audioengine_AudioEngine_setFinishCallback(lua_State* tolua_S)
 {
     int argc = 0;
@@ -303,6 +507,9 @@ int register_audioengine_module(lua_State* L)
                 tolua_variable(L, "name", lua_get_AudioProfile_name, lua_set_AudioProfile_name);
                 tolua_variable(L, "maxInstances", lua_get_AudioProfile_maxInstances, lua_set_AudioProfile_maxInstances);
                 tolua_variable(L, "minDelay", lua_get_AudioProfile_minDelay, lua_set_AudioProfile_minDelay);
+                tolua_variable(L, "keepResident", lua_get_AudioProfile_keepResident, lua_set_AudioProfile_keepResident);
+                tolua_variable(L, "stream", lua_get_AudioProfile_stream, lua_set_AudioProfile_stream);
+                tolua_variable(L, "priority", lua_get_AudioProfile_priority, lua_set_AudioProfile_priority);
             }
             lua_pop(L, 1);
         
@@ -33,6 +33,221 @@ extern "C" {
 
 #include "scripting/lua-bindings/manual/network/lua_xml_http_request.h"
 #include "scripting/lua-bindings/manual/CCLuaEngine.h"
+#include "scripting/lua-bindings/manual/tolua_fix.h"
+#include "network/HttpCache.h"
+
+using namespace cocos2d::network;
+
+static int lua_cocos2dx_HttpCache_setEnabled(lua_State* L)
+{
+    int argc = 0;
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertable(L, 1, "cc.HttpCache", 0, &tolua_err)) goto tolua_lerror;
+#endif
+
+    argc = lua_gettop(L) - 1;
+    if (1 == argc)
+    {
+#if COCOS2D_DEBUG >= 1
+        if (!tolua_isboolean(L, 2, 0, &tolua_err))
+            goto tolua_lerror;
+#endif
+        HttpCache::getInstance()->setEnabled(tolua_toboolean(L, 2, 0) != 0);
+        return 0;
+    }
+
+    luaL_error(L, "'setEnabled' function of HttpCache wrong number of arguments: %d, was expecting %d\n", argc, 1);
+    return 0;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(L, "#ferror in function 'lua_cocos2dx_HttpCache_setEnabled'.", &tolua_err);
+    return 0;
+#endif
+}
+
+static int lua_cocos2dx_HttpCache_isEnabled(lua_State* L)
+{
+    int argc = 0;
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertable(L, 1, "cc.HttpCache", 0, &tolua_err)) goto tolua_lerror;
+#endif
+
+    argc = lua_gettop(L) - 1;
+    if (0 == argc)
+    {
+        tolua_pushboolean(L, HttpCache::getInstance()->isEnabled());
+        return 1;
+    }
+
+    luaL_error(L, "'isEnabled' function of HttpCache wrong number of arguments: %d, was expecting %d\n", argc, 0);
+    return 0;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(L, "#ferror in function 'lua_cocos2dx_HttpCache_isEnabled'.", &tolua_err);
+    return 0;
+#endif
+}
+
+static int lua_cocos2dx_HttpCache_setCachePath(lua_State* L)
+{
+    int argc = 0;
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertable(L, 1, "cc.HttpCache", 0, &tolua_err)) goto tolua_lerror;
+#endif
+
+    argc = lua_gettop(L) - 1;
+    if (1 == argc)
+    {
+#if COCOS2D_DEBUG >= 1
+        if (!tolua_isstring(L, 2, 0, &tolua_err))
+            goto tolua_lerror;
+#endif
+        HttpCache::getInstance()->setCachePath(tolua_tostring(L, 2, ""));
+        return 0;
+    }
+
+    luaL_error(L, "'setCachePath' function of HttpCache wrong number of arguments: %d, was expecting %d\n", argc, 1);
+    return 0;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(L, "#ferror in function 'lua_cocos2dx_HttpCache_setCachePath'.", &tolua_err);
+    return 0;
+#endif
+}
+
+static int lua_cocos2dx_HttpCache_getCachePath(lua_State* L)
+{
+    int argc = 0;
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertable(L, 1, "cc.HttpCache", 0, &tolua_err)) goto tolua_lerror;
+#endif
+
+    argc = lua_gettop(L) - 1;
+    if (0 == argc)
+    {
+        tolua_pushstring(L, HttpCache::getInstance()->getCachePath().c_str());
+        return 1;
+    }
+
+    luaL_error(L, "'getCachePath' function of HttpCache wrong number of arguments: %d, was expecting %d\n", argc, 0);
+    return 0;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(L, "#ferror in function 'lua_cocos2dx_HttpCache_getCachePath'.", &tolua_err);
+    return 0;
+#endif
+}
+
+static int lua_cocos2dx_HttpCache_setMaxMemorySize(lua_State* L)
+{
+    int argc = 0;
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertable(L, 1, "cc.HttpCache", 0, &tolua_err)) goto tolua_lerror;
+#endif
+
+    argc = lua_gettop(L) - 1;
+    if (1 == argc)
+    {
+#if COCOS2D_DEBUG >= 1
+        if (!tolua_isnumber(L, 2, 0, &tolua_err))
+            goto tolua_lerror;
+#endif
+        HttpCache::getInstance()->setMaxMemorySize((size_t)tolua_tonumber(L, 2, 0));
+        return 0;
+    }
+
+    luaL_error(L, "'setMaxMemorySize' function of HttpCache wrong number of arguments: %d, was expecting %d\n", argc, 1);
+    return 0;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(L, "#ferror in function 'lua_cocos2dx_HttpCache_setMaxMemorySize'.", &tolua_err);
+    return 0;
+#endif
+}
+
+static int lua_cocos2dx_HttpCache_setMaxDiskSize(lua_State* L)
+{
+    int argc = 0;
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertable(L, 1, "cc.HttpCache", 0, &tolua_err)) goto tolua_lerror;
+#endif
+
+    argc = lua_gettop(L) - 1;
+    if (1 == argc)
+    {
+#if COCOS2D_DEBUG >= 1
+        if (!tolua_isnumber(L, 2, 0, &tolua_err))
+            goto tolua_lerror;
+#endif
+        HttpCache::getInstance()->setMaxDiskSize((size_t)tolua_tonumber(L, 2, 0));
+        return 0;
+    }
+
+    luaL_error(L, "'setMaxDiskSize' function of HttpCache wrong number of arguments: %d, was expecting %d\n", argc, 1);
+    return 0;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(L, "#ferror in function 'lua_cocos2dx_HttpCache_setMaxDiskSize'.", &tolua_err);
+    return 0;
+#endif
+}
+
+static int lua_cocos2dx_HttpCache_clear(lua_State* L)
+{
+    int argc = 0;
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertable(L, 1, "cc.HttpCache", 0, &tolua_err)) goto tolua_lerror;
+#endif
+
+    argc = lua_gettop(L) - 1;
+    if (0 == argc)
+    {
+        HttpCache::getInstance()->clear();
+        return 0;
+    }
+
+    luaL_error(L, "'clear' function of HttpCache wrong number of arguments: %d, was expecting %d\n", argc, 0);
+    return 0;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(L, "#ferror in function 'lua_cocos2dx_HttpCache_clear'.", &tolua_err);
+    return 0;
+#endif
+}
+
+// cc.HttpCache:setEnabled(true), the cache used by XMLHttpRequest
+static int register_http_cache(lua_State* L)
+{
+    tolua_usertype(L, "cc.HttpCache");
+    tolua_module(L, "cc", 0);
+    tolua_beginmodule(L, "cc");
+      tolua_cclass(L, "HttpCache", "cc.HttpCache", "", nullptr);
+      tolua_beginmodule(L, "HttpCache");
+        tolua_function(L, "setEnabled", lua_cocos2dx_HttpCache_setEnabled);
+        tolua_function(L, "isEnabled", lua_cocos2dx_HttpCache_isEnabled);
+        tolua_function(L, "setCachePath", lua_cocos2dx_HttpCache_setCachePath);
+        tolua_function(L, "getCachePath", lua_cocos2dx_HttpCache_getCachePath);
+        tolua_function(L, "setMaxMemorySize", lua_cocos2dx_HttpCache_setMaxMemorySize);
+        tolua_function(L, "setMaxDiskSize", lua_cocos2dx_HttpCache_setMaxDiskSize);
+        tolua_function(L, "clear", lua_cocos2dx_HttpCache_clear);
+      tolua_endmodule(L);
+    tolua_endmodule(L);
+    return 1;
+}
 
 
 int register_network_module(lua_State* L)
@@ -50,6 +265,7 @@ int register_network_module(lua_State* L)
 #endif
         
         register_xml_http_request(L);
+        register_http_cache(L);
     }
     lua_pop(L, 1);
     
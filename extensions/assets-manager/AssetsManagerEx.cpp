@@ -34,6 +34,7 @@
 #include "unzip.h"
 #endif
 #include "base/CCAsyncTaskPool.h"
+#include "zlib.h"
 
 using namespace cocos2d;
 using namespace std;
@@ -47,11 +48,91 @@ NS_CC_EXT_BEGIN
 #define BUFFER_SIZE    8192
 #define MAX_FILENAME   512
 
+#define PATCH_SUFFIX        ".patch"
+#define PATCH_TEMP_SUFFIX   ".patching"
+#define PATCH_MAGIC         "BSDIFF4Z"
+#define PATCH_HEADER_SIZE   32
+
 #define DEFAULT_CONNECTION_TIMEOUT 8
 
 const std::string AssetsManagerEx::VERSION_ID = "@version";
 const std::string AssetsManagerEx::MANIFEST_ID = "@manifest";
 
+namespace {
+    // Offsets are stored in bsdiff's sign-magnitude little endian format
+    int64_t readPatchOffset(const unsigned char *buf)
+    {
+        int64_t y = buf[7] & 0x7F;
+        for (int i = 6; i >= 0; --i)
+        {
+            y = y * 256 + buf[i];
+        }
+        if (buf[7] & 0x80)
+            y = -y;
+        return y;
+    }
+
+    // Inflates one zlib compressed block of a patch on demand, the compressed bytes are read
+    // from the patch file as they are needed, each block has its own handle on the file
+    class PatchBlockReader
+    {
+    public:
+        PatchBlockReader() : _file(nullptr), _remaining(0), _inited(false)
+        {
+            memset(&_stream, 0, sizeof(_stream));
+        }
+
+        ~PatchBlockReader()
+        {
+            if (_inited)
+                inflateEnd(&_stream);
+            if (_file)
+                fclose(_file);
+        }
+
+        bool init(const std::string &path, long offset, long len)
+        {
+            _file = fopen(path.c_str(), "rb");
+            if (!_file || fseek(_file, offset, SEEK_SET) != 0)
+                return false;
+            _remaining = len;
+            _inited = (inflateInit(&_stream) == Z_OK);
+            return _inited;
+        }
+
+        bool read(unsigned char *out, size_t len)
+        {
+            _stream.next_out = out;
+            _stream.avail_out = (uInt)len;
+            while (_stream.avail_out > 0)
+            {
+                if (_stream.avail_in == 0 && _remaining > 0)
+                {
+                    size_t chunk = (size_t)std::min<long>(_remaining, BUFFER_SIZE);
+                    if (fread(_input, 1, chunk, _file) != chunk)
+                        return false;
+                    _remaining -= (long)chunk;
+                    _stream.next_in = _input;
+                    _stream.avail_in = (uInt)chunk;
+                }
+                int err = inflate(&_stream, Z_NO_FLUSH);
+                if (err == Z_STREAM_END)
+                    return _stream.avail_out == 0;
+                if (err != Z_OK)
+                    return false;
+            }
+            return true;
+        }
+
+    private:
+        FILE *_file;
+        long _remaining;
+        unsigned char _input[BUFFER_SIZE];
+        z_stream _stream;
+        bool _inited;
+    };
+}
+
 // Implementation of AssetsManagerEx
 
 AssetsManagerEx::AssetsManagerEx(const std::string& manifestUrl, const std::string& storagePath)
@@ -421,6 +502,154 @@ void AssetsManagerEx::decompressDownloadedZip()
     _compressedFiles.clear();
 }
 
+bool AssetsManagerEx::applyPatch(const std::string &basePath, const std::string &patchPath, const std::string &dstPath, const Manifest::Asset &asset) const
+{
+    // Patch layout follows bsdiff 4: a 32 bytes header (magic, control block length, diff block length, new size)
+    // then the control, diff and extra blocks, each block being compressed with zlib instead of bzip2.
+    // The blocks are inflated while the patched file is written, the patch is never loaded in memory as a whole.
+    const std::string suitablePatchPath = _fileUtils->getSuitableFOpen(patchPath);
+    FILE *patch = fopen(suitablePatchPath.c_str(), "rb");
+    if (!patch)
+    {
+        CCLOG("AssetsManagerEx : can not open patch file %s\n", patchPath.c_str());
+        return false;
+    }
+    unsigned char header[PATCH_HEADER_SIZE];
+    bool validHeader = fread(header, 1, PATCH_HEADER_SIZE, patch) == PATCH_HEADER_SIZE && memcmp(header, PATCH_MAGIC, 8) == 0;
+    fseek(patch, 0, SEEK_END);
+    long patchSize = ftell(patch);
+    fclose(patch);
+    if (!validHeader)
+    {
+        CCLOG("AssetsManagerEx : invalid patch file %s\n", patchPath.c_str());
+        return false;
+    }
+    int64_t ctrlLen = readPatchOffset(header + 8);
+    int64_t diffLen = readPatchOffset(header + 16);
+    int64_t newSize = readPatchOffset(header + 24);
+    if (ctrlLen < 0 || diffLen < 0 || newSize < 0 || PATCH_HEADER_SIZE + ctrlLen + diffLen > patchSize
+        || (asset.size >= 0 && asset.size != newSize))
+    {
+        CCLOG("AssetsManagerEx : corrupted patch header in %s\n", patchPath.c_str());
+        return false;
+    }
+    
+    PatchBlockReader ctrlBlock, diffBlock, extraBlock;
+    const long ctrlStart = PATCH_HEADER_SIZE;
+    if (!ctrlBlock.init(suitablePatchPath, ctrlStart, (long)ctrlLen)
+        || !diffBlock.init(suitablePatchPath, (long)(ctrlStart + ctrlLen), (long)diffLen)
+        || !extraBlock.init(suitablePatchPath, (long)(ctrlStart + ctrlLen + diffLen), (long)(patchSize - ctrlStart - ctrlLen - diffLen)))
+    {
+        CCLOG("AssetsManagerEx : can not inflate patch %s\n", patchPath.c_str());
+        return false;
+    }
+    
+    FILE *base = fopen(_fileUtils->getSuitableFOpen(basePath).c_str(), "rb");
+    if (!base)
+    {
+        CCLOG("AssetsManagerEx : can not open patch base file %s\n", basePath.c_str());
+        return false;
+    }
+    fseek(base, 0, SEEK_END);
+    int64_t baseSize = ftell(base);
+    
+    FILE *out = fopen(_fileUtils->getSuitableFOpen(dstPath).c_str(), "wb");
+    if (!out)
+    {
+        CCLOG("AssetsManagerEx : can not create patched file %s\n", dstPath.c_str());
+        fclose(base);
+        return false;
+    }
+    
+    unsigned char ctrlBuf[24];
+    unsigned char diffBuf[BUFFER_SIZE];
+    unsigned char baseBuf[BUFFER_SIZE];
+    uLong crc = crc32(0L, Z_NULL, 0);
+    int64_t newPos = 0, basePos = 0;
+    bool succeed = true;
+    while (succeed && newPos < newSize)
+    {
+        if (!ctrlBlock.read(ctrlBuf, sizeof(ctrlBuf)))
+        {
+            succeed = false;
+            break;
+        }
+        int64_t addLen = readPatchOffset(ctrlBuf);
+        int64_t copyLen = readPatchOffset(ctrlBuf + 8);
+        int64_t seekLen = readPatchOffset(ctrlBuf + 16);
+        if (addLen < 0 || copyLen < 0 || newPos + addLen + copyLen > newSize)
+        {
+            succeed = false;
+            break;
+        }
+        
+        // Add diff bytes to base bytes, bytes out of the base file range are added to zero
+        while (succeed && addLen > 0)
+        {
+            size_t chunk = (size_t)std::min<int64_t>(addLen, BUFFER_SIZE);
+            if (!diffBlock.read(diffBuf, chunk))
+            {
+                succeed = false;
+                break;
+            }
+            memset(baseBuf, 0, chunk);
+            if (basePos < baseSize && basePos + (int64_t)chunk > 0)
+            {
+                int64_t from = std::max<int64_t>(basePos, 0);
+                int64_t to = std::min<int64_t>(basePos + chunk, baseSize);
+                fseek(base, (long)from, SEEK_SET);
+                if (fread(baseBuf + (from - basePos), 1, (size_t)(to - from), base) != (size_t)(to - from))
+                {
+                    succeed = false;
+                    break;
+                }
+            }
+            for (size_t i = 0; i < chunk; ++i)
+            {
+                diffBuf[i] += baseBuf[i];
+            }
+            crc = crc32(crc, diffBuf, (uInt)chunk);
+            fwrite(diffBuf, chunk, 1, out);
+            addLen -= chunk;
+            newPos += chunk;
+            basePos += chunk;
+        }
+        
+        // Copy extra bytes which don't exist in the base file
+        while (succeed && copyLen > 0)
+        {
+            size_t chunk = (size_t)std::min<int64_t>(copyLen, BUFFER_SIZE);
+            if (!extraBlock.read(diffBuf, chunk))
+            {
+                succeed = false;
+                break;
+            }
+            crc = crc32(crc, diffBuf, (uInt)chunk);
+            fwrite(diffBuf, chunk, 1, out);
+            copyLen -= chunk;
+            newPos += chunk;
+        }
+        basePos += seekLen;
+    }
+    
+    if (ferror(out))
+        succeed = false;
+    fclose(out);
+    fclose(base);
+    
+    if (succeed && asset.hasCrc32 && crc != asset.crc32)
+    {
+        CCLOG("AssetsManagerEx : crc32 mismatch after patching %s\n", dstPath.c_str());
+        succeed = false;
+    }
+    if (!succeed)
+    {
+        CCLOG("AssetsManagerEx : fail to apply patch %s\n", patchPath.c_str());
+        _fileUtils->removeFile(dstPath);
+    }
+    return succeed;
+}
+
 void AssetsManagerEx::dispatchUpdateEvent(EventAssetsManagerEx::EventCode code, const std::string &assetId/* = ""*/, const std::string &message/* = ""*/, int curle_code/* = CURLE_OK*/, int curlm_code/* = CURLM_OK*/)
 {
     EventAssetsManagerEx event(_eventName, this, code, _percent, _percentByFile, assetId, message, curle_code, curlm_code);
@@ -558,6 +787,7 @@ void AssetsManagerEx::startUpdate()
     // Clean up before update
     _failedUnits.clear();
     _downloadUnits.clear();
+    _patchUnits.clear();
     _compressedFiles.clear();
     _totalWaitToDownload = _totalToDownload = 0;
     _percent = _percentByFile = _sizeCollected = _totalSize = 0;
@@ -611,6 +841,11 @@ void AssetsManagerEx::startUpdate()
                     unit.srcUrl = packageUrl + path;
                     unit.storagePath = _storagePath + path;
                     _downloadUnits.emplace(unit.customId, unit);
+                    
+                    if (diff.type == Manifest::DiffType::MODIFIED)
+                    {
+                        preparePatchUnit(unit);
+                    }
                 }
             }
             // Set other assets' downloadState to SUCCESSED
@@ -813,6 +1048,8 @@ void AssetsManagerEx::updateAssets(const DownloadUnits& assets)
             _updateState = State::UPDATING;
             _downloadUnits.clear();
             _downloadUnits = assets;
+            // Retried assets are always downloaded as whole files
+            _patchUnits.clear();
             _totalWaitToDownload = _totalToDownload = (int)_downloadUnits.size();
             this->batchDownload();
         }
@@ -851,6 +1088,11 @@ void AssetsManagerEx::onError(const network::DownloadTask& task,
     {
         dispatchUpdateEvent(EventAssetsManagerEx::EventCode::ERROR_DOWNLOAD_MANIFEST, task.identifier, errorStr, errorCode, errorCodeInternal);
     }
+    else if (_patchUnits.find(task.identifier) != _patchUnits.end())
+    {
+        CCLOG("AssetsManagerEx : Fail to download patch of %s, download full file instead\n", task.identifier.c_str());
+        fallbackFromPatch(task.identifier);
+    }
     else
     {
         auto unitIt = _downloadUnits.find(task.identifier);
@@ -937,6 +1179,13 @@ void AssetsManagerEx::onSuccess(const std::string &srcUrl, const std::string &st
     }
     else
     {
+        // Patch downloaded, it must be applied before the asset is up to date
+        if (_patchUnits.find(customId) != _patchUnits.end())
+        {
+            applyPatchAsync(customId);
+            return;
+        }
+        
         auto &assets = _remoteManifest->getAssets();
         auto assetIt = assets.find(customId);
         if (assetIt != assets.end())
@@ -989,6 +1238,101 @@ void AssetsManagerEx::batchDownload()
     for(auto iter : _downloadUnits)
     {
         DownloadUnit& unit = iter.second;
+        auto patchIt = _patchUnits.find(unit.customId);
+        if (patchIt != _patchUnits.end())
+        {
+            _downloader->createDownloadFileTask(patchIt->second.srcUrl, patchIt->second.storagePath, unit.customId);
+        }
+        else
+        {
+            _downloader->createDownloadFileTask(unit.srcUrl, unit.storagePath, unit.customId);
+        }
+    }
+}
+
+void AssetsManagerEx::preparePatchUnit(const DownloadUnit &unit)
+{
+    auto localIt = _assets->find(unit.customId);
+    if (localIt == _assets->end())
+        return;
+    
+    const Manifest::Patch *patch = _remoteManifest->findPatch(unit.customId, localIt->second.md5);
+    if (patch == nullptr)
+        return;
+    
+    // The installed revision can live either in the storage path or in the app package
+    std::string basePath = _fileUtils->fullPathForFilename(localIt->second.path);
+    if (basePath.empty())
+        return;
+    
+    PatchUnit patchUnit;
+    patchUnit.srcUrl = _remoteManifest->getPackageUrl() + patch->path;
+    patchUnit.storagePath = unit.storagePath + PATCH_SUFFIX;
+    patchUnit.basePath = basePath;
+    _patchUnits.emplace(unit.customId, patchUnit);
+}
+
+void AssetsManagerEx::applyPatchAsync(const std::string &customId)
+{
+    auto unitIt = _downloadUnits.find(customId);
+    auto &assets = _remoteManifest->getAssets();
+    auto assetIt = assets.find(customId);
+    if (unitIt == _downloadUnits.end() || assetIt == assets.end())
+    {
+        fallbackFromPatch(customId);
+        return;
+    }
+    
+    struct AsyncData
+    {
+        std::string customId;
+        std::string srcUrl;
+        std::string storagePath;
+        std::string basePath;
+        std::string patchPath;
+        Manifest::Asset asset;
+        bool succeed;
+    };
+    
+    AsyncData* asyncData = new AsyncData;
+    asyncData->customId = customId;
+    asyncData->srcUrl = unitIt->second.srcUrl;
+    asyncData->storagePath = unitIt->second.storagePath;
+    asyncData->basePath = _patchUnits[customId].basePath;
+    asyncData->patchPath = _patchUnits[customId].storagePath;
+    asyncData->asset = assetIt->second;
+    asyncData->succeed = false;
+    
+    std::function<void(void*)> mainThread = [this](void* param) {
+        auto asyncDataInner = reinterpret_cast<AsyncData*>(param);
+        if (asyncDataInner->succeed)
+        {
+            _patchUnits.erase(asyncDataInner->customId);
+            onSuccess(asyncDataInner->srcUrl, asyncDataInner->storagePath, asyncDataInner->customId);
+        }
+        else
+        {
+            fallbackFromPatch(asyncDataInner->customId);
+        }
+        delete asyncDataInner;
+    };
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_OTHER, mainThread, (void*)asyncData, [this, asyncData]() {
+        // The base file can be the destination itself, so patch into a temporary file first
+        std::string tempPath = asyncData->storagePath + PATCH_TEMP_SUFFIX;
+        asyncData->succeed = applyPatch(asyncData->basePath, asyncData->patchPath, tempPath, asyncData->asset)
+                          && _fileUtils->renameFile(tempPath, asyncData->storagePath);
+        _fileUtils->removeFile(asyncData->patchPath);
+    });
+}
+
+void AssetsManagerEx::fallbackFromPatch(const std::string &customId)
+{
+    _patchUnits.erase(customId);
+    
+    auto unitIt = _downloadUnits.find(customId);
+    if (unitIt != _downloadUnits.end())
+    {
+        const DownloadUnit &unit = unitIt->second;
         _downloader->createDownloadFileTask(unit.srcUrl, unit.storagePath, unit.customId);
     }
 }
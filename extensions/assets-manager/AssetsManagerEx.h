@@ -141,6 +141,15 @@ protected:
     bool decompress(const std::string &filename);
     void decompressDownloadedZip();
     
+    /** @brief Apply a binary patch to the installed revision of an asset, the file and the patch are
+     *         streamed from disk so big assets never need to be fully loaded in memory.
+     @param basePath    Full path of the installed revision
+     @param patchPath   Full path of the downloaded patch file
+     @param dstPath     Full path of the patched file to be generated
+     @param asset       The remote asset used to verify the patched result
+     */
+    bool applyPatch(const std::string &basePath, const std::string &patchPath, const std::string &dstPath, const Manifest::Asset &asset) const;
+    
     /** @brief Update a list of assets under the current AssetsManagerEx context
      */
     void updateAssets(const DownloadUnits& assets);
@@ -188,7 +197,24 @@ protected:
     virtual void onSuccess(const std::string &srcUrl, const std::string &storagePath, const std::string &customId);
     
 private:
+    //! Download unit of an asset which is updated with a patch instead of the whole file
+    struct PatchUnit
+    {
+        std::string srcUrl;
+        std::string storagePath;
+        std::string basePath;
+    };
+    
     void batchDownload();
+    
+    // Register a patch download for the given unit if the remote manifest provides one
+    void preparePatchUnit(const DownloadUnit &unit);
+    
+    // Apply a downloaded patch on the task pool, falls back to the full file on failure
+    void applyPatchAsync(const std::string &customId);
+    
+    // Download the full file of an asset whose patch failed
+    void fallbackFromPatch(const std::string &customId);
 
     // Called when one DownloadUnits finished
     void onDownloadUnitsFinished();
@@ -243,6 +269,9 @@ private:
     //! All failed units
     DownloadUnits _failedUnits;
     
+    //! Assets downloaded as patches against their installed revision
+    std::unordered_map<std::string, PatchUnit> _patchUnits;
+    
     //! All files to be decompressed
     std::vector<std::string> _compressedFiles;
     
@@ -45,6 +45,10 @@
 #define KEY_COMPRESSED          "compressed"
 #define KEY_COMPRESSED_FILE     "compressedFile"
 #define KEY_DOWNLOAD_STATE      "downloadState"
+#define KEY_SIZE                "size"
+#define KEY_CRC32               "crc32"
+#define KEY_PATCHES             "patches"
+#define KEY_PATCH_FROM          "from"
 
 NS_CC_EXT_BEGIN
 
@@ -223,6 +227,25 @@ void Manifest::genResumeAssetsList(DownloadUnits *units) const
     }
 }
 
+const Manifest::Patch* Manifest::findPatch(const std::string &key, const std::string &baseMd5) const
+{
+    auto assetIt = _assets.find(key);
+    if (assetIt == _assets.end() || baseMd5.empty())
+        return nullptr;
+    
+    // Patches can't be applied to archives, they are decompressed after download
+    const Asset &asset = assetIt->second;
+    if (asset.compressed)
+        return nullptr;
+    
+    for (const auto &patch : asset.patches)
+    {
+        if (patch.baseMd5 == baseMd5)
+            return &patch;
+    }
+    return nullptr;
+}
+
 std::vector<std::string> Manifest::getSearchPaths() const
 {
     std::vector<std::string> searchPaths;
@@ -393,6 +416,41 @@ Manifest::Asset Manifest::parseAsset(const std::string &path, const rapidjson::V
     }
     else asset.downloadState = DownloadState::UNSTARTED;
     
+    if ( json.HasMember(KEY_SIZE) && json[KEY_SIZE].IsInt64() )
+    {
+        asset.size = json[KEY_SIZE].GetInt64();
+    }
+    else asset.size = -1;
+    
+    if ( json.HasMember(KEY_CRC32) && json[KEY_CRC32].IsUint() )
+    {
+        asset.hasCrc32 = true;
+        asset.crc32 = json[KEY_CRC32].GetUint();
+    }
+    else
+    {
+        asset.hasCrc32 = false;
+        asset.crc32 = 0;
+    }
+    
+    if ( json.HasMember(KEY_PATCHES) && json[KEY_PATCHES].IsArray() )
+    {
+        const rapidjson::Value& patches = json[KEY_PATCHES];
+        for (rapidjson::SizeType i = 0; i < patches.Size(); ++i)
+        {
+            const rapidjson::Value& entry = patches[i];
+            if (entry.IsObject()
+                && entry.HasMember(KEY_PATCH_FROM) && entry[KEY_PATCH_FROM].IsString()
+                && entry.HasMember(KEY_PATH) && entry[KEY_PATH].IsString())
+            {
+                Patch patch;
+                patch.baseMd5 = entry[KEY_PATCH_FROM].GetString();
+                patch.path = entry[KEY_PATH].GetString();
+                asset.patches.push_back(patch);
+            }
+        }
+    }
+    
     return asset;
 }
 
@@ -66,12 +66,27 @@ public:
         SUCCESSED
     };
     
+    //! Binary patch which turns an older revision of an asset into the current one
+    struct Patch {
+        //! md5 of the installed revision this patch applies to
+        std::string baseMd5;
+        //! Path of the patch file relative to the package url
+        std::string path;
+    };
+    
     //! Asset object
     struct Asset {
         std::string md5;
         std::string path;
         bool compressed;
         DownloadState downloadState;
+        //! Size of the asset in bytes, -1 if not provided
+        long long size;
+        //! Whether crc32 is provided to verify patched results
+        bool hasCrc32;
+        unsigned int crc32;
+        //! Available patches against older revisions [Optional]
+        std::vector<Patch> patches;
     };
     
     //! Object indicate the difference between two Assets
@@ -145,6 +160,13 @@ protected:
      */
     void genResumeAssetsList(DownloadUnits *units) const;
     
+    /** @brief Find the patch of an asset which applies to the given installed revision
+     * @param key       Key of the asset
+     * @param baseMd5   md5 of the installed revision of the asset
+     * @return The patch found or nullptr if the asset must be downloaded as a whole
+     */
+    const Patch* findPatch(const std::string &key, const std::string &baseMd5) const;
+    
     /** @brief Prepend all search paths to the FileUtils.
      */
     void prependSearchPaths();
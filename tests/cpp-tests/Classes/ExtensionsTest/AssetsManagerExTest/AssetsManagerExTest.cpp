@@ -14,6 +14,7 @@ AssetsManagerExTests::AssetsManagerExTests()
     addTestCase("AssetsManager Test1", [](){ return AssetsManagerExLoaderScene::create(0); });
     addTestCase("AssetsManager Test2", [](){ return AssetsManagerExLoaderScene::create(1); });
     addTestCase("AssetsManager Test3", [](){ return AssetsManagerExLoaderScene::create(2); });
+    ADD_TEST_CASE(AssetsManagerExPatchTest);
 }
 
 AssetsManagerExLoaderScene* AssetsManagerExLoaderScene::create(int testIndex)
@@ -194,3 +195,89 @@ std::string AssetsManagerExLoaderScene::title() const
 {
     return "AssetsManagerExTest";
 }
+
+namespace {
+    // Exposes the patch application of AssetsManagerEx to the test
+    class PatchTestAssetsManager : public AssetsManagerEx
+    {
+    public:
+        PatchTestAssetsManager(const std::string& manifestUrl, const std::string& storagePath)
+        : AssetsManagerEx(manifestUrl, storagePath)
+        {
+        }
+
+        using AssetsManagerEx::applyPatch;
+    };
+
+    bool isSameData(const Data& a, const Data& b)
+    {
+        return a.getSize() == b.getSize() && memcmp(a.getBytes(), b.getBytes(), a.getSize()) == 0;
+    }
+}
+
+bool AssetsManagerExPatchTest::init()
+{
+    if (!TestCase::init())
+    {
+        return false;
+    }
+
+    auto fileUtils = FileUtils::getInstance();
+    std::string storagePath = fileUtils->getWritablePath() + "CppTests/AssetsManagerExTest/patch/";
+    auto am = new (std::nothrow) PatchTestAssetsManager("AMTestScene1/project.manifest", storagePath);
+    am->autorelease();
+
+    // AMTestPatch/new.dat.patch turns old.dat into new.dat, it has two control entries with a seek in the base file
+    // and an extra block bigger than the read buffer of AssetsManagerEx.
+    // Patches are applied to downloaded files, so the fixtures are copied to the storage path first.
+    Data base = fileUtils->getDataFromFile("AMTestPatch/old.dat");
+    Data expected = fileUtils->getDataFromFile("AMTestPatch/new.dat");
+    Data patch = fileUtils->getDataFromFile("AMTestPatch/new.dat.patch");
+    std::string basePath = storagePath + "old.dat";
+    std::string otherBasePath = storagePath + "other.dat";
+    std::string patchPath = storagePath + "new.dat.patch";
+    std::string truncatedPatchPath = storagePath + "truncated.dat.patch";
+    std::string dstPath = storagePath + "new.dat";
+    Data truncatedPatch;
+    truncatedPatch.copy(patch.getBytes(), patch.getSize() / 2);
+    fileUtils->writeDataToFile(base, basePath);
+    fileUtils->writeDataToFile(expected, otherBasePath);
+    fileUtils->writeDataToFile(patch, patchPath);
+    fileUtils->writeDataToFile(truncatedPatch, truncatedPatchPath);
+
+    Manifest::Asset asset = Manifest::Asset();
+    asset.size = expected.getSize();
+    asset.hasCrc32 = true;
+    asset.crc32 = 3641977939u;
+
+    bool applied = am->applyPatch(basePath, patchPath, dstPath, asset)
+                && isSameData(fileUtils->getDataFromFile(dstPath), expected);
+    fileUtils->removeFile(dstPath);
+
+    // A failed patch must leave no file behind, AssetsManagerEx then downloads the whole asset instead
+    bool otherBaseRejected = !am->applyPatch(otherBasePath, patchPath, dstPath, asset) && !fileUtils->isFileExist(dstPath);
+    bool truncatedRejected = !am->applyPatch(basePath, truncatedPatchPath, dstPath, asset) && !fileUtils->isFileExist(dstPath);
+
+    fileUtils->removeDirectory(storagePath);
+
+    std::string result = StringUtils::format("Apply patch: %s\nPatch of another revision rejected: %s\nTruncated patch rejected: %s",
+                                             applied ? "passed" : "FAILED",
+                                             otherBaseRejected ? "passed" : "FAILED",
+                                             truncatedRejected ? "passed" : "FAILED");
+    CCLOG("%s", result.c_str());
+    auto label = Label::createWithTTF(result, "fonts/arial.ttf", 18);
+    label->setPosition(VisibleRect::center());
+    addChild(label);
+
+    return true;
+}
+
+std::string AssetsManagerExPatchTest::title() const
+{
+    return "AssetsManagerEx Binary Patch";
+}
+
+std::string AssetsManagerExPatchTest::subtitle() const
+{
+    return "Failed patches fall back to the full download";
+}
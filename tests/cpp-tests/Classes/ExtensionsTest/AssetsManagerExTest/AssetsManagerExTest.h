@@ -32,4 +32,15 @@ private:
     void onLoadEnd();
 };
 
+class AssetsManagerExPatchTest : public TestCase
+{
+public:
+    CREATE_FUNC(AssetsManagerExPatchTest);
+
+    virtual bool init() override;
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
 #endif /* defined(__AssetsManagerEx_Test_H__) */
@@ -1,5 +1,7 @@
 #include "HttpClientTest.h"
 #include "../ExtensionsTest.h"
+#include "network/NetworkMetrics.h"
+#include "network/HttpCache.h"
 #include <string>
 
 USING_NS_CC;
@@ -9,6 +11,8 @@ using namespace cocos2d::network;
 HttpClientTests::HttpClientTests()
 {
     ADD_TEST_CASE(HttpClientTest);
+    ADD_TEST_CASE(HttpCacheTest);
+    ADD_TEST_CASE(HttpClientMetricsTest);
 }
 
 HttpClientTest::HttpClientTest() 
@@ -374,3 +378,182 @@ void HttpClientTest::onHttpRequestCompleted(HttpClient *sender, HttpResponse *re
         log("request ref count not 2, is %d", response->getHttpRequest()->getReferenceCount());
     }
 }
+
+static std::vector<char> toVector(const std::string& str)
+{
+    return std::vector<char>(str.begin(), str.end());
+}
+
+static std::string formatHttpDate(time_t date)
+{
+    char buf[64];
+    strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", gmtime(&date));
+    return buf;
+}
+
+bool HttpCacheTest::init()
+{
+    if (!TestCase::init())
+    {
+        return false;
+    }
+
+    auto cache = HttpCache::getInstance();
+    std::string cachePath = cache->getCachePath();
+    size_t maxMemorySize = cache->getMaxMemorySize();
+    std::string testPath = FileUtils::getInstance()->getWritablePath() + "CppTests/HttpCacheTest/";
+    cache->setCachePath(testPath);
+    cache->clear();
+
+    std::vector<std::string> failures;
+    auto check = [&failures](bool condition, const char* name) {
+        if (!condition)
+        {
+            failures.push_back(name);
+        }
+    };
+    HttpCache::Entry entry;
+    time_t now = time(nullptr);
+
+    // freshness
+    cache->store("http://cache.test/max-age", toVector("HTTP/1.1 200 OK\r\nCache-Control: max-age=60\r\n"), toVector("max-age"));
+    check(cache->lookup("http://cache.test/max-age", entry) && HttpCache::isFresh(entry), "max-age is fresh");
+    cache->store("http://cache.test/expires", toVector("HTTP/1.1 200 OK\r\nDate: " + formatHttpDate(now) + "\r\nExpires: " + formatHttpDate(now + 60) + "\r\n"), toVector("expires"));
+    check(cache->lookup("http://cache.test/expires", entry) && HttpCache::isFresh(entry), "Expires in the future is fresh");
+    cache->store("http://cache.test/expired", toVector("HTTP/1.1 200 OK\r\nExpires: " + formatHttpDate(now - 60) + "\r\nETag: \"e\"\r\n"), toVector("expired"));
+    check(cache->lookup("http://cache.test/expired", entry) && !HttpCache::isFresh(entry), "Expires in the past is stale");
+    cache->store("http://cache.test/no-store", toVector("HTTP/1.1 200 OK\r\nCache-Control: no-store, max-age=60\r\n"), toVector("no-store"));
+    check(!cache->lookup("http://cache.test/no-store", entry), "no-store is not cached");
+
+    // revalidation of a stale entry with "304 Not Modified"
+    cache->store("http://cache.test/etag", toVector("HTTP/1.1 200 OK\r\nCache-Control: no-cache\r\nETag: \"v1\"\r\n"), toVector("etag"));
+    bool stale = cache->lookup("http://cache.test/etag", entry) && !HttpCache::isFresh(entry);
+    auto validationHeaders = HttpCache::getValidationHeaders(entry);
+    check(stale && validationHeaders.size() == 1 && validationHeaders[0] == "If-None-Match: \"v1\"", "no-cache is revalidated with its ETag");
+    bool revalidated = cache->revalidate("http://cache.test/etag", toVector("HTTP/1.1 304 Not Modified\r\nCache-Control: max-age=60\r\n"), entry);
+    check(revalidated && HttpCache::isFresh(entry) && entry.data == toVector("etag") && entry.etag == "\"v1\"", "304 refreshes the entry");
+    check(cache->lookup("http://cache.test/etag", entry) && HttpCache::isFresh(entry), "304 is persisted");
+
+    // without a disk cache the least recently used entries are evicted for good
+    cache->setCachePath("");
+    cache->clear();
+    cache->setMaxMemorySize(2500);
+    std::vector<char> data(1000, 'x');
+    cache->store("http://cache.test/a", toVector("Cache-Control: max-age=60\r\n"), data);
+    cache->store("http://cache.test/b", toVector("Cache-Control: max-age=60\r\n"), data);
+    cache->lookup("http://cache.test/a", entry);
+    cache->store("http://cache.test/c", toVector("Cache-Control: max-age=60\r\n"), data);
+    check(cache->lookup("http://cache.test/a", entry) && cache->lookup("http://cache.test/c", entry), "recently used entries are kept");
+    check(!cache->lookup("http://cache.test/b", entry), "the least recently used entry is evicted");
+
+    cache->setMaxMemorySize(maxMemorySize);
+    cache->clear();
+    cache->setCachePath(cachePath);
+    FileUtils::getInstance()->removeDirectory(testPath);
+
+    std::string result = failures.empty() ? "Passed" : "Failed:";
+    for (const auto& failure : failures)
+    {
+        result += "\n" + failure;
+        log("HttpCacheTest failed: %s", failure.c_str());
+    }
+    auto label = Label::createWithTTF(result, "fonts/arial.ttf", 18);
+    label->setPosition(VisibleRect::center());
+    addChild(label);
+
+    return true;
+}
+
+bool HttpClientMetricsTest::init()
+{
+    if (!TestCase::init())
+    {
+        return false;
+    }
+
+    auto winSize = Director::getInstance()->getWinSize();
+
+    auto menu = Menu::create();
+    menu->setPosition(Vec2::ZERO);
+    addChild(menu);
+
+    auto itemSend = MenuItemLabel::create(Label::createWithTTF("Send 5 Gets", "fonts/arial.ttf", 20),
+                                          CC_CALLBACK_1(HttpClientMetricsTest::onMenuSendClicked, this));
+    itemSend->setPosition(winSize.width / 4, winSize.height - 75);
+    menu->addChild(itemSend);
+
+    auto itemReset = MenuItemLabel::create(Label::createWithTTF("Reset", "fonts/arial.ttf", 20),
+                                           CC_CALLBACK_1(HttpClientMetricsTest::onMenuResetClicked, this));
+    itemReset->setPosition(winSize.width / 2, winSize.height - 75);
+    menu->addChild(itemReset);
+
+    auto itemCapture = MenuItemLabel::create(Label::createWithTTF("Start/Save Capture", "fonts/arial.ttf", 20),
+                                             CC_CALLBACK_1(HttpClientMetricsTest::onMenuCaptureClicked, this));
+    itemCapture->setPosition(winSize.width / 4 * 3, winSize.height - 75);
+    menu->addChild(itemCapture);
+
+    _labelCapture = Label::createWithTTF("", "fonts/arial.ttf", 12);
+    _labelCapture->setPosition(winSize.width / 2, winSize.height - 100);
+    addChild(_labelCapture);
+
+    _labelMetrics = Label::createWithSystemFont("", "Courier", 9);
+    _labelMetrics->setAnchorPoint(Vec2::ANCHOR_MIDDLE_TOP);
+    _labelMetrics->setPosition(winSize.width / 2, winSize.height - 115);
+    addChild(_labelMetrics);
+
+    NetworkMetrics::addConsoleCommand();
+    schedule(CC_SCHEDULE_SELECTOR(HttpClientMetricsTest::updateMetrics), 0.5f);
+    updateMetrics(0);
+
+    return true;
+}
+
+void HttpClientMetricsTest::onExit()
+{
+    NetworkMetrics::getInstance()->stopCapture();
+    TestCase::onExit();
+}
+
+void HttpClientMetricsTest::onMenuSendClicked(cocos2d::Ref *sender)
+{
+    // a failing host and the same host several times, to see the failures and the connection reuse
+    const char* urls[] = {"http://httpbin.org/ip", "http://httpbin.org/get", "http://httpbin.org/bytes/10240",
+                          "https://httpbin.org/get", "http://just-make-this-request-failed.com"};
+    for (auto url : urls)
+    {
+        HttpRequest* request = new (std::nothrow) HttpRequest();
+        request->setUrl(url);
+        request->setRequestType(HttpRequest::Type::GET);
+        HttpClient::getInstance()->send(request);
+        request->release();
+    }
+}
+
+void HttpClientMetricsTest::onMenuResetClicked(cocos2d::Ref *sender)
+{
+    NetworkMetrics::getInstance()->reset();
+    updateMetrics(0);
+}
+
+void HttpClientMetricsTest::onMenuCaptureClicked(cocos2d::Ref *sender)
+{
+    auto metrics = NetworkMetrics::getInstance();
+    if (!metrics->isCapturing())
+    {
+        metrics->startCapture();
+        _labelCapture->setString("Capturing, send requests then save the capture");
+        return;
+    }
+
+    metrics->stopCapture();
+    std::string path = FileUtils::getInstance()->getWritablePath() + "network.har";
+    if (metrics->saveCapture(path))
+        _labelCapture->setString("Capture saved to " + path);
+    else
+        _labelCapture->setString("Failed to save the capture to " + path);
+}
+
+void HttpClientMetricsTest::updateMetrics(float dt)
+{
+    _labelMetrics->setString(NetworkMetrics::getInstance()->getSummary());
+}
@@ -32,4 +32,36 @@ private:
     cocos2d::Label* _labelStatusCode;
 };
 
+class HttpCacheTest : public TestCase
+{
+public:
+    CREATE_FUNC(HttpCacheTest);
+
+    virtual bool init() override;
+
+    virtual std::string title() const override { return "Http Cache Test"; }
+    virtual std::string subtitle() const override { return "Freshness, revalidation and eviction, without network"; }
+};
+
+class HttpClientMetricsTest : public TestCase
+{
+public:
+    CREATE_FUNC(HttpClientMetricsTest);
+
+    virtual bool init() override;
+    virtual void onExit() override;
+
+    void onMenuSendClicked(cocos2d::Ref *sender);
+    void onMenuResetClicked(cocos2d::Ref *sender);
+    void onMenuCaptureClicked(cocos2d::Ref *sender);
+    void updateMetrics(float dt);
+
+    virtual std::string title() const override { return "Network Metrics Test"; }
+    virtual std::string subtitle() const override { return "Also printed by the 'network' console command"; }
+
+private:
+    cocos2d::Label* _labelMetrics;
+    cocos2d::Label* _labelCapture;
+};
+
 #endif //__HTTPREQUESTHTTP_H
@@ -26,6 +26,7 @@
 
 #include "SocketIOTest.h"
 #include "../ExtensionsTest.h"
+#include "base/ccUtils.h"
 
 USING_NS_CC;
 USING_NS_CC_EXT;
@@ -34,6 +35,7 @@ using namespace  cocos2d::network;
 SocketIOTests::SocketIOTests()
 {
     ADD_TEST_CASE(SocketIOTest);
+    ADD_TEST_CASE(SocketIOBenchmarkTest);
 }
 
 SocketIOTest::SocketIOTest()
@@ -313,3 +315,155 @@ void SocketIOTest::onError(network::SIOClient* client, const std::string& data)
 	s << client->getTag() << " received error with content: " << data.c_str();
 	_sioClientStatus->setString(s.str().c_str());
 }
+
+// SocketIOBenchmarkTest
+
+static const char* BENCHMARK_SERVER = "ws://127.0.0.1:3000";
+static const int BENCHMARK_EVENTS = 5000;
+static const int BENCHMARK_BINARY_EVENTS = 500;
+static const size_t BENCHMARK_ATTACHMENT_SIZE = 4096;
+
+SocketIOBenchmarkTest::SocketIOBenchmarkTest()
+	: _sioClient(nullptr)
+	, _status(nullptr)
+	, _expected(0)
+	, _received(0)
+	, _receivedBytes(0)
+	, _startTime(0)
+{
+	Size winSize = Director::getInstance()->getWinSize();
+
+	const int MARGIN = 40;
+	const int SPACE = 35;
+
+	auto menuRequest = Menu::create();
+	menuRequest->setPosition(Vec2::ZERO);
+	addChild(menuRequest);
+
+	auto labelConnect = Label::createWithTTF("Connect To Local Server", "fonts/arial.ttf", 22);
+	auto itemConnect = MenuItemLabel::create(labelConnect, CC_CALLBACK_1(SocketIOBenchmarkTest::onMenuConnectClicked, this));
+	itemConnect->setPosition(Vec2(VisibleRect::center().x, winSize.height - MARGIN - SPACE));
+	menuRequest->addChild(itemConnect);
+
+	// Round trips of small json events, measures parsing and dispatch
+	auto labelEvents = Label::createWithTTF("Benchmark Events", "fonts/arial.ttf", 22);
+	auto itemEvents = MenuItemLabel::create(labelEvents, CC_CALLBACK_1(SocketIOBenchmarkTest::onMenuEventBenchmarkClicked, this));
+	itemEvents->setPosition(Vec2(VisibleRect::center().x, winSize.height - MARGIN - 2 * SPACE));
+	menuRequest->addChild(itemEvents);
+
+	// Round trips of events carrying a binary attachment
+	auto labelBinary = Label::createWithTTF("Benchmark Binary Events", "fonts/arial.ttf", 22);
+	auto itemBinary = MenuItemLabel::create(labelBinary, CC_CALLBACK_1(SocketIOBenchmarkTest::onMenuBinaryBenchmarkClicked, this));
+	itemBinary->setPosition(Vec2(VisibleRect::center().x, winSize.height - MARGIN - 3 * SPACE));
+	menuRequest->addChild(itemBinary);
+
+	_status = Label::createWithTTF("Not connected...", "fonts/arial.ttf", 14, Size(320, 100), TextHAlignment::LEFT);
+	_status->setAnchorPoint(Vec2(0, 0));
+	_status->setPosition(Vec2(VisibleRect::left().x, VisibleRect::rightBottom().y));
+	this->addChild(_status);
+}
+
+SocketIOBenchmarkTest::~SocketIOBenchmarkTest()
+{
+}
+
+void SocketIOBenchmarkTest::onMenuConnectClicked(cocos2d::Ref *sender)
+{
+	if (_sioClient != nullptr)
+		return;
+
+	_sioClient = SocketIO::connect(BENCHMARK_SERVER, *this);
+	_sioClient->setTag("Benchmark Client");
+
+	_sioClient->on("connect", CC_CALLBACK_2(SocketIOBenchmarkTest::connect, this));
+	_sioClient->on("bench", CC_CALLBACK_2(SocketIOBenchmarkTest::bench, this));
+	_sioClient->onBinary("benchbinary", CC_CALLBACK_3(SocketIOBenchmarkTest::benchBinary, this));
+}
+
+void SocketIOBenchmarkTest::startRound(const char* name)
+{
+	_received = 0;
+	_receivedBytes = 0;
+	_startTime = utils::gettime();
+
+	std::stringstream s;
+	s << name << ": " << _expected << " events in flight...";
+	_status->setString(s.str());
+}
+
+void SocketIOBenchmarkTest::finishRound(const char* name)
+{
+	double elapsed = utils::gettime() - _startTime;
+
+	std::stringstream s;
+	s << name << ": " << _received << " round trips in " << elapsed << " s\n"
+	  << (int)(_received / elapsed) << " events/s, " << (int)(_receivedBytes / elapsed / 1024) << " KB/s";
+	_status->setString(s.str());
+	CCLOG("%s", s.str().c_str());
+}
+
+void SocketIOBenchmarkTest::onMenuEventBenchmarkClicked(cocos2d::Ref *sender)
+{
+	if (_sioClient == nullptr)
+		return;
+
+	_expected = BENCHMARK_EVENTS;
+	startRound("Events");
+
+	const std::string args = "{\"x\":120.5,\"y\":64.25,\"angle\":90,\"state\":\"running\"}";
+	for (int i = 0; i < BENCHMARK_EVENTS; ++i)
+	{
+		_sioClient->emit("bench", args);
+	}
+}
+
+void SocketIOBenchmarkTest::onMenuBinaryBenchmarkClicked(cocos2d::Ref *sender)
+{
+	if (_sioClient == nullptr)
+		return;
+
+	_expected = BENCHMARK_BINARY_EVENTS;
+	startRound("Binary events");
+
+	std::vector<std::vector<char>> attachments(1, std::vector<char>(BENCHMARK_ATTACHMENT_SIZE, 'x'));
+	for (int i = 0; i < BENCHMARK_BINARY_EVENTS; ++i)
+	{
+		_sioClient->emit("benchbinary", "chunk", attachments);
+	}
+}
+
+void SocketIOBenchmarkTest::connect(network::SIOClient* client, const std::string& data)
+{
+	_status->setString("Connected, choose a benchmark");
+}
+
+void SocketIOBenchmarkTest::bench(network::SIOClient* client, const std::string& data)
+{
+	_receivedBytes += data.size();
+	if (++_received == _expected)
+		finishRound("Events");
+}
+
+void SocketIOBenchmarkTest::benchBinary(network::SIOClient* client, const std::string& data, const std::vector<std::vector<char>>& attachments)
+{
+	for (auto& attachment : attachments)
+		_receivedBytes += attachment.size();
+	if (++_received == _expected)
+		finishRound("Binary events");
+}
+
+void SocketIOBenchmarkTest::onClose(network::SIOClient* client)
+{
+	_status->setString("Closed");
+	if (client == _sioClient)
+		_sioClient = nullptr;
+}
+
+void SocketIOBenchmarkTest::onError(network::SIOClient* client, const std::string& data)
+{
+	CCLOGERROR("SocketIOBenchmarkTest::onError received: %s", data.c_str());
+
+	std::stringstream s;
+	s << "Error: " << data;
+	_status->setString(s.str());
+}
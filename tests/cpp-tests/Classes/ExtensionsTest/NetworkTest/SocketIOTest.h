@@ -105,4 +105,44 @@ protected:
 	cocos2d::Label *_sioClientStatus;
 };
 
+/**
+*  @brief Measures event throughput against the local server stub socketio-bench-server.js
+**/
+class SocketIOBenchmarkTest: public TestCase
+	, public cocos2d::network::SocketIO::SIODelegate
+{
+public:
+    CREATE_FUNC(SocketIOBenchmarkTest);
+
+    SocketIOBenchmarkTest();
+    virtual ~SocketIOBenchmarkTest();
+
+	virtual void onClose(cocos2d::network::SIOClient* client)override;
+	virtual void onError(cocos2d::network::SIOClient* client, const std::string& data)override;
+
+	void onMenuConnectClicked(cocos2d::Ref *sender);
+	void onMenuEventBenchmarkClicked(cocos2d::Ref *sender);
+	void onMenuBinaryBenchmarkClicked(cocos2d::Ref *sender);
+
+	void connect(cocos2d::network::SIOClient* client, const std::string& data);
+	void bench(cocos2d::network::SIOClient* client, const std::string& data);
+	void benchBinary(cocos2d::network::SIOClient* client, const std::string& data, const std::vector<std::vector<char>>& attachments);
+
+    virtual std::string title() const override{ return "SocketIO Benchmark"; }
+    virtual std::string subtitle() const override{ return "Run socketio-bench-server.js on localhost:3000"; }
+
+protected:
+	void startRound(const char* name);
+	void finishRound(const char* name);
+
+	cocos2d::network::SIOClient *_sioClient;
+
+	cocos2d::Label *_status;
+
+	int _expected;
+	int _received;
+	size_t _receivedBytes;
+	double _startTime;
+};
+
 #endif /* defined(__TestCpp__SocketIOTest__) */
@@ -0,0 +1,18 @@
+// Local socket.io 1.x server stub for SocketIOBenchmarkTest, echoes every benchmark event back.
+//
+//   npm install socket.io@1.4
+//   node socketio-bench-server.js
+
+var io = require('socket.io')(3000);
+
+io.on('connection', function (socket) {
+    socket.on('bench', function (data) {
+        socket.emit('bench', data);
+    });
+
+    socket.on('benchbinary', function (data, buffer) {
+        socket.emit('benchbinary', data, buffer);
+    });
+});
+
+console.log('socket.io benchmark server listening on port 3000');
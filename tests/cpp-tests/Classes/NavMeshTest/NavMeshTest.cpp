@@ -28,6 +28,7 @@
 #include "physics3d/CCPhysics3D.h"
 #include "3d/CCBundle3D.h"
 #include "2d/CCLight.h"
+#include <chrono>
 
 USING_NS_CC_EXT;
 USING_NS_CC;
@@ -44,6 +45,8 @@ NavMeshTests::NavMeshTests()
 #else
     ADD_TEST_CASE(NavMeshBasicTestDemo);
     ADD_TEST_CASE(NavMeshAdvanceTestDemo);
+    ADD_TEST_CASE(NavMeshDynamicGeometryTestDemo);
+    ADD_TEST_CASE(NavMeshPathQueryBenchmark);
 #endif
 };
 
@@ -433,4 +436,250 @@ void NavMeshAdvanceTestDemo::touchesEnded(const std::vector<cocos2d::Touch*>& to
     }
 }
 
+NavMeshDynamicGeometryTestDemo::NavMeshDynamicGeometryTestDemo(void)
+    : _tileLabel(nullptr)
+{
+
+}
+
+NavMeshDynamicGeometryTestDemo::~NavMeshDynamicGeometryTestDemo(void)
+{
+
+}
+
+bool NavMeshDynamicGeometryTestDemo::init()
+{
+    if (!NavMeshBaseTestDemo::init()) return false;
+
+    //the navmesh is rebuilt from the triangles of the scene and of the blocks added
+    _triangles = Bundle3D::getTrianglesList("NavMesh/scene.obj");
+    getNavMesh()->setGeometry(_triangles);
+
+    TTFConfig ttfConfig("fonts/arial.ttf", 15);
+    auto menuItem = MenuItemLabel::create(Label::createWithTTF(ttfConfig, "Create Block"), [=](Ref*){
+        float x = cocos2d::random(-50.0f, 50.0f);
+        float z = cocos2d::random(-50.0f, 50.0f);
+        Physics3DWorld::HitResult result;
+        if (getPhysics3DWorld()->rayCast(Vec3(x, 50.0f, z), Vec3(x, -50.0f, z), &result))
+            createBlock(result.hitPosition);
+    });
+    menuItem->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    menuItem->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 50));
+    auto menu = Menu::create(menuItem, nullptr);
+    menu->setPosition(Vec2::ZERO);
+    addChild(menu);
+
+    _tileLabel = Label::createWithTTF("", "fonts/arial.ttf", 12);
+    _tileLabel->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    _tileLabel->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 80));
+    addChild(_tileLabel);
+
+    return true;
+}
+
+void NavMeshDynamicGeometryTestDemo::onEnter()
+{
+    NavMeshBaseTestDemo::onEnter();
+
+    Physics3DWorld::HitResult result;
+    getPhysics3DWorld()->rayCast(Vec3(0.0f, 50.0f, 0.0f), Vec3(0.0f, -50.0f, 0.0f), &result);
+    createAgent(result.hitPosition);
+}
+
+void NavMeshDynamicGeometryTestDemo::createBlock(const Vec3 &pos)
+{
+    const Vec3 halfSize(4.0f, 4.0f, 4.0f);
+    auto block = Sprite3D::create("Sprite3DTest/box.c3t");
+    block->setTexture("Images/CyanSquare.png");
+    block->setScale(halfSize.x * 2.0f);
+    block->setPosition3D(pos + Vec3(0.0f, halfSize.y, 0.0f));
+    block->setCameraMask((unsigned short)CameraFlag::USER1);
+    addChild(block);
+
+    //the 12 triangles of the block
+    Vec3 min = pos - Vec3(halfSize.x, 0.0f, halfSize.z);
+    Vec3 max = pos + Vec3(halfSize.x, halfSize.y * 2.0f, halfSize.z);
+    Vec3 corners[8];
+    for (int i = 0; i < 8; ++i){
+        corners[i] = Vec3((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+    }
+    static const int faces[6][4] = { { 0, 2, 3, 1 }, { 4, 5, 7, 6 }, { 0, 1, 5, 4 }, { 2, 6, 7, 3 }, { 0, 4, 6, 2 }, { 1, 3, 7, 5 } };
+    for (auto &face : faces){
+        _triangles.push_back(corners[face[0]]);
+        _triangles.push_back(corners[face[1]]);
+        _triangles.push_back(corners[face[2]]);
+        _triangles.push_back(corners[face[0]]);
+        _triangles.push_back(corners[face[2]]);
+        _triangles.push_back(corners[face[3]]);
+    }
+
+    getNavMesh()->setGeometry(_triangles);
+    getNavMesh()->rebuildTiles(min, max);
+}
+
+void NavMeshDynamicGeometryTestDemo::update(float delta)
+{
+    NavMeshBaseTestDemo::update(delta);
+
+    const auto &stats = getNavMesh()->getStats();
+    _tileLabel->setString(StringUtils::format("tiles being rebuilt: %d, last swap: %.2f ms", stats.pendingTileCount, stats.tileRebuildTime));
+}
+
+void NavMeshDynamicGeometryTestDemo::touchesEnded(const std::vector<cocos2d::Touch*>& touches, cocos2d::Event *event)
+{
+    if (!_needMoveAgents) return;
+    if (!touches.empty()){
+        auto touch = touches[0];
+        auto location = touch->getLocationInView();
+        Vec3 nearP(location.x, location.y, 0.0f), farP(location.x, location.y, 1.0f);
+
+        auto size = Director::getInstance()->getWinSize();
+        _camera->unproject(size, &nearP, &nearP);
+        _camera->unproject(size, &farP, &farP);
+
+        Physics3DWorld::HitResult result;
+        getPhysics3DWorld()->rayCast(nearP, farP, &result);
+        moveAgents(result.hitPosition);
+    }
+}
+
+std::string NavMeshDynamicGeometryTestDemo::title() const
+{
+    return "Navigation Mesh Test";
+}
+
+std::string NavMeshDynamicGeometryTestDemo::subtitle() const
+{
+    return "Dynamic Geometry Test";
+}
+
+static const int BENCHMARK_MAX_AGENTS = 300;
+static const int BENCHMARK_PATH_QUERIES = 300;
+
+NavMeshPathQueryBenchmark::NavMeshPathQueryBenchmark(void)
+    : _resultLabel(nullptr)
+    , _async(true)
+    , _foundPaths(0)
+    , _syncPathQueryTime(0.0f)
+    , _moveTime(0.0f)
+    , _reportTime(0.0f)
+{
+
+}
+
+NavMeshPathQueryBenchmark::~NavMeshPathQueryBenchmark(void)
+{
+
+}
+
+bool NavMeshPathQueryBenchmark::init()
+{
+    if (!NavMeshBaseTestDemo::init()) return false;
+
+    auto navMesh = NavMesh::create("NavMesh/all_tiles_tilecache.bin", "NavMesh/geomset.txt", BENCHMARK_MAX_AGENTS);
+    setNavMesh(navMesh);
+
+    TTFConfig ttfConfig("fonts/arial.ttf", 15);
+    auto agentItem = MenuItemLabel::create(Label::createWithTTF(ttfConfig, "Create 50 Agents"), [=](Ref*){
+        for (int i = 0; i < 50 && (int)_agents.size() < BENCHMARK_MAX_AGENTS; ++i){
+            createAgent(getRandomGroundPoint());
+        }
+    });
+    agentItem->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    agentItem->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 50));
+
+    auto modeLabel = Label::createWithTTF(ttfConfig, "Path Queries: findPathAsync");
+    auto modeItem = MenuItemLabel::create(modeLabel, [=](Ref*){
+        _async = !_async;
+        modeLabel->setString(_async ? "Path Queries: findPathAsync" : "Path Queries: findPath");
+    });
+    modeItem->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    modeItem->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 80));
+
+    auto menu = Menu::create(agentItem, modeItem, nullptr);
+    menu->setPosition(Vec2::ZERO);
+    addChild(menu);
+
+    _resultLabel = Label::createWithTTF("", "fonts/arial.ttf", 12);
+    _resultLabel->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    _resultLabel->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 110));
+    addChild(_resultLabel);
+
+    return true;
+}
+
+void NavMeshPathQueryBenchmark::onEnter()
+{
+    NavMeshBaseTestDemo::onEnter();
+
+    //the ends of the paths are taken on the ground of the scene
+    Physics3DWorld::HitResult result;
+    for (float x = -50.0f; x <= 50.0f; x += 5.0f){
+        for (float z = -50.0f; z <= 50.0f; z += 5.0f){
+            if (getPhysics3DWorld()->rayCast(Vec3(x, 50.0f, z), Vec3(x, -50.0f, z), &result))
+                _groundPoints.push_back(result.hitPosition);
+        }
+    }
+}
+
+Vec3 NavMeshPathQueryBenchmark::getRandomGroundPoint() const
+{
+    if (_groundPoints.empty())
+        return Vec3::ZERO;
+    return _groundPoints[cocos2d::random(0, (int)_groundPoints.size() - 1)];
+}
+
+void NavMeshPathQueryBenchmark::update(float delta)
+{
+    NavMeshBaseTestDemo::update(delta);
+
+    auto navMesh = getNavMesh();
+    if (_async){
+        for (int i = 0; i < BENCHMARK_PATH_QUERIES; ++i){
+            navMesh->findPathAsync(getRandomGroundPoint(), getRandomGroundPoint(), [this](const std::vector<Vec3> &pathPoints){
+                if (!pathPoints.empty())
+                    ++_foundPaths;
+            });
+        }
+    }
+    else{
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Vec3> pathPoints;
+        for (int i = 0; i < BENCHMARK_PATH_QUERIES; ++i){
+            pathPoints.clear();
+            navMesh->findPath(getRandomGroundPoint(), getRandomGroundPoint(), pathPoints);
+            if (!pathPoints.empty())
+                ++_foundPaths;
+        }
+        _syncPathQueryTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0f;
+    }
+
+    //the agents repath together regularly
+    _moveTime += delta;
+    if (3.0f < _moveTime){
+        _moveTime = 0.0f;
+        moveAgents(getRandomGroundPoint());
+    }
+
+    _reportTime += delta;
+    if (0.5f < _reportTime){
+        _reportTime = 0.0f;
+        const auto &stats = navMesh->getStats();
+        _resultLabel->setString(StringUtils::format("agents: %d, crowd update: %.2f ms, tile cache update: %.2f ms\n%d paths per frame: %.2f ms, %d found in 0.5 s",
+            stats.agentCount, stats.crowdUpdateTime, stats.tileCacheUpdateTime,
+            BENCHMARK_PATH_QUERIES, _async ? stats.pathQueryTime : _syncPathQueryTime, _foundPaths));
+        _foundPaths = 0;
+    }
+}
+
+std::string NavMeshPathQueryBenchmark::title() const
+{
+    return "Navigation Mesh Test";
+}
+
+std::string NavMeshPathQueryBenchmark::subtitle() const
+{
+    return "Path Query Benchmark";
+}
+
 #endif
@@ -122,6 +122,59 @@ protected:
     cocos2d::Label *_debugLabel;
 };
 
+class NavMeshDynamicGeometryTestDemo : public NavMeshBaseTestDemo
+{
+public:
+    CREATE_FUNC(NavMeshDynamicGeometryTestDemo);
+    NavMeshDynamicGeometryTestDemo(void);
+    virtual ~NavMeshDynamicGeometryTestDemo(void);
+
+    // overrides
+    virtual bool init() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void update(float delta) override;
+
+    virtual void onEnter() override;
+
+protected:
+
+    virtual void touchesEnded(const std::vector<cocos2d::Touch*>& touches, cocos2d::Event  *event)override;
+
+    void createBlock(const cocos2d::Vec3 &pos);
+
+protected:
+    std::vector<cocos2d::Vec3> _triangles;
+    cocos2d::Label *_tileLabel;
+};
+
+class NavMeshPathQueryBenchmark : public NavMeshBaseTestDemo
+{
+public:
+    CREATE_FUNC(NavMeshPathQueryBenchmark);
+    NavMeshPathQueryBenchmark(void);
+    virtual ~NavMeshPathQueryBenchmark(void);
+
+    // overrides
+    virtual bool init() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void update(float delta) override;
+
+    virtual void onEnter() override;
+
+protected:
+    cocos2d::Vec3 getRandomGroundPoint() const;
+
+    std::vector<cocos2d::Vec3> _groundPoints;
+    cocos2d::Label *_resultLabel;
+    bool _async;
+    int _foundPaths;
+    float _syncPathQueryTime;
+    float _moveTime;
+    float _reportTime;
+};
+
 #endif
 
 #endif
@@ -26,6 +26,12 @@
 #include "NewAudioEngineTest.h"
 #include "ui/CocosGUI.h"
 
+#if AUDIO_MIXER_BENCHMARK_ENABLED
+#include <chrono>
+#include "audio/mixer/MixerOutput.h"
+#include "audio/mixer/SoftwareMixer.h"
+#endif
+
 using namespace cocos2d;
 using namespace cocos2d::ui;
 using namespace cocos2d::experimental;
@@ -39,9 +45,14 @@ AudioEngineTests::AudioEngineTests()
     ADD_TEST_CASE(AudioProfileTest);
     ADD_TEST_CASE(InvalidAudioFileTest);
     ADD_TEST_CASE(LargeAudioFileTest);
+    ADD_TEST_CASE(AudioStreamTest);
+    ADD_TEST_CASE(AudioMetricsTest);
     ADD_TEST_CASE(AudioPerformanceTest);
     ADD_TEST_CASE(AudioSwitchStateTest);
     ADD_TEST_CASE(AudioSmallFileTest);
+#if AUDIO_MIXER_BENCHMARK_ENABLED
+    ADD_TEST_CASE(AudioMixerBenchmarkTest);
+#endif
 }
 
 namespace {
@@ -617,6 +628,135 @@ std::string LargeAudioFileTest::title() const
     return "Test large audio file";
 }
 
+// AudioStreamTest
+bool AudioStreamTest::init()
+{
+    auto ret = AudioEngineTestDemo::init();
+    
+    _audioID = AudioEngine::INVALID_AUDIO_ID;
+    
+    auto playItem = TextButton::create("play streamed music", [&](TextButton* button){
+        if (_audioID == AudioEngine::INVALID_AUDIO_ID) {
+            AudioProfile profile;
+            profile.name = "AudioStreamTest";
+            profile.stream = true;
+            _audioID = AudioEngine::play2d("audio/LuckyDay.mp3", false, 1.0f, &profile);
+            
+            if (_audioID != AudioEngine::INVALID_AUDIO_ID) {
+                AudioEngine::setFinishCallback(_audioID, [&](int id, const std::string& filePath){
+                    _audioID = AudioEngine::INVALID_AUDIO_ID;
+                });
+            }
+        }
+    });
+    playItem->setNormalizedPosition(Vec2(0.3f, 0.7f));
+    this->addChild(playItem);
+    
+    auto queueItem = TextButton::create("play background next", [&](TextButton* button){
+        if (_audioID != AudioEngine::INVALID_AUDIO_ID && !AudioEngine::playNext(_audioID, "background.mp3")) {
+            log("AudioStreamTest: the audio engine doesn't stream on this platform");
+        }
+    });
+    queueItem->setNormalizedPosition(Vec2(0.7f, 0.7f));
+    this->addChild(queueItem);
+    
+    auto loopItem = TextButton::create("toggle loop", [&](TextButton* button){
+        if (_audioID != AudioEngine::INVALID_AUDIO_ID) {
+            AudioEngine::setLoop(_audioID, !AudioEngine::isLoop(_audioID));
+        }
+    });
+    loopItem->setNormalizedPosition(Vec2(0.3f, 0.55f));
+    this->addChild(loopItem);
+    
+    auto seekItem = TextButton::create("seek to 60s", [&](TextButton* button){
+        if (_audioID != AudioEngine::INVALID_AUDIO_ID) {
+            AudioEngine::setCurrentTime(_audioID, 60.0f);
+        }
+    });
+    seekItem->setNormalizedPosition(Vec2(0.7f, 0.55f));
+    this->addChild(seekItem);
+    
+    _stateLabel = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _stateLabel->setNormalizedPosition(Vec2(0.5f, 0.35f));
+    this->addChild(_stateLabel);
+    
+    this->schedule(CC_SCHEDULE_SELECTOR(AudioStreamTest::updateState), 0.1f);
+    
+    return ret;
+}
+
+void AudioStreamTest::updateState(float dt)
+{
+    if (_audioID == AudioEngine::INVALID_AUDIO_ID) {
+        _stateLabel->setString("stopped");
+        return;
+    }
+    
+    _stateLabel->setString(StringUtils::format("time %.1f / %.1f s, loop %s", AudioEngine::getCurrentTime(_audioID),
+                                               AudioEngine::getDuration(_audioID), AudioEngine::isLoop(_audioID) ? "on" : "off"));
+}
+
+AudioStreamTest::~AudioStreamTest()
+{
+}
+
+std::string AudioStreamTest::title() const
+{
+    return "Test streamed music";
+}
+
+std::string AudioStreamTest::subtitle() const
+{
+    return "The next music starts without a gap";
+}
+
+// AudioMetricsTest
+bool AudioMetricsTest::init()
+{
+    auto ret = AudioEngineTestDemo::init();
+    
+    auto playItem = TextButton::create("play 10 effects", [&](TextButton* button){
+        char path[64];
+        for (int index = 0; index < 10; ++index) {
+            sprintf(path, "audio/SoundEffectsFX009/FX0%d.mp3", 81 + index % 6);
+            AudioEngine::play2d(path);
+        }
+    });
+    playItem->setNormalizedPosition(Vec2(0.3f, 0.75f));
+    this->addChild(playItem);
+    
+    auto resetItem = TextButton::create("reset metrics", [&](TextButton* button){
+        AudioEngine::resetMetrics();
+    });
+    resetItem->setNormalizedPosition(Vec2(0.7f, 0.75f));
+    this->addChild(resetItem);
+    
+    _metricsLabel = Label::createWithTTF("", "fonts/arial.ttf", 10);
+    _metricsLabel->setAnchorPoint(Vec2::ANCHOR_MIDDLE_TOP);
+    _metricsLabel->setNormalizedPosition(Vec2(0.5f, 0.65f));
+    this->addChild(_metricsLabel);
+    
+    AudioEngine::addConsoleCommand();
+    this->schedule(CC_SCHEDULE_SELECTOR(AudioMetricsTest::updateMetrics), 0.5f);
+    
+    return ret;
+}
+
+void AudioMetricsTest::updateMetrics(float dt)
+{
+    _metricsLabel->setString(AudioEngine::getMetricsSummary());
+}
+
+std::string AudioMetricsTest::title() const
+{
+    return "Audio metrics";
+}
+
+std::string AudioMetricsTest::subtitle() const
+{
+    return "Also printed by the 'audio' console command";
+}
+
 bool AudioIssue11143Test::init()
 {
     if (AudioEngineTestDemo::init())
@@ -803,3 +943,142 @@ std::string AudioSmallFileTest::subtitle() const
 {
     return "Should not crash";
 }
+
+/////////////////////////////////////////////////////////////////////////
+
+#if AUDIO_MIXER_BENCHMARK_ENABLED
+
+static const int MIXER_BENCHMARK_VOICES = 64;
+static const int MIXER_BENCHMARK_BUFFERS = 400;
+
+bool AudioMixerBenchmarkTest::init()
+{
+    if (AudioEngineTestDemo::init())
+    {
+        // synthesized clips, mixing them exercises the copy, resampling and upmixing paths
+        const int sampleRates[] = { 22050, 44100, 48000, 32000 };
+        for (int i = 0; i < 8; ++i)
+        {
+            auto clip = std::make_shared<MixerPcm>();
+            clip->sampleRate = sampleRates[i % 4];
+            clip->channelCount = 1 + (i / 4);
+            clip->frameCount = clip->sampleRate * 2;
+            clip->samples.resize(clip->frameCount * clip->channelCount);
+            const float frequency = 220.0f * (i + 1);
+            for (int frame = 0; frame < clip->frameCount; ++frame)
+            {
+                auto sample = (int16_t)(8000 * sinf(2 * M_PI * frequency * frame / clip->sampleRate));
+                for (int c = 0; c < clip->channelCount; ++c)
+                {
+                    clip->samples[frame * clip->channelCount + c] = sample;
+                }
+            }
+            _clips.push_back(clip);
+        }
+
+        auto& layerSize = this->getContentSize();
+
+        auto runItem = TextButton::create("Run benchmark", [this](TextButton* button){
+            runBenchmark();
+        });
+        runItem->setPosition(layerSize.width * 0.5f, layerSize.height * 0.65f);
+        addChild(runItem);
+
+        auto wavItem = TextButton::create("Render to WAV", [this](TextButton* button){
+            renderToWav();
+        });
+        wavItem->setPosition(layerSize.width * 0.5f, layerSize.height * 0.5f);
+        addChild(wavItem);
+
+        _resultLabel = Label::createWithTTF("", "fonts/arial.ttf", 16);
+        _resultLabel->setPosition(layerSize.width * 0.5f, layerSize.height * 0.3f);
+        addChild(_resultLabel);
+
+        return true;
+    }
+    
+    return false;
+}
+
+void AudioMixerBenchmarkTest::runBenchmark()
+{
+    // all the voices mixed, then many more voices than the mixer mixes
+    std::string result = measureMixing(MIXER_BENCHMARK_VOICES, MIXER_BENCHMARK_VOICES);
+    result += "\n" + measureMixing(MIXER_BENCHMARK_VOICES * 4, MIXER_BENCHMARK_VOICES / 2);
+    _resultLabel->setString(result);
+}
+
+std::string AudioMixerBenchmarkTest::measureMixing(int voiceCount, int audibleVoiceCount)
+{
+    // without output the buffers are mixed on this thread, as fast as possible
+    SoftwareMixer mixer;
+    SoftwareMixer::Config config;
+    config.maxVoices = voiceCount;
+    config.maxAudibleVoices = audibleVoiceCount;
+    mixer.init(config, nullptr);
+    for (int i = 0; i < voiceCount; ++i)
+    {
+        mixer.play(_clips[i % _clips.size()].get(), 0.1f, true, i % 3);
+    }
+
+    std::vector<int16_t> buffer(config.framesPerBuffer * config.channelCount);
+    double total = 0;
+    double longest = 0;
+    for (int i = 0; i < MIXER_BENCHMARK_BUFFERS; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        mixer.mix(buffer.data(), config.framesPerBuffer);
+        double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        total += elapsed;
+        longest = std::max(longest, elapsed);
+    }
+
+    double budget = 1000000.0 * config.framesPerBuffer / config.sampleRate;
+    double average = total / MIXER_BENCHMARK_BUFFERS;
+    auto result = StringUtils::format("%d voices (%d virtual): average %.1f us, max %.1f us per buffer, %.2f%% of real time",
+                                      mixer.getActiveVoiceCount(), mixer.getVirtualVoiceCount(), average, longest, 100 * average / budget);
+    log("AudioMixerBenchmarkTest: %s", result.c_str());
+    return result;
+}
+
+void AudioMixerBenchmarkTest::renderToWav()
+{
+    std::string path = FileUtils::getInstance()->getWritablePath() + "mixer-benchmark.wav";
+    auto output = new (std::nothrow) WavMixerOutput(path, false);
+
+    // with a fast output the mixer thread renders as fast as possible
+    SoftwareMixer mixer;
+    SoftwareMixer::Config config;
+    config.maxVoices = MIXER_BENCHMARK_VOICES;
+    config.maxAudibleVoices = MIXER_BENCHMARK_VOICES;
+    config.realtimePriority = false;
+    if (!mixer.init(config, output))
+    {
+        _resultLabel->setString("Can't create " + path);
+        return;
+    }
+    for (int i = 0; i < MIXER_BENCHMARK_VOICES; ++i)
+    {
+        mixer.play(_clips[i % _clips.size()].get(), 0.1f, false);
+    }
+    while (mixer.getActiveVoiceCount() > 0)
+    {
+        mixer.releaseVoices(nullptr);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    mixer.destroy();
+
+    _resultLabel->setString("Mixed clips written to " + path);
+}
+
+std::string AudioMixerBenchmarkTest::title() const
+{
+    return "Software mixer benchmark";
+}
+
+std::string AudioMixerBenchmarkTest::subtitle() const
+{
+    return "64 voices mixed without sound hardware, then 256 voices with 32 audible";
+}
+
+#endif // AUDIO_MIXER_BENCHMARK_ENABLED
@@ -145,6 +145,41 @@ private:
     
 };
 
+class AudioStreamTest : public AudioEngineTestDemo
+{
+public:
+    CREATE_FUNC(AudioStreamTest);
+    
+    virtual ~AudioStreamTest();
+    
+    virtual bool init() override;
+    
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    
+private:
+    void updateState(float dt);
+    
+    int _audioID;
+    cocos2d::Label* _stateLabel;
+};
+
+class AudioMetricsTest : public AudioEngineTestDemo
+{
+public:
+    CREATE_FUNC(AudioMetricsTest);
+    
+    virtual bool init() override;
+    
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    
+private:
+    void updateMetrics(float dt);
+    
+    cocos2d::Label* _metricsLabel;
+};
+
 class AudioLoadTest : public AudioEngineTestDemo
 {
 public:
@@ -199,4 +234,30 @@ public:
     virtual std::string subtitle() const override;
 };
 
+// the software mixer isn't part of the Xcode and Tizen projects
+#if CC_TARGET_PLATFORM != CC_PLATFORM_IOS && CC_TARGET_PLATFORM != CC_PLATFORM_MAC && CC_TARGET_PLATFORM != CC_PLATFORM_TIZEN
+#define AUDIO_MIXER_BENCHMARK_ENABLED 1
+
+namespace cocos2d { namespace experimental { struct MixerPcm; } }
+
+class AudioMixerBenchmarkTest : public AudioEngineTestDemo
+{
+public:
+    CREATE_FUNC(AudioMixerBenchmarkTest);
+    
+    virtual bool init() override;
+    
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+private:
+    void runBenchmark();
+    std::string measureMixing(int voiceCount, int audibleVoiceCount);
+    void renderToWav();
+
+    std::vector<std::shared_ptr<cocos2d::experimental::MixerPcm>> _clips;
+    cocos2d::Label* _resultLabel;
+};
+#endif
+
 #endif /* defined(__NEWAUDIOENGINE_TEST_H_) */
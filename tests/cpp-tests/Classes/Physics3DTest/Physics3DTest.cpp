@@ -29,6 +29,7 @@
 #include "3d/CCBundle3D.h"
 #include "physics3d/CCPhysics3D.h"
 #include "extensions/Particle3D/PU/CCPUParticleSystem3D.h"
+#include <chrono>
 USING_NS_CC_EXT;
 USING_NS_CC;
 
@@ -58,6 +59,8 @@ Physics3DTests::Physics3DTests()
     ADD_TEST_CASE(Physics3DConstraintDemo);
     ADD_TEST_CASE(Physics3DKinematicDemo);
     ADD_TEST_CASE(Physics3DCollisionCallbackDemo);
+    ADD_TEST_CASE(Physics3DCollisionReportDemo);
+    ADD_TEST_CASE(Physics3DRayCastBenchmark);
     ADD_TEST_CASE(Physics3DColliderDemo);
     ADD_TEST_CASE(Physics3DTerrainDemo);
 #endif
@@ -681,6 +684,166 @@ bool Physics3DTerrainDemo::init()
     return true;
 }
 
+std::string Physics3DCollisionReportDemo::subtitle() const
+{
+    return "Physics3D Collision Report";
+}
+
+bool Physics3DCollisionReportDemo::init()
+{
+    if (!Physics3DTestDemo::init())
+        return false;
+    
+    //the contacts of all the objects are gathered after each step, no callback is called
+    auto world = physicsScene->getPhysics3DWorld();
+    world->setCollisionReportEnabled(true);
+    
+    Physics3DRigidBodyDes rbDes;
+    rbDes.mass = 0.0f;
+    rbDes.shape = Physics3DShape::createBox(Vec3(60.0f, 1.0f, 60.0f));
+    
+    auto floor = PhysicsSprite3D::create("Sprite3DTest/box.c3t", &rbDes);
+    floor->setTexture("Sprite3DTest/plane.png");
+    floor->setScaleX(60);
+    floor->setScaleZ(60);
+    this->addChild(floor);
+    floor->setCameraMask((unsigned short)CameraFlag::USER1);
+    floor->syncNodeToPhysics();
+    floor->setSyncFlag(Physics3DComponent::PhysicsSyncFlag::NONE);
+    
+    //the boxes fall asleep once the stack settles, their nodes aren't synchronized anymore
+    const int size = 10;
+    rbDes.mass = 1.f;
+    rbDes.shape = Physics3DShape::createBox(Vec3(0.8f, 0.8f, 0.8f));
+    for (int k = 0; k < size; ++k)
+    {
+        for (int i = 0; i < size; ++i)
+        {
+            for (int j = 0; j < size; ++j)
+            {
+                auto sprite = PhysicsSprite3D::create("Sprite3DTest/box.c3t", &rbDes);
+                sprite->setTexture("Images/CyanSquare.png");
+                sprite->setPosition3D(Vec3(i - size / 2.0f, 5.0f + k, j - size / 2.0f));
+                sprite->syncNodeToPhysics();
+                sprite->setSyncFlag(Physics3DComponent::PhysicsSyncFlag::PHYSICS_TO_NODE);
+                sprite->setCameraMask((unsigned short)CameraFlag::USER1);
+                sprite->setScale(0.8f);
+                this->addChild(sprite);
+            }
+        }
+    }
+    
+    auto label = Label::createWithTTF("", "fonts/arial.ttf", 12);
+    label->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    label->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 70));
+    this->addChild(label);
+    
+    schedule([=](float dt){
+        const auto& report = world->getCollisionReport();
+        int awake = 0;
+        for (auto obj : world->getPhysicsObjects())
+        {
+            if (obj->getObjType() == Physics3DObject::PhysicsObjType::RIGID_BODY
+                && static_cast<Physics3DRigidBody*>(obj)->getRigidBody()->isActive())
+                ++awake;
+        }
+        char text[128];
+        snprintf(text, sizeof(text), "pairs: %d\npoints: %d\nawake bodies: %d",
+                 (int)report.pairs.size(), (int)report.points.size(), awake);
+        label->setString(text);
+    }, 0.25f, "report");
+    
+    physicsScene->setPhysics3DDebugCamera(_camera);
+    
+    return true;
+}
+
+Physics3DRayCastBenchmark::Physics3DRayCastBenchmark()
+: _resultLabel(nullptr)
+, _frames(0)
+, _serialTime(0.0)
+, _batchTime(0.0)
+{
+}
+
+std::string Physics3DRayCastBenchmark::subtitle() const
+{
+    return "Physics3D 10000 Rays Benchmark";
+}
+
+bool Physics3DRayCastBenchmark::init()
+{
+    if (!Physics3DTestDemo::init())
+        return false;
+    
+    //a grid of static pillars, the rays are cast through them from above
+    Physics3DRigidBodyDes rbDes;
+    rbDes.mass = 0.0f;
+    rbDes.shape = Physics3DShape::createBox(Vec3(1.0f, 6.0f, 1.0f));
+    const int size = 20;
+    for (int i = 0; i < size; ++i)
+    {
+        for (int j = 0; j < size; ++j)
+        {
+            auto sprite = PhysicsSprite3D::create("Sprite3DTest/box.c3t", &rbDes);
+            sprite->setTexture("Images/CyanSquare.png");
+            sprite->setPosition3D(Vec3((i - size / 2) * 3.0f, 0.0f, (j - size / 2) * 3.0f));
+            sprite->setScaleY(6.0f);
+            sprite->syncNodeToPhysics();
+            sprite->setSyncFlag(Physics3DComponent::PhysicsSyncFlag::NONE);
+            sprite->setCameraMask((unsigned short)CameraFlag::USER1);
+            this->addChild(sprite);
+        }
+    }
+    
+    const int rayCount = 10000;
+    const float extent = size * 1.5f + 5.0f;
+    _rays.resize(rayCount);
+    _results.resize(rayCount);
+    for (auto& ray : _rays)
+    {
+        ray.startPos = Vec3(RandomHelper::random_real(-extent, extent), 20.0f, RandomHelper::random_real(-extent, extent));
+        ray.endPos = Vec3(RandomHelper::random_real(-extent, extent), -5.0f, RandomHelper::random_real(-extent, extent));
+    }
+    
+    _resultLabel = Label::createWithTTF("", "fonts/arial.ttf", 12);
+    _resultLabel->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    _resultLabel->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 70));
+    this->addChild(_resultLabel);
+    
+    scheduleUpdate();
+    
+    return true;
+}
+
+void Physics3DRayCastBenchmark::update(float delta)
+{
+    auto world = physicsScene->getPhysics3DWorld();
+    
+    auto start = std::chrono::steady_clock::now();
+    int serialHits = 0;
+    Physics3DWorld::HitResult result;
+    for (const auto& ray : _rays)
+    {
+        if (world->rayCast(ray.startPos, ray.endPos, &result))
+            ++serialHits;
+    }
+    auto middle = std::chrono::steady_clock::now();
+    int batchHits = world->rayCastBatch(_rays.data(), (int)_rays.size(), _results.data());
+    auto end = std::chrono::steady_clock::now();
+    
+    _serialTime += std::chrono::duration_cast<std::chrono::microseconds>(middle - start).count();
+    _batchTime += std::chrono::duration_cast<std::chrono::microseconds>(end - middle).count();
+    if (++_frames == 60)
+    {
+        _resultLabel->setString(StringUtils::format("rayCast: %.1f us, %d hits\nrayCastBatch on %d threads: %.1f us, %d hits",
+            _serialTime / _frames, serialHits, WorkerPool::getInstance()->getWorkerCount() + 1, _batchTime / _frames, batchHits));
+        _frames = 0;
+        _serialTime = 0.0;
+        _batchTime = 0.0;
+    }
+}
+
 std::string Physics3DTerrainDemo::subtitle() const 
 {
     return "Physics3D Terrain";
@@ -26,6 +26,7 @@
 #define _PHYSICS3D_TEST_H_
 
 #include "../BaseTest.h"
+#include "physics3d/CCPhysics3DWorld.h"
 #include <string>
 
 namespace cocos2d {
@@ -132,6 +133,41 @@ public:
     virtual bool init() override;
 };
 
+class Physics3DCollisionReportDemo : public Physics3DTestDemo
+{
+public:
+
+    CREATE_FUNC(Physics3DCollisionReportDemo);
+    Physics3DCollisionReportDemo(){};
+    virtual ~Physics3DCollisionReportDemo(){};
+
+    virtual std::string subtitle() const override;
+
+    virtual bool init() override;
+};
+
+class Physics3DRayCastBenchmark : public Physics3DTestDemo
+{
+public:
+
+    CREATE_FUNC(Physics3DRayCastBenchmark);
+    Physics3DRayCastBenchmark();
+    virtual ~Physics3DRayCastBenchmark(){};
+
+    virtual std::string subtitle() const override;
+
+    virtual bool init() override;
+    virtual void update(float delta) override;
+
+private:
+    std::vector<cocos2d::Physics3DWorld::RayQuery> _rays;
+    std::vector<cocos2d::Physics3DWorld::HitResult> _results;
+    cocos2d::Label* _resultLabel;
+    int _frames;
+    double _serialTime;
+    double _batchTime;
+};
+
 class Physics3DTerrainDemo : public Physics3DTestDemo
 {
 public:
@@ -2,6 +2,7 @@
 
 #if CC_USE_PHYSICS
 
+#include <chrono>
 #include <cmath>
 #include "ui/CocosGUI.h"
 #include "../testResource.h"
@@ -28,6 +29,9 @@ PhysicsTests::PhysicsTests()
     ADD_TEST_CASE(PhysicsTransformTest);
     ADD_TEST_CASE(PhysicsIssue9959);
     ADD_TEST_CASE(PhysicsIssue15932);
+    ADD_TEST_CASE(PhysicsLargeSceneBenchmark);
+    ADD_TEST_CASE(PhysicsSolverBenchmark);
+    ADD_TEST_CASE(PhysicsContactBatchBenchmark);
 }
 
 namespace
@@ -1887,4 +1891,308 @@ std::string PhysicsIssue15932::subtitle() const
     return "addComponent()/removeComponent() should not crash";
 }
 
+namespace
+{
+    const int BENCHMARK_REPORT_FRAMES = 60;
+
+    const int LARGE_SCENE_GROUPS = 150;
+    const int LARGE_SCENE_NODES_PER_GROUP = 100;
+    const int LARGE_SCENE_BODIES = 300;
+
+    const int SOLVER_BENCHMARK_BODIES = 3000;
+    const float SOLVER_BENCHMARK_RADIUS = 3.0f;
+
+    struct SolverSettings
+    {
+        const char* name;
+        int threads;
+        int iterations;
+        float slop;
+        bool spatialHash;
+        float sleepTime;
+    };
+
+    const int CONTACT_BENCHMARK_BODIES = 500;
+
+    const SolverSettings SOLVER_SETTINGS[] = {
+        { "default: bounding box tree, 10 iterations, a thread per processor", 0, 10, 0.1f, false, PHYSICS_INFINITY },
+        { "1 solver thread", 1, 10, 0.1f, false, PHYSICS_INFINITY },
+        { "spatial hash", 0, 10, 0.1f, true, PHYSICS_INFINITY },
+        { "spatial hash, 5 iterations, slop 0.5", 0, 5, 0.5f, true, PHYSICS_INFINITY },
+        { "spatial hash, 5 iterations, sleep after 0.5 s", 0, 5, 0.1f, true, 0.5f },
+    };
+}
+
+PhysicsBenchmarkDemo::PhysicsBenchmarkDemo()
+: _resultLabel(nullptr)
+, _frames(0)
+, _totalTime(0.0)
+, _maxTime(0.0)
+{
+}
+
+void PhysicsBenchmarkDemo::onEnter()
+{
+    PhysicsDemo::onEnter();
+
+    _resultLabel = Label::createWithTTF("", "fonts/arial.ttf", 16);
+    _resultLabel->setPosition(VisibleRect::center() + Vec2(0, VisibleRect::getVisibleRect().size.height / 4));
+    addChild(_resultLabel, 1);
+
+    _frames = 0;
+    _totalTime = 0.0;
+    _maxTime = 0.0;
+    _physicsWorld->setAutoStep(false);
+    scheduleUpdate();
+}
+
+void PhysicsBenchmarkDemo::onExit()
+{
+    _physicsWorld->setAutoStep(true);
+    PhysicsDemo::onExit();
+}
+
+void PhysicsBenchmarkDemo::update(float delta)
+{
+    auto start = std::chrono::steady_clock::now();
+    _physicsWorld->step(delta);
+    auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    _totalTime += time;
+    _maxTime = std::max(_maxTime, (double)time);
+    if (++_frames == BENCHMARK_REPORT_FRAMES)
+    {
+        _resultLabel->setString(StringUtils::format("%s\nstep average %.1f us, max %.1f us",
+            getBenchmarkDescription().c_str(), _totalTime / _frames, _maxTime));
+        _frames = 0;
+        _totalTime = 0.0;
+        _maxTime = 0.0;
+    }
+}
+
+PhysicsLargeSceneBenchmark::PhysicsLargeSceneBenchmark()
+: _nodeCount(0)
+{
+}
+
+void PhysicsLargeSceneBenchmark::onEnter()
+{
+    PhysicsBenchmarkDemo::onEnter();
+
+    // nodes without physics bodies, hidden so that rendering doesn't hide the cost of the physics step
+    auto scenery = Node::create();
+    scenery->setVisible(false);
+    addChild(scenery);
+    _nodeCount = 1;
+    for (int i = 0; i < LARGE_SCENE_GROUPS; ++i)
+    {
+        auto group = Node::create();
+        group->setPosition(i % 15 * 30.0f, i / 15 * 30.0f);
+        scenery->addChild(group);
+        for (int j = 0; j < LARGE_SCENE_NODES_PER_GROUP; ++j)
+        {
+            auto node = Node::create();
+            node->setPosition(j * 2.0f, j * 1.5f);
+            node->setRotation(j * 3.6f);
+            group->addChild(node);
+        }
+        _nodeCount += LARGE_SCENE_NODES_PER_GROUP + 1;
+    }
+
+    auto wall = Node::create();
+    wall->addComponent(PhysicsBody::createEdgeBox(VisibleRect::getVisibleRect().size, PhysicsMaterial(0.1f, 0.5f, 0.5f)));
+    wall->setPosition(VisibleRect::center());
+    addChild(wall);
+
+    auto balls = Node::create();
+    addChild(balls);
+    auto size = VisibleRect::getVisibleRect().size;
+    for (int i = 0; i < LARGE_SCENE_BODIES; ++i)
+    {
+        auto position = VisibleRect::leftBottom() + Vec2(size.width * (0.1f + 0.8f * CCRANDOM_0_1()), size.height * (0.2f + 0.7f * CCRANDOM_0_1()));
+        balls->addChild(makeBall(position, 1.5f + CCRANDOM_0_1(), PhysicsMaterial(0.1f, 0.5f, 0.5f)));
+    }
+}
+
+std::string PhysicsLargeSceneBenchmark::getBenchmarkDescription() const
+{
+    return StringUtils::format("%d nodes, %d bodies", _nodeCount, (int)_physicsWorld->getAllBodies().size());
+}
+
+std::string PhysicsLargeSceneBenchmark::title() const
+{
+    return "Large Scene Benchmark";
+}
+
+std::string PhysicsLargeSceneBenchmark::subtitle() const
+{
+    return "Physics step time with 15000 nodes without body";
+}
+
+int PhysicsSolverBenchmark::_settingsIndex = 0;
+
+void PhysicsSolverBenchmark::onEnter()
+{
+    PhysicsBenchmarkDemo::onEnter();
+
+    // the settings are applied before the bodies are added, the broadphase can't go back to the bounding box tree
+    auto& settings = SOLVER_SETTINGS[_settingsIndex];
+    _physicsWorld->setSolverThreads(settings.threads);
+    _physicsWorld->setIterations(settings.iterations);
+    _physicsWorld->setCollisionSlop(settings.slop);
+    _physicsWorld->setSleepTimeThreshold(settings.sleepTime);
+    if (settings.spatialHash)
+    {
+        _physicsWorld->useSpatialHash(SOLVER_BENCHMARK_RADIUS * 2, SOLVER_BENCHMARK_BODIES * 10);
+    }
+
+    MenuItemFont::setFontSize(18);
+    auto item = MenuItemFont::create("Next settings", [this](Ref*) {
+        _settingsIndex = (_settingsIndex + 1) % (sizeof(SOLVER_SETTINGS) / sizeof(SOLVER_SETTINGS[0]));
+        getTestSuite()->restartCurrTest();
+    });
+    auto menu = Menu::create(item, nullptr);
+    menu->setPosition(VisibleRect::right() - Vec2(item->getContentSize().width / 2 + 10, 0));
+    addChild(menu, 1);
+
+    auto wall = Node::create();
+    wall->addComponent(PhysicsBody::createEdgeBox(VisibleRect::getVisibleRect().size, PhysicsMaterial(0.1f, 0.0f, 0.5f)));
+    wall->setPosition(VisibleRect::center());
+    addChild(wall);
+
+    auto balls = SpriteBatchNode::create("Images/ball.png", SOLVER_BENCHMARK_BODIES);
+    addChild(balls);
+    auto size = VisibleRect::getVisibleRect().size;
+    for (int i = 0; i < SOLVER_BENCHMARK_BODIES; ++i)
+    {
+        auto position = VisibleRect::leftBottom() + Vec2(size.width * (0.05f + 0.9f * CCRANDOM_0_1()), size.height * (0.05f + 0.9f * CCRANDOM_0_1()));
+        auto ball = Sprite::createWithTexture(balls->getTexture());
+        ball->setScale(0.13f * SOLVER_BENCHMARK_RADIUS);
+        ball->addComponent(PhysicsBody::createCircle(ball->getContentSize().width / 2, PhysicsMaterial(0.1f, 0.0f, 0.5f)));
+        ball->setPosition(position);
+        balls->addChild(ball);
+    }
+}
+
+std::string PhysicsSolverBenchmark::getBenchmarkDescription() const
+{
+    return StringUtils::format("%s\n%d bodies, %d solver threads", SOLVER_SETTINGS[_settingsIndex].name,
+        (int)_physicsWorld->getAllBodies().size(), _physicsWorld->getSolverThreads());
+}
+
+std::string PhysicsSolverBenchmark::title() const
+{
+    return "Solver Settings Benchmark";
+}
+
+std::string PhysicsSolverBenchmark::subtitle() const
+{
+    return "Physics step time of 3000 bodies, touch Next settings to compare";
+}
+
+bool PhysicsContactBatchBenchmark::_batched = false;
+
+PhysicsContactBatchBenchmark::PhysicsContactBatchBenchmark()
+: _contacts(0)
+, _events(0)
+, _eventsPerStep(0)
+{
+}
+
+void PhysicsContactBatchBenchmark::onEnter()
+{
+    PhysicsBenchmarkDemo::onEnter();
+
+    _contacts = 0;
+    _events = 0;
+    _eventsPerStep = 0;
+
+    if (_batched)
+    {
+        _physicsWorld->setContactBatchCallback([this](PhysicsWorld& world, const std::vector<PhysicsContactEvent>& events) {
+            for (auto& event : events)
+            {
+                if (event.eventCode == PhysicsContact::EventCode::BEGIN)
+                {
+                    ++_contacts;
+                }
+                else if (event.eventCode == PhysicsContact::EventCode::SEPARATE)
+                {
+                    --_contacts;
+                }
+            }
+            _events += (int)events.size();
+        }, PhysicsWorld::CONTACT_EVENT_BEGIN | PhysicsWorld::CONTACT_EVENT_POSTSOLVE | PhysicsWorld::CONTACT_EVENT_SEPARATE);
+    }
+    else
+    {
+        auto contactListener = EventListenerPhysicsContact::create();
+        contactListener->onContactBegin = [this](PhysicsContact& contact) {
+            ++_contacts;
+            ++_events;
+            return true;
+        };
+        contactListener->onContactPostSolve = [this](PhysicsContact& contact, const PhysicsContactPostSolve& solve) {
+            ++_events;
+        };
+        contactListener->onContactSeparate = [this](PhysicsContact& contact) {
+            --_contacts;
+            ++_events;
+        };
+        _eventDispatcher->addEventListenerWithSceneGraphPriority(contactListener, this);
+    }
+
+    MenuItemFont::setFontSize(18);
+    auto item = MenuItemFont::create(_batched ? "Use listeners" : "Use batches", [this](Ref*) {
+        _batched = !_batched;
+        getTestSuite()->restartCurrTest();
+    });
+    auto menu = Menu::create(item, nullptr);
+    menu->setPosition(VisibleRect::right() - Vec2(item->getContentSize().width / 2 + 10, 0));
+    addChild(menu, 1);
+
+    auto wall = Node::create();
+    wall->addComponent(PhysicsBody::createEdgeBox(VisibleRect::getVisibleRect().size, PhysicsMaterial(0.1f, 0.0f, 0.5f)));
+    wall->setPosition(VisibleRect::center());
+    addChild(wall);
+
+    auto size = VisibleRect::getVisibleRect().size;
+    for (int i = 0; i < CONTACT_BENCHMARK_BODIES; ++i)
+    {
+        auto position = VisibleRect::leftBottom() + Vec2(size.width * (0.3f + 0.4f * CCRANDOM_0_1()), size.height * (0.05f + 0.9f * CCRANDOM_0_1()));
+        auto box = makeBox(position, Size(10, 10), 0, PhysicsMaterial(0.1f, 0.0f, 0.5f));
+        box->getPhysicsBody()->setContactTestBitmask(0xFFFFFFFF);
+        addChild(box);
+    }
+}
+
+void PhysicsContactBatchBenchmark::onExit()
+{
+    _physicsWorld->setContactBatchCallback(nullptr);
+    PhysicsBenchmarkDemo::onExit();
+}
+
+void PhysicsContactBatchBenchmark::update(float delta)
+{
+    _events = 0;
+    PhysicsBenchmarkDemo::update(delta);
+    _eventsPerStep = _events;
+}
+
+std::string PhysicsContactBatchBenchmark::getBenchmarkDescription() const
+{
+    return StringUtils::format("%s: %d bodies, %d contacts, %d events per step", _batched ? "batches" : "listeners",
+        (int)_physicsWorld->getAllBodies().size(), _contacts, _eventsPerStep);
+}
+
+std::string PhysicsContactBatchBenchmark::title() const
+{
+    return "Contact Batch Benchmark";
+}
+
+std::string PhysicsContactBatchBenchmark::subtitle() const
+{
+    return "Physics step time with contact listeners or batches";
+}
+
 #endif
\ No newline at end of file
@@ -277,4 +277,80 @@ public:
     virtual std::string subtitle() const override;
 };
 
+// times the physics step, which is done by the test instead of the world
+class PhysicsBenchmarkDemo : public PhysicsDemo
+{
+public:
+    PhysicsBenchmarkDemo();
+
+    void onEnter() override;
+    void onExit() override;
+    virtual void update(float delta) override;
+
+protected:
+    virtual std::string getBenchmarkDescription() const = 0;
+
+    cocos2d::Label* _resultLabel;
+    int _frames;
+    double _totalTime;
+    double _maxTime;
+};
+
+class PhysicsLargeSceneBenchmark : public PhysicsBenchmarkDemo
+{
+public:
+    CREATE_FUNC(PhysicsLargeSceneBenchmark);
+
+    PhysicsLargeSceneBenchmark();
+
+    void onEnter() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+protected:
+    virtual std::string getBenchmarkDescription() const override;
+
+private:
+    int _nodeCount;
+};
+
+class PhysicsSolverBenchmark : public PhysicsBenchmarkDemo
+{
+public:
+    CREATE_FUNC(PhysicsSolverBenchmark);
+
+    void onEnter() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+protected:
+    virtual std::string getBenchmarkDescription() const override;
+
+private:
+    static int _settingsIndex;
+};
+
+class PhysicsContactBatchBenchmark : public PhysicsBenchmarkDemo
+{
+public:
+    CREATE_FUNC(PhysicsContactBatchBenchmark);
+
+    PhysicsContactBatchBenchmark();
+
+    void onEnter() override;
+    void onExit() override;
+    virtual void update(float delta) override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+protected:
+    virtual std::string getBenchmarkDescription() const override;
+
+private:
+    static bool _batched;
+    int _contacts;
+    int _events;
+    int _eventsPerStep;
+};
+
 #endif // #if CC_USE_PHYSICS
\ No newline at end of file
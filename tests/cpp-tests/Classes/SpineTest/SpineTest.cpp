@@ -45,6 +45,8 @@ SpineTests::SpineTests()
     ADD_TEST_CASE(SpineTestLayerFFD);
     ADD_TEST_CASE(SpineTestPerformanceLayer);
     ADD_TEST_CASE(SpineTestLayerRapor);
+    ADD_TEST_CASE(SpineTestParallelUpdate);
+    ADD_TEST_CASE(SpineTestLoadBenchmark);
 }
 
 bool SpineTestLayerNormal::init () {
@@ -200,3 +202,158 @@ bool SpineTestLayerRapor::init () {
     
     return true;
 }
+
+SpineTestParallelUpdate::SpineTestParallelUpdate()
+    : _atlas(nullptr)
+    , _attachmentLoader(nullptr)
+    , _skeletonData(nullptr)
+    , _resultLabel(nullptr)
+    , _beforeUpdateListener(nullptr)
+    , _afterVisitListener(nullptr)
+    , _afterDrawListener(nullptr)
+    , _frameTime(0)
+    , _frames(0)
+    , _drawnBatches(0)
+{
+}
+
+SpineTestParallelUpdate::~SpineTestParallelUpdate()
+{
+    // the skeletons must be released before the data they share
+    removeAllChildren();
+    if (_skeletonData) spSkeletonData_dispose(_skeletonData);
+    if (_attachmentLoader) spAttachmentLoader_dispose(_attachmentLoader);
+    if (_atlas) spAtlas_dispose(_atlas);
+}
+
+bool SpineTestParallelUpdate::init () {
+    if (!SpineTestLayer::init()) return false;
+
+    _atlas = spAtlas_createFromFile("spine/raptor.atlas", 0);
+    _attachmentLoader = &Cocos2dAttachmentLoader_create(_atlas)->super;
+    spSkeletonJson* json = spSkeletonJson_createWithLoader(_attachmentLoader);
+    json->scale = 0.5f;
+    _skeletonData = spSkeletonJson_readSkeletonDataFile(json, "spine/raptor.json");
+    spSkeletonJson_dispose(json);
+
+    const int columns = 15, rows = 10;
+    Size visibleSize = VisibleRect::getVisibleRect().size;
+    for (int i = 0; i < columns * rows; ++i)
+    {
+        auto skeletonNode = SkeletonAnimation::createWithData(_skeletonData);
+        skeletonNode->setAnimation(0, "walk", true);
+        skeletonNode->update(CCRANDOM_0_1());
+        skeletonNode->setScale(0.1f);
+        skeletonNode->setPosition(VisibleRect::leftBottom() + Vec2(visibleSize.width * (i % columns + 0.5f) / columns,
+            visibleSize.height * 0.8f * (i / columns) / rows + 10));
+        addChild(skeletonNode);
+    }
+
+    TTFConfig ttfConfig("fonts/arial.ttf", 15);
+    auto modeLabel = Label::createWithTTF(ttfConfig, "Parallel: off");
+    auto modeItem = MenuItemLabel::create(modeLabel, [=](Ref*){
+        auto batch = SkeletonBatch::getInstance();
+        batch->setParallelEnabled(!batch->isParallelEnabled());
+        modeLabel->setString(batch->isParallelEnabled() ? "Parallel: on" : "Parallel: off");
+    });
+    auto menu = Menu::create(modeItem, nullptr);
+    menu->setPosition(Vec2(VisibleRect::right().x - 80, VisibleRect::top().y - 60));
+    addChild(menu, 1);
+
+    _resultLabel = Label::createWithTTF("", "fonts/arial.ttf", 12);
+    _resultLabel->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    _resultLabel->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 50));
+    addChild(_resultLabel, 1);
+
+    return true;
+}
+
+void SpineTestParallelUpdate::onEnter () {
+    SpineTestLayer::onEnter();
+
+    // measure the update and the visit of the scene, where the skeletons are animated and their vertices computed
+    _beforeUpdateListener = _eventDispatcher->addCustomEventListener(Director::EVENT_BEFORE_UPDATE, [this](EventCustom*){
+        _frameStart = std::chrono::steady_clock::now();
+    });
+    _afterVisitListener = _eventDispatcher->addCustomEventListener(Director::EVENT_AFTER_VISIT, [this](EventCustom*){
+        _frameTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _frameStart).count();
+        if (++_frames == 60)
+        {
+            // the skeletons share the atlas, their commands are batched into a few draw calls by the renderer
+            _resultLabel->setString(StringUtils::format("update and visit: %.2f ms, %d workers\nspine commands: %d, draw calls: %d",
+                _frameTime / 60 / 1000.0f, WorkerPool::getInstance()->getWorkerCount(),
+                SkeletonBatch::getInstance()->getCommandCount(), (int)_drawnBatches));
+            _frameTime = 0;
+            _frames = 0;
+        }
+    });
+    _afterDrawListener = _eventDispatcher->addCustomEventListener(Director::EVENT_AFTER_DRAW, [this](EventCustom*){
+        _drawnBatches = Director::getInstance()->getRenderer()->getDrawnBatches();
+    });
+}
+
+void SpineTestParallelUpdate::onExit () {
+    _eventDispatcher->removeEventListener(_beforeUpdateListener);
+    _eventDispatcher->removeEventListener(_afterVisitListener);
+    _eventDispatcher->removeEventListener(_afterDrawListener);
+    SkeletonBatch::getInstance()->setParallelEnabled(false);
+
+    SpineTestLayer::onExit();
+}
+
+bool SpineTestLoadBenchmark::init () {
+    if (!SpineTestLayer::init()) return false;
+
+    // the skeleton data read from the binary file is kept in the cache while this skeleton exists
+    auto skeletonNode = SkeletonAnimation::createWithFile("spine/raptor.skel", "spine/raptor.atlas", 0.5f);
+    skeletonNode->setAnimation(0, "walk", true);
+    skeletonNode->setScale(0.5f);
+    skeletonNode->setPosition(Vec2(VisibleRect::center().x, VisibleRect::bottom().y + 20));
+    addChild(skeletonNode);
+
+    TTFConfig ttfConfig("fonts/arial.ttf", 15);
+    auto runItem = MenuItemLabel::create(Label::createWithTTF(ttfConfig, "Run again"), [this](Ref*){
+        runBenchmark();
+    });
+    auto menu = Menu::create(runItem, nullptr);
+    menu->setPosition(Vec2(VisibleRect::right().x - 80, VisibleRect::top().y - 60));
+    addChild(menu, 1);
+
+    _resultLabel = Label::createWithTTF("", "fonts/arial.ttf", 12);
+    _resultLabel->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    _resultLabel->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 50));
+    addChild(_resultLabel, 1);
+
+    runBenchmark();
+
+    return true;
+}
+
+void SpineTestLoadBenchmark::runBenchmark () {
+    static const int LOAD_COUNT = 20;
+
+    spAtlas* atlas = spAtlas_createFromFile("spine/raptor.atlas", 0);
+    auto timeLoads = [atlas](const std::string& skeletonDataFile) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < LOAD_COUNT; ++i)
+        {
+            spAttachmentLoader* attachmentLoader = &Cocos2dAttachmentLoader_create(atlas)->super;
+            spSkeletonData* skeletonData = SkeletonDataCache::readSkeletonData(skeletonDataFile, attachmentLoader, 0.5f);
+            if (skeletonData) spSkeletonData_dispose(skeletonData);
+            spAttachmentLoader_dispose(attachmentLoader);
+        }
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / LOAD_COUNT / 1000.0f;
+    };
+    float jsonTime = timeLoads("spine/raptor.json");
+    float binaryTime = timeLoads("spine/raptor.skel");
+    spAtlas_dispose(atlas);
+
+    // the skeleton shown retains the data, every creation is a cache hit
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < LOAD_COUNT; ++i)
+        SkeletonAnimation::createWithFile("spine/raptor.skel", "spine/raptor.atlas", 0.5f);
+    float cachedTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / LOAD_COUNT / 1000.0f;
+
+    _resultLabel->setString(StringUtils::format("raptor, per skeleton:\nJSON: %.2f ms\nbinary: %.2f ms\ncached: %.3f ms",
+        jsonTime, binaryTime, cachedTime));
+}
@@ -29,6 +29,7 @@
 #include "cocos2d.h"
 #include "../BaseTest.h"
 #include <spine/spine-cocos2dx.h>
+#include <chrono>
 
 DEFINE_TEST_SUITE(SpineTests);
 
@@ -115,4 +116,58 @@ public:
 	CREATE_FUNC (SpineTestPerformanceLayer);
 };
 
+class SpineTestParallelUpdate: public SpineTestLayer
+{
+public:
+    CREATE_FUNC(SpineTestParallelUpdate);
+    SpineTestParallelUpdate();
+    virtual ~SpineTestParallelUpdate();
+
+    virtual std::string title() const override
+    {
+        return "Spine Test";
+    }
+    virtual std::string subtitle() const override
+    {
+        return "150 skeletons, parallel update and vertices";
+    }
+    virtual bool init () override;
+    virtual void onEnter () override;
+    virtual void onExit () override;
+
+private:
+    spAtlas* _atlas;
+    spAttachmentLoader* _attachmentLoader;
+    spSkeletonData* _skeletonData;
+    cocos2d::Label* _resultLabel;
+    cocos2d::EventListenerCustom* _beforeUpdateListener;
+    cocos2d::EventListenerCustom* _afterVisitListener;
+    cocos2d::EventListenerCustom* _afterDrawListener;
+    std::chrono::steady_clock::time_point _frameStart;
+    long long _frameTime;
+    int _frames;
+    ssize_t _drawnBatches;
+};
+
+class SpineTestLoadBenchmark: public SpineTestLayer
+{
+public:
+    CREATE_FUNC(SpineTestLoadBenchmark);
+
+    virtual std::string title() const override
+    {
+        return "Spine Test";
+    }
+    virtual std::string subtitle() const override
+    {
+        return "Load time of JSON, binary and cached skeleton data";
+    }
+    virtual bool init () override;
+
+private:
+    void runBenchmark ();
+
+    cocos2d::Label* _resultLabel;
+};
+
 #endif // _EXAMPLELAYER_H_
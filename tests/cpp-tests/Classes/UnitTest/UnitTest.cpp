@@ -1,6 +1,7 @@
 #include "UnitTest.h"
 #include "RefPtrTest.h"
 #include "ui/UIHelper.h"
+#include "editor-support/cocostudio/ActionTimeline/CSLoader.h"
 
 USING_NS_CC;
 
@@ -45,6 +46,7 @@ UnitTests::UnitTests()
     ADD_TEST_CASE(RefPtrTest);
     ADD_TEST_CASE(UTFConversionTest);
     ADD_TEST_CASE(UIHelperSubStringTest);
+    ADD_TEST_CASE(CSLoaderAsyncTest);
 #ifdef UNIT_TEST_FOR_OPTIMIZED_MATH_UTIL
     ADD_TEST_CASE(MathUtilTest);
 #endif
@@ -1173,3 +1175,70 @@ std::string MathUtilTest::subtitle() const
 {
     return "MathUtilTest";
 }
+
+// CSLoaderAsyncTest
+
+static std::string describeNodeTree(Node* node)
+{
+    std::string description = StringUtils::format("%s:%d(", node->getName().c_str(), node->getTag());
+    for (auto child : node->getChildren())
+    {
+        description += describeNodeTree(child);
+    }
+    return description + ")";
+}
+
+void CSLoaderAsyncTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    // the nested project node of TestAnimation.csb, the sprites and particles of DemoPlayer.csb
+    // must give the same trees as the synchronous loading
+    const char* files[] = {"ActionTimeline/TestAnimation.csb", "ActionTimeline/DemoPlayer.csb"};
+    auto label = Label::createWithSystemFont("Loading...", "", 20);
+    label->setPosition(VisibleRect::center());
+    addChild(label);
+
+    auto pendingLoads = std::make_shared<int>(3);
+    auto failures = std::make_shared<int>(0);
+    auto onLoaded = [this, label, pendingLoads, failures](bool succeed) {
+        if (!succeed)
+        {
+            ++*failures;
+        }
+        if (--*pendingLoads == 0)
+        {
+            label->setString(*failures == 0 ? "Passed" : StringUtils::format("%d failures, see the log", *failures));
+        }
+        // the test is kept alive until its loads are done
+        release();
+    };
+
+    for (auto file : files)
+    {
+        std::string expected = describeNodeTree(CSLoader::createNode(file));
+        retain();
+        CSLoader::createNodeAsync(file, [file, expected, onLoaded](Node* node) {
+            bool succeed = node && describeNodeTree(node) == expected;
+            if (!succeed)
+            {
+                CCLOG("CSLoaderAsyncTest: the tree of %s differs from the synchronous one", file);
+            }
+            onLoaded(succeed);
+        });
+    }
+
+    retain();
+    CSLoader::createNodeAsync("ActionTimeline/NotExisting.csb", [onLoaded](Node* node) {
+        if (node)
+        {
+            CCLOG("CSLoaderAsyncTest: a node was created for a missing file");
+        }
+        onLoaded(node == nullptr);
+    });
+}
+
+std::string CSLoaderAsyncTest::subtitle() const
+{
+    return "CSLoader::createNodeAsync gives the trees of createNode";
+}
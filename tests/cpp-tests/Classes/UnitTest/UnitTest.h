@@ -64,4 +64,12 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class CSLoaderAsyncTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(CSLoaderAsyncTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
 #endif /* __UNIT_TEST__ */
@@ -0,0 +1,263 @@
+#include "PerformanceArmatureTest.h"
+#include "editor-support/cocostudio/CocoStudio.h"
+#include "Profile.h"
+
+USING_NS_CC;
+using namespace cocostudio;
+
+#define DELAY_TIME              4
+#define STAT_TIME               3
+
+static const int kArmatureCount = 200;
+static const char* kArmatureName = "PerformanceArmature";
+
+PerformceArmatureTests::PerformceArmatureTests()
+{
+    ADD_TEST_CASE(ArmaturePerformTest);
+    ADD_TEST_CASE(ArmatureBatchNodePerformTest);
+}
+
+// A walking figure built in code, the body and the head keep their pose while the limbs swing.
+static void addArmatureData()
+{
+    auto dataManager = ArmatureDataManager::getInstance();
+    if (dataManager->getArmatureData(kArmatureName))
+        return;
+
+    SpriteFrameCache::getInstance()->addSpriteFramesWithFile("Images/grossini_quad.plist");
+
+    struct BoneInfo
+    {
+        const char* name;
+        const char* parentName;
+        const char* displayName;
+        float x, y;
+        float swing;
+    };
+    static const BoneInfo bones[] = {
+        { "body", "", "grossini_dance_05.png", 0, 0, 0 },
+        { "head", "body", "grossini_dance_06.png", 0, 40, 0 },
+        { "armL", "body", "grossini_dance_08.png", -25, 10, 0.6f },
+        { "armR", "body", "grossini_dance_08.png", 25, 10, -0.6f },
+        { "legL", "body", "grossini_dance_10.png", -10, -40, 0.4f },
+        { "legR", "body", "grossini_dance_10.png", 10, -40, -0.4f },
+    };
+    const int duration = 40;
+
+    auto armatureData = ArmatureData::create();
+    armatureData->name = kArmatureName;
+    armatureData->dataVersion = VERSION_COMBINED;
+
+    auto animationData = AnimationData::create();
+    animationData->name = kArmatureName;
+    auto movementData = MovementData::create();
+    movementData->name = "walk";
+    movementData->duration = duration;
+    movementData->loop = true;
+
+    for (const auto& info : bones)
+    {
+        auto boneData = BoneData::create();
+        boneData->name = info.name;
+        boneData->parentName = info.parentName;
+        boneData->x = info.x;
+        boneData->y = info.y;
+        auto displayData = SpriteDisplayData::create();
+        displayData->displayName = info.displayName;
+        boneData->addDisplayData(displayData);
+        armatureData->addBoneData(boneData);
+
+        // the static bones still have key frames, their tween plays without moving them
+        auto movementBoneData = MovementBoneData::create();
+        movementBoneData->name = info.name;
+        const float angles[] = { info.swing, -info.swing, info.swing };
+        for (int i = 0; i < 3; ++i)
+        {
+            auto frameData = FrameData::create();
+            frameData->frameID = i * duration / 2;
+            frameData->duration = i < 2 ? duration / 2 : 0;
+            frameData->skewX = angles[i];
+            frameData->skewY = -angles[i];
+            movementBoneData->addFrameData(frameData);
+        }
+        movementData->addMovementBoneData(movementBoneData);
+    }
+    animationData->addMovement(movementData);
+
+    dataManager->addArmatureData(kArmatureName, armatureData);
+    dataManager->addAnimationData(kArmatureName, animationData);
+}
+
+////////////////////////////////////////////////////////
+//
+// ArmatureMainScene
+//
+////////////////////////////////////////////////////////
+ArmatureMainScene::ArmatureMainScene()
+: _infoLabel(nullptr)
+, _beforeUpdateListener(nullptr)
+, _afterVisitListener(nullptr)
+, _afterDrawListener(nullptr)
+, _frameTime(0)
+, _frames(0)
+, _drawnBatches(0)
+, isStating(false)
+, statCount(0)
+, totalStatTime(0.0f)
+, minFrameRate(-1.0f)
+, maxFrameRate(-1.0f)
+{
+}
+
+bool ArmatureMainScene::init()
+{
+    if (!TestCase::init())
+        return false;
+
+    addArmatureData();
+
+    Node* parent = this;
+    if (isUsingBatchNode())
+    {
+        parent = BatchNode::create();
+        addChild(parent);
+    }
+
+    const int columns = 20;
+    const int rows = kArmatureCount / columns;
+    auto s = Director::getInstance()->getWinSize();
+    for (int i = 0; i < kArmatureCount; ++i)
+    {
+        auto armature = Armature::create(kArmatureName);
+        armature->getAnimation()->play("walk");
+        armature->getAnimation()->gotoAndPlay(i % 40);
+        armature->setScale(0.3f);
+        armature->setPosition(Vec2(s.width * (i % columns + 0.5f) / columns, s.height * 0.1f + s.height * 0.7f * (i / columns) / rows));
+        parent->addChild(armature);
+    }
+
+    _infoLabel = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _infoLabel->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    _infoLabel->setPosition(Vec2(VisibleRect::left().x + 10, VisibleRect::top().y - 80));
+    addChild(_infoLabel, 1);
+
+    return true;
+}
+
+std::string ArmatureMainScene::subtitle() const
+{
+    return genStr("%d armatures of 6 bones, 2 of them static", kArmatureCount);
+}
+
+void ArmatureMainScene::onEnter()
+{
+    TestCase::onEnter();
+
+    // the update and the visit of the scene, where the armatures are animated and their skins drawn
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    _beforeUpdateListener = dispatcher->addCustomEventListener(Director::EVENT_BEFORE_UPDATE, [this](EventCustom*){
+        _frameStart = std::chrono::steady_clock::now();
+    });
+    _afterVisitListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_VISIT, [this](EventCustom*){
+        _frameTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _frameStart).count();
+        if (++_frames == 60)
+        {
+            _infoLabel->setString(genStr("update and visit: %.2f ms\ndraw calls: %d", _frameTime / 60 / 1000.0f, (int)_drawnBatches));
+            _frameTime = 0;
+            _frames = 0;
+        }
+    });
+    _afterDrawListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_DRAW, [this](EventCustom*){
+        _drawnBatches = Director::getInstance()->getRenderer()->getDrawnBatches();
+    });
+
+    if (isAutoTesting())
+    {
+        Profile::getInstance()->testCaseBegin(isUsingBatchNode() ? "ArmatureBatchNodeTest" : "ArmatureTest",
+                                              genStrVector("ArmatureCount", nullptr),
+                                              genStrVector("Avg", "Min", "Max", nullptr));
+        doAutoTest();
+        scheduleUpdate();
+    }
+}
+
+void ArmatureMainScene::onExit()
+{
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    dispatcher->removeEventListener(_beforeUpdateListener);
+    dispatcher->removeEventListener(_afterVisitListener);
+    dispatcher->removeEventListener(_afterDrawListener);
+    Director::getInstance()->getScheduler()->unscheduleAllForTarget(this);
+
+    TestCase::onExit();
+}
+
+void ArmatureMainScene::update(float dt)
+{
+    if (isStating)
+    {
+        totalStatTime += dt;
+        statCount++;
+
+        auto curFrameRate = Director::getInstance()->getFrameRate();
+        if (maxFrameRate < 0 || curFrameRate > maxFrameRate)
+            maxFrameRate = curFrameRate;
+
+        if (minFrameRate < 0 || curFrameRate < minFrameRate)
+            minFrameRate = curFrameRate;
+    }
+}
+
+void ArmatureMainScene::beginStat(float dt)
+{
+    unschedule(CC_SCHEDULE_SELECTOR(ArmatureMainScene::beginStat));
+    isStating = true;
+}
+
+void ArmatureMainScene::endStat(float dt)
+{
+    unschedule(CC_SCHEDULE_SELECTOR(ArmatureMainScene::endStat));
+    isStating = false;
+
+    // record test data
+    auto avgStr = genStr("%.2f", (float) statCount / totalStatTime);
+    Profile::getInstance()->addTestResult(genStrVector(genStr("%d", kArmatureCount).c_str(), nullptr),
+                                          genStrVector(avgStr.c_str(), genStr("%.2f", minFrameRate).c_str(),
+                                                       genStr("%.2f", maxFrameRate).c_str(), nullptr));
+
+    // a single case, the auto test ends here
+    Profile::getInstance()->testCaseEnd();
+    setAutoTesting(false);
+}
+
+void ArmatureMainScene::doAutoTest()
+{
+    isStating = false;
+    statCount = 0;
+    totalStatTime = 0.0f;
+    minFrameRate = -1.0f;
+    maxFrameRate = -1.0f;
+
+    schedule(CC_SCHEDULE_SELECTOR(ArmatureMainScene::beginStat), DELAY_TIME);
+    schedule(CC_SCHEDULE_SELECTOR(ArmatureMainScene::endStat), DELAY_TIME + STAT_TIME);
+}
+
+////////////////////////////////////////////////////////
+//
+// ArmaturePerformTest
+//
+////////////////////////////////////////////////////////
+std::string ArmaturePerformTest::title() const
+{
+    return "Armature Test";
+}
+
+////////////////////////////////////////////////////////
+//
+// ArmatureBatchNodePerformTest
+//
+////////////////////////////////////////////////////////
+std::string ArmatureBatchNodePerformTest::title() const
+{
+    return "Armature in BatchNode Test";
+}
@@ -0,0 +1,65 @@
+#ifndef __PERFORMANCE_ARMATURE_TEST_H__
+#define __PERFORMANCE_ARMATURE_TEST_H__
+
+#include "BaseTest.h"
+#include <chrono>
+
+DEFINE_TEST_SUITE(PerformceArmatureTests);
+
+class ArmatureMainScene : public TestCase
+{
+public:
+    virtual bool init() override;
+    virtual std::string subtitle() const override;
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    virtual void update(float dt) override;
+    void beginStat(float dt);
+    void endStat(float dt);
+    void doAutoTest();
+
+protected:
+    ArmatureMainScene();
+
+    virtual bool isUsingBatchNode() const = 0;
+
+    cocos2d::Label* _infoLabel;
+    cocos2d::EventListenerCustom* _beforeUpdateListener;
+    cocos2d::EventListenerCustom* _afterVisitListener;
+    cocos2d::EventListenerCustom* _afterDrawListener;
+    std::chrono::steady_clock::time_point _frameStart;
+    long long _frameTime;
+    int _frames;
+    ssize_t _drawnBatches;
+
+    bool       isStating;
+    int        statCount;
+    float      totalStatTime;
+    float      minFrameRate;
+    float      maxFrameRate;
+};
+
+class ArmaturePerformTest : public ArmatureMainScene
+{
+public:
+    CREATE_FUNC(ArmaturePerformTest);
+
+    virtual std::string title() const override;
+
+protected:
+    virtual bool isUsingBatchNode() const override { return false; }
+};
+
+class ArmatureBatchNodePerformTest : public ArmatureMainScene
+{
+public:
+    CREATE_FUNC(ArmatureBatchNodePerformTest);
+
+    virtual std::string title() const override;
+
+protected:
+    virtual bool isUsingBatchNode() const override { return true; }
+};
+
+#endif
@@ -0,0 +1,372 @@
+#include "PerformanceCSLoaderTest.h"
+#include "editor-support/cocostudio/ActionTimeline/CSLoader.h"
+#include "editor-support/cocostudio/ActionTimeline/CCActionTimeline.h"
+#include "editor-support/cocostudio/CSParseBinary_generated.h"
+#include "Profile.h"
+#include <chrono>
+
+USING_NS_CC;
+
+static const int kCellCount = 1000;
+static const int kAutoTestRuns = 10;
+static const char* kCellFileName = "PerformanceListCell.csb";
+static const char* kCellPlist = "Images/grossini_quad.plist";
+static const int kAnimatedNodeCount = 300;
+static const char* kAnimatedNodeFileName = "PerformanceAnimatedNode.csb";
+
+PerformceCSLoaderTests::PerformceCSLoaderTests()
+{
+    ADD_TEST_CASE(CSLoaderPerformTest);
+    ADD_TEST_CASE(CSLoaderPrototypePerformTest);
+    ADD_TEST_CASE(CSLoaderTimelinePerformTest);
+}
+
+// A list cell exported the way Cocos Studio does: a root node, a background, an icon,
+// a row of stars grouped under a node and a badge, the sprites using frames of a plist.
+// With animated, the sprites have action tags and an action of 60 frames moves, scales and rotates them,
+// the badge doesn't move and the stars don't scale, as the exported actions often have constant timelines.
+static Data createCellData(bool animated)
+{
+    flatbuffers::FlatBufferBuilder builder;
+
+    int actionTag = 0;
+    auto createOptions = [&builder, &actionTag, animated](const char* name, float x, float y, float width, float height) {
+        if (animated)
+            ++actionTag;
+        flatbuffers::RotationSkew rotationSkew(0, 0);
+        flatbuffers::Position position(x, y);
+        flatbuffers::Scale scale(1, 1);
+        flatbuffers::AnchorPoint anchorPoint(0.5f, 0.5f);
+        flatbuffers::Color color(255, 255, 255, 255);
+        flatbuffers::FlatSize size(width, height);
+        return flatbuffers::CreateWidgetOptions(builder, builder.CreateString(name), actionTag, &rotationSkew, 0, 1, 255, 0,
+                                                &position, &scale, &anchorPoint, &color, &size, 0, 0, 0, 0,
+                                                builder.CreateString(""), builder.CreateString(""),
+                                                builder.CreateString(""), builder.CreateString(""));
+    };
+    auto createSprite = [&builder, &createOptions](const char* name, const char* frame, float x, float y) {
+        auto fileNameData = flatbuffers::CreateResourceData(builder, builder.CreateString(frame), builder.CreateString(kCellPlist), 1);
+        auto options = flatbuffers::CreateSpriteOptions(builder, createOptions(name, x, y, 85, 121), fileNameData);
+        std::vector<flatbuffers::Offset<flatbuffers::NodeTree>> children;
+        return flatbuffers::CreateNodeTree(builder, builder.CreateString("Sprite"), builder.CreateVector(children),
+                                           flatbuffers::CreateOptions(builder, *(flatbuffers::Offset<flatbuffers::Table>*)(&options)), builder.CreateString(""));
+    };
+    // the root of a file is a Node and its options are the WidgetOptions, the nodes inside are SingleNodes
+    auto createNode = [&builder, &createOptions](const char* name, float x, float y, const std::vector<flatbuffers::Offset<flatbuffers::NodeTree>>& children, bool root) {
+        flatbuffers::Offset<flatbuffers::Table> options;
+        auto nodeOptions = createOptions(name, x, y, 0, 0);
+        if (root)
+        {
+            options = *(flatbuffers::Offset<flatbuffers::Table>*)(&nodeOptions);
+        }
+        else
+        {
+            auto singleNodeOptions = flatbuffers::CreateSingleNodeOptions(builder, nodeOptions);
+            options = *(flatbuffers::Offset<flatbuffers::Table>*)(&singleNodeOptions);
+        }
+        return flatbuffers::CreateNodeTree(builder, builder.CreateString(root ? "Node" : "SingleNode"), builder.CreateVector(children),
+                                           flatbuffers::CreateOptions(builder, options), builder.CreateString(""));
+    };
+
+    std::vector<flatbuffers::Offset<flatbuffers::NodeTree>> stars;
+    for (int i = 0; i < 3; ++i)
+    {
+        stars.push_back(createSprite(StringUtils::format("star%d", i).c_str(), "grossini_dance_08.png", i * 30.0f, 0));
+    }
+
+    std::vector<flatbuffers::Offset<flatbuffers::NodeTree>> children;
+    children.push_back(createSprite("background", "grossini_dance_05.png", 0, 0));
+    children.push_back(createSprite("icon", "grossini_dance_06.png", -60, 0));
+    children.push_back(createNode("stars", 0, -30, stars, false));
+    children.push_back(createSprite("badge", "grossini_dance_10.png", 60, 30));
+    auto root = createNode("cell", 0, 0, children, true);
+
+    flatbuffers::Offset<flatbuffers::NodeAction> action = 0;
+    if (animated)
+    {
+        // the sprites were given the action tags 1 to 6 in the order they were created: 3 stars, background, icon, badge
+        std::vector<flatbuffers::Offset<flatbuffers::TimeLine>> timelines;
+        auto easing = flatbuffers::CreateEasingData(builder, cocos2d::tweenfunc::Sine_EaseInOut);
+        auto addPointTimeline = [&builder, &timelines, easing](int tag, const Vec2& from, const Vec2& to) {
+            std::vector<flatbuffers::Offset<flatbuffers::Frame>> frames;
+            for (int i = 0; i <= 2; ++i)
+            {
+                flatbuffers::Position position(i == 1 ? to.x : from.x, i == 1 ? to.y : from.y);
+                frames.push_back(flatbuffers::CreateFrame(builder, flatbuffers::CreatePointFrame(builder, i * 30, 1, &position, easing)));
+            }
+            timelines.push_back(flatbuffers::CreateTimeLine(builder, builder.CreateString("Position"), tag, builder.CreateVector(frames)));
+        };
+        auto addScaleTimeline = [&builder, &timelines](int tag, const char* property, const Vec2& from, const Vec2& to) {
+            std::vector<flatbuffers::Offset<flatbuffers::Frame>> frames;
+            for (int i = 0; i <= 2; ++i)
+            {
+                flatbuffers::Scale scale(i == 1 ? to.x : from.x, i == 1 ? to.y : from.y);
+                frames.push_back(flatbuffers::CreateFrame(builder, 0, flatbuffers::CreateScaleFrame(builder, i * 30, 1, &scale)));
+            }
+            timelines.push_back(flatbuffers::CreateTimeLine(builder, builder.CreateString(property), tag, builder.CreateVector(frames)));
+        };
+
+        for (int i = 0; i < 3; ++i)
+        {
+            addPointTimeline(i + 1, Vec2(i * 30.0f, 0), Vec2(i * 30.0f, 20));
+            addScaleTimeline(i + 1, "Scale", Vec2(1, 1), Vec2(1, 1));
+            addScaleTimeline(i + 1, "RotationSkew", Vec2(0, 0), Vec2(360, 360));
+        }
+        addScaleTimeline(4, "Scale", Vec2(1, 1), Vec2(1.2f, 1.2f));
+        addPointTimeline(5, Vec2(-60, 0), Vec2(-40, 0));
+        addScaleTimeline(5, "RotationSkew", Vec2(0, 0), Vec2(-30, -30));
+        addPointTimeline(6, Vec2(60, 30), Vec2(60, 30));
+        addScaleTimeline(6, "Scale", Vec2(1, 1), Vec2(0.5f, 0.5f));
+
+        action = flatbuffers::CreateNodeAction(builder, 60, 1.0f, builder.CreateVector(timelines));
+    }
+
+    std::vector<flatbuffers::Offset<flatbuffers::String>> textures;
+    textures.push_back(builder.CreateString(kCellPlist));
+    std::vector<flatbuffers::Offset<flatbuffers::String>> texturePngs;
+    std::vector<flatbuffers::Offset<flatbuffers::AnimationInfo>> animations;
+    builder.Finish(flatbuffers::CreateCSParseBinary(builder, 0, builder.CreateVector(textures), builder.CreateVector(texturePngs), root,
+                                                    action, builder.CreateVector(animations)));
+
+    Data data;
+    data.copy(builder.GetBufferPointer(), builder.GetSize());
+    return data;
+}
+
+////////////////////////////////////////////////////////
+//
+// CSLoaderMainScene
+//
+////////////////////////////////////////////////////////
+CSLoaderMainScene::CSLoaderMainScene()
+: _cellParent(nullptr)
+, _infoLabel(nullptr)
+, _totalTime(0)
+, _minTime(-1)
+, _maxTime(-1)
+, _runs(0)
+{
+}
+
+bool CSLoaderMainScene::init()
+{
+    if (!TestCase::init())
+        return false;
+
+    _cellFile = FileUtils::getInstance()->getWritablePath() + kCellFileName;
+    if (!FileUtils::getInstance()->isFileExist(_cellFile))
+    {
+        FileUtils::getInstance()->writeDataToFile(createCellData(false), _cellFile);
+    }
+
+    // the cells of the last run are shown, the previous ones are released
+    _cellParent = Node::create();
+    addChild(_cellParent);
+
+    _infoLabel = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _infoLabel->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    _infoLabel->setPosition(Vec2(VisibleRect::left().x + 10, VisibleRect::top().y - 80));
+    addChild(_infoLabel, 1);
+
+    return true;
+}
+
+std::string CSLoaderMainScene::subtitle() const
+{
+    return genStr("%d list cells of 7 nodes created per second", kCellCount);
+}
+
+void CSLoaderMainScene::onEnter()
+{
+    TestCase::onEnter();
+
+    auto loader = CSLoader::getInstance();
+    if (isUsingPrototype())
+    {
+        loader->prewarmPrototypes({ _cellFile });
+    }
+    else
+    {
+        loader->removePrototype(_cellFile);
+    }
+
+    if (isAutoTesting())
+    {
+        Profile::getInstance()->testCaseBegin(isUsingPrototype() ? "CSLoaderPrototypeTest" : "CSLoaderTest",
+                                              genStrVector("CellCount", nullptr),
+                                              genStrVector("Avg(ms)", "Min(ms)", "Max(ms)", nullptr));
+    }
+
+    schedule(CC_SCHEDULE_SELECTOR(CSLoaderMainScene::instantiate), 1.0f);
+}
+
+void CSLoaderMainScene::onExit()
+{
+    unschedule(CC_SCHEDULE_SELECTOR(CSLoaderMainScene::instantiate));
+    CSLoader::getInstance()->removePrototype(_cellFile);
+
+    TestCase::onExit();
+}
+
+void CSLoaderMainScene::instantiate(float dt)
+{
+    _cellParent->removeAllChildren();
+
+    auto s = Director::getInstance()->getWinSize();
+    const int columns = 40;
+    const int rows = kCellCount / columns;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kCellCount; ++i)
+    {
+        auto cell = CSLoader::createNode(_cellFile);
+        cell->setScale(0.1f);
+        cell->setPosition(Vec2(s.width * (i % columns + 0.5f) / columns, s.height * 0.1f + s.height * 0.7f * (i / columns) / rows));
+        _cellParent->addChild(cell);
+    }
+    auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    _totalTime += time;
+    _minTime = _minTime < 0 ? time : std::min(_minTime, (long long)time);
+    _maxTime = std::max(_maxTime, (long long)time);
+    ++_runs;
+    _infoLabel->setString(genStr("last: %.2f ms\naverage: %.2f ms", time / 1000.0f, _totalTime / _runs / 1000.0f));
+
+    if (isAutoTesting() && _runs == kAutoTestRuns)
+    {
+        Profile::getInstance()->addTestResult(genStrVector(genStr("%d", kCellCount).c_str(), nullptr),
+                                              genStrVector(genStr("%.2f", _totalTime / _runs / 1000.0f).c_str(),
+                                                           genStr("%.2f", _minTime / 1000.0f).c_str(),
+                                                           genStr("%.2f", _maxTime / 1000.0f).c_str(), nullptr));
+
+        // a single measure, the auto test ends here
+        Profile::getInstance()->testCaseEnd();
+        setAutoTesting(false);
+    }
+}
+
+////////////////////////////////////////////////////////
+//
+// CSLoaderPerformTest
+//
+////////////////////////////////////////////////////////
+std::string CSLoaderPerformTest::title() const
+{
+    return "CSLoader Test";
+}
+
+////////////////////////////////////////////////////////
+//
+// CSLoaderPrototypePerformTest
+//
+////////////////////////////////////////////////////////
+std::string CSLoaderPrototypePerformTest::title() const
+{
+    return "CSLoader with Prototypes Test";
+}
+
+////////////////////////////////////////////////////////
+//
+// CSLoaderTimelinePerformTest
+//
+////////////////////////////////////////////////////////
+CSLoaderTimelinePerformTest::CSLoaderTimelinePerformTest()
+: _infoLabel(nullptr)
+, _beforeUpdateListener(nullptr)
+, _afterUpdateListener(nullptr)
+, _updateTime(0)
+, _totalTime(0)
+, _frames(0)
+, _runs(0)
+{
+}
+
+bool CSLoaderTimelinePerformTest::init()
+{
+    if (!TestCase::init())
+        return false;
+
+    std::string file = FileUtils::getInstance()->getWritablePath() + kAnimatedNodeFileName;
+    if (!FileUtils::getInstance()->isFileExist(file))
+    {
+        FileUtils::getInstance()->writeDataToFile(createCellData(true), file);
+    }
+
+    auto s = Director::getInstance()->getWinSize();
+    const int columns = 20;
+    const int rows = kAnimatedNodeCount / columns;
+    for (int i = 0; i < kAnimatedNodeCount; ++i)
+    {
+        auto node = CSLoader::createNode(file);
+        node->setScale(0.2f);
+        node->setPosition(Vec2(s.width * (i % columns + 0.5f) / columns, s.height * 0.1f + s.height * 0.7f * (i / columns) / rows));
+        addChild(node);
+
+        // the actions are clones of the one cached for the file, started on different frames
+        auto action = CSLoader::createTimeline(file);
+        node->runAction(action);
+        action->gotoFrameAndPlay(0, action->getDuration(), i % action->getDuration(), true);
+    }
+
+    _infoLabel = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _infoLabel->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    _infoLabel->setPosition(Vec2(VisibleRect::left().x + 10, VisibleRect::top().y - 80));
+    addChild(_infoLabel, 1);
+
+    return true;
+}
+
+std::string CSLoaderTimelinePerformTest::title() const
+{
+    return "CSLoader Timeline Test";
+}
+
+std::string CSLoaderTimelinePerformTest::subtitle() const
+{
+    return genStr("%d animated csb nodes of 6 sprites", kAnimatedNodeCount);
+}
+
+void CSLoaderTimelinePerformTest::onEnter()
+{
+    TestCase::onEnter();
+
+    // the update of the scene, where the actions set the properties of the sprites
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    _beforeUpdateListener = dispatcher->addCustomEventListener(Director::EVENT_BEFORE_UPDATE, [this](EventCustom*){
+        _updateStart = std::chrono::steady_clock::now();
+    });
+    _afterUpdateListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_UPDATE, [this](EventCustom*){
+        _updateTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _updateStart).count();
+        if (++_frames < 60)
+            return;
+
+        _infoLabel->setString(genStr("update: %.3f ms", _updateTime / 60 / 1000.0f));
+        _totalTime += _updateTime;
+        _updateTime = 0;
+        _frames = 0;
+
+        if (isAutoTesting() && ++_runs == kAutoTestRuns)
+        {
+            Profile::getInstance()->addTestResult(genStrVector(genStr("%d", kAnimatedNodeCount).c_str(), nullptr),
+                                                  genStrVector(genStr("%.3f", _totalTime / _runs / 60 / 1000.0f).c_str(), nullptr));
+            Profile::getInstance()->testCaseEnd();
+            setAutoTesting(false);
+        }
+    });
+
+    if (isAutoTesting())
+    {
+        Profile::getInstance()->testCaseBegin("CSLoaderTimelineTest",
+                                              genStrVector("NodeCount", nullptr),
+                                              genStrVector("Update(ms)", nullptr));
+    }
+}
+
+void CSLoaderTimelinePerformTest::onExit()
+{
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    dispatcher->removeEventListener(_beforeUpdateListener);
+    dispatcher->removeEventListener(_afterUpdateListener);
+
+    TestCase::onExit();
+}
@@ -0,0 +1,80 @@
+#ifndef __PERFORMANCE_CSLOADER_TEST_H__
+#define __PERFORMANCE_CSLOADER_TEST_H__
+
+#include "BaseTest.h"
+#include <chrono>
+
+DEFINE_TEST_SUITE(PerformceCSLoaderTests);
+
+class CSLoaderMainScene : public TestCase
+{
+public:
+    virtual bool init() override;
+    virtual std::string subtitle() const override;
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    void instantiate(float dt);
+
+protected:
+    CSLoaderMainScene();
+
+    virtual bool isUsingPrototype() const = 0;
+
+    std::string _cellFile;
+    cocos2d::Node* _cellParent;
+    cocos2d::Label* _infoLabel;
+    long long _totalTime;
+    long long _minTime;
+    long long _maxTime;
+    int _runs;
+};
+
+class CSLoaderPerformTest : public CSLoaderMainScene
+{
+public:
+    CREATE_FUNC(CSLoaderPerformTest);
+
+    virtual std::string title() const override;
+
+protected:
+    virtual bool isUsingPrototype() const override { return false; }
+};
+
+class CSLoaderPrototypePerformTest : public CSLoaderMainScene
+{
+public:
+    CREATE_FUNC(CSLoaderPrototypePerformTest);
+
+    virtual std::string title() const override;
+
+protected:
+    virtual bool isUsingPrototype() const override { return true; }
+};
+
+class CSLoaderTimelinePerformTest : public TestCase
+{
+public:
+    CREATE_FUNC(CSLoaderTimelinePerformTest);
+
+    virtual bool init() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+
+protected:
+    CSLoaderTimelinePerformTest();
+
+    cocos2d::Label* _infoLabel;
+    cocos2d::EventListenerCustom* _beforeUpdateListener;
+    cocos2d::EventListenerCustom* _afterUpdateListener;
+    std::chrono::steady_clock::time_point _updateStart;
+    long long _updateTime;
+    long long _totalTime;
+    int _frames;
+    int _runs;
+};
+
+#endif
@@ -32,6 +32,8 @@ public:
         addTest("Callback Tests", []() { return new PerformceCallbackTests(); });
         addTest("Math Tests", []() { return new PerformceMathTests(); });
         addTest("Container Tests", []() { return new PerformceContainerTests(); });
+        addTest("Armature Tests", []() { return new PerformceArmatureTests(); });
+        addTest("CSLoader Tests", []() { return new PerformceCSLoaderTests(); });
     }
 };
 
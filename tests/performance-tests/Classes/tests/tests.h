@@ -3,6 +3,8 @@
 
 // sort them alphabetically. thanks
 #include "PerformanceAllocTest.h"
+#include "PerformanceArmatureTest.h"
+#include "PerformanceCSLoaderTest.h"
 #include "PerformanceNodeChildrenTest.h"
 #include "PerformanceParticleTest.h"
 #include "PerformanceParticle3DTest.h"
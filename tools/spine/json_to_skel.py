@@ -0,0 +1,462 @@
+#!/usr/bin/python
+#-*- coding: UTF-8 -*-
+# ----------------------------------------------------------------------------
+# Convert a Spine 3.4 JSON skeleton to the binary format read by spSkeletonBinary.
+#
+# License: MIT
+# ----------------------------------------------------------------------------
+'''
+Convert a Spine 3.4 JSON skeleton to the binary format (".skel") read by spSkeletonBinary.
+
+The binary skeletons of tests/cpp-tests/Resources/spine are generated with it:
+    python tools/spine/json_to_skel.py spineboy.json spineboy.skel
+
+The Spine editor exports the same layout, the nonessential data (the colors of the
+bones and the attachments shown by the editor) is written with the editor defaults.
+'''
+
+import json
+import struct
+
+from argparse import ArgumentParser
+from collections import OrderedDict
+
+BLEND_MODES = { 'normal': 0, 'additive': 1, 'multiply': 2, 'screen': 3 }
+POSITION_MODES = { 'fixed': 0, 'percent': 1 }
+SPACING_MODES = { 'length': 0, 'fixed': 1, 'percent': 2 }
+ROTATE_MODES = { 'tangent': 0, 'chain': 1, 'chainScale': 2 }
+
+ATTACHMENT_REGION = 0
+ATTACHMENT_BOUNDING_BOX = 1
+ATTACHMENT_MESH = 2
+ATTACHMENT_LINKED_MESH = 3
+ATTACHMENT_PATH = 4
+
+SLOT_TIMELINES = { 'attachment': 0, 'color': 1 }
+BONE_TIMELINES = { 'rotate': 0, 'translate': 1, 'scale': 2, 'shear': 3 }
+PATH_TIMELINES = { 'position': 0, 'spacing': 1, 'mix': 2 }
+
+CURVE_LINEAR = 0
+CURVE_STEPPED = 1
+CURVE_BEZIER = 2
+
+class BinaryWriter(object):
+    '''Big endian values, as written by the Spine editor.'''
+
+    def __init__(self):
+        self.data = bytearray()
+
+    def write_byte(self, value):
+        self.data.append(value & 0xFF)
+
+    def write_signed_byte(self, value):
+        self.data += struct.pack('>b', value)
+
+    def write_bool(self, value):
+        self.write_byte(1 if value else 0)
+
+    def write_short(self, value):
+        self.data += struct.pack('>H', value)
+
+    def write_float(self, value):
+        self.data += struct.pack('>f', value)
+
+    def write_varint(self, value, optimize_positive=True):
+        if not optimize_positive:
+            value = ((value << 1) ^ (value >> 31)) & 0xFFFFFFFF
+        for i in range(5):
+            if value < 0x80 or i == 4:
+                self.write_byte(value)
+                return
+            self.write_byte((value & 0x7F) | 0x80)
+            value >>= 7
+
+    def write_string(self, value):
+        if value is None:
+            self.write_varint(0)
+            return
+        encoded = value.encode('utf-8')
+        self.write_varint(len(encoded) + 1)
+        self.data += encoded
+
+    def write_color(self, value):
+        if value is None:
+            value = 'ffffffff'
+        for i in range(4):
+            self.write_byte(int(value[i * 2:i * 2 + 2], 16))
+
+def write_curve(writer, frame):
+    curve = frame.get('curve')
+    if curve == 'stepped':
+        writer.write_byte(CURVE_STEPPED)
+    elif isinstance(curve, list):
+        writer.write_byte(CURVE_BEZIER)
+        for value in curve:
+            writer.write_float(value)
+    else:
+        writer.write_byte(CURVE_LINEAR)
+
+def write_frames(writer, frames, write_frame):
+    '''The curve of the last frame isn't written.'''
+    writer.write_varint(len(frames))
+    for i, frame in enumerate(frames):
+        writer.write_float(frame.get('time', 0))
+        write_frame(frame)
+        if i < len(frames) - 1:
+            write_curve(writer, frame)
+
+def write_floats(writer, values, keys):
+    for key, default in keys:
+        writer.write_float(values.get(key, default))
+
+class SkeletonConverter(object):
+
+    def __init__(self, skeleton):
+        self.skeleton = skeleton
+        self.writer = BinaryWriter()
+
+        self.bones = skeleton['bones']
+        self.slots = skeleton.get('slots', [])
+        self.iks = skeleton.get('ik', [])
+        self.transforms = skeleton.get('transform', [])
+        self.paths = skeleton.get('path', [])
+        self.skins = skeleton.get('skins', OrderedDict())
+        self.events = skeleton.get('events', OrderedDict())
+
+        self.bone_indices = self.indices([bone['name'] for bone in self.bones])
+        self.slot_indices = self.indices([slot['name'] for slot in self.slots])
+        self.ik_indices = self.indices([ik['name'] for ik in self.iks])
+        self.transform_indices = self.indices([transform['name'] for transform in self.transforms])
+        self.path_indices = self.indices([path['name'] for path in self.paths])
+        self.event_indices = self.indices(list(self.events.keys()))
+
+        # the default skin is the first one
+        self.skin_names = (['default'] if 'default' in self.skins else []) + [name for name in self.skins if name != 'default']
+        self.skin_indices = self.indices(self.skin_names)
+
+    @staticmethod
+    def indices(names):
+        return dict((name, i) for i, name in enumerate(names))
+
+    def convert(self):
+        self.write_header()
+        self.write_bones()
+        self.write_slots()
+        self.write_constraints()
+
+        self.write_skin('default')
+        other_skins = [name for name in self.skin_names if name != 'default']
+        self.writer.write_varint(len(other_skins))
+        for name in other_skins:
+            self.writer.write_string(name)
+            self.write_skin(name)
+
+        self.write_events()
+
+        animations = self.skeleton.get('animations', OrderedDict())
+        self.writer.write_varint(len(animations))
+        for name, animation in animations.items():
+            self.writer.write_string(name)
+            self.write_animation(animation)
+
+        return bytes(self.writer.data)
+
+    def write_header(self):
+        w = self.writer
+        header = self.skeleton.get('skeleton', {})
+        w.write_string(header.get('hash'))
+        w.write_string(header.get('spine'))
+        w.write_float(header.get('width', 0))
+        w.write_float(header.get('height', 0))
+        # nonessential data
+        w.write_bool(True)
+        w.write_string(header.get('images'))
+
+    def write_bones(self):
+        w = self.writer
+        w.write_varint(len(self.bones))
+        for i, bone in enumerate(self.bones):
+            w.write_string(bone['name'])
+            if i > 0:
+                w.write_varint(self.bone_indices[bone['parent']])
+            write_floats(w, bone, (('rotation', 0), ('x', 0), ('y', 0), ('scaleX', 1), ('scaleY', 1),
+                                   ('shearX', 0), ('shearY', 0), ('length', 0)))
+            w.write_bool(bone.get('inheritRotation', True))
+            w.write_bool(bone.get('inheritScale', True))
+            w.write_color(bone.get('color', '989898ff'))
+
+    def write_slots(self):
+        w = self.writer
+        w.write_varint(len(self.slots))
+        for slot in self.slots:
+            w.write_string(slot['name'])
+            w.write_varint(self.bone_indices[slot['bone']])
+            w.write_color(slot.get('color'))
+            w.write_string(slot.get('attachment'))
+            w.write_varint(BLEND_MODES[slot.get('blend', 'normal')])
+
+    def write_constraint_bones(self, constraint):
+        self.writer.write_varint(len(constraint['bones']))
+        for bone in constraint['bones']:
+            self.writer.write_varint(self.bone_indices[bone])
+
+    def write_constraints(self):
+        w = self.writer
+        w.write_varint(len(self.iks))
+        for ik in self.iks:
+            w.write_string(ik['name'])
+            self.write_constraint_bones(ik)
+            w.write_varint(self.bone_indices[ik['target']])
+            w.write_float(ik.get('mix', 1))
+            w.write_signed_byte(1 if ik.get('bendPositive', True) else -1)
+
+        w.write_varint(len(self.transforms))
+        for transform in self.transforms:
+            w.write_string(transform['name'])
+            self.write_constraint_bones(transform)
+            w.write_varint(self.bone_indices[transform['target']])
+            write_floats(w, transform, (('rotation', 0), ('x', 0), ('y', 0), ('scaleX', 0), ('scaleY', 0), ('shearY', 0),
+                                        ('rotateMix', 1), ('translateMix', 1), ('scaleMix', 1), ('shearMix', 1)))
+
+        w.write_varint(len(self.paths))
+        for path in self.paths:
+            w.write_string(path['name'])
+            self.write_constraint_bones(path)
+            w.write_varint(self.slot_indices[path['target']])
+            w.write_varint(POSITION_MODES[path.get('positionMode', 'percent')])
+            w.write_varint(SPACING_MODES[path.get('spacingMode', 'length')])
+            w.write_varint(ROTATE_MODES[path.get('rotateMode', 'tangent')])
+            write_floats(w, path, (('rotation', 0), ('position', 0), ('spacing', 0), ('rotateMix', 1), ('translateMix', 1)))
+
+    def write_vertices(self, attachment, vertex_count):
+        '''The weighted vertices are the bone count, then the bone index, x, y and weight of each bone.'''
+        w = self.writer
+        vertices = attachment['vertices']
+        if len(vertices) == vertex_count * 2:
+            w.write_bool(False)
+            for value in vertices:
+                w.write_float(value)
+            return
+
+        w.write_bool(True)
+        i = 0
+        while i < len(vertices):
+            bone_count = int(vertices[i])
+            i += 1
+            w.write_varint(bone_count)
+            for _ in range(bone_count):
+                w.write_varint(int(vertices[i]))
+                w.write_float(vertices[i + 1])
+                w.write_float(vertices[i + 2])
+                w.write_float(vertices[i + 3])
+                i += 4
+
+    def write_attachment(self, name, attachment):
+        w = self.writer
+        w.write_string(attachment.get('name'))
+        kind = attachment.get('type', 'region')
+        path = attachment.get('path')
+        if kind == 'region':
+            w.write_byte(ATTACHMENT_REGION)
+            w.write_string(path)
+            write_floats(w, attachment, (('rotation', 0), ('x', 0), ('y', 0), ('scaleX', 1), ('scaleY', 1),
+                                         ('width', 32), ('height', 32)))
+            w.write_color(attachment.get('color'))
+        elif kind == 'boundingbox':
+            w.write_byte(ATTACHMENT_BOUNDING_BOX)
+            vertex_count = attachment.get('vertexCount', 0)
+            w.write_varint(vertex_count)
+            self.write_vertices(attachment, vertex_count)
+            w.write_color('60f000ff')
+        elif kind == 'mesh' and 'parent' not in attachment:
+            w.write_byte(ATTACHMENT_MESH)
+            w.write_string(path)
+            w.write_color(attachment.get('color'))
+            uvs = attachment['uvs']
+            vertex_count = len(uvs) // 2
+            w.write_varint(vertex_count)
+            for value in uvs:
+                w.write_float(value)
+            w.write_varint(len(attachment['triangles']))
+            for index in attachment['triangles']:
+                w.write_short(index)
+            self.write_vertices(attachment, vertex_count)
+            w.write_varint(attachment.get('hull', 0))
+            edges = attachment.get('edges', [])
+            w.write_varint(len(edges))
+            for index in edges:
+                w.write_short(index)
+            w.write_float(attachment.get('width', 32))
+            w.write_float(attachment.get('height', 32))
+        elif kind in ('mesh', 'linkedmesh'):
+            w.write_byte(ATTACHMENT_LINKED_MESH)
+            w.write_string(path)
+            w.write_color(attachment.get('color'))
+            w.write_string(attachment.get('skin'))
+            w.write_string(attachment['parent'])
+            w.write_bool(attachment.get('deform', True))
+            w.write_float(attachment.get('width', 32))
+            w.write_float(attachment.get('height', 32))
+        elif kind == 'path':
+            w.write_byte(ATTACHMENT_PATH)
+            w.write_bool(attachment.get('closed', False))
+            w.write_bool(attachment.get('constantSpeed', True))
+            vertex_count = attachment.get('vertexCount', 0)
+            w.write_varint(vertex_count)
+            self.write_vertices(attachment, vertex_count)
+            for value in attachment['lengths']:
+                w.write_float(value)
+            w.write_color('ff7f00ff')
+        else:
+            raise ValueError('%s: unknown attachment type %s' % (name, kind))
+
+    def write_skin(self, name):
+        w = self.writer
+        skin = self.skins.get(name)
+        if not skin:
+            w.write_varint(0)
+            return
+
+        w.write_varint(len(skin))
+        for slot, attachments in skin.items():
+            w.write_varint(self.slot_indices[slot])
+            w.write_varint(len(attachments))
+            for attachment_name, attachment in attachments.items():
+                w.write_string(attachment_name)
+                self.write_attachment(attachment_name, attachment)
+
+    def write_events(self):
+        w = self.writer
+        w.write_varint(len(self.events))
+        for name, event in self.events.items():
+            w.write_string(name)
+            w.write_varint(event.get('int', 0), False)
+            w.write_float(event.get('float', 0))
+            w.write_string(event.get('string'))
+
+    def write_animation(self, animation):
+        w = self.writer
+
+        slots = animation.get('slots', OrderedDict())
+        w.write_varint(len(slots))
+        for slot, timelines in slots.items():
+            w.write_varint(self.slot_indices[slot])
+            w.write_varint(len(timelines))
+            for kind, frames in timelines.items():
+                w.write_byte(SLOT_TIMELINES[kind])
+                if kind == 'color':
+                    write_frames(w, frames, lambda frame: w.write_color(frame['color']))
+                else:
+                    # the attachment frames have no curve
+                    w.write_varint(len(frames))
+                    for frame in frames:
+                        w.write_float(frame.get('time', 0))
+                        w.write_string(frame.get('name'))
+
+        bones = animation.get('bones', OrderedDict())
+        w.write_varint(len(bones))
+        for bone, timelines in bones.items():
+            w.write_varint(self.bone_indices[bone])
+            w.write_varint(len(timelines))
+            for kind, frames in timelines.items():
+                w.write_byte(BONE_TIMELINES[kind])
+                if kind == 'rotate':
+                    write_frames(w, frames, lambda frame: w.write_float(frame.get('angle', 0)))
+                else:
+                    write_frames(w, frames, lambda frame: write_floats(w, frame, (('x', 0), ('y', 0))))
+
+        iks = animation.get('ik', OrderedDict())
+        w.write_varint(len(iks))
+        for ik, frames in iks.items():
+            w.write_varint(self.ik_indices[ik])
+            def write_ik_frame(frame):
+                w.write_float(frame.get('mix', 1))
+                w.write_signed_byte(1 if frame.get('bendPositive', True) else -1)
+            write_frames(w, frames, write_ik_frame)
+
+        transforms = animation.get('transform', OrderedDict())
+        w.write_varint(len(transforms))
+        for transform, frames in transforms.items():
+            w.write_varint(self.transform_indices[transform])
+            write_frames(w, frames, lambda frame: write_floats(w, frame, (('rotateMix', 1), ('translateMix', 1),
+                                                                          ('scaleMix', 1), ('shearMix', 1))))
+
+        paths = animation.get('paths', OrderedDict())
+        w.write_varint(len(paths))
+        for path, timelines in paths.items():
+            w.write_varint(self.path_indices[path])
+            w.write_varint(len(timelines))
+            for kind, frames in timelines.items():
+                w.write_byte(PATH_TIMELINES[kind])
+                if kind == 'mix':
+                    write_frames(w, frames, lambda frame: write_floats(w, frame, (('rotateMix', 1), ('translateMix', 1))))
+                else:
+                    write_frames(w, frames, lambda frame, kind=kind: w.write_float(frame.get(kind, 0)))
+
+        deforms = animation.get('deform', animation.get('ffd', OrderedDict()))
+        w.write_varint(len(deforms))
+        for skin, slots in deforms.items():
+            w.write_varint(self.skin_indices[skin])
+            w.write_varint(len(slots))
+            for slot, attachments in slots.items():
+                w.write_varint(self.slot_indices[slot])
+                w.write_varint(len(attachments))
+                for attachment, frames in attachments.items():
+                    w.write_string(attachment)
+                    def write_deform_frame(frame):
+                        vertices = frame.get('vertices')
+                        if vertices is None:
+                            w.write_varint(0)
+                            return
+                        w.write_varint(len(vertices))
+                        w.write_varint(frame.get('offset', 0))
+                        for value in vertices:
+                            w.write_float(value)
+                    write_frames(w, frames, write_deform_frame)
+
+        draw_order = animation.get('drawOrder', animation.get('draworder'))
+        if draw_order is None:
+            w.write_varint(0)
+        else:
+            w.write_varint(len(draw_order))
+            for frame in draw_order:
+                w.write_float(frame.get('time', 0))
+                offsets = frame.get('offsets', [])
+                w.write_varint(len(offsets))
+                for offset in offsets:
+                    w.write_varint(self.slot_indices[offset['slot']])
+                    # negative offsets are written as unsigned 32 bits values
+                    w.write_varint(offset['offset'] & 0xFFFFFFFF)
+
+        events = animation.get('events')
+        if events is None:
+            w.write_varint(0)
+        else:
+            w.write_varint(len(events))
+            for frame in events:
+                event = self.events[frame['name']]
+                w.write_float(frame.get('time', 0))
+                w.write_varint(self.event_indices[frame['name']])
+                w.write_varint(frame.get('int', event.get('int', 0)), False)
+                w.write_float(frame.get('float', event.get('float', 0)))
+                if 'string' in frame:
+                    w.write_bool(True)
+                    w.write_string(frame['string'])
+                else:
+                    w.write_bool(False)
+
+def convert(json_file, skel_file):
+    with open(json_file) as f:
+        skeleton = json.load(f, object_pairs_hook=OrderedDict)
+    data = SkeletonConverter(skeleton).convert()
+    with open(skel_file, 'wb') as f:
+        f.write(data)
+
+# -------------- entrance --------------
+if __name__ == '__main__':
+    parser = ArgumentParser(description="Convert a Spine 3.4 JSON skeleton to a binary skeleton.")
+    parser.add_argument('json_file', help='The JSON skeleton exported by Spine.')
+    parser.add_argument('skel_file', help='The binary skeleton to write.')
+    args = parser.parse_args()
+
+    convert(args.json_file, args.skel_file)